@@ -0,0 +1,52 @@
+#pragma once    // BENCHUTILS.H
+
+// Tiny helpers shared by the benchmarks, nothing clever.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+
+namespace RiRi::Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    [[nodiscard]] inline double secondsSince(const Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /// Resident set size of this process in bytes, 0 where we don't know how to ask.
+    [[nodiscard]] inline std::size_t currentRss() {
+#ifdef __linux__
+        std::FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (!statm) return 0;
+        long pages = 0, resident = 0;
+        const int read = std::fscanf(statm, "%ld %ld", &pages, &resident);
+        std::fclose(statm);
+        return read == 2 ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    [[nodiscard]] inline double mib(const std::size_t bytes) {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    /// `argv[index]` as a number, or `fallback` if it isn't there.
+    [[nodiscard]] inline std::size_t argOr(const int argc, char** argv, const int index, const std::size_t fallback) {
+        return argc > index ? std::strtoull(argv[index], nullptr, 10) : fallback;
+    }
+
+    /// `argv[index]` as a string, or `fallback` if it isn't there.
+    [[nodiscard]] inline std::string argOr(const int argc, char** argv, const int index, const char* fallback) {
+        return argc > index ? argv[index] : fallback;
+    }
+
+} // namespace RiRi::Bench
@@ -0,0 +1,68 @@
+// How long CLEAR and UNLINK keep the caller (and the shard lock), and how long the freeing behind them takes.
+//
+// usage: RiRi_bench_clear [plain|concurrent] [keys] [shards] [big value MiB]
+//
+//  - plain:      the default store layout
+//  - concurrent: StoreOptions::concurrentReads, every key also has its copy for lock-free readers
+//
+// Fills a store with `keys` keys (40 byte string values), CLEARs it, and waits for the background
+// freer to finish; then does the same for one big value, DELETE against UNLINK. The caller's time
+// should stay flat whatever the size; the background time is what CLEAR used to cost the caller.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "LazyFree.h"
+#include "MemoryMaps.h"
+#include "Reclaimer.h"
+
+#include <cstdint>
+#include <string>
+
+
+using namespace RiRi;
+
+int main(int argc, char** argv) {
+    const std::string mode = Bench::argOr(argc, argv, 1, "plain");
+    const std::size_t keys = Bench::argOr(argc, argv, 2, std::size_t{4'000'000});
+    const std::size_t shards = Bench::argOr(argc, argv, 3, Internal::DEFAULT_SHARD_COUNT);
+    const std::size_t big_mib = Bench::argOr(argc, argv, 4, std::size_t{256});
+
+    Internal::RapidStore store({
+        .initialCapacity = 0,
+        .shardCount = shards,
+        .concurrentReads = mode == "concurrent"
+    });
+
+    std::string key;
+    for (std::size_t n = 0; n < keys; ++n) {
+        key.assign("tenant:42:session:");
+        key.append(std::to_string(n));
+        Internal::setValue(store, key, RapidDataType{std::string(40, 'v')});
+    }
+    const std::size_t rss = Bench::currentRss();
+
+    auto start = Bench::Clock::now();
+    Internal::clearMap(store);
+    const double cleared = Bench::secondsSince(start);
+    start = Bench::Clock::now();
+    Internal::epochCollect();       // the copies for lock-free readers reach the freer through the reclaimer
+    Internal::lazyFreeWait();
+    const double freed = Bench::secondsSince(start);
+
+    std::printf("%-10s CLEAR  %10zu keys  %3zu shards  %8.1f MiB   caller %9.3f ms   background %9.3f ms\n",
+        mode.c_str(), keys, store.shardCount(), Bench::mib(rss), cleared * 1e3, freed * 1e3);
+
+    for (const bool unlink : {false, true}) {
+        Internal::setValue(store, "big", RapidDataType{std::string(big_mib << 20, 'b')});
+        start = Bench::Clock::now();
+        const bool gone = unlink ? Internal::unlinkKey(store, "big") : Internal::deleteKey(store, "big");
+        const double took = Bench::secondsSince(start);
+        start = Bench::Clock::now();
+        Internal::epochCollect();
+        Internal::lazyFreeWait();
+        std::printf("%-10s %-6s %6zu MiB value                        caller %9.3f ms   background %9.3f ms\n",
+            mode.c_str(), unlink ? "UNLINK" : "DELETE", big_mib, took * 1e3, Bench::secondsSince(start) * 1e3);
+        if (!gone) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+// What mass deletions leave behind, and what COMPACT (or `compactBelow`) gives back.
+//
+// usage: RiRi_bench_compact [none|manual|auto] [keys] [shards] [percent deleted]
+//
+//  - none:   delete and leave it, the memory a store used to keep for good
+//  - manual: delete, then COMPACT
+//  - auto:   StoreOptions::compactBelow = 0.25, the deleting writes compact as they go
+//
+// Fills a store with `keys` keys (40 byte string values) and deletes `percent` of them. Prints the
+// table and slab bytes before and after, the time COMPACT took, and the slowest DELETE: the pauses
+// compaction adds to the writes (a shrink or a step of moving strings) should stay in microseconds.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "MemoryMaps.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+
+using namespace RiRi;
+
+int main(int argc, char** argv) {
+    const std::string mode = Bench::argOr(argc, argv, 1, "manual");
+    const std::size_t keys = Bench::argOr(argc, argv, 2, std::size_t{4'000'000});
+    const std::size_t shards = Bench::argOr(argc, argv, 3, Internal::DEFAULT_SHARD_COUNT);
+    const std::size_t percent = std::min(Bench::argOr(argc, argv, 4, std::size_t{80}), std::size_t{100});
+
+    Internal::RapidStore store({
+        .initialCapacity = 0,
+        .shardCount = shards,
+        .compactBelow = mode == "auto" ? 0.25f : 0.0f
+    });
+
+    const auto key = [](const std::size_t n) { return "tenant:42:session:" + std::to_string(n); };
+    for (std::size_t n = 0; n < keys; ++n) {
+        Internal::setValue(store, key(n), RapidDataType{std::string(40, 'v')});
+    }
+    const auto footprint = [&store] {
+        const Internal::RapidMemoryStats stats = Internal::memoryStats(store);
+        return stats.bucketBytes + stats.entryBytes + stats.slabBytes;
+    };
+    const std::size_t filled = footprint();
+
+    double slowest = 0;
+    for (std::size_t n = 0; n < keys; ++n) {
+        if (n % 100 >= percent) continue;
+        const auto start = Bench::Clock::now();
+        Internal::deleteKey(store, key(n));
+        slowest = std::max(slowest, Bench::secondsSince(start));
+    }
+    const std::size_t deleted = footprint();
+
+    const auto start = Bench::Clock::now();
+    const std::size_t reclaimed = mode == "manual" ? Internal::compactStore(store) : 0;
+    const double took = Bench::secondsSince(start);
+
+    std::printf("%-6s %10zu keys  %3zu shards  %3zu%% deleted   filled %8.1f MiB   deleted %8.1f MiB   after %8.1f MiB"
+                "   COMPACT %8.3f ms (%8.1f MiB back)   slowest DELETE %7.1f us\n",
+        mode.c_str(), keys, store.shardCount(), percent, Bench::mib(filled), Bench::mib(deleted), Bench::mib(footprint()),
+        took * 1e3, Bench::mib(reclaimed), slowest * 1e6);
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Random GETs on a store much bigger than the TLB covers, with its tables on normal pages and then on huge ones.
+//
+// usage: RiRi_bench_hugepages [keys] [lookups]
+//
+// Every lookup goes to a random bucket and a random entry, two pages nobody touched lately: on 4K
+// pages that's (nearly) two dTLB misses per GET, on 2MB pages most of them go away. dTLB misses are
+// read off the CPU's counters (perf_event_open); where we aren't allowed to (containers, a strict
+// perf_event_paranoid) they read "n/a" and only the timings are left.
+//
+// Whether the huge pages were explicit (a pool reserved through /proc/sys/vm/nr_hugepages) or
+// transparent, and how much of the process THP ended up backing, is printed along with them.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "PageAllocator.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+using namespace RiRi;
+
+namespace {
+
+    /// dTLB load misses of this thread, while it's running; `valid()` is false if the kernel said no.
+    class DtlbMisses {
+    public:
+        DtlbMisses() {
+#ifdef __linux__
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            _fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+        ~DtlbMisses() {
+#ifdef __linux__
+            if (valid()) close(_fd);
+#endif
+        }
+
+        [[nodiscard]] bool valid() const { return _fd >= 0; }
+
+        void start() {
+#ifdef __linux__
+            if (!valid()) return;
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        [[nodiscard]] std::uint64_t stop() {
+            std::uint64_t count = 0;
+#ifdef __linux__
+            if (!valid()) return 0;
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+            return count;
+        }
+
+    private:
+        int _fd = -1;
+    };
+
+
+    /// Anonymous memory of this process on transparent huge pages, in bytes, 0 where we can't tell.
+    [[nodiscard]] std::size_t transparentHugeBytes() {
+        std::size_t kib = 0;
+#ifdef __linux__
+        std::FILE* rollup = std::fopen("/proc/self/smaps_rollup", "r");
+        if (!rollup) return 0;
+        char line[256];
+        while (std::fgets(line, sizeof(line), rollup)) {
+            if (std::sscanf(line, "AnonHugePages: %zu kB", &kib) == 1) break;
+        }
+        std::fclose(rollup);
+#endif
+        return kib * 1024;
+    }
+
+
+    void run(const bool huge, const std::size_t keys, const std::vector<std::string>& lookups) {
+        Internal::RapidStore store({.initialCapacity = keys, .hugePages = huge});
+        for (std::size_t n = 0; n < keys; ++n) {
+            Internal::setValue(store, "tenant:42:session:" + std::to_string(n), RapidDataType{static_cast<std::int64_t>(n)});
+        }
+
+        DtlbMisses misses;
+        std::size_t found = 0;
+        misses.start();
+        const auto start = Bench::Clock::now();
+        for (const std::string& key : lookups) {
+            found += Internal::getValue(store, key) != nullptr;
+        }
+        const double seconds = Bench::secondsSince(start);
+        const std::uint64_t missed = misses.stop();
+
+        const auto per_get = static_cast<double>(missed) / static_cast<double>(lookups.size());
+        std::printf("%-6s %10zu keys   %6.2f Mops/s   dTLB misses/GET %s   THP %8.1f MiB%s\n",
+            huge ? "huge" : "normal", keys, static_cast<double>(lookups.size()) / seconds / 1e6,
+            misses.valid() ? std::to_string(per_get).substr(0, 5).c_str() : "n/a  ",
+            Bench::mib(transparentHugeBytes()), huge && Internal::explicitHugePages() ? "   (explicit pages)" : "");
+        if (found != lookups.size()) std::printf("  lost %zu keys!\n", lookups.size() - found);
+    }
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    const std::size_t keys = Bench::argOr(argc, argv, 1, std::size_t{8'000'000});
+    const std::size_t count = Bench::argOr(argc, argv, 2, std::size_t{10'000'000});
+
+    // the same random keys for both runs, built up front so their strings aren't what we measure
+    std::vector<std::string> lookups(count);
+    std::mt19937_64 random(42);
+    for (auto& key : lookups) key = "tenant:42:session:" + std::to_string(random() % keys);
+
+    run(false, keys, lookups);
+    run(true, keys, lookups);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Insert throughput and memory footprint of the store.
+//
+// usage: RiRi_bench_insert [riri|baseline|set|bulk] [keys]
+//
+//  - riri:     a sharded RapidStore, keys and string values carved out of per-shard slabs
+//  - set:      the same, every key built up front and SET as a single batch (tables double their way up)
+//  - bulk:     the same single batch through BULK_LOAD: every table grown once, no per-key checks
+//  - baseline: the same sharding, but every shard is what it used to be before the slabs,
+//              ankerl::unordered_dense::map<std::string, RapidDataType>: one heap allocation per
+//              long key and per long string value
+//
+// Run each mode in its own process (RSS is per process and the allocator never gives everything
+// back), e.g. `RiRi_bench_insert baseline 5000000 && RiRi_bench_insert riri 5000000`.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "ankerl/unordered_dense.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+using namespace RiRi;
+
+namespace {
+
+    constexpr std::size_t BATCH = 1024;
+
+    /// Refills `nodes` in place (reusing their string buffers) with keys `first..first+BATCH`.
+    /// Keys are ~30 bytes and values alternate between int64 and ~40 byte strings, both past the SSO.
+    void fillBatch(std::array<RapidNode, BATCH>& nodes, const std::size_t first) {
+        for (std::size_t i = 0; i < BATCH; ++i) {
+            const std::size_t n = first + i;
+            nodes[i].key.assign("tenant:42:session:");
+            nodes[i].key.append(std::to_string(n));
+            if (n % 2) {
+                nodes[i].value = static_cast<std::int64_t>(n);
+            } else {
+                auto* str = std::get_if<std::string>(&nodes[i].value);
+                if (!str) str = &nodes[i].value.emplace<std::string>();
+                str->assign("payload-of-a-cached-session-object:");
+                str->append(std::to_string(n));
+            }
+        }
+    }
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    const std::string mode = Bench::argOr(argc, argv, 1, "riri");
+    const std::size_t keys = Bench::argOr(argc, argv, 2, std::size_t{2'000'000}) / BATCH * BATCH;
+
+    std::array<RapidNode, BATCH> nodes;
+    std::array<Internal::RapidWrite, BATCH> inserted{};
+    fillBatch(nodes, 0);    // warm the batch buffers up before measuring anything
+
+    // the single batch modes build every node before the clock starts
+    std::vector<RapidNode> all;
+    if (mode == "set" || mode == "bulk") {
+        all.resize(keys);
+        for (std::size_t first = 0; first < keys; first += BATCH) {
+            fillBatch(nodes, first);
+            std::move(nodes.begin(), nodes.end(), all.begin() + static_cast<std::ptrdiff_t>(first));
+        }
+    }
+
+    const std::size_t rss_before = Bench::currentRss();
+    const auto start = Bench::Clock::now();
+    std::size_t entries = 0;
+
+    // called while the store is still alive, so its memory still counts
+    const auto report = [&] {
+        const double seconds = Bench::secondsSince(start);
+        std::printf("%-9s %10zu keys  %8.3f s  %8.2f Mops/s  RSS +%8.1f MiB\n", mode.c_str(), entries, seconds,
+            static_cast<double>(entries) / seconds / 1e6, Bench::mib(Bench::currentRss() - rss_before));
+    };
+
+    if (mode == "baseline") {
+        using Map = ankerl::unordered_dense::map<std::string, RapidDataType, Internal::RapidHash, std::equal_to<>>;
+        const Internal::RapidStore routing({.initialCapacity = 0});     // only used to pick shards
+        std::array<Map, Internal::DEFAULT_SHARD_COUNT> shards;
+        for (std::size_t first = 0; first < keys; first += BATCH) {
+            fillBatch(nodes, first);
+            for (const auto& [key, value] : nodes) {
+                shards[routing.shardIndex(Internal::RapidStore::hash(key))].try_emplace(key, value);
+            }
+        }
+        for (const auto& map : shards) entries += map.size();
+        report();
+    } else if (mode == "set") {
+        Internal::RapidStore store({.initialCapacity = 0});
+        std::vector<Internal::RapidWrite> written(keys);
+        Internal::setValues(store, all, written);
+        entries = Internal::size(store);
+        report();
+    } else if (mode == "bulk") {
+        Internal::RapidStore store({.initialCapacity = 0});
+        Internal::loadValues(store, all, DuplicatePolicy::LastWins);
+        entries = Internal::size(store);
+        report();
+    } else {
+        Internal::RapidStore store({.initialCapacity = 0});
+        for (std::size_t first = 0; first < keys; first += BATCH) {
+            fillBatch(nodes, first);
+            Internal::setValues(store, nodes, inserted);
+        }
+        entries = Internal::size(store);
+        report();
+    }
+    return entries == keys ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+// Key comparison: `sameKey()` against `std::string_view`'s `==`, for 8, 32 and 128 byte keys.
+//
+// usage: RiRi_bench_keys [pairs] [rounds]
+//
+// Every pair is two equal keys in separate buffers (what a probe that finds its key compares),
+// every other one differs in its last byte. The keys' hash is timed alongside, for scale: that's
+// the other half of the per-key work of a batch.
+
+#include "BenchUtils.h"
+#include "KeyCompare.h"
+#include "MemoryMaps.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+using namespace RiRi;
+
+namespace {
+
+    template <typename Fn>
+    double nanosPerKey(const std::size_t keys, const std::size_t rounds, Fn&& fn) {
+        const auto start = Bench::Clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) fn();
+        return Bench::secondsSince(start) * 1e9 / static_cast<double>(keys * rounds);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t pairs = Bench::argOr(argc, argv, 1, std::size_t{4096});
+    const std::size_t rounds = Bench::argOr(argc, argv, 2, std::size_t{2000});
+
+    std::size_t sink = 0;
+    for (const std::size_t size : {std::size_t{8}, std::size_t{32}, std::size_t{128}}) {
+        std::vector<std::string> lhs(pairs), rhs(pairs);
+        for (std::size_t i = 0; i < pairs; ++i) {
+            lhs[i] = std::to_string(i * 2654435761u);
+            lhs[i].resize(size, ':');
+            rhs[i] = lhs[i];
+            if (i % 2) rhs[i].back() = '!';
+        }
+
+        const double scalar = nanosPerKey(pairs, rounds, [&] {
+            for (std::size_t i = 0; i < pairs; ++i) sink += std::string_view(lhs[i]) == std::string_view(rhs[i]);
+        });
+        const double vector = nanosPerKey(pairs, rounds, [&] {
+            for (std::size_t i = 0; i < pairs; ++i) sink += Internal::sameKey(lhs[i], rhs[i]);
+        });
+        const double hash = nanosPerKey(pairs, rounds, [&] {
+            for (std::size_t i = 0; i < pairs; ++i) sink += Internal::RapidHash{}(std::string_view(lhs[i]));
+        });
+
+        std::printf("%4zu byte keys   ==: %6.2f ns   sameKey: %6.2f ns  (%.2fx)   hash: %6.2f ns\n",
+            size, scalar, vector, scalar / vector, hash);
+    }
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// Per-SET latency while the store grows, with and without incremental rehashing.
+//
+// usage: RiRi_bench_latency [full|incremental] [keys] [shards]
+//
+//  - full:        tables grow the way ankerl grows them, all at once, inside the SET that filled them
+//  - incremental: tables grow a few entries per write (StoreOptions::incrementalRehash)
+//
+// Starts from an empty store, so every shard grows many times along the way. Throughput barely
+// moves between the two; the tail (p99.99 and max) is what to look at.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "MemoryMaps.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+using namespace RiRi;
+
+int main(int argc, char** argv) {
+    const std::string mode = Bench::argOr(argc, argv, 1, "full");
+    const std::size_t keys = Bench::argOr(argc, argv, 2, std::size_t{4'000'000});
+    const std::size_t shards = Bench::argOr(argc, argv, 3, Internal::DEFAULT_SHARD_COUNT);
+
+    Internal::RapidStore store({
+        .initialCapacity = 0,
+        .shardCount = shards,
+        .incrementalRehash = mode == "incremental"
+    });
+
+    std::vector<std::uint32_t> nanos(keys);
+    std::string key;
+    const auto start = Bench::Clock::now();
+
+    for (std::size_t n = 0; n < keys; ++n) {
+        key.assign("tenant:42:session:");
+        key.append(std::to_string(n));
+
+        const auto before = Bench::Clock::now();
+        Internal::setValue(store, std::move(key), RapidDataType{static_cast<std::int64_t>(n)});
+        const auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(Bench::Clock::now() - before);
+        nanos[n] = static_cast<std::uint32_t>(std::min<std::int64_t>(took.count(), UINT32_MAX));
+    }
+
+    const double seconds = Bench::secondsSince(start);
+    const std::size_t entries = Internal::size(store);
+    std::sort(nanos.begin(), nanos.end());
+    const auto percentile = [&](const double p) {
+        return static_cast<double>(nanos[std::min(keys - 1, static_cast<std::size_t>(p * static_cast<double>(keys)))]) / 1e3;
+    };
+
+    std::printf("%-12s %10zu keys  %3zu shards  %6.2f Mops/s   us: p50 %6.2f  p99 %6.2f  p99.9 %7.2f  p99.99 %8.2f  max %9.2f\n",
+        mode.c_str(), entries, store.shardCount(), static_cast<double>(entries) / seconds / 1e6,
+        percentile(0.5), percentile(0.99), percentile(0.999), percentile(0.9999), static_cast<double>(nanos.back()) / 1e3);
+    return entries == keys ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Batch GET throughput on a store much bigger than the caches, against the same keys one GET at a time.
+//
+// usage: RiRi_bench_mget [locked|lock-free] [keys] [batch]
+//
+//  - locked:    readers take the shard locks (the default store setup)
+//  - lock-free: StoreOptions::concurrentReads, readers go to the read index
+//
+// Keys are looked up in random order, so nearly every lookup misses the cache. Batches prefetch
+// their buckets and entries a group at a time, single GETs can't; the gap between the two is what
+// the overlapped misses buy.
+
+#include "BenchUtils.h"
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "riri/ReadGuard.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+
+using namespace RiRi;
+
+int main(int argc, char** argv) {
+    const std::string mode = Bench::argOr(argc, argv, 1, "locked");
+    const std::size_t keys = Bench::argOr(argc, argv, 2, std::size_t{4'000'000});
+    const std::size_t batch = Bench::argOr(argc, argv, 3, std::size_t{256});
+
+    Internal::RapidStore store({.initialCapacity = keys, .concurrentReads = mode == "lock-free"});
+    for (std::size_t n = 0; n < keys; ++n) {
+        Internal::setValue(store, "tenant:42:session:" + std::to_string(n), RapidDataType{static_cast<std::int64_t>(n)});
+    }
+
+    std::vector<RapidNode> nodes(keys);
+    std::mt19937_64 random(42);
+    for (auto& node : nodes) node.key = "tenant:42:session:" + std::to_string(random() % keys);
+    std::vector<const RapidDataType*> values(batch);
+
+    std::size_t found = 0;
+    ReadGuard guard;
+    auto start = Bench::Clock::now();
+    for (const RapidNode& node : nodes) {
+        found += Internal::getValue(store, node.key) != nullptr;
+    }
+    const double single = Bench::secondsSince(start);
+
+    start = Bench::Clock::now();
+    for (std::size_t at = 0; at < keys; at += batch) {
+        const std::size_t count = std::min(batch, keys - at);
+        Internal::getValues(store, std::span<const RapidNode>(nodes).subspan(at, count), values);
+        for (std::size_t i = 0; i < count; ++i) found += values[i] != nullptr;
+    }
+    const double batched = Bench::secondsSince(start);
+
+    std::printf("%-10s %10zu keys  batch %5zu   single %6.2f Mops/s   batched %6.2f Mops/s   (%.2fx)\n",
+        mode.c_str(), keys, batch, static_cast<double>(keys) / single / 1e6, static_cast<double>(keys) / batched / 1e6, single / batched);
+    return found == 2 * keys ? 0 : 1;
+}
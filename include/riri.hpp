@@ -3,6 +3,8 @@
 // CORE
 #include "riri/Commands.hpp"
 #include "riri/RapidResponse.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
 
 // UTILS
 #include "riri/utils/Accessors.hpp"
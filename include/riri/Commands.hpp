@@ -1,8 +1,13 @@
 #pragma once    // COMMANDS.HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <span>
 #include "RapidTypes.hpp"
 #include "RapidResponse.hpp"    // That one HEINOUS header file
+#include "Store.hpp"
 
 
 /**
@@ -25,12 +30,33 @@ namespace RiRi {
          */
         struct enableBatched{ };
 
+        /**
+         * @struct enableParallel
+         * @brief A tag, next to `enableBatched` or `enableErrorBatched`, for batch overloads that spread
+         * a big batch over several cores.
+         *
+         * The batch is split by shard, and the shards run on a shared work-stealing pool, the calling
+         * thread included; the response is the same as without the tag. Worth it from a few thousand
+         * nodes up (smaller batches stay on the calling thread), and a store needs at least as many
+         * shards as threads to keep them all busy. Parallel batches from several threads run at the
+         * same time, sharing the pool; none waits for another to finish.
+         */
+        struct enableParallel {
+            std::size_t threads = 0;    ///< Up to how many threads to use, the caller included; `0` for one per core.
+        };
+
         /**
          * @namespace RiRi::Commands
          * @brief Contains all command functions of RiRi
          *
          * This namespace includes functions for setting, getting, updating, deleting keys,
          * retrieving all keys,clearing the store, auto-setting keys, and searching by value.
+         *
+         * @note Nodes with their `hash` filled in (`RiRi::prehash()`) and `RapidKey`s are never hashed again.
+         * @note Any write may also come back with `ERR_VALUE_OUT_OF_RANGE`, for a key or string value over
+         * 4 GiB, or `ERR_OUT_OF_MEMORY`; the store is left as it was either way.
+         * @note Reads copy what they hand out; out of memory for that, they come back with `ERR_OUT_OF_MEMORY`
+         * where they'd have said `ERR_KEY_NOT_FOUND` (or, for the ones returning many entries, instead of those).
          */
         namespace Commands {
 
@@ -46,9 +72,26 @@ namespace RiRi {
                  *
                  * @param key a `string` value; can be either copied to or moved into
                  * @param value a `RapidDataType` value; can be either copied to or moved into
+                 * @param mode `NX` (the default) only inserts, `XX` only replaces (UPDATE), `Always` does whichever
+                 * it takes (UPSERT); every SET overload takes one, batches apply it to every node
                  * @return A `Status` object containing `StatusCode`
                  */
-                Response::Status SET(std::string key, RapidDataType value);
+                Response::Status SET(std::string key, RapidDataType value, SetMode mode = SetMode::NX);
+
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::Status SET(const RapidKey& key, RapidDataType value, SetMode mode = SetMode::NX);
+
+                /**
+                 * @brief Same as above, and the key expires `ttl` from now (see `EXPIRE`).
+                 *
+                 * @param ttl a `std::chrono::milliseconds`, e.g. `30s` or `1500ms`; replaces any TTL an existing key had
+                 * @return `OK`, `ERR_KEY_ALREADY_EXISTS` (`NX`), `ERR_KEY_NOT_FOUND` (`XX`), or `ERR_INVALID_ARGUMENT` if
+                 * `ttl` isn't positive
+                 */
+                Response::Status SET(std::string key, RapidDataType value, std::chrono::milliseconds ttl, SetMode mode = SetMode::NX);
+                Response::Status SET(const RapidKey& key, RapidDataType value, std::chrono::milliseconds ttl, SetMode mode = SetMode::NX);
 
                 /**
                  * @brief Stores key-value pairs in the data store (best effort approach).
@@ -60,7 +103,7 @@ namespace RiRi {
                  * For error-only reporting, pass the `enableErrorBatched` tag and
                  * switch to handling `StatusErrorBatchWith<F>
                  */
-                Response::Status SET (std::span<RapidNode> nodes);
+                Response::Status SET (std::span<RapidNode> nodes, SetMode mode = SetMode::NX);
 
 
                 /**
@@ -84,7 +127,7 @@ namespace RiRi {
                  * @warning There is a hard error-tracking limit (default 8). If this limit is exceeded, this function will still
                  * attempt to insert the remaining keys, but any further errors will be dropped from the response buffer.
                  */
-                Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched);
+                Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched, SetMode mode = SetMode::NX);
 
 
                 /**
@@ -108,11 +151,33 @@ namespace RiRi {
                  * function accessible by passing the `enableErrorBatched` tag (return type: `StatusErrorBatchWith<F>`)
                  * for a lighter response object.
                  */
-                Response::StatusBatchWith <std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched);
+                Response::StatusBatchWith <std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched, SetMode mode = SetMode::NX);
+
+                /**
+                 * @brief The `enableErrorBatched` and `enableBatched` SETs, on several cores (see `enableParallel`).
+                 *
+                 * Keys of different shards may be written in any order; keys of one shard, in the order given.
+                 */
+                Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched, enableParallel parallel, SetMode mode = SetMode::NX);
+                Response::StatusBatchWith <std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched, enableParallel parallel, SetMode mode = SetMode::NX);
                 // For SET, we really only need string_view and status code pairs, so there's no need of result_field,
                 // so we set it to std::monostate, and we only call `addStatusEntry` and never `addResultEntry` (because
                 // my API won't let you do so, the function is constrained).
 
+                /**
+                 * @brief Same as the SET overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status SET(Store& store, std::string key, RapidDataType value, SetMode mode = SetMode::NX);
+                Response::Status SET(Store& store, const RapidKey& key, RapidDataType value, SetMode mode = SetMode::NX);
+                Response::Status SET(Store& store, std::string key, RapidDataType value, std::chrono::milliseconds ttl, SetMode mode = SetMode::NX);
+                Response::Status SET(Store& store, const RapidKey& key, RapidDataType value, std::chrono::milliseconds ttl, SetMode mode = SetMode::NX);
+                Response::Status SET (Store& store, std::span<RapidNode> nodes, SetMode mode = SetMode::NX);
+                Response::StatusErrorBatchWith<std::string_view> SET (Store& store, std::span<RapidNode> nodes, enableErrorBatched, SetMode mode = SetMode::NX);
+                Response::StatusBatchWith <std::string_view, std::monostate> SET (Store& store, std::span<RapidNode> nodes, enableBatched, SetMode mode = SetMode::NX);
+                Response::StatusErrorBatchWith<std::string_view> SET (Store& store, std::span<RapidNode> nodes, enableErrorBatched, enableParallel parallel, SetMode mode = SetMode::NX);
+                Response::StatusBatchWith <std::string_view, std::monostate> SET (Store& store, std::span<RapidNode> nodes, enableBatched, enableParallel parallel, SetMode mode = SetMode::NX);
+
                 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
                 //GET
@@ -125,9 +190,19 @@ namespace RiRi {
                  *
                  * @return A single value associated with the key and appropriate status code; inside a
                  * `StatusWith` response object
+                 *
+                 * @note The value is a copy owned by the calling thread, writers can't change it under your feet.
+                 * It stays valid for as long as the response does, however many GETs come after it.
+                 * @note In a concurrent-reads store, a GET inside a `RiRi::ReadGuard` skips the copy: the value is
+                 * then valid for as long as the guard is held, not the response (see `ReadGuard`).
                  */
                 Response::StatusWith<const RapidDataType*> GET(std::string_view key);
 
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::StatusWith<const RapidDataType*> GET(const RapidKey& key);
+
                 /**
                  * @brief Retrieves the value associated with one key from the data store
                  *
@@ -150,9 +225,38 @@ namespace RiRi {
                  *
                  * @return A `StatusBatchWith<string_viw, const RapidDataType*>` object containing either values
                  * for each key or status code. Additionally, provides an overall status code.
+                 *
+                 * @note All values of one batch stay valid together, for as long as the response does (or, inside a
+                 * `RiRi::ReadGuard` on a concurrent-reads store, the guard; like the single key GET).
                  */
                 Response::StatusBatchWith<std::string_view, const RapidDataType*> GET(std::span<RapidNode> nodes, enableBatched);
 
+                /**
+                 * @brief The `enableBatched` GET, on several cores (see `enableParallel`).
+                 *
+                 * @note The values still belong to the calling thread, just like the single-threaded GET's.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> GET(std::span<RapidNode> nodes, enableBatched, enableParallel parallel);
+
+                /**
+                 * @brief Same as the single key GET, and the value's version, for a later CAS.
+                 *
+                 * @param version set to the value's version, `0` if the key doesn't exist
+                 * @note The value lives just as long as the single key GET's.
+                 */
+                Response::StatusWith<const RapidDataType*> GET(std::string_view key, std::uint64_t& version);
+
+                /**
+                 * @brief Same as the GET overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusWith<const RapidDataType*> GET(Store& store, std::string_view key);
+                Response::StatusWith<const RapidDataType*> GET(Store& store, const RapidKey& key);
+                Response::StatusWith<const RapidDataType*> GET(Store& store, std::span<RapidNode> node);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> GET(Store& store, std::span<RapidNode> nodes, enableBatched);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> GET(Store& store, std::span<RapidNode> nodes, enableBatched, enableParallel parallel);
+                Response::StatusWith<const RapidDataType*> GET(Store& store, std::string_view key, std::uint64_t& version);
+
                 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
                 //UPDATE
@@ -168,6 +272,11 @@ namespace RiRi {
                  */
                 Response::Status UPDATE(std::string_view key, RapidDataType value);
 
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::Status UPDATE(const RapidKey& key, RapidDataType value);
+
                 /**
                  * @brief Updates/replaces existing values, each associated with a key, with new provided values
                  * Best effort approach and supports bulk updates.
@@ -224,6 +333,245 @@ namespace RiRi {
                  */
                 Response::StatusBatchWith<std::string_view, std::monostate> UPDATE (std::span<RapidNode> nodes, enableBatched);
 
+                /**
+                 * @brief Same as the UPDATE overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status UPDATE(Store& store, std::string_view key, RapidDataType value);
+                Response::Status UPDATE(Store& store, const RapidKey& key, RapidDataType value);
+                Response::Status UPDATE(Store& store, std::span<RapidNode> nodes);
+                Response::StatusErrorBatchWith<std::string_view> UPDATE (Store& store, std::span<RapidNode> nodes, enableErrorBatched);
+                Response::StatusBatchWith<std::string_view, std::monostate> UPDATE (Store& store, std::span<RapidNode> nodes, enableBatched);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // UPSERT
+
+                /**
+                 * @brief Stores `value` at `key`, whether the key exists or not: `SET` with `SetMode::Always`.
+                 *
+                 * One lookup, `insert_or_assign` style, instead of a SET that failed and an UPDATE after it; no
+                 * other write of the key can get in between. An existing key keeps its TTL, like with UPDATE.
+                 *
+                 * @param key a `string_view`
+                 * @param value a `RapidDataType` value; can be either copied to or moved into
+                 *
+                 * @return A `Status` object: `OK` (or `WARN_KEY_STORE_NEARING_CAPACITY`), or `ERR_KEY_STORE_FULL`.
+                 */
+                Response::Status UPSERT(std::string_view key, RapidDataType value);
+
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::Status UPSERT(const RapidKey& key, RapidDataType value);
+
+                /**
+                 * @brief Same as above, and the key expires `ttl` from now, whether it had a TTL or not.
+                 * @return As above, or `ERR_INVALID_ARGUMENT` if `ttl` isn't positive
+                 */
+                Response::Status UPSERT(std::string_view key, RapidDataType value, std::chrono::milliseconds ttl);
+
+                /**
+                 * @brief Batched UPSERT, one lock per shard; keys and values are moved out of `nodes`, never copied.
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ node1, node2, ... }`
+                 * @return A `Status`, like SET's: `OK`, `WARN_KEY_STORE_NEARING_CAPACITY` or `ERR_SOME_OPERATIONS_FAILED`
+                 * @note With the `enableErrorBatched` or `enableBatched` tag, per-key diagnostics, like SET's.
+                 */
+                Response::Status UPSERT(std::span<RapidNode> nodes);
+                Response::StatusErrorBatchWith<std::string_view> UPSERT(std::span<RapidNode> nodes, enableErrorBatched);
+                Response::StatusBatchWith<std::string_view, std::monostate> UPSERT(std::span<RapidNode> nodes, enableBatched);
+
+                /**
+                 * @brief Same as the UPSERT overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status UPSERT(Store& store, std::string_view key, RapidDataType value);
+                Response::Status UPSERT(Store& store, const RapidKey& key, RapidDataType value);
+                Response::Status UPSERT(Store& store, std::string_view key, RapidDataType value, std::chrono::milliseconds ttl);
+                Response::Status UPSERT(Store& store, std::span<RapidNode> nodes);
+                Response::StatusErrorBatchWith<std::string_view> UPSERT(Store& store, std::span<RapidNode> nodes, enableErrorBatched);
+                Response::StatusBatchWith<std::string_view, std::monostate> UPSERT(Store& store, std::span<RapidNode> nodes, enableBatched);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // BULK_LOAD
+
+                /**
+                 * @brief Loads a big batch in one go, e.g. a cold store warming up: keys and values are moved in,
+                 * one lock and at most one table growth per shard, and no per-key response.
+                 *
+                 * Every shard's table grows once to fit all of its nodes, instead of doubling its way up, and
+                 * unless the store has a memory budget none of a SET's per-key checks run. Spread over every
+                 * core by default (see `enableParallel`).
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ node1, node2, ... }`; keys and values are moved out of
+                 * those that go in
+                 * @param policy what happens to a key that's there already, or earlier in `nodes` (see `DuplicatePolicy`)
+                 * @param parallel up to how many threads to use
+                 *
+                 * @return A `Status`: `OK`, `ERR_SOME_OPERATIONS_FAILED` if any node didn't go in (a full store, or a
+                 * duplicate with `DuplicatePolicy::Report`), or `WARN_ZERO_NODES_PROVIDED`
+                 * @note With the `enableErrorBatched` tag, which keys didn't go in and why, like SET's.
+                 */
+                Response::Status BULK_LOAD(std::span<RapidNode> nodes, DuplicatePolicy policy = DuplicatePolicy::LastWins, enableParallel parallel = {});
+                Response::StatusErrorBatchWith<std::string_view> BULK_LOAD(std::span<RapidNode> nodes, enableErrorBatched,
+                                                                           DuplicatePolicy policy = DuplicatePolicy::LastWins, enableParallel parallel = {});
+
+                /**
+                 * @brief Same as the BULK_LOAD overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status BULK_LOAD(Store& store, std::span<RapidNode> nodes, DuplicatePolicy policy = DuplicatePolicy::LastWins, enableParallel parallel = {});
+                Response::StatusErrorBatchWith<std::string_view> BULK_LOAD(Store& store, std::span<RapidNode> nodes, enableErrorBatched,
+                                                                           DuplicatePolicy policy = DuplicatePolicy::LastWins, enableParallel parallel = {});
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // INCRBY, INCRBYFLOAT
+
+                /**
+                 * @brief Adds `by` to the integer stored at `key`, in place (a single lookup, no GET and UPDATE).
+                 *
+                 * @param key a `string_view`
+                 * @param by an `int64_t`, negative to decrement
+                 * @param initial what a missing key starts from (it's created, as if by SET), or `std::nullopt`
+                 * to leave missing keys alone
+                 *
+                 * @return A `StatusWith<const RapidDataType*>`: the new value (an `int64_t`) and `OK` (or
+                 * `WARN_KEY_STORE_NEARING_CAPACITY`), or `nullptr` and `ERR_KEY_NOT_FOUND`, `ERR_WRONG_TYPE` if the value
+                 * isn't an `int64_t`, `ERR_VALUE_OUT_OF_RANGE` if the sum overflows, or `ERR_KEY_STORE_FULL`.
+                 *
+                 * @note Atomic per key, concurrent increments of a key never lose one; the TTL of the key stays.
+                 * @note The value is owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusWith<const RapidDataType*> INCRBY(std::string_view key, std::int64_t by, std::optional<std::int64_t> initial = std::nullopt);
+
+                /**
+                 * @brief Batched INCRBY, one lock per shard: every node's value is its increment (an `int64_t`).
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ {key1, by1}, {key2, by2}, ... }`; on success, the value of a
+                 * node is replaced by the key's new value
+                 * @param initial as above, for every missing key
+                 *
+                 * @return A `StatusBatchWith<string_view, const RapidDataType*>`: `{key, new value}` (pointing into `nodes`)
+                 * for every key that went through, and `{key, code}` for the rest, codes as above, plus
+                 * `ERR_INVALID_ARGUMENT` for an increment that isn't an `int64_t`.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBY(std::span<RapidNode> nodes, std::optional<std::int64_t> initial = std::nullopt);
+
+                /**
+                 * @brief INCRBY for `double`s: `by` and the stored value are `double`s (`ERR_WRONG_TYPE` otherwise, an
+                 * integer is no double), and a sum that isn't finite is `ERR_VALUE_OUT_OF_RANGE`.
+                 */
+                Response::StatusWith<const RapidDataType*> INCRBYFLOAT(std::string_view key, double by, std::optional<double> initial = std::nullopt);
+
+                /**
+                 * @brief Batched INCRBYFLOAT, same as the batched INCRBY with `double` increments.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBYFLOAT(std::span<RapidNode> nodes, std::optional<double> initial = std::nullopt);
+
+                /**
+                 * @brief Same as the INCRBY and INCRBYFLOAT overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusWith<const RapidDataType*> INCRBY(Store& store, std::string_view key, std::int64_t by, std::optional<std::int64_t> initial = std::nullopt);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBY(Store& store, std::span<RapidNode> nodes, std::optional<std::int64_t> initial = std::nullopt);
+                Response::StatusWith<const RapidDataType*> INCRBYFLOAT(Store& store, std::string_view key, double by, std::optional<double> initial = std::nullopt);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBYFLOAT(Store& store, std::span<RapidNode> nodes, std::optional<double> initial = std::nullopt);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // APPEND, SETRANGE, GETRANGE
+
+                /**
+                 * @brief Appends `suffix` to the string stored at `key`, in place (no read-modify-UPDATE).
+                 *
+                 * The string's bytes only move when their block is full, and then to one with room to spare, so a
+                 * log buffer appended to a line at a time costs about what the lines do.
+                 *
+                 * @param key a `string_view`; a missing key is created, as if it held an empty string
+                 * @param suffix a `string_view`
+                 *
+                 * @return A `StatusWith<const RapidDataType*>`: the new length (an `int64_t`) and `OK` (or
+                 * `WARN_KEY_STORE_NEARING_CAPACITY`), or `nullptr` and `ERR_WRONG_TYPE` if the value isn't a string,
+                 * `ERR_VALUE_OUT_OF_RANGE` past 4 GiB, or `ERR_KEY_STORE_FULL`.
+                 *
+                 * @note The value is owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusWith<const RapidDataType*> APPEND(std::string_view key, std::string_view suffix);
+
+                /**
+                 * @brief Overwrites the string stored at `key` from `offset` on with `bytes`, in place, like APPEND.
+                 *
+                 * The string grows if it has to, zero bytes fill any gap between its old end and `offset`.
+                 * @return Same as APPEND.
+                 */
+                Response::StatusWith<const RapidDataType*> SETRANGE(std::string_view key, std::size_t offset, std::string_view bytes);
+
+                /**
+                 * @brief Up to `length` bytes of the string stored at `key`, from `offset` on (`substr()` rules).
+                 *
+                 * @return A `StatusWith<string_view>`: the bytes (empty past the end) and `OK`, or `ERR_KEY_NOT_FOUND`,
+                 * or `ERR_WRONG_TYPE` if the value isn't a string.
+                 *
+                 * @note A view, never a copy of the whole value: only the range is copied, into the calling thread's
+                 * read buffer, valid as long as the response. Inside a `RiRi::ReadGuard` on a concurrent-reads store
+                 * nothing is copied at all, the view is valid as long as the guard, like a GET's value.
+                 */
+                Response::StatusWith<std::string_view> GETRANGE(std::string_view key, std::size_t offset, std::size_t length = SIZE_MAX);
+
+                /**
+                 * @brief Same as the APPEND, SETRANGE and GETRANGE overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusWith<const RapidDataType*> APPEND(Store& store, std::string_view key, std::string_view suffix);
+                Response::StatusWith<const RapidDataType*> SETRANGE(Store& store, std::string_view key, std::size_t offset, std::string_view bytes);
+                Response::StatusWith<std::string_view> GETRANGE(Store& store, std::string_view key, std::size_t offset, std::size_t length = SIZE_MAX);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // CAS
+
+                /**
+                 * @brief Compare-and-swap: stores `value` at `key` only if its value is still at `expected_version`.
+                 *
+                 * Every write of a value gives it a new version (`GET(key, version)` hands it out), so optimistic
+                 * writers need no lock of their own: GET with the version, compute, CAS, and GET again on a mismatch.
+                 * The compare and the swap happen in one lookup, under the key's shard lock.
+                 *
+                 * @param key a `string_view`
+                 * @param expected_version the version the value must be at; `0` to only create a missing key
+                 * @param value a `RapidDataType`; can be either copied to or moved into
+                 *
+                 * @return A `StatusWith<const RapidDataType*>`: the new version (an `int64_t`) and `OK` (or
+                 * `WARN_KEY_STORE_NEARING_CAPACITY`); the version the value is at and `ERR_VERSION_MISMATCH`; or
+                 * `nullptr` and `ERR_KEY_NOT_FOUND` or `ERR_KEY_STORE_FULL`.
+                 *
+                 * @note The version is owned by the calling thread, valid for as long as the response is. A TTL of the key stays.
+                 */
+                Response::StatusWith<const RapidDataType*> CAS(std::string_view key, std::uint64_t expected_version, RapidDataType value);
+
+                /**
+                 * @brief Batched CAS, one lock per shard: every node is swapped (or not) on its own.
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ {key1, value1}, {key2, value2}, ... }`; on success, the value
+                 * of a node is moved into the store and replaced by its new version
+                 * @param expected_versions the version for every node, as long as `nodes`
+                 *
+                 * @return A `StatusBatchWith<string_view, const RapidDataType*>`: `{key, new version}` (pointing into
+                 * `nodes`) for every key that went through, and `{key, code}` for the rest, codes as above;
+                 * `ERR_INVALID_ARGUMENT` (and no entries) if the spans aren't as long as each other.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> CAS(std::span<RapidNode> nodes, std::span<const std::uint64_t> expected_versions);
+
+                /**
+                 * @brief Same as the CAS overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusWith<const RapidDataType*> CAS(Store& store, std::string_view key, std::uint64_t expected_version, RapidDataType value);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> CAS(Store& store, std::span<RapidNode> nodes, std::span<const std::uint64_t> expected_versions);
+
                 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
                 //DELETE
@@ -238,6 +586,11 @@ namespace RiRi {
                  */
                 Response::Status DELETE(std::string_view key);
 
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::Status DELETE(const RapidKey& key);
+
                 /**
                  * @brief Deletes/removes key-value pairs from the data store
                  * Best effort approach and supports bulk deletion.
@@ -294,16 +647,286 @@ namespace RiRi {
                  */
                 Response::StatusBatchWith<std::string_view, std::monostate> DELETE (std::span<RapidNode> nodes, enableBatched);
 
+                /**
+                 * @brief Same as the DELETE overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status DELETE(Store& store, std::string_view key);
+                Response::Status DELETE(Store& store, const RapidKey& key);
+                Response::Status DELETE(Store& store, std::span<RapidNode> nodes);
+                Response::StatusErrorBatchWith<std::string_view> DELETE (Store& store, std::span<RapidNode> nodes, enableErrorBatched);
+                Response::StatusBatchWith<std::string_view, std::monostate> DELETE (Store& store, std::span<RapidNode> nodes, enableBatched);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // UNLINK
+
+                /**
+                 * @brief Deletes/removes a key-value pair like DELETE does, but leaves freeing a big value
+                 * (64 KiB or more) to a background thread.
+                 *
+                 * The key is gone by the time this returns, and its value no longer counts towards the store's
+                 * memory; only giving the memory back to the system happens later. Small values are freed on the
+                 * spot, same as DELETE, handing them over would cost more than it saves.
+                 *
+                 * @param key a `string_view` of the key to remove
+                 *
+                 * @return A `Status` object containing `StatusCode`: OK, or ERR_KEY_NOT_FOUND
+                 */
+                Response::Status UNLINK(std::string_view key);
+
+                /**
+                 * @brief Same as above, with a key that's already hashed (see `RapidKey`).
+                 */
+                Response::Status UNLINK(const RapidKey& key);
+
+                /**
+                 * @brief UNLINKs key-value pairs from the data store, best effort, one lock per shard.
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ node1, node2, ... }`, only the keys are read
+                 *
+                 * @return A `Status` object containing `StatusCode`; ERR_SOME_OPERATIONS_FAILED if a key wasn't there
+                 */
+                Response::Status UNLINK(std::span<RapidNode> nodes);
+
+                /**
+                 * @brief UNLINKs key-value pairs from the data store, best effort, one lock per shard. Provides a
+                 * capped diagnostic response, exactly like DELETE's `enableErrorBatched` overload.
+                 *
+                 * @param nodes a `span` of `RapidNode`: `{ node1, node2, ... }`, only the keys are read
+                 *
+                 * @return A `StatusErrorBatchWith<std::string_view>` object containing `StatusCode` for overall
+                 * status code, and a capped buffer of `{key, ERR_KEY_NOT_FOUND}` pairs
+                 */
+                Response::StatusErrorBatchWith<std::string_view> UNLINK(std::span<RapidNode> nodes, enableErrorBatched);
+
+                /**
+                 * @brief Same as the UNLINK overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status UNLINK(Store& store, std::string_view key);
+                Response::Status UNLINK(Store& store, const RapidKey& key);
+                Response::Status UNLINK(Store& store, std::span<RapidNode> nodes);
+                Response::StatusErrorBatchWith<std::string_view> UNLINK(Store& store, std::span<RapidNode> nodes, enableErrorBatched);
+
                 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
                 // CLEAR
 
                 /**
                  * @brief Clears the entire data store (drops all stored key-values).
+                 *
+                 * Takes the same (short) time whatever the store holds: every shard is swapped for an empty one,
+                 * and what it held is freed by a background thread afterwards.
+                 *
                  * @return A `Status` object containing `StatusCode`
                  */
                 Response::Status CLEAR();
 
+                /**
+                 * @brief Same as the CLEAR overload above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status CLEAR(Store& store);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // COMPACT
+
+                /**
+                 * @brief Gives back the memory mass deletions left behind.
+                 *
+                 * Hash tables under a quarter full are shrunk (and their entry vectors with them), keys and
+                 * values are moved out of slabs that are mostly empty into fresh ones, and the old slabs are
+                 * freed. Incremental, a shard at a time and a bounded number of keys per shard lock, so
+                 * reads and writes carry on meanwhile. Nothing changes for the keys: values, TTLs and
+                 * versions stay as they were. See `StoreOptions::compactBelow` to have it done on its own.
+                 *
+                 * @return A `StatusWith<const RapidDataType*>`: the bytes given back (an `int64_t`, `0` if the
+                 * store was compact already) and `OK`.
+                 * @note The value is owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusWith<const RapidDataType*> COMPACT();
+
+                /**
+                 * @brief Same as the COMPACT overload above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusWith<const RapidDataType*> COMPACT(Store& store);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // FIND_BY_VALUE
+
+                /**
+                 * @brief Finds every key holding the given value (a reverse lookup).
+                 *
+                 * @param value a `RapidDataType`; types must match too, `1` is not `true` is not `"1"`
+                 *
+                 * @return A `StatusBatchWith<string_view, monostate>` with one `{key, OK}` entry per matching key
+                 * (in no particular order), or no entries and `ERR_VALUE_NOT_FOUND` if nothing matches.
+                 *
+                 * @note Fast only on stores built with `StoreOptions::valueIndex`; everywhere else (the default
+                 * store included) this scans the whole store.
+                 * @note The keys are copies owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusBatchWith<std::string_view, std::monostate> FIND_BY_VALUE(const RapidDataType& value);
+
+                /**
+                 * @brief Same as the FIND_BY_VALUE overload above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusBatchWith<std::string_view, std::monostate> FIND_BY_VALUE(Store& store, const RapidDataType& value);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // EXPIRE, TTL, PERSIST
+
+                /**
+                 * @brief Gives an existing key a TTL (or a new one): it's deleted `ttl` from now.
+                 *
+                 * Once its time is up, a key is gone for every command, right away. Its memory is reclaimed
+                 * a little later: by the next writes to its shard, or by the store's sweeper (see
+                 * `StoreOptions::expirySweepInterval`). Until then, it still counts towards the store's size.
+                 *
+                 * @param key a `string_view`
+                 * @param ttl a `std::chrono::milliseconds`; `0` or less deletes the key right away
+                 * @return `OK`, or `ERR_KEY_NOT_FOUND`
+                 *
+                 * @note UPDATE keeps a key's TTL; DELETE, or a SET after the key expired, doesn't.
+                 */
+                Response::Status EXPIRE(std::string_view key, std::chrono::milliseconds ttl);
+
+                /**
+                 * @brief How long a key has left to live.
+                 *
+                 * @param key a `string_view`
+                 * @return A `StatusWith<const RapidDataType*>`: the milliseconds left (an `int64_t`) and `OK`,
+                 * `nullptr` and `INFO_KEY_HAS_NO_EXPIRY` for a key without a TTL, or `nullptr` and `ERR_KEY_NOT_FOUND`.
+                 * @note The value is owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusWith<const RapidDataType*> TTL(std::string_view key);
+
+                /**
+                 * @brief Takes a key's TTL away, it lives until it's deleted.
+                 *
+                 * @param key a `string_view`
+                 * @return `OK`, `INFO_KEY_HAS_NO_EXPIRY` if it had none, or `ERR_KEY_NOT_FOUND`
+                 */
+                Response::Status PERSIST(std::string_view key);
+
+                /**
+                 * @brief Same as the EXPIRE, TTL and PERSIST overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::Status EXPIRE(Store& store, std::string_view key, std::chrono::milliseconds ttl);
+                Response::StatusWith<const RapidDataType*> TTL(Store& store, std::string_view key);
+                Response::Status PERSIST(Store& store, std::string_view key);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // MEMORY_STATS, MEMORY_USAGE
+
+                /**
+                 * @brief Where the store's memory goes, field by field (think Redis' `INFO memory`).
+                 *
+                 * Fields, all `int64_t`s: `keys`, `key_bytes`, `value_bytes` (strings too long to live in their
+                 * entry), `bucket_bytes`, `entry_bytes` (the entries themselves), `used_bytes` (the four before
+                 * it), `slab_bytes` (what the key and value bytes took from the system, free space included),
+                 * `budget_bytes` (what's charged against `StoreOptions::maxMemory`) and `max_memory`.
+                 *
+                 * @return A `StatusBatchWith<string_view, const RapidDataType*>` with one `{field, value}` entry per field, and `OK`.
+                 * @note Cheap: it adds up the counts every shard keeps anyway, it never looks at a key.
+                 * @note The values are owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> MEMORY_STATS();
+
+                /**
+                 * @brief What a single key costs: its key and value bytes, its entry and its share of the buckets.
+                 *
+                 * @param key a `string_view`
+                 * @return A `StatusWith<const RapidDataType*>`: the bytes (an `int64_t`) and `OK`, or `nullptr` and `ERR_KEY_NOT_FOUND`.
+                 * @note The value is owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusWith<const RapidDataType*> MEMORY_USAGE(std::string_view key);
+
+                /**
+                 * @brief Same as the MEMORY_STATS and MEMORY_USAGE overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> MEMORY_STATS(Store& store);
+                Response::StatusWith<const RapidDataType*> MEMORY_USAGE(Store& store, std::string_view key);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // RANGE, SCAN_PREFIX
+
+                /**
+                 * @brief Every key in `[start, end)`, in order (bytewise, like `std::string_view`), with its value.
+                 *
+                 * @param start a `string_view`; the first key, inclusive
+                 * @param end a `string_view`; the last key, exclusive, empty for no end
+                 * @param limit at most this many keys (the first ones), must not be `0`
+                 *
+                 * @return A `StatusBatchWith<string_view, const RapidDataType*>` with one `{key, value}` entry per
+                 * key, no entries and `ERR_KEY_NOT_FOUND` if there are none, or `ERR_INVALID_ARGUMENT` if `end`
+                 * comes before `start` or `limit` is `0`.
+                 *
+                 * @note Fast only on stores built with `StoreOptions::orderedIndex`: it goes straight to `start`
+                 * and looks at no more keys than it returns. Everywhere else (the default store included) this
+                 * scans the whole store.
+                 * @note The keys and values are copies owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> RANGE(std::string_view start, std::string_view end, std::size_t limit = SIZE_MAX);
+
+                /**
+                 * @brief Every key starting with `prefix`, in order, with its value; the RANGE the prefix spans.
+                 *
+                 * @param prefix a `string_view`; empty matches every key
+                 * @param limit at most this many keys (the first ones), must not be `0`
+                 * @return Same as RANGE.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN_PREFIX(std::string_view prefix, std::size_t limit = SIZE_MAX);
+
+                /**
+                 * @brief Same as the RANGE and SCAN_PREFIX overloads above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> RANGE(Store& store, std::string_view start, std::string_view end, std::size_t limit = SIZE_MAX);
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN_PREFIX(Store& store, std::string_view prefix, std::size_t limit = SIZE_MAX);
+
+                ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+                // SCAN
+
+                /**
+                 * @brief The next chunk of a walk over every key in the store, with its value.
+                 *
+                 * @code
+                 * std::uint64_t cursor = 0;
+                 * do {
+                 *     for (const auto& [key, value] : RiRi::Commands::SCAN(cursor, 1000)) { ... }
+                 * } while (cursor != 0);
+                 * @endcode
+                 *
+                 * @param cursor `0` to start a walk; set to where the next call picks up, `0` again once it's done
+                 * @param count entries looked at by this call, at most (so it never takes long); must not be `0`
+                 *
+                 * @return A `StatusBatchWith<string_view, const RapidDataType*>` with one `{key, value}` entry per
+                 * key (in no particular order) and `OK`, possibly none, or `ERR_INVALID_ARGUMENT` if `count` is `0`.
+                 *
+                 * @note Stateless, nothing to close. Keys that exist for the whole walk come at least once, however
+                 * the store changes meanwhile; some may come twice, and keys added during the walk may not come at all.
+                 * @note The keys and values are copies owned by the calling thread, valid for as long as the response is.
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN(std::uint64_t& cursor, std::size_t count);
+
+                /**
+                 * @brief Same as the SCAN overload above, on `store` instead of the default store.
+                 * @param store the `Store` to work on; everything else as above
+                 */
+                Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN(Store& store, std::uint64_t& cursor, std::size_t count);
+
                 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
                 // //GET_ALL
@@ -339,24 +962,6 @@ namespace RiRi {
                 // RIRI_API Response::RapidResponseFull AUTO_SET(std::span<RapidNode> args);
                 // RIRI_API Response::RapidResponseFull AUTO_SET(std::span<RapidNode> args, enableFullResponse);
 
-                ////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-                // // SEARCH
-                //
-                // /**
-                //  * @brief ## Note: Optimization Remaining
-                //  * @brief Searches the datastore for all keys associated with a specific value.
-                //  *
-                //  * @param args Parsed arguments of the type: `span` of `RapidNode`: `{ {<empty>, value}, {<empty>, value2}, ... }`
-                //  * @return A list of matching keys, or "key: (not found)".
-                //  *
-                //  * @note - This operation performs a full scan of the datastore (O(N)).
-                //  *         It may be slow with large datasets.
-                //  * @note - The command name (`SEARCH` or `FIND_BY_VALUE`) is already removed before this function is called.
-                //  *         The args vector only contains the remaining arguments (values).
-                //  */
-                // RIRI_API Response::RapidResponse SEARCH(std::span<RapidNode> args);
-                // RIRI_API Response::RapidResponseFull SEARCH(std::span<RapidNode> args, enableFullResponse);
 
         } // namespace Commands
 
@@ -1,5 +1,6 @@
 #pragma once    // RAPIDRESPONSE.HPP
 
+#include <atomic>
 #include <concepts>
 #include <cstdint>
 #include <cstring>
@@ -108,11 +109,55 @@ namespace RiRi::Response {
     };
 
 
+    /**
+     * @brief Memory a response's fields may point into, freed by `destroy` once nothing refers to it.
+     *
+     * `refs` counts the `Lease`s on it, plus whatever its owner keeps for itself.
+     */
+    struct Leased {
+        std::atomic<std::uint32_t> refs{1};
+        void (*destroy)(Leased*) noexcept = nullptr;
+    };
+
+
+    /**
+     * @brief Keeps a `Leased` alive for as long as it (or a copy of it) lives.
+     *
+     * Reads copy values into a per-thread buffer and hand out pointers into it; their response holds a
+     * lease on that buffer, and the thread only reuses it once no response does anymore. So a value is
+     * valid as long as the response it came in, however many reads the thread does in the meantime.
+     */
+    class Lease {
+    public:
+        constexpr Lease() noexcept = default;
+
+        explicit Lease(Leased* held) noexcept : _held(held) {
+            if (_held) _held->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Lease(const Lease& other) noexcept : Lease(other._held) {}
+        Lease(Lease&& other) noexcept : _held(std::exchange(other._held, nullptr)) {}
+
+        Lease& operator=(Lease other) noexcept {
+            std::swap(_held, other._held);
+            return *this;
+        }
+
+        ~Lease() {
+            // acq_rel: whoever frees (or reuses) it sees every read of the last holder done
+            if (_held && _held->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) _held->destroy(_held);
+        }
+
+    private:
+        Leased* _held = nullptr;
+    };
+
+
     /**
      * @brief A single status-field response class
 
      * This class encapsulates the response status code and a field value of the type ResponseField.
-     * @note This class does not own field's memory
+     * @note This class does not own field's memory, but it may hold a `Lease` on it (see `hold()`).
      */
     template<ResponseField F>
         requires (!std::is_same_v<F, std::monostate>)   // mustn't be monostate
@@ -124,6 +169,9 @@ namespace RiRi::Response {
         /// The status code: initialized to the default status code ORPHANED
         StatusCode _status_code = StatusCode::ORPHANED;
 
+        /// Keeps what `_field` points into alive, if anything has to
+        Lease _lease;
+
     public:
 
         // thou shall use default
@@ -181,6 +229,12 @@ namespace RiRi::Response {
          * @param code The status code of type StatusCode
          */
         constexpr void setCode(const StatusCode code) noexcept { _status_code = code; }
+
+        /**
+         * @brief Keeps `lease` (what the field points into) for as long as this response lives
+         * @param lease The `Lease` to hold on to
+         */
+        void hold(Lease lease) noexcept { _lease = std::move(lease); }
     };
 
 
@@ -204,7 +258,7 @@ namespace RiRi::Response {
      *
     * @note Regardless of the size of the static blob, the entirety of the
     * requested result (or StatusCode) will be returned, nothing will be dropped.
-    * @note This class does not own the memory of the Fields.
+    * @note This class does not own the memory of the Fields, but it may hold a `Lease` on it (see `hold()`).
      */
     template <ResponseField F1, ResponseField F2>
         requires (!std::is_same_v<F1, std::monostate>)      // F1 cannot be monostate
@@ -246,7 +300,8 @@ namespace RiRi::Response {
         : _overall_code(obj._overall_code),
         _dynamic_store(std::move(obj._dynamic_store)),
         _entry_count(obj._entry_count),
-        _capacity(obj._capacity)
+        _capacity(obj._capacity),
+        _lease(std::move(obj._lease))
         {
             // if static buffer, we copy it.
             if (obj._entries == reinterpret_cast<EntryType *>(obj._static_store)) {
@@ -278,6 +333,9 @@ namespace RiRi::Response {
         std::uint32_t _entry_count = 0;
         std::uint32_t _capacity = TARGET_FIELD_TRACKING_CAPACITY;
 
+        /// Keeps what the result fields point into alive, if anything has to
+        Lease _lease;
+
         /**
          * @brief Increases the dynamic storage capacity for entries when the current capacity is not enough.
          *
@@ -398,6 +456,12 @@ namespace RiRi::Response {
             _overall_code = code;
         }
 
+        /**
+         * @brief Keeps `lease` (what the result fields point into) for as long as this response lives
+         * @param lease The `Lease` to hold on to
+         */
+        void hold(Lease lease) noexcept { _lease = std::move(lease); }
+
         /**
          * @brief Adds a TARGET_FIELD-RESPONSE_FIELD pair to the Response's memory blob.
          *
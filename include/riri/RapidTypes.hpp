@@ -1,7 +1,12 @@
 #pragma once    // RAPIDTYPES.HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
 
@@ -35,6 +40,8 @@ namespace RiRi {
      *
      * @var RapidNode::key The key as a `std::string`.
      * @var RapidNode::value The value as a `RapidDataType`, which can be a string, integer, double, or boolean.
+     * @var RapidNode::hash The hash of `key` if it was already computed (see `RiRi::prehash()`), `0` if not;
+     * commands hash the key themselves then. Change the key, reset the hash.
      *
      * You can either pass the values normally enforcing a copy, i.e., one allocation during node creation OR
      * move the values entirely via std::move, zero allocation during node creation
@@ -44,6 +51,16 @@ namespace RiRi {
     struct RapidNode {
         std::string key;
         RapidDataType value;
+        std::size_t hash = 0;
+
+        // `auto& [key, value] : nodes` predates `hash` and should keep working, so structured bindings
+        // see a node as a (key, value) pair (std::tuple_size below), the hash is a detail
+        template <std::size_t I>
+        [[nodiscard]] auto& get() & noexcept { if constexpr (I == 0) return key; else return value; }
+        template <std::size_t I>
+        [[nodiscard]] const auto& get() const& noexcept { if constexpr (I == 0) return key; else return value; }
+        template <std::size_t I>
+        [[nodiscard]] auto&& get() && noexcept { if constexpr (I == 0) return std::move(key); else return std::move(value); }
     };
     // Rule of 0 states that...
     // "If you can, write none of the special members. Let the compiler generate all of them."
@@ -51,6 +68,71 @@ namespace RiRi {
     // Or pass the values (enforcing a copy once) normally.
 
 
+    /**
+     * @brief Hashes a key exactly like the store does.
+     *
+     * The hash of a key never changes (not across stores, nor across runs of the same build).
+     */
+    [[nodiscard]] std::size_t hashKey(std::string_view key) noexcept;
+
+
+    /**
+     * @brief Fills in `RapidNode::hash` for every node that doesn't have one yet.
+     *
+     * For spans that go through several commands (e.g. a GET, then an UPDATE of the same keys):
+     * hash them once here, and no command has to hash them again.
+     */
+    void prehash(std::span<RapidNode> nodes) noexcept;
+
+
+    /**
+     * @brief A key that knows its own hash.
+     *
+     * Every command hashes its key(s) first, which for long keys (think 100+ byte composite keys)
+     * is a good part of the work. A `RapidKey` is hashed once, when it's built, and every command
+     * taking one skips straight to the lookup. Keep the hot ones around.
+     *
+     * @code
+     * const RiRi::RapidKey hot("tenant:42:user:1337:session:current");
+     * RiRi::Commands::GET(hot);
+     * RiRi::Commands::UPDATE(hot, "new value");
+     * @endcode
+     *
+     * @note Immutable, a key that could change under its hash would be a lookup that never finds anything.
+     */
+    class RapidKey {
+    public:
+        explicit RapidKey(std::string key) noexcept : _key(std::move(key)), _hash(hashKey(_key)) { }
+
+        [[nodiscard]] const std::string& key() const noexcept { return _key; }
+        [[nodiscard]] std::size_t hash() const noexcept { return _hash; }
+
+    private:
+        std::string _key;
+        std::size_t _hash;
+    };
+
+
+    /**
+     * @brief What a SET does about a key that already exists (or doesn't), like Redis' `SET ... NX|XX`.
+     */
+    enum class SetMode : std::uint8_t {
+        NX,         ///< only if the key doesn't exist yet, `ERR_KEY_ALREADY_EXISTS` otherwise; what SET always did
+        XX,         ///< only if the key exists, `ERR_KEY_NOT_FOUND` otherwise; an UPDATE
+        Always,     ///< either way, in a single lookup; an UPSERT
+    };
+
+
+    /**
+     * @brief What a BULK_LOAD does about a key it already has: in the store, or earlier in the batch.
+     */
+    enum class DuplicatePolicy : std::uint8_t {
+        FirstWins,  ///< the value that was there first stays, the later one is dropped quietly
+        LastWins,   ///< the later value replaces it, like an UPSERT; the batch's last value is the one left
+        Report,     ///< the value that was there first stays, the later one fails with `ERR_KEY_ALREADY_EXISTS`
+    };
+
+
     /**
      * @brief Represents various status codes for responses within the RapidResponse framework.
      *
@@ -72,6 +154,7 @@ namespace RiRi {
         // INFO CODES (100-199)
         ORPHANED = 100,                         // Default uninitialized state (equivalent to UNSET in other similar systems).
             // Basically, the response is currently empty and pending assignment.
+        INFO_KEY_HAS_NO_EXPIRY = 101,           // COMMAND LEVEL // TTL and PERSIST of a key that lives forever
 
         // WARNING CODES (200-299)
         WARN_KEY_STORE_NEARING_CAPACITY = 200,      // COMMAND LEVEL
@@ -102,6 +185,9 @@ namespace RiRi {
         // Instead, what if I do this:
         ERR_SOME_OPERATIONS_FAILED = 406,        // COMMAND LEVEL
         ERR_MULTIPLE_OPERATIONS_FAILED = 407,    // COMMAND LEVEL
+        ERR_WRONG_TYPE = 408,                    // COMMAND LEVEL // INCRBY of a string, and the like
+        ERR_VALUE_OUT_OF_RANGE = 409,            // COMMAND LEVEL // a counter that would overflow
+        ERR_VERSION_MISMATCH = 410,              // COMMAND LEVEL // CAS of a value somebody else wrote first
 
         // This would avoid branching, plus make the error codes more general,
         // over multiple types of commands, because the user already knows what command
@@ -132,6 +218,15 @@ namespace RiRi {
 } // namespace riri
 
 
+template <>
+struct std::tuple_size<RiRi::RapidNode> : std::integral_constant<std::size_t, 2> { };
+
+template <std::size_t I>
+struct std::tuple_element<I, RiRi::RapidNode> {
+    using type = std::conditional_t<I == 0, std::string, RiRi::RapidDataType>;
+};
+
+
 // Maybe I would need this for command dispatch? who knows? archiving in file
 // /**
 //  * @brief Type alias for a command function that takes a vector of string views as arguments.
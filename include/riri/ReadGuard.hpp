@@ -0,0 +1,46 @@
+#pragma once    // READGUARD.HPP
+
+
+namespace RiRi {
+
+        /**
+         * @class ReadGuard
+         * @brief Keeps values returned by `GET` alive while it is in scope.
+         *
+         * In concurrent-reads mode `GET` never takes a lock. Writers don't free old values right away
+         * anymore, they hand them to an epoch based reclaimer, which frees them only once no reader
+         * could still be looking at them. A `ReadGuard` tells the reclaimer "I am still looking".
+         *
+         * So: every `const RapidDataType*` you got from a `GET` *inside* the guard's scope stays valid
+         * (and keeps pointing at the value as it was when you read it) until the guard is destroyed,
+         * even if another thread updates or deletes that key in the meantime. Inside a guard a `GET`
+         * hands out the published value itself, no copy; it's the guard, not the response, that keeps
+         * it alive then, so don't use it past the guard's scope.
+         *
+         * Outside a guard, `GET` hands out per-thread copies that live as long as the response they came
+         * in, concurrent reads or not; without concurrent reads, copies made inside a guard's scope live
+         * on after it too, so the same promise holds.
+         *
+         * @code
+         * {
+         *     RiRi::ReadGuard guard;
+         *     auto response = RiRi::Commands::GET("key");
+         *     // response's pointer is safe to use here, no matter what writers do
+         * }   // and not anymore here
+         * @endcode
+         *
+         * @note Cheap: it only writes to a per-thread slot, never to memory shared with other readers.
+         * @note Guards nest, only the outermost one matters.
+         * @warning Don't hold a guard forever, nothing retired while it lives can be freed.
+         * @warning A guard belongs to the thread that created it; don't hand it to another thread.
+         */
+        class ReadGuard {
+        public:
+                ReadGuard() noexcept;
+                ~ReadGuard();
+
+                ReadGuard(const ReadGuard&) = delete;
+                ReadGuard& operator=(const ReadGuard&) = delete;
+        };
+
+} // namespace RiRi
@@ -0,0 +1,164 @@
+#pragma once    // STORE.HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+
+namespace RiRi {
+
+        namespace Internal {
+                class RapidStore;
+                struct StoreAccess;
+        }
+
+        /**
+         * @brief What a store over its memory budget (`StoreOptions::maxMemory`) does with a write that needs more.
+         */
+        enum class EvictionPolicy : std::uint8_t {
+                Reject,     ///< turn it down, `ERR_KEY_STORE_FULL`
+                LRU,        ///< make room by evicting (roughly) the least recently used keys
+                LFU,        ///< make room by evicting (roughly) the least frequently used keys
+        };
+
+
+        /**
+         * @struct StoreOptions
+         * @brief Everything a `Store` is built from. Defaults match the default store.
+         *
+         * @code
+         * RiRi::Store store({.initialCapacity = 50'000'000, .shardCount = 64});
+         * @endcode
+         */
+        struct StoreOptions {
+                /// Number of keys to reserve room for up front (spread over the shards), no rehashing until then.
+                std::size_t initialCapacity = 100;
+
+                /// How full the hash tables get before they grow, clamped to `[0.1, 0.99]`.
+                float maxLoadFactor = 0.8f;
+
+                /// Number of independently locked shards; rounded up to a power of two.
+                std::size_t shardCount = 16;
+
+                /// Serve GETs without locks (see `RiRi::ReadGuard`); costs some write throughput and memory.
+                bool concurrentReads = false;
+
+                /// Grow the hash tables a few entries per write instead of all at once when they fill up;
+                /// no single SET ever pays for a full rehash, at the price of some overall throughput.
+                bool incrementalRehash = false;
+
+                /// Load factor under which a shard compacts on its own, like `COMPACT` does: shrinks its
+                /// table and moves its strings into fresh slabs, a few entries per write. Clamped to
+                /// `[0, 0.25]`, `0` never (call `COMPACT` after mass deletions instead).
+                float compactBelow = 0.0f;
+
+                /// Put the hash tables' entries and buckets on 2MB pages (explicit ones if the system has
+                /// some reserved, transparent ones otherwise), so random lookups in big stores miss the
+                /// TLB far less; falls back to normal pages where there are none. Only tables of 2MB and up.
+                bool hugePages = false;
+
+                /// Spread the shards over the machine's NUMA nodes, each shard's tables and slabs in its
+                /// node's memory, so threads working on a node's keys (see `Store::nodeOf()`) stay local.
+                /// No effect on single-node machines.
+                bool numaAware = false;
+
+                /// Keep a value -> keys index, so `FIND_BY_VALUE` doesn't have to scan the whole store;
+                /// costs every write a little and every distinct value some memory.
+                bool valueIndex = false;
+
+                /// Keep the keys in order too, so `RANGE` and `SCAN_PREFIX` only look at the keys they return
+                /// instead of scanning the whole store; costs every new key a little and some memory.
+                bool orderedIndex = false;
+
+                /// How often a background thread expires the keys whose TTL ran out, `0` for no thread.
+                /// Without one, expired keys are never returned, but their memory is only reclaimed by
+                /// the writes to their shard.
+                std::chrono::milliseconds expirySweepInterval{0};
+
+                /// Bytes the keys and values (with their bookkeeping) may take, `0` for no limit. Split evenly
+                /// over the shards, so one shard can be full while the store as a whole isn't.
+                std::size_t maxMemory = 0;
+
+                /// What a write that doesn't fit in `maxMemory` does. Eviction samples a few keys of the
+                /// shard and drops the worst, like Redis does; it's approximate, not exact LRU/LFU.
+                /// Lock-free GETs (`concurrentReads`) count as uses too.
+                EvictionPolicy eviction = EvictionPolicy::Reject;
+
+                /// Fraction of `maxMemory` past which writes report `WARN_KEY_STORE_NEARING_CAPACITY`;
+                /// `1` never warns (a cache that evicts is meant to stay full).
+                float memoryWarningRatio = 0.9f;
+        };
+
+
+        /**
+         * @class Store
+         * @brief An isolated keyspace.
+         *
+         * Every `Commands::*` function has an overload taking a `Store&` as its first argument; the ones
+         * without it work on the default store (`Store::defaultStore()`). Stores share nothing, so one store
+         * growing (or being cleared) never stalls another, e.g. one store per tenant.
+         *
+         * @code
+         * RiRi::Store sessions({.initialCapacity = 1'000'000});
+         * RiRi::Commands::SET(sessions, "key", "value");
+         * auto response = RiRi::Commands::GET(sessions, "key");
+         * @endcode
+         *
+         * @note Safe to use from multiple threads, like the default store.
+         * @warning Moving a store while other threads use it is NOT safe.
+         */
+        class Store {
+        public:
+                explicit Store(const StoreOptions& options = {});
+                ~Store();
+
+                Store(const Store&) = delete;
+                Store& operator=(const Store&) = delete;
+                Store(Store&&) noexcept;
+                Store& operator=(Store&&) noexcept;
+
+                /**
+                 * @brief The store every `Commands::*` overload without a `Store&` works on.
+                 */
+                [[nodiscard]] static Store& defaultStore() noexcept;
+
+                /**
+                 * @brief The options this store was built with (shard count already rounded up).
+                 */
+                [[nodiscard]] const StoreOptions& options() const noexcept;
+
+                /**
+                 * @brief The NUMA node `key`'s shard lives on, `-1` unless the store is NUMA aware (on a
+                 * machine with more than one node).
+                 *
+                 * For routing work to threads on the owning node (`RiRi::runOnNode()`): group a batch's
+                 * keys by node, hand each group to a thread of that node. Parallel batches
+                 * (`RiRi::enableParallel`) already run most shards on their node's workers.
+                 */
+                [[nodiscard]] int nodeOf(std::string_view key) const noexcept;
+
+        private:
+                friend struct Internal::StoreAccess;
+
+                /// Non-owning, for the default store only.
+                explicit Store(Internal::RapidStore& store) noexcept;
+
+                std::unique_ptr<Internal::RapidStore> _owned;
+                Internal::RapidStore* _store;
+        };
+
+
+        /**
+         * @brief NUMA nodes with memory on this machine, `1` on single-node ones (and where we can't tell).
+         */
+        [[nodiscard]] std::size_t numaNodeCount() noexcept;
+
+        /**
+         * @brief Keeps the calling thread on the CPUs of NUMA node `node` (a `Store::nodeOf()` value).
+         * @return `false` if it couldn't be done (no such node, no NUMA support); the thread runs wherever it did before.
+         */
+        bool runOnNode(int node) noexcept;
+
+} // namespace RiRi
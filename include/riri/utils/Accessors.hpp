@@ -115,6 +115,7 @@ namespace RiRi::Utils {
         switch (code) {
             CASE(OK);
             CASE(ORPHANED);
+            CASE(INFO_KEY_HAS_NO_EXPIRY);
             CASE(WARN_KEY_STORE_NEARING_CAPACITY);
             CASE(WARN_ZERO_NODES_PROVIDED);
             CASE(WARN_RESPONSE_CONTAINS_WARNINGS);
@@ -127,6 +128,9 @@ namespace RiRi::Utils {
             CASE(ERR_SINGLE_NODE_EXPECTED);
             CASE(ERR_SOME_OPERATIONS_FAILED);
             CASE(ERR_MULTIPLE_OPERATIONS_FAILED);
+            CASE(ERR_WRONG_TYPE);
+            CASE(ERR_VALUE_OUT_OF_RANGE);
+            CASE(ERR_VERSION_MISMATCH);
             CASE(ERR_INVALID_KEY);
             CASE(ERR_INVALID_VALUE);
             CASE(ERR_INVALID_COMMAND);
@@ -0,0 +1,66 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace RiRi::Commands {
+
+    namespace {
+
+        Response::StatusWith<const RapidDataType*> spliced(const Internal::RapidWrite write, const std::size_t length) {
+            if (!write) return Response::StatusWith<const RapidDataType*>(nullptr, write.code());
+
+            Response::StatusWith response(Internal::snapshotNumber(static_cast<std::int64_t>(length)), write.code());
+            response.hold(Internal::readLease());
+            return response;
+        }
+
+    } // namespace
+
+
+    // APPEND
+
+    Response::StatusWith<const RapidDataType*> APPEND (Store& store, const std::string_view key, const std::string_view suffix) {
+        std::size_t length = 0;
+        const Internal::RapidWrite write = Internal::spliceString(Internal::StoreAccess::of(store), key, Internal::SPLICE_APPEND, suffix, length);
+        return spliced(write, length);
+    }
+
+
+    // SETRANGE
+
+    Response::StatusWith<const RapidDataType*> SETRANGE (Store& store, const std::string_view key, const std::size_t offset, const std::string_view bytes) {
+        if (offset == Internal::SPLICE_APPEND) return Response::StatusWith<const RapidDataType*>(nullptr, StatusCode::ERR_VALUE_OUT_OF_RANGE);
+        std::size_t length = 0;
+        const Internal::RapidWrite write = Internal::spliceString(Internal::StoreAccess::of(store), key, offset, bytes, length);
+        return spliced(write, length);
+    }
+
+
+    // GETRANGE
+
+    Response::StatusWith<std::string_view> GETRANGE (Store& store, const std::string_view key, const std::size_t offset, const std::size_t length) {
+        std::string_view range;
+        const StatusCode code = Internal::getRange(Internal::StoreAccess::of(store), key, offset, length, range);
+        Response::StatusWith<std::string_view> response(range, code);
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusWith<const RapidDataType*> APPEND (const std::string_view key, const std::string_view suffix) {
+        return APPEND(Store::defaultStore(), key, suffix);
+    }
+
+    Response::StatusWith<const RapidDataType*> SETRANGE (const std::string_view key, const std::size_t offset, const std::string_view bytes) {
+        return SETRANGE(Store::defaultStore(), key, offset, bytes);
+    }
+
+    Response::StatusWith<std::string_view> GETRANGE (const std::string_view key, const std::size_t offset, const std::size_t length) {
+        return GETRANGE(Store::defaultStore(), key, offset, length);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,53 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace RiRi::Commands {
+
+    // CAS
+
+    Response::StatusWith<const RapidDataType*> CAS (Store& store, const std::string_view key, const std::uint64_t expected_version, RapidDataType value) {
+        std::uint64_t version = 0;
+        const Internal::RapidWrite write = Internal::compareAndSwap(Internal::StoreAccess::of(store), key, expected_version, std::move(value), version);
+        if (!write && write.code() != StatusCode::ERR_VERSION_MISMATCH) return Response::StatusWith<const RapidDataType*>(nullptr, write.code());
+
+        Response::StatusWith response(Internal::snapshotNumber(static_cast<std::int64_t>(version)), write.code());
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> CAS (Store& store, std::span<RapidNode> nodes, const std::span<const std::uint64_t> expected_versions) {
+        Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+        if (nodes.empty()) {
+            response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+            return response;
+        }
+        if (expected_versions.size() != nodes.size()) {
+            response.setCode(StatusCode::ERR_INVALID_ARGUMENT);
+            return response;
+        }
+        response.setCode(StatusCode::OK);
+        const auto written = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        Internal::compareAndSwapValues(Internal::StoreAccess::of(store), nodes, expected_versions, {written.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            // the node's value is its new version now
+            written[i].code() == StatusCode::OK ? response.addResultEntry(nodes[i].key, &nodes[i].value)
+                                                : response.addStatusEntry(nodes[i].key, written[i].code());
+        }
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusWith<const RapidDataType*> CAS (const std::string_view key, const std::uint64_t expected_version, RapidDataType value) {
+        return CAS(Store::defaultStore(), key, expected_version, std::move(value));
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> CAS (std::span<RapidNode> nodes, const std::span<const std::uint64_t> expected_versions) {
+        return CAS(Store::defaultStore(), nodes, expected_versions);
+    }
+
+} // namespace RiRi::Commands
@@ -5,9 +5,16 @@ namespace RiRi::Commands {
 
     // CLEAR
 
-    Response::Status CLEAR () {
-        Internal::clearMap();
+    Response::Status CLEAR (Store& store) {
+        Internal::clearMap(Internal::StoreAccess::of(store));
         return Response::Status(StatusCode::OK);
     }
 
-} // namespace RiRi::Commands
\ No newline at end of file
+
+    // Default store
+
+    Response::Status CLEAR () {
+        return CLEAR(Store::defaultStore());
+    }
+
+} // namespace RiRi::Commands
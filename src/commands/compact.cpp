@@ -0,0 +1,25 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RiRi::Commands {
+
+    // COMPACT
+
+    Response::StatusWith<const RapidDataType*> COMPACT (Store& store) {
+        const std::size_t reclaimed = Internal::compactStore(Internal::StoreAccess::of(store));
+        Response::StatusWith response(Internal::snapshotNumber(static_cast<std::int64_t>(reclaimed)), StatusCode::OK);
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusWith<const RapidDataType*> COMPACT () {
+        return COMPACT(Store::defaultStore());
+    }
+
+} // namespace RiRi::Commands
@@ -1,17 +1,25 @@
 #include "riri/Commands.hpp"
 #include "DataManager.h"
 
+#include <memory>
+
 namespace RiRi::Commands {
 
     // DELETE
 
-    Response::Status DELETE (std::string_view key) {
-        return Response::Status(Internal::deleteKey(key)
+    Response::Status DELETE (Store& store, std::string_view key) {
+        return Response::Status(Internal::deleteKey(Internal::StoreAccess::of(store), key)
             ? StatusCode::OK
             : StatusCode::ERR_KEY_NOT_FOUND);
     }
 
-    Response::Status DELETE (std::span<RapidNode> nodes) {
+    Response::Status DELETE (Store& store, const RapidKey& key) {
+        return Response::Status(Internal::deleteKey(Internal::StoreAccess::of(store), key.key(), key.hash())
+            ? StatusCode::OK
+            : StatusCode::ERR_KEY_NOT_FOUND);
+    }
+
+    Response::Status DELETE (Store& store, std::span<RapidNode> nodes) {
         Response::Status response;
 
         // I am so sorry.
@@ -20,7 +28,7 @@ namespace RiRi::Commands {
             return response;
         }
         if (nodes.size() == 1) {
-            if (!Internal::deleteKey(nodes[0].key)) {
+            if (!Internal::deleteKey(Internal::StoreAccess::of(store), nodes[0].key, nodes[0].hash)) {
                 // if deletion failed
                 response.setCode(StatusCode::ERR_KEY_NOT_FOUND);
                 return response;
@@ -30,8 +38,10 @@ namespace RiRi::Commands {
         }
 
         response.setCode(StatusCode::OK);   // set default code
-        for (auto& [key, _]: nodes) {
-            if (!Internal::deleteKey(key)) {
+        const auto deleted = std::make_unique_for_overwrite<bool[]>(nodes.size());
+        Internal::deleteKeys(Internal::StoreAccess::of(store), nodes, {deleted.get(), nodes.size()});     // one lock per shard, not per node
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!deleted[i]) {
                 // if deletion failed
                 response.setCode(StatusCode::ERR_SOME_OPERATIONS_FAILED);
             }
@@ -39,36 +49,63 @@ namespace RiRi::Commands {
         return response;
     }
 
-    Response::StatusErrorBatchWith<std::string_view> DELETE (std::span<RapidNode> nodes, enableErrorBatched) {
+    Response::StatusErrorBatchWith<std::string_view> DELETE (Store& store, std::span<RapidNode> nodes, enableErrorBatched) {
         // the default code is OK (internal implementation)
         Response::StatusErrorBatchWith<std::string_view> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }     // exit early if empty
-        for (auto& [key, _]: nodes) {
-            if (!Internal::deleteKey(key)) {
+        const auto deleted = std::make_unique_for_overwrite<bool[]>(nodes.size());
+        Internal::deleteKeys(Internal::StoreAccess::of(store), nodes, {deleted.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!deleted[i]) {
                 // if deletion failed
-                response.addErrorEntry(key, StatusCode::ERR_KEY_NOT_FOUND);
+                response.addErrorEntry(nodes[i].key, StatusCode::ERR_KEY_NOT_FOUND);
             }
         }
         return response;
     }
 
-    Response::StatusBatchWith<std::string_view, std::monostate> DELETE (std::span<RapidNode> nodes, enableBatched) {
+    Response::StatusBatchWith<std::string_view, std::monostate> DELETE (Store& store, std::span<RapidNode> nodes, enableBatched) {
         Response::StatusBatchWith<std::string_view, std::monostate> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }
         response.setCode(StatusCode::OK);   // set default overall code
-        for (auto& [key, _]: nodes) {
-            if (!Internal::deleteKey(key)) {
+        const auto deleted = std::make_unique_for_overwrite<bool[]>(nodes.size());
+        Internal::deleteKeys(Internal::StoreAccess::of(store), nodes, {deleted.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!deleted[i]) {
                 // if deletion failed
-                response.addStatusEntry(key, StatusCode::ERR_KEY_NOT_FOUND);
+                response.addStatusEntry(nodes[i].key, StatusCode::ERR_KEY_NOT_FOUND);
             }
         }
         return response;
     }
 
-} // namespace RiRi::Commands
\ No newline at end of file
+
+    // Default store
+
+    Response::Status DELETE (const RapidKey& key) {
+        return DELETE(Store::defaultStore(), key);
+    }
+
+    Response::Status DELETE (std::string_view key) {
+        return DELETE(Store::defaultStore(), key);
+    }
+
+    Response::Status DELETE (std::span<RapidNode> nodes) {
+        return DELETE(Store::defaultStore(), nodes);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> DELETE (std::span<RapidNode> nodes, enableErrorBatched) {
+        return DELETE(Store::defaultStore(), nodes, enableErrorBatched{});
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> DELETE (std::span<RapidNode> nodes, enableBatched) {
+        return DELETE(Store::defaultStore(), nodes, enableBatched{});
+    }
+
+} // namespace RiRi::Commands
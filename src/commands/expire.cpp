@@ -0,0 +1,52 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+namespace RiRi::Commands {
+
+    // EXPIRE
+
+    Response::Status EXPIRE (Store& store, const std::string_view key, const std::chrono::milliseconds ttl) {
+        return Response::Status(Internal::expireKey(Internal::StoreAccess::of(store), key, ttl)
+            ? StatusCode::OK
+            : StatusCode::ERR_KEY_NOT_FOUND);
+    }
+
+
+    // TTL
+
+    Response::StatusWith<const RapidDataType*> TTL (Store& store, const std::string_view key) {
+        const auto ttl = Internal::getTtl(Internal::StoreAccess::of(store), key);
+        if (ttl == Internal::TTL_KEY_NOT_FOUND) return Response::StatusWith<const RapidDataType*>(nullptr, StatusCode::ERR_KEY_NOT_FOUND);
+        if (ttl == Internal::TTL_NEVER) return Response::StatusWith<const RapidDataType*>(nullptr, StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+
+        Response::StatusWith response(Internal::snapshotNumber(static_cast<std::int64_t>(ttl.count())), StatusCode::OK);
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // PERSIST
+
+    Response::Status PERSIST (Store& store, const std::string_view key) {
+        const auto ttl = Internal::persistKey(Internal::StoreAccess::of(store), key);
+        if (ttl == Internal::TTL_KEY_NOT_FOUND) return Response::Status(StatusCode::ERR_KEY_NOT_FOUND);
+        if (ttl == Internal::TTL_NEVER) return Response::Status(StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+        return Response::Status(StatusCode::OK);
+    }
+
+
+    // Default store
+
+    Response::Status EXPIRE (const std::string_view key, const std::chrono::milliseconds ttl) {
+        return EXPIRE(Store::defaultStore(), key, ttl);
+    }
+
+    Response::StatusWith<const RapidDataType*> TTL (const std::string_view key) {
+        return TTL(Store::defaultStore(), key);
+    }
+
+    Response::Status PERSIST (const std::string_view key) {
+        return PERSIST(Store::defaultStore(), key);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,33 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+namespace RiRi::Commands {
+
+    // FIND_BY_VALUE
+
+    Response::StatusBatchWith<std::string_view, std::monostate> FIND_BY_VALUE (Store& store, const RapidDataType& value) {
+        Response::StatusBatchWith<std::string_view, std::monostate> response;
+        const auto keys = Internal::findKeysByValue(Internal::StoreAccess::of(store), value);
+        if (Internal::readStarved()) {
+            response.setCode(StatusCode::ERR_OUT_OF_MEMORY);     // some keys may be missing, none of them then
+            return response;
+        }
+        if (keys.empty()) {
+            response.setCode(StatusCode::ERR_VALUE_NOT_FOUND);
+            return response;
+        }
+        for (const std::string_view key : keys) {
+            response.addStatusEntry(key, StatusCode::OK);   // the keys are all there is to say
+        }
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusBatchWith<std::string_view, std::monostate> FIND_BY_VALUE (const RapidDataType& value) {
+        return FIND_BY_VALUE(Store::defaultStore(), value);
+    }
+
+} // namespace RiRi::Commands
@@ -1,19 +1,43 @@
 #include "riri/Commands.hpp"
 #include "DataManager.h"
 
+#include <cstdint>
+#include <memory>
+
 namespace RiRi::Commands {
 
+    namespace {
+
+        /// Why a lookup came back empty handed: no such key, or no memory to copy its value into.
+        StatusCode missing() noexcept {
+            return Internal::readStarved() ? StatusCode::ERR_OUT_OF_MEMORY : StatusCode::ERR_KEY_NOT_FOUND;
+        }
+
+    } // namespace
+
+
     // GET
 
-    Response::StatusWith<const RapidDataType*> GET (std::string_view key) {
-        auto value = Internal::getValue(key);
-        return Response::StatusWith (
+    Response::StatusWith<const RapidDataType*> GET (Store& store, std::string_view key) {
+        auto value = Internal::getValue(Internal::StoreAccess::of(store), key);
+        Response::StatusWith response (
             value,
-            value ? StatusCode::OK : StatusCode::ERR_KEY_NOT_FOUND);
+            value ? StatusCode::OK : missing());
+        response.hold(Internal::readLease());       // the value lives as long as the response
+        return response;
         // I refuse to use my own public helper functions for this case
     }
 
-    Response::StatusWith<const RapidDataType*> GET (std::span<RapidNode> node) {
+    Response::StatusWith<const RapidDataType*> GET (Store& store, const RapidKey& key) {
+        auto value = Internal::getValue(Internal::StoreAccess::of(store), key.key(), key.hash());
+        Response::StatusWith response (
+            value,
+            value ? StatusCode::OK : missing());
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+    Response::StatusWith<const RapidDataType*> GET (Store& store, std::span<RapidNode> node) {
         Response::StatusWith<const RapidDataType*> response;
         if (node.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
@@ -27,25 +51,68 @@ namespace RiRi::Commands {
             // TODO
             return response;
         }
-        auto value = Internal::getValue(node[0].key);
+        auto value = Internal::getValue(Internal::StoreAccess::of(store), node[0].key, node[0].hash);
         response.fill(
             value,
-            value ? StatusCode::OK : StatusCode::ERR_KEY_NOT_FOUND);
+            value ? StatusCode::OK : missing());
+        response.hold(Internal::readLease());
         return response;
     }
 
-    Response::StatusBatchWith<std::string_view, const RapidDataType*> GET (std::span<RapidNode> nodes, enableBatched) {
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> GET (Store& store, std::span<RapidNode> nodes, enableBatched) {
+        return GET(store, nodes, enableBatched{}, enableParallel{1});
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> GET (Store& store, std::span<RapidNode> nodes, enableBatched, const enableParallel parallel) {
         Response::StatusBatchWith<std::string_view, const RapidDataType *> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }   // early exit on empty nodes
-        for (auto &[key, _]: nodes) { // _ instead of "value" since we don't care about it
-            auto val = Internal::getValue(key);
-            val ? response.addResultEntry(key, val):
-            response.addStatusEntry(key, StatusCode::ERR_KEY_NOT_FOUND);
+        const auto values = std::make_unique_for_overwrite<const RapidDataType*[]>(nodes.size());
+        Internal::getValues(Internal::StoreAccess::of(store), nodes, {values.get(), nodes.size()}, parallel.threads);     // one shared lock per shard, not per node
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            values[i] ? response.addResultEntry(nodes[i].key, values[i]):
+            response.addStatusEntry(nodes[i].key, missing());
         }
+        response.hold(Internal::readLease());       // one lease for the whole batch, it shares one buffer
         return response;
     }
 
+    Response::StatusWith<const RapidDataType*> GET (Store& store, const std::string_view key, std::uint64_t& version) {
+        auto value = Internal::getVersionedValue(Internal::StoreAccess::of(store), key, version);
+        Response::StatusWith response (
+            value,
+            value ? StatusCode::OK : missing());
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusWith<const RapidDataType*> GET (const RapidKey& key) {
+        return GET(Store::defaultStore(), key);
+    }
+
+    Response::StatusWith<const RapidDataType*> GET (std::string_view key) {
+        return GET(Store::defaultStore(), key);
+    }
+
+    Response::StatusWith<const RapidDataType*> GET (std::span<RapidNode> node) {
+        return GET(Store::defaultStore(), node);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> GET (std::span<RapidNode> nodes, enableBatched) {
+        return GET(Store::defaultStore(), nodes, enableBatched{});
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> GET (std::span<RapidNode> nodes, enableBatched, const enableParallel parallel) {
+        return GET(Store::defaultStore(), nodes, enableBatched{}, parallel);
+    }
+
+    Response::StatusWith<const RapidDataType*> GET (const std::string_view key, std::uint64_t& version) {
+        return GET(Store::defaultStore(), key, version);
+    }
+
 } // namespace RiRi::Commands
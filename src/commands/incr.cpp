@@ -0,0 +1,86 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace RiRi::Commands {
+
+    namespace {
+
+        template <typename T>
+        Response::StatusWith<const RapidDataType*> incremented(const Internal::RapidWrite write, const T result) {
+            if (!write) return Response::StatusWith<const RapidDataType*>(nullptr, write.code());
+
+            Response::StatusWith response(Internal::snapshotNumber(result), write.code());
+            response.hold(Internal::readLease());
+            return response;
+        }
+
+        template <typename T>
+        Response::StatusBatchWith<std::string_view, const RapidDataType*> incrementAll(Store& store, std::span<RapidNode> nodes, const std::optional<T> initial) {
+            Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+            if (nodes.empty()) {
+                response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+                return response;
+            }
+            response.setCode(StatusCode::OK);
+            const auto written = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+            Internal::incrementValues<T>(Internal::StoreAccess::of(store), nodes, initial, {written.get(), nodes.size()});
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                // the node's value is the new number now, for warnings too
+                written[i].code() == StatusCode::OK ? response.addResultEntry(nodes[i].key, &nodes[i].value)
+                                                    : response.addStatusEntry(nodes[i].key, written[i].code());
+            }
+            return response;
+        }
+
+    } // namespace
+
+
+    // INCRBY
+
+    Response::StatusWith<const RapidDataType*> INCRBY (Store& store, const std::string_view key, const std::int64_t by, const std::optional<std::int64_t> initial) {
+        std::int64_t result = 0;
+        const Internal::RapidWrite write = Internal::incrementValue(Internal::StoreAccess::of(store), key, by, initial, result);
+        return incremented(write, result);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBY (Store& store, std::span<RapidNode> nodes, const std::optional<std::int64_t> initial) {
+        return incrementAll(store, nodes, initial);
+    }
+
+
+    // INCRBYFLOAT
+
+    Response::StatusWith<const RapidDataType*> INCRBYFLOAT (Store& store, const std::string_view key, const double by, const std::optional<double> initial) {
+        double result = 0;
+        const Internal::RapidWrite write = Internal::incrementValue(Internal::StoreAccess::of(store), key, by, initial, result);
+        return incremented(write, result);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBYFLOAT (Store& store, std::span<RapidNode> nodes, const std::optional<double> initial) {
+        return incrementAll(store, nodes, initial);
+    }
+
+
+    // Default store
+
+    Response::StatusWith<const RapidDataType*> INCRBY (const std::string_view key, const std::int64_t by, const std::optional<std::int64_t> initial) {
+        return INCRBY(Store::defaultStore(), key, by, initial);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBY (std::span<RapidNode> nodes, const std::optional<std::int64_t> initial) {
+        return INCRBY(Store::defaultStore(), nodes, initial);
+    }
+
+    Response::StatusWith<const RapidDataType*> INCRBYFLOAT (const std::string_view key, const double by, const std::optional<double> initial) {
+        return INCRBYFLOAT(Store::defaultStore(), key, by, initial);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> INCRBYFLOAT (std::span<RapidNode> nodes, const std::optional<double> initial) {
+        return INCRBYFLOAT(Store::defaultStore(), nodes, initial);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,47 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <memory>
+
+namespace RiRi::Commands {
+
+    // BULK_LOAD
+
+    Response::Status BULK_LOAD (Store& store, std::span<RapidNode> nodes, const DuplicatePolicy policy, const enableParallel parallel) {
+        Response::Status response;
+        if (nodes.empty()) {
+            response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+            return response;
+        }
+        // nobody asked which ones failed, so nothing is written down per node
+        const std::size_t failed = Internal::loadValues(Internal::StoreAccess::of(store), nodes, policy, {}, parallel.threads);
+        response.setCode(failed == 0 ? StatusCode::OK : StatusCode::ERR_SOME_OPERATIONS_FAILED);
+        return response;
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> BULK_LOAD (Store& store, std::span<RapidNode> nodes, enableErrorBatched, const DuplicatePolicy policy, const enableParallel parallel) {
+        Response::StatusErrorBatchWith<std::string_view> response;
+        if (nodes.empty()) {
+            response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+            return response;
+        }
+        const auto loaded = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        if (Internal::loadValues(Internal::StoreAccess::of(store), nodes, policy, {loaded.get(), nodes.size()}, parallel.threads) == 0) return response;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!loaded[i]) response.addErrorEntry(nodes[i].key, loaded[i].code());
+        }
+        return response;
+    }
+
+
+    // Default store
+
+    Response::Status BULK_LOAD (std::span<RapidNode> nodes, const DuplicatePolicy policy, const enableParallel parallel) {
+        return BULK_LOAD(Store::defaultStore(), nodes, policy, parallel);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> BULK_LOAD (std::span<RapidNode> nodes, enableErrorBatched, const DuplicatePolicy policy, const enableParallel parallel) {
+        return BULK_LOAD(Store::defaultStore(), nodes, enableErrorBatched{}, policy, parallel);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,57 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <string_view>
+#include <utility>
+
+namespace RiRi::Commands {
+
+    // MEMORY_STATS
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> MEMORY_STATS (Store& store) {
+        const Internal::RapidMemoryStats stats = Internal::memoryStats(Internal::StoreAccess::of(store));
+        const std::pair<std::string_view, std::size_t> fields[] {
+            {"keys", stats.keys},
+            {"key_bytes", stats.keyBytes},
+            {"value_bytes", stats.valueBytes},
+            {"bucket_bytes", stats.bucketBytes},
+            {"entry_bytes", stats.entryBytes},
+            {"used_bytes", stats.total()},
+            {"slab_bytes", stats.slabBytes},
+            {"budget_bytes", stats.budgetBytes},
+            {"max_memory", store.options().maxMemory},
+        };
+
+        Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+        response.setCode(StatusCode::OK);
+        for (std::size_t i = 0; i < std::size(fields); ++i) {
+            response.addResultEntry(fields[i].first, Internal::snapshotNumber(static_cast<std::int64_t>(fields[i].second), i == 0));
+        }
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // MEMORY_USAGE
+
+    Response::StatusWith<const RapidDataType*> MEMORY_USAGE (Store& store, const std::string_view key) {
+        const std::size_t bytes = Internal::memoryUsage(Internal::StoreAccess::of(store), key);
+        if (bytes == 0) return Response::StatusWith<const RapidDataType*>(nullptr, StatusCode::ERR_KEY_NOT_FOUND);
+
+        Response::StatusWith response(Internal::snapshotNumber(static_cast<std::int64_t>(bytes)), StatusCode::OK);
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> MEMORY_STATS () {
+        return MEMORY_STATS(Store::defaultStore());
+    }
+
+    Response::StatusWith<const RapidDataType*> MEMORY_USAGE (const std::string_view key) {
+        return MEMORY_USAGE(Store::defaultStore(), key);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,68 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <span>
+#include <string_view>
+
+namespace RiRi::Commands {
+
+    namespace {
+
+        /// The batch both commands answer with: `{key, value}` per entry, or `ERR_KEY_NOT_FOUND` without any
+        /// (`ERR_OUT_OF_MEMORY` without any, if some didn't fit).
+        Response::StatusBatchWith<std::string_view, const RapidDataType*> scanned(const std::span<const Internal::RapidScanEntry> entries) {
+            Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+            if (Internal::readStarved()) {
+                response.setCode(StatusCode::ERR_OUT_OF_MEMORY);
+                return response;
+            }
+            if (entries.empty()) {
+                response.setCode(StatusCode::ERR_KEY_NOT_FOUND);
+                return response;
+            }
+            response.setCode(StatusCode::OK);
+            for (const Internal::RapidScanEntry& entry : entries) {
+                response.addResultEntry(entry.key, entry.value);
+            }
+            response.hold(Internal::readLease());
+            return response;
+        }
+
+    } // namespace
+
+
+    // RANGE
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> RANGE (Store& store, const std::string_view start, const std::string_view end, const std::size_t limit) {
+        if (limit == 0 || (!end.empty() && end < start)) {
+            Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+            response.setCode(StatusCode::ERR_INVALID_ARGUMENT);
+            return response;
+        }
+        return scanned(Internal::scanKeys(Internal::StoreAccess::of(store), start, end, limit));
+    }
+
+
+    // SCAN_PREFIX
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN_PREFIX (Store& store, const std::string_view prefix, const std::size_t limit) {
+        if (limit == 0) {
+            Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+            response.setCode(StatusCode::ERR_INVALID_ARGUMENT);
+            return response;
+        }
+        return scanned(Internal::scanPrefix(Internal::StoreAccess::of(store), prefix, limit));
+    }
+
+
+    // Default store
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> RANGE (const std::string_view start, const std::string_view end, const std::size_t limit) {
+        return RANGE(Store::defaultStore(), start, end, limit);
+    }
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN_PREFIX (const std::string_view prefix, const std::size_t limit) {
+        return SCAN_PREFIX(Store::defaultStore(), prefix, limit);
+    }
+
+} // namespace RiRi::Commands
@@ -0,0 +1,34 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace RiRi::Commands {
+
+    // SCAN
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN (Store& store, std::uint64_t& cursor, const std::size_t count) {
+        Response::StatusBatchWith<std::string_view, const RapidDataType*> response;
+        if (count == 0) {
+            response.setCode(StatusCode::ERR_INVALID_ARGUMENT);
+            return response;
+        }
+        for (const Internal::RapidScanEntry& entry : Internal::scanStore(Internal::StoreAccess::of(store), cursor, count)) {
+            response.addResultEntry(entry.key, entry.value);
+        }
+        // an empty chunk is no error, the walk just isn't done yet; a short one for want of memory is,
+        // though the cursor still picks up right where it stopped
+        response.setCode(Internal::readStarved() ? StatusCode::ERR_OUT_OF_MEMORY : StatusCode::OK);
+        response.hold(Internal::readLease());
+        return response;
+    }
+
+
+    // Default store
+
+    Response::StatusBatchWith<std::string_view, const RapidDataType*> SCAN (std::uint64_t& cursor, const std::size_t count) {
+        return SCAN(Store::defaultStore(), cursor, count);
+    }
+
+} // namespace RiRi::Commands
@@ -1,22 +1,70 @@
 #include "riri/Commands.hpp"
 #include "DataManager.h"
 
+#include <memory>
+
 namespace RiRi::Commands {
 
+    namespace {
+
+        /// The write `mode` asks for: a SET, an UPDATE or an UPSERT.
+        Internal::RapidWrite write(Store& store, const std::string_view key, RapidDataType&& value, const SetMode mode, const std::size_t hash = 0) {
+            Internal::RapidStore& rapid = Internal::StoreAccess::of(store);
+            switch (mode) {
+                case SetMode::XX: return Internal::updateValue(rapid, key, std::move(value), hash);
+                case SetMode::Always: return Internal::upsertValue(rapid, key, std::move(value), hash);
+                default: return Internal::setValue(rapid, key, std::move(value), hash);
+            }
+        }
+
+        Internal::RapidWrite write(Store& store, const std::string_view key, RapidDataType&& value, const std::chrono::milliseconds ttl, const SetMode mode, const std::size_t hash = 0) {
+            Internal::RapidStore& rapid = Internal::StoreAccess::of(store);
+            switch (mode) {
+                case SetMode::XX: return Internal::updateValue(rapid, key, std::move(value), ttl, hash);
+                case SetMode::Always: return Internal::upsertValue(rapid, key, std::move(value), ttl, hash);
+                default: return Internal::setValue(rapid, key, std::move(value), ttl, hash);
+            }
+        }
+
+        /// Batched `write()`, one lock per shard, on up to `threads` threads.
+        void writeAll(Store& store, const std::span<RapidNode> nodes, const SetMode mode, const std::span<Internal::RapidWrite> written, const std::size_t threads = 1) {
+            Internal::RapidStore& rapid = Internal::StoreAccess::of(store);
+            switch (mode) {
+                case SetMode::XX: return Internal::updateValues(rapid, nodes, written, threads);
+                case SetMode::Always: return Internal::upsertValues(rapid, nodes, written, threads);
+                default: return Internal::setValues(rapid, nodes, written, threads);
+            }
+        }
+
+    } // namespace
+
+
     // SET
 
-    Response::Status SET (std::string key, RapidDataType value) {
-        return Response::Status(Internal::setValue(std::move(key), std::move(value))
-            ? StatusCode::OK
-            : StatusCode::ERR_KEY_ALREADY_EXISTS);
+    Response::Status SET (Store& store, std::string key, RapidDataType value, const SetMode mode) {
+        return Response::Status(write(store, key, std::move(value), mode).code());
         // this is why I added an explicit constructor in RapidResponse class.
         // and no, I am not making it pretty with if-else
     }
 
+    Response::Status SET (Store& store, const RapidKey& key, RapidDataType value, const SetMode mode) {
+        return Response::Status(write(store, key.key(), std::move(value), mode, key.hash()).code());
+    }
+
+    Response::Status SET (Store& store, std::string key, RapidDataType value, const std::chrono::milliseconds ttl, const SetMode mode) {
+        if (ttl.count() <= 0) return Response::Status(StatusCode::ERR_INVALID_ARGUMENT);
+        return Response::Status(write(store, key, std::move(value), ttl, mode).code());
+    }
+
+    Response::Status SET (Store& store, const RapidKey& key, RapidDataType value, const std::chrono::milliseconds ttl, const SetMode mode) {
+        if (ttl.count() <= 0) return Response::Status(StatusCode::ERR_INVALID_ARGUMENT);
+        return Response::Status(write(store, key.key(), std::move(value), ttl, mode, key.hash()).code());
+    }
+
     // I swear I don't normally code like the following normally
     // blame clang-tidy
 
-    Response::Status SET (std::span<RapidNode> nodes) {
+    Response::Status SET (Store& store, std::span<RapidNode> nodes, const SetMode mode) {
         Response::Status response;
 
         // I am so sorry.
@@ -25,54 +73,69 @@ namespace RiRi::Commands {
             return response;
         }
         if (nodes.size() == 1) {
-            if (!Internal::setValue(std::move(nodes[0].key),std::move(nodes[0].value))) {
-                // if insertion failed
-                response.setCode(StatusCode::ERR_KEY_ALREADY_EXISTS);
-                return response;
-            }
-            response.setCode(StatusCode::OK);
+            response.setCode(write(store, nodes[0].key, std::move(nodes[0].value), mode, nodes[0].hash).code());
             return response;
         }
 
         response.setCode(StatusCode::OK);   // set default code
-        for (auto&[key, value]: nodes) {
-            if (!Internal::setValue(std::move(key),std::move(value))) {
+        const auto inserted = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        writeAll(store, nodes, mode, {inserted.get(), nodes.size()});     // one lock per shard, not per node
+        bool warned = false;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            warned |= inserted[i].code() == StatusCode::WARN_KEY_STORE_NEARING_CAPACITY;
+            if (!inserted[i]) {
                 // if insertion failed
                 response.setCode(StatusCode::ERR_SOME_OPERATIONS_FAILED);
             }
         }
+        if (warned && response.errorCount() == 0) response.setCode(StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
         return response;
     }
 
-    Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched) {
+    Response::StatusErrorBatchWith<std::string_view> SET (Store& store, std::span<RapidNode> nodes, enableErrorBatched, const SetMode mode) {
+        return SET(store, nodes, enableErrorBatched{}, enableParallel{1}, mode);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> SET (Store& store, std::span<RapidNode> nodes, enableErrorBatched, const enableParallel parallel, const SetMode mode) {
         // the default code is OK (internal implementation)
         Response::StatusErrorBatchWith<std::string_view> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }     // exit early if nodes are empty
-        for (auto& [key, value]: nodes) {
-            if (!Internal::setValue(std::move(key),std::move(value))) {
+        const auto inserted = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        writeAll(store, nodes, mode, {inserted.get(), nodes.size()}, parallel.threads);
+        bool warned = false;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            warned |= inserted[i].code() == StatusCode::WARN_KEY_STORE_NEARING_CAPACITY;
+            if (!inserted[i]) {
                 // if insertion failed
 
                 // try_emplace allows me to do this directly if things go wrong, heh
-                response.addErrorEntry(key, StatusCode::ERR_KEY_ALREADY_EXISTS);
+                response.addErrorEntry(nodes[i].key, inserted[i].code());
             }
         }
+        if (warned && response.ok()) response.setCode(StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);     // not an error, so no entry
         return response;
     }
 
-    Response::StatusBatchWith<std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched) {
+    Response::StatusBatchWith<std::string_view, std::monostate> SET (Store& store, std::span<RapidNode> nodes, enableBatched, const SetMode mode) {
+        return SET(store, nodes, enableBatched{}, enableParallel{1}, mode);
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> SET (Store& store, std::span<RapidNode> nodes, enableBatched, const enableParallel parallel, const SetMode mode) {
         Response::StatusBatchWith<std::string_view, std::monostate> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }
         response.setCode(StatusCode::OK);   // set default overall code
-        for (auto& [key, value]: nodes) {
-            if (!Internal::setValue(std::move(key),std::move(value))) {
-                // if insertion failed
-                response.addStatusEntry(key, StatusCode::ERR_KEY_ALREADY_EXISTS);
+        const auto inserted = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        writeAll(store, nodes, mode, {inserted.get(), nodes.size()}, parallel.threads);
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (inserted[i].code() != StatusCode::OK) {
+                // if insertion failed, or went through with a warning
+                response.addStatusEntry(nodes[i].key, inserted[i].code());
             }
             // we don't need to track success cases, so no need to call `addResultEntry()`
             // though the compiler won't let me do that anyway; the function is constrained
@@ -82,4 +145,43 @@ namespace RiRi::Commands {
         return response;
     }
 
+
+    // Default store
+
+    Response::Status SET (const RapidKey& key, RapidDataType value, const SetMode mode) {
+        return SET(Store::defaultStore(), key, std::move(value), mode);
+    }
+
+    Response::Status SET (std::string key, RapidDataType value, const SetMode mode) {
+        return SET(Store::defaultStore(), std::move(key), std::move(value), mode);
+    }
+
+    Response::Status SET (std::string key, RapidDataType value, const std::chrono::milliseconds ttl, const SetMode mode) {
+        return SET(Store::defaultStore(), std::move(key), std::move(value), ttl, mode);
+    }
+
+    Response::Status SET (const RapidKey& key, RapidDataType value, const std::chrono::milliseconds ttl, const SetMode mode) {
+        return SET(Store::defaultStore(), key, std::move(value), ttl, mode);
+    }
+
+    Response::Status SET (std::span<RapidNode> nodes, const SetMode mode) {
+        return SET(Store::defaultStore(), nodes, mode);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched, const SetMode mode) {
+        return SET(Store::defaultStore(), nodes, enableErrorBatched{}, mode);
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched, const SetMode mode) {
+        return SET(Store::defaultStore(), nodes, enableBatched{}, mode);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> SET (std::span<RapidNode> nodes, enableErrorBatched, const enableParallel parallel, const SetMode mode) {
+        return SET(Store::defaultStore(), nodes, enableErrorBatched{}, parallel, mode);
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> SET (std::span<RapidNode> nodes, enableBatched, const enableParallel parallel, const SetMode mode) {
+        return SET(Store::defaultStore(), nodes, enableBatched{}, parallel, mode);
+    }
+
 } // namespace RiRi::Commands
@@ -0,0 +1,72 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+#include <memory>
+
+namespace RiRi::Commands {
+
+    // UNLINK
+
+    Response::Status UNLINK (Store& store, const std::string_view key) {
+        return Response::Status(Internal::unlinkKey(Internal::StoreAccess::of(store), key)
+            ? StatusCode::OK
+            : StatusCode::ERR_KEY_NOT_FOUND);
+    }
+
+    Response::Status UNLINK (Store& store, const RapidKey& key) {
+        return Response::Status(Internal::unlinkKey(Internal::StoreAccess::of(store), key.key(), key.hash())
+            ? StatusCode::OK
+            : StatusCode::ERR_KEY_NOT_FOUND);
+    }
+
+    Response::Status UNLINK (Store& store, std::span<RapidNode> nodes) {
+        Response::Status response;
+        if (nodes.empty()) {
+            response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+            return response;
+        }
+
+        response.setCode(StatusCode::OK);   // set default code
+        const auto unlinked = std::make_unique_for_overwrite<bool[]>(nodes.size());
+        Internal::unlinkKeys(Internal::StoreAccess::of(store), nodes, {unlinked.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!unlinked[i]) response.setCode(StatusCode::ERR_SOME_OPERATIONS_FAILED);
+        }
+        return response;
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> UNLINK (Store& store, std::span<RapidNode> nodes, enableErrorBatched) {
+        // the default code is OK (internal implementation)
+        Response::StatusErrorBatchWith<std::string_view> response;
+        if (nodes.empty()) {
+            response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
+            return response;
+        }
+        const auto unlinked = std::make_unique_for_overwrite<bool[]>(nodes.size());
+        Internal::unlinkKeys(Internal::StoreAccess::of(store), nodes, {unlinked.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!unlinked[i]) response.addErrorEntry(nodes[i].key, StatusCode::ERR_KEY_NOT_FOUND);
+        }
+        return response;
+    }
+
+
+    // Default store
+
+    Response::Status UNLINK (const std::string_view key) {
+        return UNLINK(Store::defaultStore(), key);
+    }
+
+    Response::Status UNLINK (const RapidKey& key) {
+        return UNLINK(Store::defaultStore(), key);
+    }
+
+    Response::Status UNLINK (std::span<RapidNode> nodes) {
+        return UNLINK(Store::defaultStore(), nodes);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> UNLINK (std::span<RapidNode> nodes, enableErrorBatched) {
+        return UNLINK(Store::defaultStore(), nodes, enableErrorBatched{});
+    }
+
+} // namespace RiRi::Commands
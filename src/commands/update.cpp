@@ -1,17 +1,21 @@
 #include "riri/Commands.hpp"
 #include "DataManager.h"
 
+#include <memory>
+
 namespace RiRi::Commands {
 
     // UPDATE
 
-    Response::Status UPDATE (std::string_view key, RapidDataType value) {
-        return Response::Status(Internal::updateValue(key, std::move(value))
-            ? StatusCode::OK
-            : StatusCode::ERR_KEY_NOT_FOUND);
+    Response::Status UPDATE (Store& store, std::string_view key, RapidDataType value) {
+        return Response::Status(Internal::updateValue(Internal::StoreAccess::of(store), key, std::move(value)).code());
     }
 
-    Response::Status UPDATE (std::span<RapidNode> nodes) {
+    Response::Status UPDATE (Store& store, const RapidKey& key, RapidDataType value) {
+        return Response::Status(Internal::updateValue(Internal::StoreAccess::of(store), key.key(), std::move(value), key.hash()).code());
+    }
+
+    Response::Status UPDATE (Store& store, std::span<RapidNode> nodes) {
         Response::Status response;
 
         // I am so sorry.
@@ -20,53 +24,60 @@ namespace RiRi::Commands {
             return response;
         }
         if (nodes.size() == 1) {
-            if (!Internal::updateValue(nodes[0].key, std::move(nodes[0].value))) {
-                // if update failed
-                response.setCode(StatusCode::ERR_KEY_NOT_FOUND);
-                return response;
-            }
-            response.setCode(StatusCode::OK);
+            response.setCode(Internal::updateValue(Internal::StoreAccess::of(store), nodes[0].key, std::move(nodes[0].value), nodes[0].hash).code());
             return response;
         }
 
         response.setCode(StatusCode::OK);   // set default code
-        for (auto& [key, value]: nodes) {
-            if (!Internal::updateValue(key, std::move(value))) {
+        const auto updated = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        Internal::updateValues(Internal::StoreAccess::of(store), nodes, {updated.get(), nodes.size()});   // one lock per shard, not per node
+        bool warned = false;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            warned |= updated[i].code() == StatusCode::WARN_KEY_STORE_NEARING_CAPACITY;
+            if (!updated[i]) {
                 // if update failed
                 response.setCode(StatusCode::ERR_SOME_OPERATIONS_FAILED);
             }
         }
+        if (warned && response.errorCount() == 0) response.setCode(StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
         return response;
     }
 
-    Response::StatusErrorBatchWith<std::string_view> UPDATE (std::span<RapidNode> nodes, enableErrorBatched) {
+    Response::StatusErrorBatchWith<std::string_view> UPDATE (Store& store, std::span<RapidNode> nodes, enableErrorBatched) {
         // the default code is OK (internal implementation)
         Response::StatusErrorBatchWith<std::string_view> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         } // exit early if empty
-        for (auto& [key, value]: nodes) {
-            if (!Internal::updateValue(key, std::move(value))) {
+        const auto updated = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        Internal::updateValues(Internal::StoreAccess::of(store), nodes, {updated.get(), nodes.size()});
+        bool warned = false;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            warned |= updated[i].code() == StatusCode::WARN_KEY_STORE_NEARING_CAPACITY;
+            if (!updated[i]) {
                 // if update failed
-                response.addErrorEntry(key, StatusCode::ERR_KEY_NOT_FOUND);
+                response.addErrorEntry(nodes[i].key, updated[i].code());
                 // we never move or get rid of the provided key, so we just use it
             }
         }
+        if (warned && response.ok()) response.setCode(StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);     // not an error, so no entry
         return response;
     }
 
-    Response::StatusBatchWith<std::string_view, std::monostate> UPDATE (std::span<RapidNode> nodes, enableBatched) {
+    Response::StatusBatchWith<std::string_view, std::monostate> UPDATE (Store& store, std::span<RapidNode> nodes, enableBatched) {
         Response::StatusBatchWith<std::string_view, std::monostate> response;
         if (nodes.empty()) {
             response.setCode(StatusCode::WARN_ZERO_NODES_PROVIDED);
             return response;
         }
         response.setCode(StatusCode::OK);   // set default overall code
-        for (auto& [key, value]: nodes) {
-            if (!Internal::updateValue(key, std::move(value))) {
-                // if update failed
-                response.addStatusEntry(key, StatusCode::ERR_KEY_NOT_FOUND);
+        const auto updated = std::make_unique_for_overwrite<Internal::RapidWrite[]>(nodes.size());
+        Internal::updateValues(Internal::StoreAccess::of(store), nodes, {updated.get(), nodes.size()});
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (updated[i].code() != StatusCode::OK) {
+                // if update failed, or went through with a warning
+                response.addStatusEntry(nodes[i].key, updated[i].code());
             }
             // we don't need to track success cases, so no need to call `addResultEntry()`
             // though the compiler won't let me do that anyway; the function is constrained
@@ -76,4 +87,27 @@ namespace RiRi::Commands {
         return response;
     }
 
-} // namespace RiRi::Commands
\ No newline at end of file
+
+    // Default store
+
+    Response::Status UPDATE (const RapidKey& key, RapidDataType value) {
+        return UPDATE(Store::defaultStore(), key, std::move(value));
+    }
+
+    Response::Status UPDATE (std::string_view key, RapidDataType value) {
+        return UPDATE(Store::defaultStore(), key, std::move(value));
+    }
+
+    Response::Status UPDATE (std::span<RapidNode> nodes) {
+        return UPDATE(Store::defaultStore(), nodes);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> UPDATE (std::span<RapidNode> nodes, enableErrorBatched) {
+        return UPDATE(Store::defaultStore(), nodes, enableErrorBatched{});
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> UPDATE (std::span<RapidNode> nodes, enableBatched) {
+        return UPDATE(Store::defaultStore(), nodes, enableBatched{});
+    }
+
+} // namespace RiRi::Commands
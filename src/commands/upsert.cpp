@@ -0,0 +1,62 @@
+#include "riri/Commands.hpp"
+#include "DataManager.h"
+
+namespace RiRi::Commands {
+
+    // UPSERT
+
+    Response::Status UPSERT (Store& store, const std::string_view key, RapidDataType value) {
+        return Response::Status(Internal::upsertValue(Internal::StoreAccess::of(store), key, std::move(value)).code());
+    }
+
+    Response::Status UPSERT (Store& store, const RapidKey& key, RapidDataType value) {
+        return Response::Status(Internal::upsertValue(Internal::StoreAccess::of(store), key.key(), std::move(value), key.hash()).code());
+    }
+
+    Response::Status UPSERT (Store& store, const std::string_view key, RapidDataType value, const std::chrono::milliseconds ttl) {
+        if (ttl.count() <= 0) return Response::Status(StatusCode::ERR_INVALID_ARGUMENT);
+        return Response::Status(Internal::upsertValue(Internal::StoreAccess::of(store), key, std::move(value), ttl).code());
+    }
+
+    // the batches are SET's, reporting included
+
+    Response::Status UPSERT (Store& store, std::span<RapidNode> nodes) {
+        return SET(store, nodes, SetMode::Always);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> UPSERT (Store& store, std::span<RapidNode> nodes, enableErrorBatched) {
+        return SET(store, nodes, enableErrorBatched{}, SetMode::Always);
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> UPSERT (Store& store, std::span<RapidNode> nodes, enableBatched) {
+        return SET(store, nodes, enableBatched{}, SetMode::Always);
+    }
+
+
+    // Default store
+
+    Response::Status UPSERT (const std::string_view key, RapidDataType value) {
+        return UPSERT(Store::defaultStore(), key, std::move(value));
+    }
+
+    Response::Status UPSERT (const RapidKey& key, RapidDataType value) {
+        return UPSERT(Store::defaultStore(), key, std::move(value));
+    }
+
+    Response::Status UPSERT (const std::string_view key, RapidDataType value, const std::chrono::milliseconds ttl) {
+        return UPSERT(Store::defaultStore(), key, std::move(value), ttl);
+    }
+
+    Response::Status UPSERT (std::span<RapidNode> nodes) {
+        return UPSERT(Store::defaultStore(), nodes);
+    }
+
+    Response::StatusErrorBatchWith<std::string_view> UPSERT (std::span<RapidNode> nodes, enableErrorBatched) {
+        return UPSERT(Store::defaultStore(), nodes, enableErrorBatched{});
+    }
+
+    Response::StatusBatchWith<std::string_view, std::monostate> UPSERT (std::span<RapidNode> nodes, enableBatched) {
+        return UPSERT(Store::defaultStore(), nodes, enableBatched{});
+    }
+
+} // namespace RiRi::Commands
@@ -1,55 +1,1751 @@
 #include "DataManager.h"
+#include "Eviction.h"
+#include "LazyFree.h"
 #include "MemoryMaps.h"
+#include "Reclaimer.h"
+#include "WorkPool.h"
+#include "riri/ReadGuard.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
 
 
 namespace RiRi::Internal {
 
+    namespace {
+
+        /// Keys a write expires on its way through a shard, at most; the rest wait for the next one.
+        constexpr std::size_t EXPIRE_STEP = 16;
+
+        /// Keys `expireKeys()` expires per shard lock it takes.
+        constexpr std::size_t SWEEP_STEP = 1024;
+
+        /// Keys a batch lookup prefetches ahead of finding them: enough misses in flight to keep the
+        /// memory system busy, few enough that the first ones are still cached by the time they're found.
+        constexpr std::size_t PREFETCH_GROUP = 16;
+
+        /// Batches below this many nodes stay on the calling thread, even when asked to go parallel.
+        constexpr std::size_t PARALLEL_MIN_NODES = 4096;
+
+        /// Nodes per work pool task, for batches that aren't split by shard (lock-free reads).
+        constexpr std::size_t PARALLEL_CHUNK = 4096;
+
+        /// Slabs (and large blocks) the background freer gives back per step of a cleared shard: 16 MiB or so.
+        constexpr std::size_t FREE_STEP_BLOCKS = 256;
+
+        /// Entries a write moves along a running compaction (`StoreOptions::compactBelow`), like `REHASH_STEP`.
+        constexpr std::size_t COMPACT_WRITE_STEP = 8;
+
+        /// Entries `compactStore()` moves per shard lock it takes.
+        constexpr std::size_t COMPACT_STEP = 1024;
+
+        /// How empty a table has to be for COMPACT to shrink it: under a quarter of what it holds.
+        constexpr float COMPACT_LOW_WATER = 0.25f;
+
+        /// Slab bytes of a stored value, `0` if it fits in its cell.
+        [[nodiscard]] std::size_t slabBytes(const RapidCell& value) noexcept {
+            return value.inSlab() ? value.asSlabString().size : 0;
+        }
+
+        /// Slab bytes `value` is going to take once stored.
+        [[nodiscard]] std::size_t slabBytes(const RapidDataType& value) noexcept {
+            const auto* str = std::get_if<std::string>(&value);
+            return str != nullptr && str->size() > RapidCell::INLINE_CAPACITY ? str->size() : 0;
+        }
+
+        /// Whether an entry's TTL ran out. Reads the clock only for entries that have one.
+        [[nodiscard]] bool expired(const RapidShard& shard, const RapidSlabString key, const RapidCell& value) noexcept {
+            return value.expires() && shard.expiry->deadline(key) <= expiryNow();
+        }
+
+        /// An entry's deadline, `0` if it has no TTL.
+        [[nodiscard]] std::int64_t deadlineOf(const RapidShard& shard, const RapidSlabString key, const RapidCell& value) noexcept {
+            return value.expires() ? shard.expiry->deadline(key) : 0;
+        }
+
+        /// The `expiryNow()` deadline `ttl` from now; absurdly long TTLs are cut to a mere hundred million years.
+        [[nodiscard]] std::int64_t deadlineIn(const std::chrono::milliseconds ttl) noexcept {
+            constexpr std::int64_t LONGEST = std::int64_t{1} << 62;
+            return expiryNow() + std::min<std::int64_t>(ttl.count(), LONGEST);
+        }
+
+        /**
+         * @brief Takes an entry out of the shard, slab bytes, indexes, TTL and all. Shard lock held.
+         *
+         * `lazy` (UNLINK) leaves freeing a value of `LAZY_FREE_MIN_BYTES` or more, and its copy for
+         * lock-free readers, to the background freer; the shard stops counting it right away.
+         */
+        void eraseEntry(RapidShard& shard, const RapidTable::iterator it, const std::size_t hash, bool lazy = false) noexcept {
+            lazy = lazy && slabBytes(it->second) >= LAZY_FREE_MIN_BYTES;
+            if (shard.reads) shard.reads->erase(it->first.view(), hash, lazy);
+            if (shard.values) shard.values->remove(it->second, it->first);
+            if (shard.ordered) shard.ordered->erase(it->first.view());
+            if (it->second.expires()) shard.expiry->remove(it->first);
+            // the map hashes the key to find its bucket, so the bytes go back to the slab only after
+            const auto [key, value] = *it;
+            shard.keyBytes -= key.size;
+            shard.valueBytes -= slabBytes(value);
+            shard.map.erase(it);
+            slabFree(shard.slab, key);
+            if (!lazy) {
+                freeValue(shard.slab, value);
+                return;
+            }
+            const RapidSlabString bytes = value.asSlabString();
+            lazyFree(shard.slab.detach(const_cast<char*>(bytes.data), bytes.size), [](void* block) noexcept {
+                RapidSlab::freeDetached(block);
+                return true;
+            });
+        }
+
+        /// What a CLEAR swapped out of a shard, for the background freer.
+        struct ClearedShard {
+            RapidTable map;
+            RapidSlab slab;
+            std::unique_ptr<RapidValueIndex> values;
+            std::unique_ptr<RapidOrderedIndex> ordered;
+            std::unique_ptr<RapidExpiry> expiry;
+        };
+
+        /// The slabs a few at a time (that's most of it), then the table and the indexes in one go.
+        bool freeClearedShard(void* garbage) noexcept {
+            auto* cleared = static_cast<ClearedShard*>(garbage);
+            if (!cleared->slab.releaseStep(FREE_STEP_BLOCKS)) return false;
+            delete cleared;
+            return true;
+        }
+
+        /// Gives an entry's (new) value the shard's next version; before it's published. Shard lock held.
+        void newVersion(RapidShard& shard, const RapidTable::iterator it) noexcept {
+            it->first.version = ++shard.version;
+        }
+
+        /// Takes an entry's value out (slab bytes, reverse index), so it can get a new one. Shard lock held.
+        void dropValue(RapidShard& shard, const RapidTable::iterator it) noexcept {
+            if (shard.values) shard.values->remove(it->second, it->first);
+            shard.valueBytes -= slabBytes(it->second);
+            freeValue(shard.slab, it->second);
+        }
+
+        /// Gives an entry a TTL, or a new one; readers find out through `storeEntry()` or `redate()`. Shard lock held.
+        void setDeadline(RapidShard& shard, const RapidTable::iterator it, const std::size_t hash, const std::int64_t at) noexcept {
+            if (!shard.expiry) shard.expiry = std::make_unique<RapidExpiry>(expiryNow());
+            shard.expiry->set(it->first, hash, at);
+            it->second.setExpires(true);
+        }
+
+        /**
+         * @brief Gives an entry its value (and its deadline, `at`, unless `0`), and tells the indexes. Shard lock held.
+         *
+         * The value goes into the slab, the lock-free readers' copy of it is made and the reverse index
+         * learns of it before anything else happens, so an entry whose new value there is no memory for
+         * stays just as it was. `replace` drops the value it had, once the new one is in.
+         * @return `false` if out of memory
+         */
+        [[nodiscard]] bool storeEntry(RapidShard& shard, const RapidTable::iterator it, const std::size_t hash, RapidDataType&& value,
+                                      const std::int64_t at, const bool replace) noexcept {
+            RapidCell cell;
+            if (!storeValue(shard.slab, value, cell)) return false;
+            std::unique_ptr<RapidReadEntry> published;
+            if (shard.reads && !(published = shard.reads->prepare(it->first.view(), hash, std::move(value)))) {
+                freeValue(shard.slab, cell);
+                return false;
+            }
+            // the reverse index trades values before the entry does; out of memory, the old one goes back in
+            if (shard.values) {
+                if (replace) shard.values->remove(it->second, it->first);
+                if (!shard.values->add(cell, {it->first, hash})) {
+                    if (replace) (void)shard.values->add(it->second, {it->first, hash});
+                    freeValue(shard.slab, cell);
+                    return false;
+                }
+            }
+            if (replace) {
+                shard.valueBytes -= slabBytes(it->second);
+                freeValue(shard.slab, it->second);
+            }
+            if (at != 0) setDeadline(shard, it, hash, at);     // first, so the readers get value and TTL at once
+            cell.setExpires(it->second.expires());      // the TTL belongs to the key, it outlives the value
+            it->second = cell;
+            newVersion(shard, it);
+            shard.valueBytes += slabBytes(it->second);
+            if (shard.reads) shard.reads->publish(std::move(published), deadlineOf(shard, it->first, it->second), it->first.version);
+            return true;
+        }
+
+        /// Takes an entry's TTL away, if it has one. Shard lock held.
+        void clearDeadline(RapidShard& shard, const RapidTable::iterator it) noexcept {
+            if (!it->second.expires()) return;
+            shard.expiry->remove(it->first);
+            it->second.setExpires(false);
+        }
+
+        /// Tells lock-free readers an entry's TTL changed; same value, so the published entry just gets the new deadline. Shard lock held.
+        void redate(RapidShard& shard, const RapidTable::iterator it, const std::size_t hash) noexcept {
+            if (shard.reads) shard.reads->expire(it->first.view(), hash, deadlineOf(shard, it->first, it->second));
+        }
+
+        /// Expires up to `budget` of the shard's keys whose TTL ran out. Shard lock held.
+        std::size_t expireDue(RapidShard& shard, const std::size_t budget) noexcept {
+            if (!shard.expiry) return 0;    // never had a TTL, never reads the clock
+            return shard.expiry->expireDue(expiryNow(), budget, [&shard](const RapidSlabString key, const std::size_t hash) {
+                const auto it = shard.map.findForWrite(RapidHashedKey{key.view(), hash});
+                RIRI_ASSERT(it != shard.map.end());
+                eraseEntry(shard, it, hash);
+            });
+        }
+
+        /**
+         * @brief Moves an entry's key and value out of retiring slabs, if they're in one. Shard lock held.
+         *
+         * Same bytes, same hash, same entry; only the indexes that point at the key's bytes (value,
+         * ordered, expiry) have to follow it. Lock-free readers have copies of their own.
+         * @return `false` if the slab is out of memory; whatever didn't move yet is still where it was
+         */
+        bool moveEntry(RapidShard& shard, const RapidTable::iterator it) noexcept {
+            RapidSlab& slab = shard.slab;
+            if (it->second.inSlab() && slab.retiring(it->second.asSlabString().data)) {
+                const RapidSlabString old = it->second.asSlabString();
+                RapidSlabString copy;
+                if (!slabCopy(slab, old.view(), copy)) return false;
+                const bool expires = it->second.expires();
+                it->second = RapidCell::ofSlab(copy);
+                it->second.setExpires(expires);
+                slabFree(slab, old);
+            }
+
+            const RapidSlabString old = it->first;
+            if (!slab.retiring(old.data)) return true;
+            RapidSlabString moved;
+            if (!slabCopy(slab, old.view(), moved)) return false;
+            moved.stamp = old.stamp;
+            moved.version = old.version;
+            const std::size_t hash = shard.values || it->second.expires() ? RapidHash{}(old) : 0;
+            if (shard.values) {
+                shard.values->remove(it->second, old);
+                if (!shard.values->add(it->second, {moved, hash})) {
+                    (void)shard.values->add(it->second, {old, hash});
+                    slabFree(slab, moved);
+                    return false;
+                }
+            }
+            if (shard.ordered) shard.ordered->rekey(moved);
+            if (it->second.expires()) {
+                const std::int64_t at = shard.expiry->deadline(old);
+                shard.expiry->remove(old);
+                shard.expiry->set(moved, hash, at);
+            }
+            it->first = moved;
+            slabFree(slab, old);
+            return true;
+        }
+
+        /**
+         * @brief Starts what's worth doing of a compaction: shrinking a table under `lowWater`, moving
+         * the strings out of slabs that are a quarter idle (or more). Shard lock held.
+         * @return `false` if neither was
+         */
+        bool startCompaction(RapidShard& shard, const float lowWater) noexcept {
+            const bool shrink = shard.map.sparse(lowWater);
+            if (shrink) shard.map.startShrink();
+
+            const std::size_t idle = shard.slab.idleBytes();
+            if (shard.slab.compacting() || idle < 2 * RapidSlab::SLAB_SIZE || idle * 4 < shard.slab.reservedBytes()) return shrink;
+            shard.slab.retire();
+            shard.compactCursor = SIZE_MAX;
+            shard.compactRehashes = shard.map.rehashes();
+            return true;
+        }
+
+        /**
+         * @brief Moves a running compaction `budget` entries along: the shrink first, then the strings,
+         * from the back of the table, like a scan. Shard lock held.
+         * @return `true` once it's done, or stuck for want of memory (still running then, later writes
+         * move it along); `reclaimed` grows by the slab bytes it freed
+         */
+        bool compactStep(RapidShard& shard, const std::size_t budget, std::size_t& reclaimed) noexcept {
+            if (shard.map.rehashing() && !shard.map.drain(budget)) return false;
+            if (!shard.slab.compacting()) return true;
 
-    bool setValue(std::string&& key, RapidDataType&& value) noexcept {
-        return MemoryMap.try_emplace(std::move(key), std::move(value)).second;
+            // a rehash (growing, or the shrink that just finished) shuffled every entry, start over
+            if (shard.compactRehashes != shard.map.rehashes()) {
+                shard.compactRehashes = shard.map.rehashes();
+                shard.compactCursor = SIZE_MAX;
+            }
+            // erasing moves the last entry into the hole, new entries are in the new slabs already:
+            // walking down from the back never misses one that's still in a retiring slab
+            std::size_t& cursor = shard.compactCursor;
+            cursor = std::min(cursor, shard.map.size());
+            for (std::size_t moved = 0; cursor > 0 && moved < budget; ++moved) {
+                // out of memory: the retiring slabs stay until a later step gets this entry out of them
+                if (!moveEntry(shard, shard.map.entryAt(cursor - 1))) return true;
+                --cursor;
+            }
+            if (cursor > 0) return false;
+            reclaimed += shard.slab.releaseRetired();
+            return true;
+        }
+
+        /// What every write does on its way through a shard: expire a few keys, move a compaction along
+        /// (a shrink moves along with every write anyway, like any rehash). Shard lock held.
+        void tidyUp(RapidShard& shard) noexcept {
+            expireDue(shard, EXPIRE_STEP);
+            std::size_t reclaimed = 0;      // no one to report it to, it shows in MEMORY_USAGE
+            if (shard.slab.compacting()) {
+                (void)compactStep(shard, COMPACT_WRITE_STEP, reclaimed);
+            } else if (shard.compactBelow > 0.0f && shard.map.sparse(shard.compactBelow)) {
+                (void)startCompaction(shard, shard.compactBelow);
+            }
+        }
+
+        /// `map.findForWrite()`, except that a key whose TTL ran out is erased on the spot and reported missing.
+        RapidTable::iterator findLive(RapidShard& shard, const std::string_view key, const std::size_t hash) noexcept {
+            const auto it = shard.map.findForWrite(RapidHashedKey{key, hash});
+            if (it == shard.map.end() || !expired(shard, it->first, it->second)) return it;
+            eraseEntry(shard, it, hash);
+            return shard.map.end();
+        }
+
+        /// Takes a just inserted entry back out, there was no memory for its value, or for indexing it. Shard lock held.
+        void abandonEntry(RapidShard& shard, const RapidTable::iterator it, const std::size_t hash) noexcept {
+            it->second = RapidCell();       // it never got one; a reused expired entry's is gone already
+            eraseEntry(shard, it, hash);
+        }
+
+        /// `map.insert()`, except that a key whose TTL ran out counts as missing: its entry is emptied and reused.
+        /// Out of memory, for the key or for indexing it, `{map.end(), false}`.
+        std::pair<RapidTable::iterator, bool> insertLive(RapidShard& shard, const std::string_view key, const std::size_t hash) noexcept {
+            const auto [it, inserted] = shard.map.insert(RapidSlabKey{key, hash, shard.slab});
+            if (inserted) {
+                shard.keyBytes += key.size();
+                if (shard.ordered && !shard.ordered->insert(it->first)) {
+                    abandonEntry(shard, it, hash);
+                    return {shard.map.end(), false};
+                }
+            }
+            if (inserted || !expired(shard, it->first, it->second)) return {it, inserted};
+            dropValue(shard, it);
+            clearDeadline(shard, it);
+            return {it, true};
+        }
+
+        /// Whether `bytes` more still fit in the shard's share of the memory budget.
+        [[nodiscard]] bool fits(const RapidStore& store, const RapidShard& shard, const std::size_t bytes) noexcept {
+            return store.shardBudget() == 0 || shard.used() + bytes <= store.shardBudget();
+        }
+
+        /// Stamps a use of an entry, for eviction. Shard lock held, unique.
+        void touch(const RapidStore& store, const RapidTable::iterator it, const bool fresh) noexcept {
+            if (store.tracksUses()) it->first.stamp = touchedStamp(store.options().eviction, it->first.stamp, fresh);
+        }
+
+        /// Stamps a use of an entry by a reader; other readers may be at it too, one of them wins. Shard lock held, shared.
+        void touch(const RapidStore& store, const RapidSlabString& key) noexcept {
+            if (!store.tracksUses()) return;
+            const std::atomic_ref stamp(key.stamp);
+            stamp.store(touchedStamp(store.options().eviction, stamp.load(std::memory_order_relaxed), false), std::memory_order_relaxed);
+        }
+
+        /// Stamps a use of a published entry by a lock-free reader, like the map's key above. Pinned, no lock.
+        void touch(const RapidStore& store, const RapidReadEntry& entry) noexcept {
+            if (!store.tracksUses()) return;
+            const std::atomic_ref stamp(entry.stamp);
+            stamp.store(touchedStamp(store.options().eviction, stamp.load(std::memory_order_relaxed), false), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief How badly an entry wants to be evicted. Shard lock held, unique.
+         *
+         * Lock-free readers never see the map, they stamp the entry published for them; whichever of
+         * the two stamps saw the latest (or most) use counts.
+         */
+        [[nodiscard]] std::uint32_t usedScore(const RapidStore& store, const RapidShard& shard, const RapidSlabString& key) noexcept {
+            const std::uint32_t score = evictionScore(store.options().eviction, key.stamp);
+            if (!shard.reads) return score;
+            const RapidReadEntry* published = shard.reads->findEntry(key.view(), RapidHash{}(key));
+            if (published == nullptr) return score;
+            const std::uint32_t read = std::atomic_ref(published->stamp).load(std::memory_order_relaxed);
+            return std::min(score, evictionScore(store.options().eviction, read));
+        }
+
+        /**
+         * @brief Evicts the worst of `EVICTION_SAMPLES` entries picked at random (an expired one, if it finds any). Shard lock held.
+         * @param keep A key that must stay, or `nullptr`
+         * @return `false` if there was nothing to evict
+         */
+        bool evictOne(const RapidStore& store, RapidShard& shard, const RapidSlabString* keep) noexcept {
+            const std::size_t count = shard.map.size();
+            const RapidTable::value_type* victim = nullptr;
+            std::uint32_t worst = 0;
+            for (int i = 0; i < EVICTION_SAMPLES && count != 0; ++i) {
+                std::size_t index = evictionRandom() % count;
+                if (keep && shard.map.at(index).first.data == keep->data) index = (index + 1) % count;
+                const auto& entry = shard.map.at(index);
+                if (keep && entry.first.data == keep->data) break;     // the only key there is
+
+                if (expired(shard, entry.first, entry.second)) {
+                    victim = &entry;
+                    break;
+                }
+                const std::uint32_t score = usedScore(store, shard, entry.first);
+                if (victim == nullptr || score > worst) {
+                    victim = &entry;
+                    worst = score;
+                }
+            }
+            if (victim == nullptr) return false;
+
+            const RapidSlabString key = victim->first;
+            const std::size_t hash = RapidHash{}(key);
+            eraseEntry(shard, shard.map.findForWrite(RapidHashedKey{key.view(), hash}), hash);
+            return true;
+        }
+
+        /// Makes `bytes` more fit in the shard, evicting if the store does that. Shard lock held.
+        [[nodiscard]] bool makeRoom(const RapidStore& store, RapidShard& shard, const std::size_t bytes, const RapidSlabString* keep) noexcept {
+            if (!store.tracksUses()) return fits(store, shard, bytes);
+            while (!fits(store, shard, bytes)) {
+                if (!evictOne(store, shard, keep)) return false;
+            }
+            return true;
+        }
+
+        /// What a write that went through reports: `OK`, or a warning if its shard is nearly full.
+        [[nodiscard]] RapidWrite written(const RapidStore& store, const RapidShard& shard) noexcept {
+            return shard.used() > store.shardWarning() ? StatusCode::WARN_KEY_STORE_NEARING_CAPACITY : StatusCode::OK;
+        }
+
+        /// Slab strings are at most 4 GiB: a longer key or string value is turned down (`ERR_VALUE_OUT_OF_RANGE`).
+        [[nodiscard]] bool tooLong(const std::string_view key, const RapidDataType& value) noexcept {
+            const auto* str = std::get_if<std::string>(&value);
+            return key.size() > UINT32_MAX || (str && str->size() > UINT32_MAX);
+        }
+
+        /// Gives a just inserted entry its value (and its deadline, `at`, unless `0`). Shard lock held.
+        RapidWrite createEntry(const RapidStore& store, RapidShard& shard, const RapidTable::iterator it, const std::size_t hash, RapidDataType&& value, const std::int64_t at) noexcept {
+            if (!storeEntry(shard, it, hash, std::move(value), at, false)) {
+                abandonEntry(shard, it, hash);
+                return StatusCode::ERR_OUT_OF_MEMORY;
+            }
+            touch(store, it, true);
+            return written(store, shard);
+        }
+
+        /// Everything a SET does once it holds the shard's lock; `at` is the key's deadline, `0` for none.
+        RapidWrite setEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash, RapidDataType&& value, const std::int64_t at) noexcept {
+            if (tooLong(key, value)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+            if (const std::size_t bytes = RapidShard::ENTRY_BYTES + key.size() + slabBytes(value); !fits(store, shard, bytes)) {
+                // a SET of an existing key fails anyway, don't evict anything for it
+                if (findLive(shard, key, hash) != shard.map.end()) return StatusCode::ERR_KEY_ALREADY_EXISTS;
+                if (!makeRoom(store, shard, bytes, nullptr)) return StatusCode::ERR_KEY_STORE_FULL;
+            }
+            const auto [it, inserted] = insertLive(shard, key, hash);
+            if (it == shard.map.end()) return StatusCode::ERR_OUT_OF_MEMORY;     // no room for the key's bytes
+            if (!inserted) return StatusCode::ERR_KEY_ALREADY_EXISTS;     // key already exists, the slab was never touched
+            return createEntry(store, shard, it, hash, std::move(value), at);
+        }
+
+        /**
+         * @brief Gives the live entry `it` (of `key`) a new value, once it holds the shard's lock.
+         * @param at The key's new deadline, `0` to keep the one it has (if any)
+         */
+        RapidWrite replaceEntry(const RapidStore& store, RapidShard& shard, RapidTable::iterator it, const std::string_view key, const std::size_t hash,
+                                RapidDataType&& value, const std::int64_t at) noexcept {
+            if (tooLong(key, value)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+            const std::size_t old_bytes = slabBytes(it->second);
+            const std::size_t new_bytes = slabBytes(value);
+            if (new_bytes > old_bytes && !fits(store, shard, new_bytes - old_bytes)) {
+                const RapidSlabString keep = it->first;
+                if (!makeRoom(store, shard, new_bytes - old_bytes, &keep)) return StatusCode::ERR_KEY_STORE_FULL;
+                it = shard.map.findForWrite(RapidHashedKey{key, hash});    // evicting shuffles the entries around
+            }
+            // the new value goes in before the old one goes out: out of memory, the entry keeps what it had
+            if (!storeEntry(shard, it, hash, std::move(value), at, true)) return StatusCode::ERR_OUT_OF_MEMORY;
+            touch(store, it, false);
+            return written(store, shard);
+        }
+
+        /// Everything an UPDATE does once it holds the shard's lock; `at` as for `replaceEntry()`.
+        RapidWrite updateEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash, RapidDataType&& value, const std::int64_t at) noexcept {
+            const auto it = findLive(shard, key, hash);
+            if (it == shard.map.end()) return StatusCode::ERR_KEY_NOT_FOUND;
+            return replaceEntry(store, shard, it, key, hash, std::move(value), at);
+        }
+
+        /// Everything an UPSERT does once it holds the shard's lock: one probe, then a SET or an UPDATE; `at` as for `replaceEntry()`.
+        RapidWrite upsertEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash, RapidDataType&& value, const std::int64_t at) noexcept {
+            if (tooLong(key, value)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+            if (const std::size_t bytes = RapidShard::ENTRY_BYTES + key.size() + slabBytes(value); !fits(store, shard, bytes)) {
+                // too much for a new key, maybe not for an existing one: only evict for what the write really needs
+                if (const auto it = findLive(shard, key, hash); it != shard.map.end()) return replaceEntry(store, shard, it, key, hash, std::move(value), at);
+                if (!makeRoom(store, shard, bytes, nullptr)) return StatusCode::ERR_KEY_STORE_FULL;
+            }
+            const auto [it, inserted] = insertLive(shard, key, hash);
+            if (it == shard.map.end()) return StatusCode::ERR_OUT_OF_MEMORY;
+            if (!inserted) return replaceEntry(store, shard, it, key, hash, std::move(value), at);
+            return createEntry(store, shard, it, hash, std::move(value), at);
+        }
+
+        /**
+         * @brief Everything a BULK_LOAD does for one node once it holds the shard's lock (and grew its table).
+         *
+         * A store without a memory budget skips all of a SET's checks: nothing to fit, nothing to
+         * evict, no uses to stamp, no warnings. With one it takes the SET or UPSERT path.
+         */
+        RapidWrite loadEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash, RapidDataType&& value, const DuplicatePolicy policy) noexcept {
+            if (store.shardBudget() != 0) {
+                if (policy == DuplicatePolicy::LastWins) return upsertEntry(store, shard, key, hash, std::move(value), 0);
+                const RapidWrite result = setEntry(store, shard, key, hash, std::move(value), 0);
+                if (policy == DuplicatePolicy::FirstWins && result.code() == StatusCode::ERR_KEY_ALREADY_EXISTS) return StatusCode::OK;
+                return result;
+            }
+            if (tooLong(key, value)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+            const auto [it, inserted] = insertLive(shard, key, hash);
+            if (it == shard.map.end()) return StatusCode::ERR_OUT_OF_MEMORY;
+            if (inserted) {
+                if (storeEntry(shard, it, hash, std::move(value), 0, false)) return StatusCode::OK;
+                abandonEntry(shard, it, hash);
+                return StatusCode::ERR_OUT_OF_MEMORY;
+            }
+            switch (policy) {
+                case DuplicatePolicy::FirstWins: return StatusCode::OK;
+                case DuplicatePolicy::Report: return StatusCode::ERR_KEY_ALREADY_EXISTS;
+                default:        // keeps its TTL, like an UPSERT
+                    return storeEntry(shard, it, hash, std::move(value), 0, true) ? StatusCode::OK : StatusCode::ERR_OUT_OF_MEMORY;
+            }
+        }
+
+        /// Everything a CAS does once it holds the shard's lock: one probe, then a SET or an UPDATE if the versions match.
+        RapidWrite swapEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash,
+                             const std::uint64_t expected, RapidDataType&& value, std::uint64_t& version) noexcept {
+            const auto it = findLive(shard, key, hash);
+            if (it == shard.map.end()) {
+                version = 0;
+                if (expected != 0) return StatusCode::ERR_KEY_NOT_FOUND;
+                const RapidWrite write = setEntry(store, shard, key, hash, std::move(value), 0);
+                if (write) version = shard.version;
+                return write;
+            }
+            version = it->first.version;
+            if (version != expected) return StatusCode::ERR_VERSION_MISMATCH;
+            const RapidWrite write = replaceEntry(store, shard, it, key, hash, std::move(value), 0);
+            if (write) version = shard.version;
+            return write;
+        }
+
+        /// `lhs + rhs`, unless it overflows (or, for doubles, isn't finite).
+        [[nodiscard]] bool addChecked(const std::int64_t lhs, const std::int64_t rhs, std::int64_t& sum) noexcept {
+            return !__builtin_add_overflow(lhs, rhs, &sum);
+        }
+
+        [[nodiscard]] bool addChecked(const double lhs, const double rhs, double& sum) noexcept {
+            sum = lhs + rhs;
+            return std::isfinite(sum);
+        }
+
+        /// Everything an INCRBY (`T = std::int64_t`) or INCRBYFLOAT (`T = double`) does once it holds the shard's lock.
+        template <typename T>
+        RapidWrite incrementEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash,
+                                  const T by, const std::optional<T> initial, T& result) noexcept {
+            constexpr auto KIND = std::is_same_v<T, double> ? RapidCell::Kind::Double : RapidCell::Kind::Int;
+            const auto it = findLive(shard, key, hash);
+            if (it == shard.map.end()) {
+                if (!initial) return StatusCode::ERR_KEY_NOT_FOUND;
+                T sum;
+                if (!addChecked(*initial, by, sum)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+                const RapidWrite write = setEntry(store, shard, key, hash, RapidDataType(sum), 0);
+                if (write) result = sum;
+                return write;
+            }
+            if (it->second.kind() != KIND) return StatusCode::ERR_WRONG_TYPE;
+
+            // read as what it is: an int64 going through a double loses everything past 2^53
+            T current;
+            if constexpr (KIND == RapidCell::Kind::Int) current = it->second.asInt();
+            else current = it->second.asDouble();
+            T sum;
+            if (!addChecked(current, by, sum)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+
+            // numbers live in the cell, nothing to allocate or free in the slab: just a new cell, same TTL
+            if (!storeEntry(shard, it, hash, RapidDataType(sum), 0, true)) return StatusCode::ERR_OUT_OF_MEMORY;
+            touch(store, it, false);
+            result = sum;
+            return written(store, shard);
+        }
+
+        /// Everything an APPEND or SETRANGE does once it holds the shard's lock.
+        RapidWrite spliceEntry(const RapidStore& store, RapidShard& shard, const std::string_view key, const std::size_t hash,
+                               std::size_t offset, const std::string_view bytes, std::size_t& length) noexcept {
+            // slab strings are at most 4 GiB
+            const auto tooLong = [&bytes](const std::size_t at) { return at > UINT32_MAX || bytes.size() > UINT32_MAX - at; };
+
+            auto it = findLive(shard, key, hash);
+            if (it == shard.map.end()) {
+                // nothing there is an empty string
+                if (offset == SPLICE_APPEND) offset = 0;
+                if (tooLong(offset)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+                std::string value(offset, '\0');
+                value.append(bytes);
+                const RapidWrite write = setEntry(store, shard, key, hash, RapidDataType(std::move(value)), 0);
+                if (write) length = offset + bytes.size();
+                return write;
+            }
+            if (it->second.kind() != RapidCell::Kind::String) return StatusCode::ERR_WRONG_TYPE;
+
+            const std::size_t old_size = it->second.asString().size();
+            if (offset == SPLICE_APPEND) offset = old_size;
+            if (tooLong(offset)) return StatusCode::ERR_VALUE_OUT_OF_RANGE;
+            const std::size_t size = std::max(old_size, offset + bytes.size());
+
+            const std::size_t old_bytes = slabBytes(it->second);
+            const std::size_t new_bytes = size > RapidCell::INLINE_CAPACITY ? size : 0;
+            if (new_bytes > old_bytes && !fits(store, shard, new_bytes - old_bytes)) {
+                const RapidSlabString keep = it->first;
+                if (!makeRoom(store, shard, new_bytes - old_bytes, &keep)) return StatusCode::ERR_KEY_STORE_FULL;
+                it = shard.map.findForWrite(RapidHashedKey{key, hash});    // evicting shuffles the entries around
+            }
+
+            if (shard.values || shard.reads) {
+                // the indexes need the whole new string anyway (its hash, the readers' copy): it's made up
+                // front and stored like any new value, out of memory the entry keeps what it had
+                std::string spliced;
+                try {
+                    spliced.reserve(size);
+                    spliced.assign(it->second.asString());
+                    spliced.resize(size, '\0');
+                } catch (const std::bad_alloc&) {
+                    return StatusCode::ERR_OUT_OF_MEMORY;
+                }
+                spliced.replace(offset, bytes.size(), bytes);
+                if (!storeEntry(shard, it, hash, RapidDataType(std::move(spliced)), 0, true)) return StatusCode::ERR_OUT_OF_MEMORY;
+            } else {
+                RapidCell cell;
+                if (!spliceValue(shard.slab, it->second, offset, bytes, size, cell)) return StatusCode::ERR_OUT_OF_MEMORY;
+                it->second = cell;
+                shard.valueBytes += new_bytes - old_bytes;
+                newVersion(shard, it);
+            }
+            touch(store, it, false);
+            length = size;
+            return written(store, shard);
+        }
+
+        /**
+         * @brief Per-thread scratch for batched operations: which shard every node goes to.
+         *
+         * `order` holds node indices grouped by shard (stable, so nodes of one shard keep their
+         * original relative order), and `offsets[s]..offsets[s+1]` is shard `s`'s slice of it.
+         *
+         * Kept `thread_local` so that a hot batch path doesn't allocate after warming up.
+         */
+        struct ShardPlan {
+            std::vector<std::size_t> hashes;
+            std::vector<std::size_t> order;
+            std::vector<std::size_t> offsets;
+        };
+
+        ShardPlan& planBatch(const RapidStore& store, const std::span<const RapidNode> nodes) {
+            thread_local ShardPlan plan;
+            const std::size_t shard_count = store.shardCount();
+
+            plan.hashes.resize(nodes.size());
+            plan.order.resize(nodes.size());
+            plan.offsets.assign(shard_count + 1, 0);
+
+            // counting sort by shard index
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                plan.hashes[i] = RapidStore::hash(nodes[i].key, nodes[i].hash);
+                ++plan.offsets[store.shardIndex(plan.hashes[i]) + 1];
+            }
+            for (std::size_t s = 0; s < shard_count; ++s) {
+                plan.offsets[s + 1] += plan.offsets[s];
+            }
+            // scatter, `cursor` doubles as a per-shard write position
+            std::vector<std::size_t>& cursor = plan.offsets;
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                plan.order[cursor[store.shardIndex(plan.hashes[i])]++] = i;
+            }
+            // the scatter shifted every offset by one slot, shift them back
+            for (std::size_t s = shard_count; s > 0; --s) {
+                plan.offsets[s] = plan.offsets[s - 1];
+            }
+            plan.offsets[0] = 0;
+            return plan;
+        }
+
+        /**
+         * @brief Runs `op(shard, node_index, hash)` for the nodes of shard `s`, taking its lock once.
+         *
+         * Readers go through their nodes `PREFETCH_GROUP` at a time: the buckets of the whole group are
+         * prefetched, then the entries those point at, and only then is `op` run on them; so the
+         * group's cache misses overlap instead of each lookup waiting for its own.
+         *
+         * @tparam Exclusive `true` for writers (unique lock), `false` for readers (shared lock)
+         */
+        template <bool Exclusive, typename Op>
+        void forShard(RapidStore& store, const ShardPlan& plan, const std::span<const RapidNode> nodes, const std::size_t s, Op& op) {
+            const std::size_t begin = plan.offsets[s];
+            const std::size_t end = plan.offsets[s + 1];
+            if (begin == end) return;       // nothing for this shard, don't even touch its lock
+
+            RapidShard& shard = store.shard(s);
+            if constexpr (Exclusive) {
+                std::unique_lock guard(shard.lock);
+                tidyUp(shard);
+                for (std::size_t i = begin; i < end; ++i) {
+                    op(shard, plan.order[i], plan.hashes[plan.order[i]]);
+                }
+            } else {
+                std::shared_lock guard(shard.lock);
+                for (std::size_t group = begin; group < end; group += PREFETCH_GROUP) {
+                    const std::size_t group_end = std::min<std::size_t>(group + PREFETCH_GROUP, end);
+                    for (std::size_t i = group; i < group_end; ++i) {
+                        shard.map.prefetch(RapidHashedKey{nodes[plan.order[i]].key, plan.hashes[plan.order[i]]});
+                    }
+                    for (std::size_t i = group; i < group_end; ++i) {
+                        shard.map.prefetchEntry(RapidHashedKey{nodes[plan.order[i]].key, plan.hashes[plan.order[i]]});
+                    }
+                    for (std::size_t i = group; i < group_end; ++i) {
+                        op(shard, plan.order[i], plan.hashes[plan.order[i]]);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Runs `op(shard, node_index, hash)` for every node, taking each touched shard's lock once.
+         * @tparam Exclusive `true` for writers (unique lock), `false` for readers (shared lock)
+         */
+        template <bool Exclusive, typename Op>
+        void forEachShard(RapidStore& store, const std::span<const RapidNode> nodes, Op&& op) {
+            const ShardPlan& plan = planBatch(store, nodes);
+            for (std::size_t s = 0; s < store.shardCount(); ++s) {
+                forShard<Exclusive>(store, plan, nodes, s, op);
+            }
+        }
+
+        /**
+         * @brief `forEachShard()` on up to `threads` threads: every shard is a task of the work pool.
+         *
+         * `op` runs on whichever thread got the shard, so it must only touch the shard and the slots
+         * of its own nodes. Small batches aren't worth the hand-off and stay on the calling thread.
+         */
+        template <bool Exclusive, typename Op>
+        void forEachShard(RapidStore& store, const std::span<const RapidNode> nodes, const std::size_t threads, Op&& op) {
+            if (threads == 1 || nodes.size() < PARALLEL_MIN_NODES) {
+                forEachShard<Exclusive>(store, nodes, op);
+                return;
+            }
+            const ShardPlan& plan = planBatch(store, nodes);     // the caller's, the workers only read it
+            RapidWorkPool::instance().run(store.shardCount(), threads, [&](const std::size_t s) {
+                forShard<Exclusive>(store, plan, nodes, s, op);
+            });
+        }
+
+        /**
+         * @brief BULK_LOAD's share of shard `s`: grows the table once for all of its nodes, then loads
+         * them a `PREFETCH_GROUP` at a time, every bucket of the group prefetched first.
+         * @return How many of them failed
+         */
+        std::size_t loadShard(RapidStore& store, const ShardPlan& plan, const std::span<RapidNode> nodes, const std::size_t s,
+                              const DuplicatePolicy policy, const std::span<RapidWrite> loaded) noexcept {
+            const std::size_t begin = plan.offsets[s];
+            const std::size_t end = plan.offsets[s + 1];
+            if (begin == end) return 0;
+
+            RapidShard& shard = store.shard(s);
+            std::unique_lock guard(shard.lock);
+            tidyUp(shard);
+            shard.map.reserve(shard.map.size() + (end - begin));     // duplicates make it too much, never too little
+            std::size_t failed = 0;
+            for (std::size_t group = begin; group < end; group += PREFETCH_GROUP) {
+                const std::size_t group_end = std::min<std::size_t>(group + PREFETCH_GROUP, end);
+                for (std::size_t i = group; i < group_end; ++i) {
+                    shard.map.prefetch(RapidHashedKey{nodes[plan.order[i]].key, plan.hashes[plan.order[i]]});
+                }
+                for (std::size_t i = group; i < group_end; ++i) {
+                    const std::size_t n = plan.order[i];
+                    const RapidWrite result = loadEntry(store, shard, nodes[n].key, plan.hashes[n], std::move(nodes[n].value), policy);
+                    failed += !result;
+                    if (!loaded.empty()) loaded[n] = result;
+                }
+            }
+            return failed;
+        }
+
+        /**
+         * @brief `count` slots of the calling thread's read buffer, claimed after a `beginRead()`; for the
+         * snapshots of a batch, which workers may take too (see `claimSnapshots()`). `nullptr` if out of
+         * memory, a starved read then.
+         */
+        RapidDataType* const* claimSlots(const std::size_t count) noexcept {
+            beginRead();    // once for the whole batch, so every snapshot of it stays valid
+            thread_local std::vector<RapidDataType*> claimed;
+            try {
+                claimed.resize(count);
+            } catch (const std::bad_alloc&) {
+                starveRead();
+                return nullptr;
+            }
+            if (!claimSnapshots(claimed)) return nullptr;
+            return claimed.data();      // the workers' `claimed` would be their own
+        }
+
+        /**
+         * @brief Lock-free lookups of `nodes[begin, end)` in the read indexes, into `values`.
+         *
+         * Same prefetching as the locked readers (see `forShard()`), over the slots and entries of
+         * the read indexes. With `slots`, the values found are copied into them (`slots[i]` for
+         * `nodes[i]`) and those handed out instead; without, the caller must stay pinned while it uses them.
+         * @return `false` if a copy was short of memory (its value is `nullptr`, like a missing one's)
+         */
+        [[nodiscard]] bool findPublished(RapidStore& store, const std::span<const RapidNode> nodes, const std::span<const RapidDataType*> values,
+                           RapidDataType* const* slots, const std::size_t begin, const std::size_t end) noexcept {
+            ReadGuard pin;
+            bool starved = false;
+            std::array<std::size_t, PREFETCH_GROUP> hashes;
+            for (std::size_t group = begin; group < end; group += PREFETCH_GROUP) {
+                const std::size_t count = std::min(PREFETCH_GROUP, end - group);
+                for (std::size_t i = 0; i < count; ++i) {
+                    hashes[i] = RapidStore::hash(nodes[group + i].key, nodes[group + i].hash);
+                    store.shardFor(hashes[i]).reads->prefetch(hashes[i]);
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    store.shardFor(hashes[i]).reads->prefetchEntry(hashes[i]);
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    const std::size_t n = group + i;
+                    const RapidReadEntry* entry = store.shardFor(hashes[i]).reads->findEntry(nodes[n].key, hashes[i]);
+                    if (entry == nullptr) {
+                        values[n] = nullptr;
+                        continue;
+                    }
+                    touch(store, *entry);
+                    if (slots == nullptr) {
+                        values[n] = &entry->value;
+                        continue;
+                    }
+                    values[n] = slots[n];
+                    if (!loadValue(entry->value, *slots[n])) {
+                        values[n] = nullptr;
+                        starved = true;
+                    }
+                }
+            }
+            return !starved;
+        }
+
+        /// Per-thread list of the keys handed out by `findKeysByValue()`; the keys themselves are read buffer snapshots.
+        struct FoundKeys {
+            std::vector<std::string_view> keys;
+            std::size_t count = 0;
+
+            /// `false` if out of memory, the read is starved then and the key left out.
+            bool add(const std::string_view key) noexcept {
+                try {
+                    if (count == keys.size()) keys.emplace_back();
+                } catch (const std::bad_alloc&) {
+                    starveRead();
+                    return false;
+                }
+                const std::string_view copy = snapshotString(key);
+                if (readStarved()) return false;
+                keys[count++] = copy;
+                return true;
+            }
+        };
+
+
+        /// Like `FoundKeys`, values included.
+        struct ScannedEntries {
+            std::vector<RapidScanEntry> entries;
+            std::size_t count = 0;
+
+            /// `false` if out of memory, the read is starved then and the entry left out.
+            bool add(const std::string_view key, const RapidCell& value) noexcept {
+                try {
+                    if (count == entries.size()) entries.emplace_back();
+                } catch (const std::bad_alloc&) {
+                    starveRead();
+                    return false;
+                }
+                const std::string_view copy = snapshotString(key);
+                const RapidDataType* snapshot = snapshotValue(value);
+                if (readStarved()) return false;
+                entries[count++] = {copy, snapshot};
+                return true;
+            }
+        };
+
+        // A `scanStore()` cursor: | shard (21 bits) | rehash generation (8) | table (1) | slots left (34) |
+        // "Slots left" counts down from the back of the table's entries; the old table of a rehash
+        // goes first, keys only ever move from it to the current one. The cursor of the very first
+        // call (`0`) is never handed out, a table that's done always switches to the next one.
+        constexpr unsigned SCAN_SLOT_BITS = 34;
+        constexpr unsigned SCAN_GENERATION_BITS = 8;
+        constexpr std::uint64_t SCAN_FROM_TOP = (std::uint64_t{1} << SCAN_SLOT_BITS) - 1;
+        constexpr std::uint32_t SCAN_GENERATION_MASK = (1u << SCAN_GENERATION_BITS) - 1;
+
+        struct ScanCursor {
+            std::size_t shard = 0;
+            std::uint32_t generation = 0;
+            bool current = false;           // the current table, or still the old one
+            std::uint64_t slots = SCAN_FROM_TOP;
+
+            [[nodiscard]] static ScanCursor decode(const std::uint64_t cursor) noexcept {
+                if (cursor == 0) return {};
+                return {
+                    static_cast<std::size_t>(cursor >> (SCAN_SLOT_BITS + 1 + SCAN_GENERATION_BITS)),
+                    static_cast<std::uint32_t>(cursor >> (SCAN_SLOT_BITS + 1)) & SCAN_GENERATION_MASK,
+                    (cursor >> SCAN_SLOT_BITS & 1) != 0,
+                    cursor & SCAN_FROM_TOP
+                };
+            }
+
+            [[nodiscard]] std::uint64_t encode() const noexcept {
+                return static_cast<std::uint64_t>(shard) << (SCAN_SLOT_BITS + 1 + SCAN_GENERATION_BITS)
+                     | static_cast<std::uint64_t>(generation) << (SCAN_SLOT_BITS + 1)
+                     | static_cast<std::uint64_t>(current) << SCAN_SLOT_BITS
+                     | slots;
+            }
+        };
+
+        /// The first key past every key starting with `prefix`, empty if there is none (no end).
+        [[nodiscard]] std::string prefixEnd(const std::string_view prefix) {
+            std::string end(prefix);
+            while (!end.empty() && static_cast<unsigned char>(end.back()) == 0xFF) end.pop_back();
+            if (!end.empty()) end.back() = static_cast<char>(static_cast<unsigned char>(end.back()) + 1);
+            return end;
+        }
+
+    } // namespace
+
+
+    RapidWrite setValue(RapidStore& store, const std::string_view key, RapidDataType&& value, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return setEntry(store, shard, key, hash, std::move(value), 0);
     }
 
 
-    const RapidDataType* getValue(const std::string_view key) noexcept {
-        const auto it = MemoryMap.find(key);
-        if (it == MemoryMap.end()) {
-            return nullptr;         // key not found
+    RapidWrite setValue(RapidStore& store, const std::string_view key, RapidDataType&& value, const std::chrono::milliseconds ttl, std::size_t hash) noexcept {
+        RIRI_ASSERT(ttl.count() > 0);
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return setEntry(store, shard, key, hash, std::move(value), deadlineIn(ttl));
+    }
+
+
+    const RapidDataType* getValue(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        if (store.concurrentReads()) {
+            // no lock; inside the caller's ReadGuard the published value itself is handed out, see ReadGuard.hpp,
+            // outside one a copy: it has to outlive our own pin
+            const bool copy = !epochPinned();
+            if (copy) beginRead();
+            ReadGuard pin;
+            const RapidReadEntry* entry = shard.reads->findEntry(key, hash);
+            if (entry == nullptr) return nullptr;
+            touch(store, *entry);
+            return copy ? snapshotValue(entry->value) : &entry->value;
+        }
+
+        beginRead();
+        std::shared_lock guard(shard.lock);
+        const auto* entry = shard.map.find(RapidHashedKey{key, hash});
+        if (entry == nullptr || expired(shard, entry->first, entry->second)) {
+            return nullptr;                         // key not found (or gone, a writer will clean it up)
         }
-        return &it->second;         // key found
+        touch(store, entry->first);
+        return snapshotValue(entry->second);        // key found, hand out a copy the writers can't touch
     }
 
 
-    bool deleteKey(const std::string_view key) noexcept {
-        return MemoryMap.erase(key) > 0;            // returns true if the key was found and erased else false
+    bool deleteKey(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        const auto it = findLive(shard, key, hash);
+        if (it == shard.map.end()) return false;    // key not found
+
+        eraseEntry(shard, it, hash);
+        return true;
     }
 
 
-    bool updateValue(const std::string_view key, RapidDataType&& newValue) noexcept {
-        const auto it = MemoryMap.find(key);
-        if (it == MemoryMap.end()) return false;    // key not found
+    bool unlinkKey(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        const auto it = findLive(shard, key, hash);
+        if (it == shard.map.end()) return false;    // key not found
 
-        it->second = std::move(newValue);           // update the value associated with the key
+        eraseEntry(shard, it, hash, true);          // gone now, its value may be freed later
         return true;
     }
 
 
-    const std::string* getKeyByValue(const RapidDataType& value) noexcept {
-        for (const auto& [key, val] : MemoryMap) {
-            if (val == value) {
-                return &key;    // Return the first key that matches
+    RapidWrite updateValue(RapidStore& store, const std::string_view key, RapidDataType&& newValue, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return updateEntry(store, shard, key, hash, std::move(newValue), 0);
+    }
+
+
+    RapidWrite updateValue(RapidStore& store, const std::string_view key, RapidDataType&& newValue, const std::chrono::milliseconds ttl, std::size_t hash) noexcept {
+        RIRI_ASSERT(ttl.count() > 0);
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return updateEntry(store, shard, key, hash, std::move(newValue), deadlineIn(ttl));
+    }
+
+
+    RapidWrite upsertValue(RapidStore& store, const std::string_view key, RapidDataType&& value, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return upsertEntry(store, shard, key, hash, std::move(value), 0);
+    }
+
+
+    RapidWrite upsertValue(RapidStore& store, const std::string_view key, RapidDataType&& value, const std::chrono::milliseconds ttl, std::size_t hash) noexcept {
+        RIRI_ASSERT(ttl.count() > 0);
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return upsertEntry(store, shard, key, hash, std::move(value), deadlineIn(ttl));
+    }
+
+
+    void setValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> inserted, const std::size_t threads) noexcept {
+        RIRI_ASSERT(inserted.size() >= nodes.size());
+        forEachShard<true>(store, nodes, threads, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            inserted[i] = setEntry(store, shard, nodes[i].key, hash, std::move(nodes[i].value), 0);
+        });
+    }
+
+
+    void getValues(RapidStore& store, std::span<const RapidNode> nodes, std::span<const RapidDataType*> values, const std::size_t threads) noexcept {
+        RIRI_ASSERT(values.size() >= nodes.size());
+        if (store.concurrentReads()) {
+            // no locks to batch, so no need to group by shard either: chunks of nodes are the tasks.
+            // Inside the caller's ReadGuard the published values themselves (its pin outlasts the
+            // workers'), outside one copies, like a GET's
+            const bool pinned = epochPinned();
+            RapidDataType* const* slots = pinned ? nullptr : claimSlots(nodes.size());
+            if (!pinned && slots == nullptr) {
+                std::ranges::fill(values.first(nodes.size()), nullptr);
+                return;
+            }
+            if (threads == 1 || nodes.size() < PARALLEL_MIN_NODES) {
+                if (!findPublished(store, nodes, values, slots, 0, nodes.size())) starveRead();
+                return;
             }
+            // the workers' reads aren't the caller's: whoever ran short tells it so
+            std::atomic<bool> starved{false};
+            const std::size_t chunks = (nodes.size() + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+            RapidWorkPool::instance().run(chunks, threads, [&](const std::size_t chunk) {
+                if (!findPublished(store, nodes, values, slots, chunk * PARALLEL_CHUNK, std::min(nodes.size(), (chunk + 1) * PARALLEL_CHUNK))) {
+                    starved.store(true, std::memory_order_relaxed);
+                }
+            });
+            if (starved.load(std::memory_order_relaxed)) starveRead();
+            return;
         }
-        return nullptr;         // No match found
+
+        // snapshots go into the calling thread's read buffer even when workers take them: they have to outlive the call
+        RapidDataType* const* slots = claimSlots(nodes.size());
+        if (slots == nullptr) {
+            std::ranges::fill(values.first(nodes.size()), nullptr);
+            return;
+        }
+        std::atomic<bool> starved{false};
+        forEachShard<false>(store, nodes, threads, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            const auto* entry = shard.map.find(RapidHashedKey{nodes[i].key, hash});
+            if (entry == nullptr || expired(shard, entry->first, entry->second)) {
+                values[i] = nullptr;
+                return;
+            }
+            touch(store, entry->first);
+            values[i] = slots[i];
+            if (!loadValue(entry->second, *slots[i])) {
+                values[i] = nullptr;
+                starved.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (starved.load(std::memory_order_relaxed)) starveRead();
+    }
+
+
+    void updateValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> updated, const std::size_t threads) noexcept {
+        RIRI_ASSERT(updated.size() >= nodes.size());
+        forEachShard<true>(store, nodes, threads, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            updated[i] = updateEntry(store, shard, nodes[i].key, hash, std::move(nodes[i].value), 0);
+        });
+    }
+
+
+    void upsertValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> written, const std::size_t threads) noexcept {
+        RIRI_ASSERT(written.size() >= nodes.size());
+        forEachShard<true>(store, nodes, threads, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            written[i] = upsertEntry(store, shard, nodes[i].key, hash, std::move(nodes[i].value), 0);
+        });
+    }
+
+
+    std::size_t loadValues(RapidStore& store, std::span<RapidNode> nodes, const DuplicatePolicy policy, std::span<RapidWrite> loaded, const std::size_t threads) noexcept {
+        RIRI_ASSERT(loaded.empty() || loaded.size() >= nodes.size());
+        const ShardPlan& plan = planBatch(store, nodes);
+        if (threads == 1 || nodes.size() < PARALLEL_MIN_NODES) {
+            std::size_t failed = 0;
+            for (std::size_t s = 0; s < store.shardCount(); ++s) failed += loadShard(store, plan, nodes, s, policy, loaded);
+            return failed;
+        }
+        std::atomic<std::size_t> failed{0};
+        RapidWorkPool::instance().run(store.shardCount(), threads, [&](const std::size_t s) {
+            if (const std::size_t shard_failed = loadShard(store, plan, nodes, s, policy, loaded)) failed.fetch_add(shard_failed, std::memory_order_relaxed);
+        });
+        return failed.load(std::memory_order_relaxed);      // run() only returns once every task is done
+    }
+
+
+    RapidWrite incrementValue(RapidStore& store, const std::string_view key, const std::int64_t by, const std::optional<std::int64_t> initial, std::int64_t& result, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return incrementEntry(store, shard, key, hash, by, initial, result);
+    }
+
+
+    RapidWrite incrementValue(RapidStore& store, const std::string_view key, const double by, const std::optional<double> initial, double& result, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return incrementEntry(store, shard, key, hash, by, initial, result);
+    }
+
+
+    template <typename T>
+    void incrementValues(RapidStore& store, std::span<RapidNode> nodes, const std::optional<T> initial, std::span<RapidWrite> incremented) noexcept {
+        RIRI_ASSERT(incremented.size() >= nodes.size());
+        forEachShard<true>(store, nodes, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            const T* by = std::get_if<T>(&nodes[i].value);
+            if (by == nullptr) {
+                incremented[i] = StatusCode::ERR_INVALID_ARGUMENT;
+                return;
+            }
+            T result;
+            incremented[i] = incrementEntry(store, shard, nodes[i].key, hash, *by, initial, result);
+            if (incremented[i]) nodes[i].value = result;
+        });
+    }
+
+    template void incrementValues<std::int64_t>(RapidStore&, std::span<RapidNode>, std::optional<std::int64_t>, std::span<RapidWrite>) noexcept;
+    template void incrementValues<double>(RapidStore&, std::span<RapidNode>, std::optional<double>, std::span<RapidWrite>) noexcept;
+
+
+    RapidWrite spliceString(RapidStore& store, const std::string_view key, const std::size_t offset, const std::string_view bytes, std::size_t& length, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return spliceEntry(store, shard, key, hash, offset, bytes, length);
+    }
+
+
+    StatusCode getRange(RapidStore& store, const std::string_view key, const std::size_t offset, const std::size_t length, std::string_view& range, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+        const auto cut = [offset, length](const std::string_view str) {
+            return offset < str.size() ? str.substr(offset, length) : std::string_view{};
+        };
+
+        if (store.concurrentReads()) {
+            // a view into the published value inside the caller's ReadGuard, a copy of the range outside one
+            const bool copy = !epochPinned();
+            if (copy) beginRead();
+            ReadGuard pin;
+            const RapidReadEntry* entry = shard.reads->findEntry(key, hash);
+            if (entry == nullptr) return StatusCode::ERR_KEY_NOT_FOUND;
+            const auto* str = std::get_if<std::string>(&entry->value);
+            if (str == nullptr) return StatusCode::ERR_WRONG_TYPE;
+            touch(store, *entry);
+            range = copy ? snapshotString(cut(*str)) : cut(*str);
+            return readStarved() ? StatusCode::ERR_OUT_OF_MEMORY : StatusCode::OK;
+        }
+
+        beginRead();
+        std::shared_lock guard(shard.lock);
+        const auto* entry = shard.map.find(RapidHashedKey{key, hash});
+        if (entry == nullptr || expired(shard, entry->first, entry->second)) return StatusCode::ERR_KEY_NOT_FOUND;
+        if (entry->second.kind() != RapidCell::Kind::String) return StatusCode::ERR_WRONG_TYPE;
+        touch(store, entry->first);
+        range = snapshotString(cut(entry->second.asString()));      // the range only, not the whole value
+        return readStarved() ? StatusCode::ERR_OUT_OF_MEMORY : StatusCode::OK;
+    }
+
+
+    const RapidDataType* getVersionedValue(RapidStore& store, const std::string_view key, std::uint64_t& version, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+        version = 0;
+
+        if (store.concurrentReads()) {
+            // value and version are published together, a reader never gets one without the other
+            const bool copy = !epochPinned();       // as for `getValue()`
+            if (copy) beginRead();
+            ReadGuard pin;
+            const RapidReadEntry* entry = shard.reads->findEntry(key, hash);
+            if (entry == nullptr) return nullptr;
+            touch(store, *entry);
+            version = entry->version;
+            return copy ? snapshotValue(entry->value) : &entry->value;
+        }
+
+        beginRead();
+        std::shared_lock guard(shard.lock);
+        const auto* entry = shard.map.find(RapidHashedKey{key, hash});
+        if (entry == nullptr || expired(shard, entry->first, entry->second)) return nullptr;
+        touch(store, entry->first);
+        version = entry->first.version;
+        return snapshotValue(entry->second);
+    }
+
+
+    RapidWrite compareAndSwap(RapidStore& store, const std::string_view key, const std::uint64_t expected, RapidDataType&& value, std::uint64_t& version, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        return swapEntry(store, shard, key, hash, expected, std::move(value), version);
+    }
+
+
+    void compareAndSwapValues(RapidStore& store, std::span<RapidNode> nodes, std::span<const std::uint64_t> expected, std::span<RapidWrite> swapped) noexcept {
+        RIRI_ASSERT(expected.size() >= nodes.size() && swapped.size() >= nodes.size());
+        forEachShard<true>(store, nodes, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            std::uint64_t version;
+            swapped[i] = swapEntry(store, shard, nodes[i].key, hash, expected[i], std::move(nodes[i].value), version);
+            if (swapped[i]) nodes[i].value = static_cast<std::int64_t>(version);
+        });
+    }
+
+
+    void deleteKeys(RapidStore& store, std::span<const RapidNode> nodes, std::span<bool> deleted) noexcept {
+        RIRI_ASSERT(deleted.size() >= nodes.size());
+        forEachShard<true>(store, nodes, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            const auto it = findLive(shard, nodes[i].key, hash);
+            deleted[i] = it != shard.map.end();
+            if (deleted[i]) eraseEntry(shard, it, hash);
+        });
+    }
+
+
+    void unlinkKeys(RapidStore& store, std::span<const RapidNode> nodes, std::span<bool> unlinked) noexcept {
+        RIRI_ASSERT(unlinked.size() >= nodes.size());
+        forEachShard<true>(store, nodes, [&](RapidShard& shard, const std::size_t i, const std::size_t hash) {
+            const auto it = findLive(shard, nodes[i].key, hash);
+            unlinked[i] = it != shard.map.end();
+            if (unlinked[i]) eraseEntry(shard, it, hash, true);
+        });
+    }
+
+
+    const std::string* getKeyByValue(RapidStore& store, const RapidDataType& value) noexcept {
+        thread_local std::string found;     // keys live in the slab now, hand out a copy instead
+        // out of memory for the copy, it's as good as not found
+        const auto copied = [](const std::string_view key) noexcept {
+            try {
+                found.assign(key);
+                return &found;
+            } catch (const std::bad_alloc&) {
+                return static_cast<std::string*>(nullptr);
+            }
+        };
+        if (store.options().valueIndex) {
+            const std::span<const std::string_view> keys = findKeysByValue(store, value, 1);
+            if (keys.empty()) return nullptr;
+            return copied(keys.front());
+        }
+
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            std::shared_lock guard(shard.lock);
+            const std::string* first = nullptr;
+            const bool searched = shard.map.forEach([&](const RapidSlabString& key, const RapidCell& val) {
+                if (!sameValue(val, value) || expired(shard, key, val)) return true;
+                first = copied(key.view());
+                return false;
+            });
+            if (!searched) return first;    // Return the first key that matches
+        }
+        return nullptr;             // No match found
+    }
+
+
+    std::span<const std::string_view> findKeysByValue(RapidStore& store, const RapidDataType& value, const std::size_t limit) noexcept {
+        thread_local FoundKeys found;
+        found.count = 0;
+        beginRead();
+
+        for (std::size_t s = 0; s < store.shardCount() && found.count < limit; ++s) {
+            RapidShard& shard = store.shard(s);
+            std::shared_lock guard(shard.lock);
+
+            if (shard.values) {
+                shard.values->forEachCandidate(value, [&](const RapidValueRef& ref) {
+                    if (found.count == limit) return;
+                    // a shared value hash doesn't make a shared value, ask the map
+                    const auto* entry = shard.map.find(RapidHashedKey{ref.key.view(), ref.hash});
+                    if (entry == nullptr || !sameValue(entry->second, value)) return;
+                    if (!expired(shard, entry->first, entry->second)) (void)found.add(ref.key.view());
+                });
+                continue;
+            }
+            shard.map.forEach([&](const RapidSlabString& key, const RapidCell& val) {
+                if (sameValue(val, value) && !expired(shard, key, val)) (void)found.add(key.view());
+                return found.count < limit && !readStarved();
+            });
+        }
+        return {found.keys.data(), found.count};
+    }
+
+
+    std::span<const RapidScanEntry> scanKeys(RapidStore& store, const std::string_view from, const std::string_view to, const std::size_t limit) noexcept {
+        thread_local ScannedEntries found;
+        found.count = 0;
+        beginRead();
+        const auto inRange = [from, to](const std::string_view key) { return key >= from && (to.empty() || key < to); };
+
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            std::shared_lock guard(shard.lock);
+
+            if (shard.ordered) {
+                // every shard is in order on its own, the first `limit` of each are all the merge can need
+                std::size_t taken = 0;
+                shard.ordered->forEachFrom(from, [&](const RapidSlabString key) {
+                    if (taken == limit || !inRange(key.view())) return false;
+                    const auto* entry = shard.map.find(RapidHashedKey{key.view(), RapidHash{}(key)});
+                    RIRI_ASSERT(entry != nullptr);
+                    if (!expired(shard, entry->first, entry->second)) {
+                        if (!found.add(key.view(), entry->second)) return false;
+                        ++taken;
+                    }
+                    return true;
+                });
+                continue;
+            }
+            shard.map.forEach([&](const RapidSlabString& key, const RapidCell& val) {
+                if (inRange(key.view()) && !expired(shard, key, val)) return found.add(key.view(), val);
+                return true;
+            });
+        }
+
+        const auto entries = std::span(found.entries).first(found.count);
+        std::ranges::sort(entries, {}, &RapidScanEntry::key);
+        return entries.first(std::min(found.count, limit));
+    }
+
+
+    std::span<const RapidScanEntry> scanPrefix(RapidStore& store, const std::string_view prefix, const std::size_t limit) noexcept {
+        return scanKeys(store, prefix, prefixEnd(prefix), limit);
+    }
+
+
+    std::span<const RapidScanEntry> scanStore(RapidStore& store, std::uint64_t& cursor, std::size_t count) noexcept {
+        thread_local ScannedEntries found;
+        found.count = 0;
+        beginRead();
+
+        ScanCursor at = ScanCursor::decode(cursor);
+        while (count > 0 && at.shard < store.shardCount()) {
+            RapidShard& shard = store.shard(at.shard);
+            {
+                std::shared_lock guard(shard.lock);
+                // a rehash started since the last call: the table being walked became the old one as it
+                // was, same slots; if it was the old one already, or more happened, the shard starts over
+                if (const std::uint32_t generation = shard.map.rehashes() & SCAN_GENERATION_MASK; at.generation != generation) {
+                    const bool moved = at.current && ((at.generation + 1) & SCAN_GENERATION_MASK) == generation;
+                    at = {at.shard, generation, false, moved ? at.slots : SCAN_FROM_TOP};
+                }
+
+                while (count > 0) {
+                    const auto entries = shard.map.entries(!at.current);
+                    at.slots = std::min<std::uint64_t>(at.slots, entries.size());
+                    for (; at.slots > 0 && count > 0; --count) {
+                        const auto& [key, value] = entries[--at.slots];
+                        // out of memory: the cursor stays on this entry, the next call starts with it
+                        if (!expired(shard, key, value) && !found.add(key.view(), value)) {
+                            ++at.slots;
+                            count = 0;
+                            break;
+                        }
+                    }
+                    if (at.slots > 0 || at.current) break;
+                    at.current = true;
+                    at.slots = SCAN_FROM_TOP;
+                }
+            }
+            if (at.current && at.slots == 0) at = {at.shard + 1, 0, false, SCAN_FROM_TOP};
+        }
+
+        cursor = at.shard < store.shardCount() ? at.encode() : 0;
+        return {found.entries.data(), found.count};
+    }
+
+
+    void clearMap(RapidStore& store) noexcept {
+        // one shard at a time, so readers of other shards are never blocked by a CLEAR
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+
+            // the empty replacements are made before the lock is taken, the lock is only held for the swaps
+            auto* cleared = new ClearedShard();
+            store.setUp(s, cleared->map, cleared->slab);
+            if (store.options().valueIndex) cleared->values = std::make_unique<RapidValueIndex>();
+            if (store.options().orderedIndex) cleared->ordered = std::make_unique<RapidOrderedIndex>();
+            {
+                std::unique_lock guard(shard.lock);
+                shard.map.swap(cleared->map);
+                shard.slab.swap(cleared->slab);
+                shard.values.swap(cleared->values);
+                shard.ordered.swap(cleared->ordered);
+                shard.expiry.swap(cleared->expiry);
+                if (shard.reads) shard.reads->clear();
+                shard.keyBytes = 0;
+                shard.valueBytes = 0;
+            }
+            // whatever the shard held is freed in the background, however big it was
+            lazyFree(cleared, freeClearedShard);
+        }
+    }
+
+
+    std::size_t compactStore(RapidStore& store) noexcept {
+        std::size_t reclaimed = 0;
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            const auto footprint = [&shard] {
+                return shard.slab.reservedBytes() + shard.map.bucketBytes() + shard.map.entryBytes();
+            };
+
+            std::unique_lock guard(shard.lock);
+            const std::size_t before = footprint();
+            if (!shard.slab.compacting() && !startCompaction(shard, COMPACT_LOW_WATER) && !shard.map.rehashing()) continue;
+            // the lock is let go of between steps, so the shard's readers and writers never wait long
+            std::size_t freed = 0;
+            while (!compactStep(shard, COMPACT_STEP, freed)) {
+                guard.unlock();
+                guard.lock();
+            }
+            // measured rather than summed up: the old table's memory counts too, and writes in
+            // between may have grown the shard, which isn't something COMPACT gave back
+            const std::size_t after = footprint();
+            reclaimed += before > after ? before - after : 0;
+        }
+        return reclaimed;
+    }
+
+
+    size_t size(RapidStore& store) noexcept {
+        size_t total = 0;
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            std::shared_lock guard(shard.lock);
+            total += shard.map.size();
+        }
+        return total;               // Return the size of the whole store
     }
 
 
+    RapidMemoryStats memoryStats(RapidStore& store) noexcept {
+        RapidMemoryStats stats;
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            std::shared_lock guard(shard.lock);
+            stats.keys += shard.map.size();
+            stats.keyBytes += shard.keyBytes;
+            stats.valueBytes += shard.valueBytes;
+            stats.bucketBytes += shard.map.bucketBytes();
+            stats.entryBytes += shard.map.entryBytes();
+            stats.slabBytes += shard.slab.reservedBytes();
+            stats.budgetBytes += shard.used();
+        }
+        return stats;
+    }
+
+
+    std::size_t memoryUsage(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::shared_lock guard(shard.lock);
+        const auto* entry = shard.map.find(RapidHashedKey{key, hash});
+        if (entry == nullptr || expired(shard, entry->first, entry->second)) return 0;
+        // the buckets are shared by every key, each gets its cut
+        return entry->first.size + slabBytes(entry->second) + sizeof(RapidTable::value_type)
+            + shard.map.bucketBytes() / shard.map.size();
+    }
+
+
+    bool expireKey(RapidStore& store, const std::string_view key, const std::chrono::milliseconds ttl, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        const auto it = findLive(shard, key, hash);
+        if (it == shard.map.end()) return false;    // key not found
+
+        if (ttl.count() <= 0) {
+            eraseEntry(shard, it, hash);            // a deadline that already passed, no point in keeping it around
+            return true;
+        }
+        setDeadline(shard, it, hash, deadlineIn(ttl));
+        redate(shard, it, hash);
+        return true;
+    }
+
+
+    std::chrono::milliseconds getTtl(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::shared_lock guard(shard.lock);
+        const auto* entry = shard.map.find(RapidHashedKey{key, hash});
+        if (entry == nullptr) return TTL_KEY_NOT_FOUND;
+        if (!entry->second.expires()) return TTL_NEVER;
+
+        const std::int64_t left = shard.expiry->deadline(entry->first) - expiryNow();
+        return left > 0 ? std::chrono::milliseconds{left} : TTL_KEY_NOT_FOUND;
+    }
+
+
+    std::chrono::milliseconds persistKey(RapidStore& store, const std::string_view key, std::size_t hash) noexcept {
+        hash = RapidStore::hash(key, hash);
+        RapidShard& shard = store.shardFor(hash);
+
+        std::unique_lock guard(shard.lock);
+        tidyUp(shard);
+        const auto it = findLive(shard, key, hash);
+        if (it == shard.map.end()) return TTL_KEY_NOT_FOUND;
+        if (!it->second.expires()) return TTL_NEVER;
+
+        const std::chrono::milliseconds left{std::max<std::int64_t>(shard.expiry->deadline(it->first) - expiryNow(), 1)};
+        clearDeadline(shard, it);
+        redate(shard, it, hash);
+        return left;
+    }
+
+
+    std::size_t expireKeys(RapidStore& store) noexcept {
+        std::size_t total = 0;
+        for (std::size_t s = 0; s < store.shardCount(); ++s) {
+            RapidShard& shard = store.shard(s);
+            // a step per lock, so a mass expiry never keeps the shard's readers and writers out for long
+            for (;;) {
+                std::unique_lock guard(shard.lock);
+                const std::size_t expired = expireDue(shard, SWEEP_STEP);
+                total += expired;
+                if (expired < SWEEP_STEP) break;
+            }
+        }
+        return total;
+    }
+
+
+    // Default store
+
+    RapidWrite setValue(const std::string_view key, RapidDataType&& value, const std::size_t hash) noexcept {
+        return setValue(MemoryMap, key, std::move(value), hash);
+    }
+
+    RapidWrite setValue(const std::string_view key, RapidDataType&& value, const std::chrono::milliseconds ttl, const std::size_t hash) noexcept {
+        return setValue(MemoryMap, key, std::move(value), ttl, hash);
+    }
+
+    const RapidDataType* getValue(const std::string_view key, const std::size_t hash) noexcept {
+        return getValue(MemoryMap, key, hash);
+    }
+
+    bool deleteKey(const std::string_view key, const std::size_t hash) noexcept {
+        return deleteKey(MemoryMap, key, hash);
+    }
+
+    bool unlinkKey(const std::string_view key, const std::size_t hash) noexcept {
+        return unlinkKey(MemoryMap, key, hash);
+    }
+
+    RapidWrite updateValue(const std::string_view key, RapidDataType&& newValue, const std::size_t hash) noexcept {
+        return updateValue(MemoryMap, key, std::move(newValue), hash);
+    }
+
+    RapidWrite updateValue(const std::string_view key, RapidDataType&& newValue, const std::chrono::milliseconds ttl, const std::size_t hash) noexcept {
+        return updateValue(MemoryMap, key, std::move(newValue), ttl, hash);
+    }
+
+    RapidWrite upsertValue(const std::string_view key, RapidDataType&& value, const std::size_t hash) noexcept {
+        return upsertValue(MemoryMap, key, std::move(value), hash);
+    }
+
+    RapidWrite upsertValue(const std::string_view key, RapidDataType&& value, const std::chrono::milliseconds ttl, const std::size_t hash) noexcept {
+        return upsertValue(MemoryMap, key, std::move(value), ttl, hash);
+    }
+
+    void setValues(const std::span<RapidNode> nodes, const std::span<RapidWrite> inserted) noexcept {
+        setValues(MemoryMap, nodes, inserted);
+    }
+
+    void getValues(const std::span<const RapidNode> nodes, const std::span<const RapidDataType*> values) noexcept {
+        getValues(MemoryMap, nodes, values);
+    }
+
+    void updateValues(const std::span<RapidNode> nodes, const std::span<RapidWrite> updated) noexcept {
+        updateValues(MemoryMap, nodes, updated);
+    }
+
+    void upsertValues(const std::span<RapidNode> nodes, const std::span<RapidWrite> written) noexcept {
+        upsertValues(MemoryMap, nodes, written);
+    }
+
+    std::size_t loadValues(const std::span<RapidNode> nodes, const DuplicatePolicy policy, const std::span<RapidWrite> loaded) noexcept {
+        return loadValues(MemoryMap, nodes, policy, loaded);
+    }
+
+    RapidWrite incrementValue(const std::string_view key, const std::int64_t by, const std::optional<std::int64_t> initial, std::int64_t& result, const std::size_t hash) noexcept {
+        return incrementValue(MemoryMap, key, by, initial, result, hash);
+    }
+
+    RapidWrite incrementValue(const std::string_view key, const double by, const std::optional<double> initial, double& result, const std::size_t hash) noexcept {
+        return incrementValue(MemoryMap, key, by, initial, result, hash);
+    }
+
+    template <typename T>
+    void incrementValues(std::span<RapidNode> nodes, const std::optional<T> initial, std::span<RapidWrite> incremented) noexcept {
+        incrementValues(MemoryMap, nodes, initial, incremented);
+    }
+
+    template void incrementValues<std::int64_t>(std::span<RapidNode>, std::optional<std::int64_t>, std::span<RapidWrite>) noexcept;
+    template void incrementValues<double>(std::span<RapidNode>, std::optional<double>, std::span<RapidWrite>) noexcept;
+
+    RapidWrite spliceString(const std::string_view key, const std::size_t offset, const std::string_view bytes, std::size_t& length, const std::size_t hash) noexcept {
+        return spliceString(MemoryMap, key, offset, bytes, length, hash);
+    }
+
+    StatusCode getRange(const std::string_view key, const std::size_t offset, const std::size_t length, std::string_view& range, const std::size_t hash) noexcept {
+        return getRange(MemoryMap, key, offset, length, range, hash);
+    }
+
+    const RapidDataType* getVersionedValue(const std::string_view key, std::uint64_t& version, const std::size_t hash) noexcept {
+        return getVersionedValue(MemoryMap, key, version, hash);
+    }
+
+    RapidWrite compareAndSwap(const std::string_view key, const std::uint64_t expected, RapidDataType&& value, std::uint64_t& version, const std::size_t hash) noexcept {
+        return compareAndSwap(MemoryMap, key, expected, std::move(value), version, hash);
+    }
+
+    void compareAndSwapValues(const std::span<RapidNode> nodes, const std::span<const std::uint64_t> expected, const std::span<RapidWrite> swapped) noexcept {
+        compareAndSwapValues(MemoryMap, nodes, expected, swapped);
+    }
+
+    void deleteKeys(const std::span<const RapidNode> nodes, const std::span<bool> deleted) noexcept {
+        deleteKeys(MemoryMap, nodes, deleted);
+    }
+
+    void unlinkKeys(const std::span<const RapidNode> nodes, const std::span<bool> unlinked) noexcept {
+        unlinkKeys(MemoryMap, nodes, unlinked);
+    }
+
+    const std::string* getKeyByValue(const RapidDataType& value) noexcept {
+        return getKeyByValue(MemoryMap, value);
+    }
+
+    std::span<const std::string_view> findKeysByValue(const RapidDataType& value, const std::size_t limit) noexcept {
+        return findKeysByValue(MemoryMap, value, limit);
+    }
+
+    std::span<const RapidScanEntry> scanKeys(const std::string_view from, const std::string_view to, const std::size_t limit) noexcept {
+        return scanKeys(MemoryMap, from, to, limit);
+    }
+
+    std::span<const RapidScanEntry> scanPrefix(const std::string_view prefix, const std::size_t limit) noexcept {
+        return scanPrefix(MemoryMap, prefix, limit);
+    }
+
+    std::span<const RapidScanEntry> scanStore(std::uint64_t& cursor, const std::size_t count) noexcept {
+        return scanStore(MemoryMap, cursor, count);
+    }
+
+    bool expireKey(const std::string_view key, const std::chrono::milliseconds ttl, const std::size_t hash) noexcept {
+        return expireKey(MemoryMap, key, ttl, hash);
+    }
+
+    std::chrono::milliseconds getTtl(const std::string_view key, const std::size_t hash) noexcept {
+        return getTtl(MemoryMap, key, hash);
+    }
+
+    std::chrono::milliseconds persistKey(const std::string_view key, const std::size_t hash) noexcept {
+        return persistKey(MemoryMap, key, hash);
+    }
+
+    std::size_t expireKeys() noexcept {
+        return expireKeys(MemoryMap);
+    }
+
     void clearMap() noexcept {
-        MemoryMap.clear();          // Clear all entries from the internal memory map
+        clearMap(MemoryMap);
     }
 
+    std::size_t compactStore() noexcept {
+        return compactStore(MemoryMap);
+    }
 
     size_t size() noexcept {
-        return MemoryMap.size();    // Return the size of the internal memory map
+        return size(MemoryMap);
+    }
+
+    RapidMemoryStats memoryStats() noexcept {
+        return memoryStats(MemoryMap);
+    }
+
+    std::size_t memoryUsage(const std::string_view key, const std::size_t hash) noexcept {
+        return memoryUsage(MemoryMap, key, hash);
     }
 
-} // namespace RiRi::Internal
\ No newline at end of file
+} // namespace RiRi::Internal
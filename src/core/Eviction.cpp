@@ -0,0 +1,72 @@
+#include "Eviction.h"
+
+#include <chrono>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        /// A new key's LFU counter, so it isn't the first thing evicted before it ever had a chance.
+        constexpr std::uint32_t LFU_INIT = 5;
+
+        /// How hard the LFU counter is to push up: ~1M uses to saturate it, like Redis' default.
+        constexpr double LFU_LOG_FACTOR = 10;
+
+        constexpr std::uint32_t LFU_MAX = 255;
+        constexpr std::uint32_t LFU_MINUTES_MASK = (1u << 24) - 1;
+
+        [[nodiscard]] std::int64_t steadyMillis() noexcept {
+            using namespace std::chrono;
+            return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+        }
+
+        [[nodiscard]] std::uint32_t lruClock() noexcept {
+            return static_cast<std::uint32_t>(steadyMillis() / 10);
+        }
+
+        [[nodiscard]] std::uint32_t lfuMinutes() noexcept {
+            return static_cast<std::uint32_t>(steadyMillis() / 60'000) & LFU_MINUTES_MASK;
+        }
+
+        /// The stamp's counter, minus a point per minute since it was last decayed.
+        [[nodiscard]] std::uint32_t lfuDecayed(const std::uint32_t stamp, const std::uint32_t now) noexcept {
+            const std::uint32_t counter = stamp & LFU_MAX;
+            const std::uint32_t idle = (now - (stamp >> 8)) & LFU_MINUTES_MASK;
+            return idle >= counter ? 0 : counter - idle;
+        }
+
+    } // namespace
+
+
+    std::uint32_t touchedStamp(const EvictionPolicy policy, const std::uint32_t stamp, const bool fresh) noexcept {
+        if (policy == EvictionPolicy::LRU) return lruClock();
+
+        const std::uint32_t now = lfuMinutes();
+        std::uint32_t counter = fresh ? LFU_INIT : lfuDecayed(stamp, now);
+        if (!fresh && counter < LFU_MAX) {
+            // the more uses a key already has, the less likely one more counts
+            const double base = counter > LFU_INIT ? counter - LFU_INIT : 0;
+            const double chance = 1.0 / (base * LFU_LOG_FACTOR + 1);
+            if (static_cast<double>(evictionRandom() >> 11) * 0x1.0p-53 < chance) ++counter;
+        }
+        return now << 8 | counter;
+    }
+
+
+    std::uint32_t evictionScore(const EvictionPolicy policy, const std::uint32_t stamp) noexcept {
+        if (policy == EvictionPolicy::LRU) return lruClock() - stamp;     // idle time, wraps around fine
+        return LFU_MAX - lfuDecayed(stamp, lfuMinutes());
+    }
+
+
+    std::uint64_t evictionRandom() noexcept {
+        // xorshift64*, seeded per thread from wherever its state happens to live
+        thread_local std::uint64_t state = reinterpret_cast<std::uintptr_t>(&state) | 1;
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+} // namespace RiRi::Internal
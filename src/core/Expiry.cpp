@@ -0,0 +1,105 @@
+#include "Expiry.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+
+namespace RiRi::Internal {
+
+    void RapidTimingWheel::schedule(const Timer timer) {
+        // due already: the slot about to fire; too far out: the far end of the wheel, it fires early
+        const std::int64_t at = std::clamp(timer.at, _tick, _tick + REACH - 1);
+        const std::int64_t delta = at - _tick;
+
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= std::int64_t{1} << (SLOT_BITS * (level + 1))) ++level;
+
+        const auto slot = static_cast<std::size_t>((at >> (SLOT_BITS * level)) & SLOT_MASK);
+        _slots[level][slot].push_back(timer);
+        _occupied[level] |= std::uint64_t{1} << slot;
+        ++_count;
+    }
+
+
+    void RapidTimingWheel::cascade(const int level) {
+        // level `level - 1` just wrapped around, the next slot of this one comes down a level
+        const auto slot = static_cast<std::size_t>((_tick >> (SLOT_BITS * level)) & SLOT_MASK);
+        if ((_occupied[level] >> slot) & 1) {
+            _scratch.swap(_slots[level][slot]);
+            _occupied[level] &= ~(std::uint64_t{1} << slot);
+            _count -= _scratch.size();
+            for (const Timer& timer : _scratch) schedule(timer);
+            _scratch.clear();
+        }
+        if (slot == 0 && level + 1 < LEVELS) cascade(level + 1);
+    }
+
+
+    std::int64_t RapidTimingWheel::nextCascade() const noexcept {
+        std::int64_t next = INT64_MAX;
+        for (int level = 1; level < LEVELS; ++level) {
+            if (_occupied[level] == 0) continue;
+            // slot `i` of a level comes down when a new block of that level starts with index `i`
+            const std::int64_t block = (_tick >> (SLOT_BITS * level)) + 1;
+            const auto index = static_cast<int>(block & SLOT_MASK);
+            const std::uint64_t ahead = _occupied[level] >> index;
+            const std::int64_t skip = ahead != 0
+                ? std::countr_zero(ahead)
+                : static_cast<std::int64_t>(SLOTS) - index + std::countr_zero(_occupied[level]);
+            next = std::min(next, (block + skip) << (SLOT_BITS * level));
+        }
+        return next;
+    }
+
+
+    void RapidTimingWheel::advance(const std::int64_t now, std::vector<Timer>& due) {
+        while (_tick <= now) {
+            if (_count == 0) {
+                _tick = now + 1;        // nothing to fire, nothing to cascade, just catch up
+                return;
+            }
+
+            const auto slot = static_cast<std::size_t>(_tick & SLOT_MASK);
+            if (slot == 0) cascade(1);
+
+            // level 0 slots from `slot` on are this lap's
+            const std::uint64_t ahead = _occupied[0] >> slot;
+            if (ahead == 0) {
+                // nothing fires until the next lap, or until something comes down from above
+                const std::int64_t lap = _occupied[0] != 0 ? (_tick | SLOT_MASK) + 1 : INT64_MAX;
+                _tick = std::min({now + 1, lap, nextCascade()});
+                continue;
+            }
+            const std::size_t next = slot + static_cast<std::size_t>(std::countr_zero(ahead));
+            const std::int64_t at = (_tick & ~SLOT_MASK) + static_cast<std::int64_t>(next);
+            if (at > now) {
+                _tick = now + 1;
+                return;
+            }
+
+            std::vector<Timer>& fired = _slots[0][next];
+            _count -= fired.size();
+            _occupied[0] &= ~(std::uint64_t{1} << next);
+            if (due.empty()) {
+                due.swap(fired);
+            } else {
+                due.insert(due.end(), fired.begin(), fired.end());
+                fired.clear();
+            }
+            _tick = at + 1;
+        }
+    }
+
+
+    void RapidExpiry::set(const RapidSlabString key, const std::size_t hash, const std::int64_t at) {
+        const auto [it, fresh] = _deadlines.try_emplace(key.data, Deadline{at, at, hash, key.size});
+        if (!fresh) {
+            it->second.at = at;
+            if (at >= it->second.scheduled) return;     // the pending timer fires first, and re-files itself
+            it->second.scheduled = at;
+        }
+        _wheel.schedule({key.data, at});
+    }
+
+} // namespace RiRi::Internal
@@ -0,0 +1,108 @@
+#include "LazyFree.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        struct Garbage {
+            void* ptr;
+            RapidFreeStepFn step;
+        };
+
+        struct LazyFreer {
+            std::mutex mutex;
+            std::condition_variable wake;       // something was handed over, for the freer
+            std::condition_variable idle;       // everything's gone, for `lazyFreeWait()`
+            std::deque<Garbage> queue;          // guarded by `mutex`, and so is `pending`
+            std::size_t pending = 0;            // the queue, and the one being freed right now
+
+            [[noreturn]] void run() noexcept {
+                std::unique_lock lock(mutex);
+                while (true) {
+                    wake.wait(lock, [this] { return !queue.empty(); });
+                    const Garbage garbage = queue.front();
+                    queue.pop_front();
+
+                    while (true) {
+                        lock.unlock();
+                        const bool done = garbage.step(garbage.ptr);
+                        lock.lock();
+
+                        if (done) {
+                            if (--pending == 0) idle.notify_all();
+                            break;
+                        }
+                        // one step each, in turns: a small UNLINK doesn't wait for a big CLEAR to be done;
+                        // out of memory to queue it again, it doesn't take turns until it's gone
+                        try {
+                            queue.push_back(garbage);
+                            break;
+                        } catch (const std::bad_alloc&) { }
+                    }
+                }
+            }
+        };
+
+        /// Never destroyed: static destructors (the epoch reclaimer's, at exit) may still hand garbage over.
+        /// `nullptr` while there's no memory (or no thread) to start it with; a later call tries again.
+        LazyFreer* freer() noexcept {
+            try {
+                static LazyFreer* const instance = [] {
+                    auto created = std::make_unique<LazyFreer>();
+                    std::thread([freer = created.get()] { freer->run(); }).detach();
+                    return created.release();
+                }();
+                return instance;
+            } catch (const std::exception&) {      // `bad_alloc`, or the `system_error` of a thread that couldn't start
+                return nullptr;
+            }
+        }
+
+    } // namespace
+
+
+    void lazyFree(void* garbage, const RapidFreeStepFn step) noexcept {
+        bool handed = false;
+        if (LazyFreer* lazy = freer()) {
+            {
+                std::scoped_lock guard(lazy->mutex);
+                try {
+                    lazy->queue.push_back({garbage, step});
+                    ++lazy->pending;
+                    handed = true;
+                } catch (const std::bad_alloc&) { }
+            }
+            if (handed) lazy->wake.notify_one();
+        }
+        // out of memory to hand it over: the caller's time it is, after all
+        if (!handed) {
+            while (!step(garbage)) { }
+        }
+    }
+
+
+    void lazyFreeWait() noexcept {
+        LazyFreer* lazy = freer();
+        if (lazy == nullptr) return;    // never started, never handed anything
+        std::unique_lock lock(lazy->mutex);
+        lazy->idle.wait(lock, [lazy] { return lazy->pending == 0; });
+    }
+
+
+    std::size_t lazyFreePending() noexcept {
+        LazyFreer* lazy = freer();
+        if (lazy == nullptr) return 0;
+        std::scoped_lock guard(lazy->mutex);
+        return lazy->pending;
+    }
+
+} // namespace RiRi::Internal
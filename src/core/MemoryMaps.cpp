@@ -1,28 +1,243 @@
 #include "MemoryMaps.h"
+#include "DataManager.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <new>
 
 constexpr size_t DEFAULT_MEMORY_CAPACITY = 100;
+
+// The default store serves GETs lock-free only if the library was built with RIRI_CONCURRENT_READS
+#ifdef RIRI_CONCURRENT_READS
+constexpr bool DEFAULT_CONCURRENT_READS = true;
+#else
+constexpr bool DEFAULT_CONCURRENT_READS = false;
+#endif
+// Same for spreading its shards over the NUMA nodes, RIRI_NUMA_AWARE
+#ifdef RIRI_NUMA_AWARE
+constexpr bool DEFAULT_NUMA_AWARE = true;
+#else
+constexpr bool DEFAULT_NUMA_AWARE = false;
+#endif
 // constexpr size_t DEFAULT_COMMAND_CAPACITY = 16;
 
+namespace RiRi {
+
+    std::size_t hashKey(const std::string_view key) noexcept {
+        return Internal::RapidStore::hash(key);
+    }
+
+    void prehash(const std::span<RapidNode> nodes) noexcept {
+        for (RapidNode& node : nodes) {
+            if (node.hash == 0) node.hash = hashKey(node.key);
+        }
+    }
+
+} // namespace RiRi
+
+
 namespace RiRi::Internal {
 
-    ankerl::unordered_dense::map<
-        std::string,
-        RapidDataType,
-        RapidHash,
-        std::equal_to<>
-    > MemoryMap = [] {
-        ankerl::unordered_dense::map<
-            std::string,
-            RapidDataType,
-            RapidHash,
-            std::equal_to<>
-        > map;
-        map.reserve(DEFAULT_MEMORY_CAPACITY);
-        // NOTE: The size is reserved to avoid rehashing during runtime.
-        // This is a small size, for development purposes.
-        // Adjust the size based on the expected number of entries
-        return map;
-    } ();
+    namespace {
+
+        StoreOptions normalized(StoreOptions options) noexcept {
+            options.shardCount = std::bit_ceil(options.shardCount ? options.shardCount : 1);
+            options.maxLoadFactor = std::clamp(options.maxLoadFactor, 0.1f, 0.99f);
+            options.expirySweepInterval = std::max(options.expirySweepInterval, std::chrono::milliseconds{0});
+            options.memoryWarningRatio = std::clamp(options.memoryWarningRatio, 0.0f, 1.0f);
+            options.compactBelow = std::clamp(options.compactBelow, 0.0f, 0.25f);
+            return options;
+        }
+
+        /// Keys `map` takes before its buckets have to grow, the same number ankerl works with.
+        [[nodiscard]] std::size_t bucketCapacity(const RapidMap& map) noexcept {
+            return static_cast<std::size_t>(static_cast<float>(map.bucket_count()) * map.max_load_factor());
+        }
+
+        /// Buckets `map` would reserve for `keys` keys (the smallest power of two they fit in at its load factor).
+        [[nodiscard]] std::size_t bucketsFor(const RapidMap& map, const std::size_t keys) noexcept {
+            return std::bit_ceil(static_cast<std::size_t>(std::ceil(static_cast<float>(keys) / map.max_load_factor())));
+        }
+
+    } // namespace
+
+
+    void RapidTable::configure(const float maxLoadFactor, const std::size_t capacity, const bool incremental, const RapidMap::allocator_type& pages) {
+        _incremental = incremental;
+        // both tables, and every table they're replaced with, keep this allocator
+        _map = RapidMap(pages);
+        _draining = RapidMap(pages);
+        _map.max_load_factor(maxLoadFactor);    // before reserving, it sizes the buckets
+        _map.reserve(capacity);
+        _draining.max_load_factor(maxLoadFactor);
+        _floor = capacity;
+    }
+
+
+    const RapidTable::value_type* RapidTable::find(const RapidHashedKey& key) const noexcept {
+        if (const auto it = _map.find(key); it != _map.end()) return &*it;
+        if (_draining.empty()) return nullptr;
+        const auto it = _draining.find(key);
+        return it == _draining.end() ? nullptr : &*it;
+    }
+
+
+    RapidTable::iterator RapidTable::findForWrite(const RapidHashedKey& key) noexcept {
+        if (rehashing()) {
+            rehashStep(REHASH_STEP);
+            if (const auto old = _draining.find(key); old != _draining.end()) {
+                // pull it over right now, writers only ever touch the new table
+                const value_type entry = *old;
+                _draining.erase(key);
+                return _map.try_emplace(RapidMovedKey{entry.first, key.hash}, entry.second).first;
+            }
+        }
+        return _map.find(key);
+    }
+
+
+    std::pair<RapidTable::iterator, bool> RapidTable::insert(const RapidSlabKey& key) noexcept {
+        if (rehashing()) {
+            if (const iterator it = findForWrite({key.key, key.hash}); it != _map.end()) return {it, false};
+        } else if (_incremental && _map.size() >= MIN_INCREMENTAL_SIZE && _map.size() >= capacity()) {
+            startRehash(_map.size() * 2);
+        }
+        // the new table has room for twice the old one, and the old one empties at REHASH_STEP
+        // entries per write, so it's always gone long before the new one fills up
+        try {
+            return _map.try_emplace(key);
+        } catch (const std::bad_alloc&) {
+            return {_map.end(), false};
+        }
+    }
+
+
+    void RapidTable::reserve(const std::size_t keys) noexcept {
+        if (keys <= capacity()) return;
+        rehashStep(_draining.size());           // one table left to grow
+        _map.reserve(keys);
+        _map.reserve(bucketCapacity(_map));     // line the values vector up with the buckets
+    }
+
+
+    void RapidTable::clear() noexcept {
+        _map.clear();
+        _draining = RapidMap(_map.get_allocator());
+        _draining.max_load_factor(_map.max_load_factor());
+    }
+
+
+    std::size_t RapidTable::capacity() const noexcept {
+        // a full values vector means a reallocation (copying every entry), as bad as full buckets
+        return std::min(bucketCapacity(_map), _map.values().capacity());
+    }
+
+
+    std::size_t RapidTable::bucketBytes() const noexcept {
+        return (_map.bucket_count() + _draining.bucket_count()) * sizeof(RapidMap::bucket_type);
+    }
+
+
+    std::size_t RapidTable::entryBytes() const noexcept {
+        return (_map.values().capacity() + _draining.values().capacity()) * sizeof(value_type);
+    }
+
+
+    bool RapidTable::sparse(const float lowWater) const noexcept {
+        if (rehashing()) return false;
+        // and a shrink really ends up with fewer buckets, or every check would start one that changes nothing
+        return static_cast<float>(_map.size()) < lowWater * static_cast<float>(capacity())
+            && bucketsFor(_map, shrunkSize()) < _map.bucket_count();
+    }
+
+
+    void RapidTable::startShrink() noexcept {
+        RIRI_ASSERT(!rehashing());
+        startRehash(shrunkSize());
+        rehashStep(0);      // nothing to move over (an empty table): lets go of the old one right away
+    }
+
+
+    void RapidTable::startRehash(const std::size_t keys) noexcept {
+        const float max_load_factor = _map.max_load_factor();
+
+        ++_rehashes;
+        _draining = std::move(_map);            // leaves _map empty, with ankerl's default load factor
+        _map.max_load_factor(max_load_factor);
+        _map.reserve(keys);
+        _map.reserve(bucketCapacity(_map));     // line the values vector up with the buckets
+    }
+
+
+    void RapidTable::rehashStep(std::size_t entries) noexcept {
+        for (; entries > 0 && !_draining.empty(); --entries) {
+            // always the last entry, so erasing it doesn't shuffle anything around
+            const value_type entry = _draining.values().back();
+            const std::size_t hash = RapidHash{}(entry.first);
+            _draining.erase(RapidHashedKey{entry.first.view(), hash});
+            _map.try_emplace(RapidMovedKey{entry.first, hash}, entry.second);
+        }
+        if (_draining.empty()) {
+            _draining = RapidMap(_map.get_allocator());             // done, give the old table's memory back
+            _draining.max_load_factor(_map.max_load_factor());
+        }
+    }
+
+
+    RapidStore::RapidStore(const StoreOptions& options)
+    : _options(normalized(options)),
+      _shards(std::make_unique<RapidShard[]>(_options.shardCount)),
+      _shard_mask(_options.shardCount - 1),
+      _numa(_options.numaAware && numaNodes().size() > 1)
+    {
+        for (std::size_t i = 0; i <= _shard_mask; ++i) {
+            setUp(i, _shards[i].map, _shards[i].slab);
+            _shards[i].compactBelow = _options.compactBelow;
+            if (_options.concurrentReads) _shards[i].reads = std::make_unique<RapidReadIndex>();
+            if (_options.valueIndex) _shards[i].values = std::make_unique<RapidValueIndex>();
+            if (_options.orderedIndex) _shards[i].ordered = std::make_unique<RapidOrderedIndex>();
+        }
+
+        if (_options.maxMemory != 0) {
+            _shard_budget = std::max<std::size_t>(_options.maxMemory / shardCount(), 1);
+            if (_options.memoryWarningRatio < 1.0f) {
+                _shard_warning = static_cast<std::size_t>(static_cast<double>(_shard_budget) * _options.memoryWarningRatio);
+            }
+        }
+
+        if (_options.expirySweepInterval.count() == 0) return;
+        _sweeper = std::jthread([this](const std::stop_token stop) {
+            std::mutex mutex;       // only there because condition variables want one
+            std::condition_variable_any wake;
+            std::unique_lock lock(mutex);
+            while (!wake.wait_for(lock, stop, _options.expirySweepInterval, [&stop] { return stop.stop_requested(); })) {
+                expireKeys(*this);
+            }
+        });
+    }
+
+
+    void RapidStore::setUp(const std::size_t index, RapidTable& map, RapidSlab& slab) const {
+        // keys are spread uniformly over the shards, so is the reservation
+        const std::size_t per_shard = (_options.initialCapacity + _shard_mask) / (_shard_mask + 1);
+        // a NUMA node's shards get all their big allocations from it, whoever touches them first
+        const int node = shardNode(index);
+        slab.setNode(node);
+        map.configure(_options.maxLoadFactor, per_shard, _options.incrementalRehash, RapidMap::allocator_type(_options.hugePages, node));
+    }
+
+
+    RapidStore MemoryMap({
+        .initialCapacity = DEFAULT_MEMORY_CAPACITY,
+        .concurrentReads = DEFAULT_CONCURRENT_READS,
+        .numaAware = DEFAULT_NUMA_AWARE
+    });
+    // NOTE: The size is reserved to avoid rehashing during runtime.
+    // This is a small size, for development purposes.
+    // Adjust the size based on the expected number of entries
 
 } // namespace RiRi::Internal
 
@@ -40,7 +255,7 @@ namespace RiRi::Internal {
 //         RapidHash,
 //         std::equal_to<>
 //     > map;
-//     map.reserve(DEFAULT_COMMAND_CAPACITY);
+//     map.reserve(DEFAULT_MEMORY_CAPACITY);
 //     // NOTE: The reserved size is small because we expect a limited number of commands.
 //     // This can be adjusted based on the expected number of commands.
 //     // Make sure to adjust the size if you add more commands.
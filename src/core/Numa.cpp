@@ -0,0 +1,116 @@
+#include "Numa.h"
+#include "PageAllocator.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#ifdef RIRI_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        constexpr int MPOL_PREFERRED_MODE = 1;      // MPOL_PREFERRED, <numaif.h> isn't always around
+        constexpr std::size_t MASK_BITS = sizeof(unsigned long) * 8;
+
+#if !defined(RIRI_LIBNUMA) && defined(__linux__)
+        /// A sysfs list like `0-3,8,10-11`, expanded; empty if the file isn't there.
+        [[nodiscard]] std::vector<int> readList(const std::string& path) {
+            std::vector<int> list;
+            std::FILE* file = std::fopen(path.c_str(), "r");
+            if (!file) return list;
+            int first = 0;
+            while (std::fscanf(file, "%d", &first) == 1) {
+                int last = first;
+                int separator = std::fgetc(file);
+                if (separator == '-') {
+                    if (std::fscanf(file, "%d", &last) != 1) break;
+                    separator = std::fgetc(file);
+                }
+                for (int n = first; n <= last; ++n) list.push_back(n);
+                if (separator != ',') break;
+            }
+            std::fclose(file);
+            return list;
+        }
+#endif
+
+        [[nodiscard]] std::vector<int> discoverNodes() {
+            std::vector<int> nodes;
+#ifdef RIRI_LIBNUMA
+            if (numa_available() >= 0) {
+                for (int n = 0; n <= numa_max_node(); ++n) {
+                    if (numa_node_size64(n, nullptr) > 0) nodes.push_back(n);
+                }
+            }
+#elif defined(__linux__)
+            nodes = readList("/sys/devices/system/node/has_memory");
+#endif
+            if (nodes.empty()) nodes.push_back(0);
+            return nodes;
+        }
+
+    } // namespace
+
+
+    const std::vector<int>& numaNodes() noexcept {
+        static const std::vector<int> nodes = discoverNodes();
+        return nodes;
+    }
+
+
+    bool bindToNode(void* pages, const std::size_t bytes, const int node) noexcept {
+#ifdef __linux__
+        if (node < 0) return false;
+        const auto start = reinterpret_cast<std::uintptr_t>(pages);
+        const std::uintptr_t first = (start + BASE_PAGE_SIZE - 1) & ~(BASE_PAGE_SIZE - 1);
+        const std::uintptr_t last = (start + bytes) & ~(BASE_PAGE_SIZE - 1);
+        if (first >= last) return false;
+
+        unsigned long mask[4] = {};     // 256 nodes
+        if (static_cast<std::size_t>(node) >= sizeof(mask) * 8) return false;
+        mask[node / MASK_BITS] = 1UL << (node % MASK_BITS);
+#ifdef RIRI_LIBNUMA
+        return mbind(reinterpret_cast<void*>(first), last - first, MPOL_PREFERRED_MODE, mask, sizeof(mask) * 8, 0) == 0;
+#else
+        return syscall(SYS_mbind, first, last - first, MPOL_PREFERRED_MODE, mask, sizeof(mask) * 8, 0) == 0;
+#endif
+#else
+        (void)pages; (void)bytes; (void)node;
+        return false;
+#endif
+    }
+
+
+    bool runOnNode(const int node) noexcept {
+#ifdef RIRI_LIBNUMA
+        return numa_available() >= 0 && numa_run_on_node(node) == 0;
+#elif defined(__linux__)
+        if (node < 0) return false;
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        try {
+            for (const int cpu : readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+                if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+            }
+        } catch (...) {
+            return false;
+        }
+        return CPU_COUNT(&cpus) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+        (void)node;
+        return false;
+#endif
+    }
+
+} // namespace RiRi::Internal
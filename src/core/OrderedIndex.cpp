@@ -0,0 +1,199 @@
+#include "OrderedIndex.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        [[nodiscard]] bool before(const RapidSlabString& lhs, const std::string_view rhs) noexcept {
+            return lhs.view() < rhs;
+        }
+
+    } // namespace
+
+
+    std::uint32_t RapidOrderedIndex::route(const Inner& node, const std::string_view key) noexcept {
+        const auto* separators = node.separators.data();
+        return static_cast<std::uint32_t>(std::upper_bound(separators, separators + node.count - 1, key,
+            [](const std::string_view k, const std::string& separator) { return k < separator; }) - separators);
+    }
+
+
+    RapidOrderedIndex::Leaf* RapidOrderedIndex::descend(const std::string_view key, std::array<Step, MAX_DEPTH>& path, std::size_t& depth) const noexcept {
+        depth = 0;
+        Node* node = _root;
+        while (!node->leaf) {
+            auto* inner = static_cast<Inner*>(node);
+            const std::uint32_t child = route(*inner, key);
+            path[depth++] = {inner, child};
+            node = inner->children[child];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+
+    void RapidOrderedIndex::seek(const std::string_view from, const Leaf*& leaf, std::size_t& i) const noexcept {
+        if (_root == nullptr) return;
+        std::array<Step, MAX_DEPTH> path;
+        std::size_t depth;
+        leaf = descend(from, path, depth);
+        i = static_cast<std::size_t>(std::lower_bound(leaf->keys.data(), leaf->keys.data() + leaf->count, from, before) - leaf->keys.data());
+    }
+
+
+    bool RapidOrderedIndex::insert(const RapidSlabString key) noexcept {
+        try {
+            if (_root == nullptr) _root = new Leaf;
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+
+        std::array<Step, MAX_DEPTH> path;
+        std::size_t depth;
+        Leaf* leaf = descend(key.view(), path, depth);
+        RapidSlabString* keys = leaf->keys.data();
+        RapidSlabString* at = std::lower_bound(keys, keys + leaf->count, key.view(), before);
+        constexpr std::uint32_t HALF = FANOUT / 2;
+
+        // a split needs a leaf, a separator, a node for every full one above (and a root, if they all
+        // are): they come first, so out of memory the tree is just as it was
+        std::unique_ptr<Leaf> fresh;
+        std::string separator;
+        std::array<std::unique_ptr<Inner>, MAX_DEPTH + 1> spares;
+        std::size_t spare = 0;
+        if (leaf->count + 1 == FANOUT) {
+            try {
+                fresh = std::make_unique<Leaf>();
+                // the key the upper half starts with, once `key` is in
+                const auto i = static_cast<std::uint32_t>(at - keys);
+                separator.assign(i == HALF ? key.view() : keys[i < HALF ? HALF - 1 : HALF].view());
+                std::size_t full = 0;
+                while (full < depth && path[depth - 1 - full].node->count + 1 == FANOUT) ++full;
+                for (std::size_t n = 0; n < full + (full == depth ? 1 : 0); ++n) spares[n] = std::make_unique<Inner>();
+            } catch (const std::bad_alloc&) {
+                return false;
+            }
+        }
+
+        std::move_backward(at, keys + leaf->count, keys + leaf->count + 1);
+        *at = key;
+        ++leaf->count;
+        ++_size;
+        if (leaf->count < FANOUT) return true;
+
+        // full: the upper half moves to a new leaf right after it
+        Leaf* right = fresh.release();
+        std::copy(keys + HALF, keys + FANOUT, right->keys.data());
+        right->count = FANOUT - HALF;
+        leaf->count = HALF;
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = right;
+        leaf->next = right;
+
+        Node* added = right;
+        while (depth > 0) {
+            const auto [parent, child] = path[--depth];
+            // `added` goes right after `child`, its separator right before it
+            std::move_backward(parent->children.data() + child + 1, parent->children.data() + parent->count, parent->children.data() + parent->count + 1);
+            std::move_backward(parent->separators.data() + child, parent->separators.data() + parent->count - 1, parent->separators.data() + parent->count);
+            parent->children[child + 1] = added;
+            parent->separators[child] = std::move(separator);
+            if (++parent->count < FANOUT) return true;
+
+            // full too: split it, the separator between the halves moves up a level
+            Inner* sibling = spares[spare++].release();
+            std::move(parent->children.data() + HALF, parent->children.data() + FANOUT, sibling->children.data());
+            std::move(parent->separators.data() + HALF, parent->separators.data() + FANOUT - 1, sibling->separators.data());
+            sibling->count = FANOUT - HALF;
+            parent->count = HALF;
+            separator = std::move(parent->separators[HALF - 1]);
+            added = sibling;
+        }
+
+        // the root split, the tree grows a level
+        Inner* root = spares[spare].release();
+        root->children[0] = _root;
+        root->children[1] = added;
+        root->separators[0] = std::move(separator);
+        root->count = 2;
+        _root = root;
+        return true;
+    }
+
+
+    void RapidOrderedIndex::erase(const std::string_view key) noexcept {
+        if (_root == nullptr) return;
+
+        std::array<Step, MAX_DEPTH> path;
+        std::size_t depth;
+        Leaf* leaf = descend(key, path, depth);
+        RapidSlabString* keys = leaf->keys.data();
+        RapidSlabString* at = std::lower_bound(keys, keys + leaf->count, key, before);
+        if (at == keys + leaf->count || at->view() != key) return;
+        std::move(at + 1, keys + leaf->count, at);
+        --leaf->count;
+        --_size;
+        if (leaf->count > 0 || depth == 0) return;      // an empty root leaf stays
+
+        // an empty leaf goes, and so does every inner node that has no children left because of it
+        if (leaf->prev != nullptr) leaf->prev->next = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = leaf->prev;
+        delete leaf;
+        while (depth > 0) {
+            const auto [parent, child] = path[--depth];
+            std::move(parent->children.data() + child + 1, parent->children.data() + parent->count, parent->children.data() + child);
+            // the separator in front of the child goes, or the one after it for the first child
+            const std::uint32_t separator = child > 0 ? child - 1 : 0;
+            if (parent->count > 1) {
+                std::move(parent->separators.data() + separator + 1, parent->separators.data() + parent->count - 1, parent->separators.data() + separator);
+            }
+            if (--parent->count > 0) break;
+            if (parent == _root) _root = nullptr;
+            delete parent;
+        }
+
+        // a root with a single child is a level too many
+        while (_root != nullptr && !_root->leaf && _root->count == 1) {
+            auto* root = static_cast<Inner*>(_root);
+            _root = root->children[0];
+            delete root;
+        }
+    }
+
+
+    void RapidOrderedIndex::rekey(const RapidSlabString key) noexcept {
+        if (_root == nullptr) return;
+        std::array<Step, MAX_DEPTH> path;
+        std::size_t depth;
+        Leaf* leaf = descend(key.view(), path, depth);
+        RapidSlabString* keys = leaf->keys.data();
+        RapidSlabString* at = std::lower_bound(keys, keys + leaf->count, key.view(), before);
+        if (at != keys + leaf->count && at->view() == key.view()) *at = key;
+    }
+
+
+    void RapidOrderedIndex::clear() noexcept {
+        destroy(_root);
+        _root = nullptr;
+        _size = 0;
+    }
+
+
+    void RapidOrderedIndex::destroy(Node* node) noexcept {
+        if (node == nullptr) return;
+        if (node->leaf) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        auto* inner = static_cast<Inner*>(node);
+        for (std::uint32_t i = 0; i < inner->count; ++i) destroy(inner->children[i]);
+        delete inner;
+    }
+
+} // namespace RiRi::Internal
@@ -0,0 +1,88 @@
+#include "PageAllocator.h"
+#include "Numa.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        // the huge page pool is usually empty: one failed MAP_HUGETLB and we stop paying for the syscall
+        std::atomic<bool> explicit_pages{true};
+
+    } // namespace
+
+
+#ifdef __linux__
+
+    void* mapHugePages(const std::size_t bytes, const int node) noexcept {
+        if (explicit_pages.load(std::memory_order_relaxed)) {
+            void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (pages != MAP_FAILED) {
+                bindToNode(pages, bytes, node);     // before anything touches them, so they all follow it
+                return pages;
+            }
+            explicit_pages.store(false, std::memory_order_relaxed);
+        }
+
+        // transparent ones only back 2MB aligned ranges: map a page more than asked, trim both ends
+        const std::size_t mapped = bytes + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        const auto start = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        if (aligned != start) munmap(raw, aligned - start);
+        if (const std::size_t tail = start + mapped - (aligned + bytes); tail != 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+
+        auto* pages = reinterpret_cast<void*>(aligned);
+        madvise(pages, bytes, MADV_HUGEPAGE);      // fails if THP is off, which leaves plain pages: fine
+        bindToNode(pages, bytes, node);
+        return pages;
+    }
+
+
+    void* mapPages(const std::size_t bytes, const int node) noexcept {
+        void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED) return nullptr;
+        bindToNode(pages, bytes, node);
+        return pages;
+    }
+
+
+    void unmapPages(void* pages, const std::size_t bytes) noexcept {
+        munmap(pages, bytes);
+    }
+
+#else
+
+    // no pages to ask for: aligned heap blocks (all the same alignment, so unmapPages() needn't know), the rest works the same
+    void* mapHugePages(const std::size_t bytes, int) noexcept {
+        explicit_pages.store(false, std::memory_order_relaxed);
+        return ::operator new(bytes, std::align_val_t{HUGE_PAGE_SIZE}, std::nothrow);
+    }
+
+
+    void* mapPages(const std::size_t bytes, int) noexcept {
+        return ::operator new(bytes, std::align_val_t{HUGE_PAGE_SIZE}, std::nothrow);
+    }
+
+
+    void unmapPages(void* pages, const std::size_t bytes) noexcept {
+        ::operator delete(pages, bytes, std::align_val_t{HUGE_PAGE_SIZE});
+    }
+
+#endif
+
+
+    bool explicitHugePages() noexcept {
+        return explicit_pages.load(std::memory_order_relaxed);
+    }
+
+} // namespace RiRi::Internal
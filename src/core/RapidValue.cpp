@@ -0,0 +1,245 @@
+#include "RapidValue.h"
+#include "DataManager.h"
+#include "Reclaimer.h"
+
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        /**
+         * @brief Per-thread home of the values handed out by reads.
+         *
+         * A deque, because growing it never moves the slots already handed out in the same read. The
+         * thread holds one reference, every response with values in it another (`readLease()`); the
+         * last one to let go frees it, so a response may outlive both the next read and the thread.
+         */
+        struct ReadBuffer : Response::Leased {
+            std::deque<RapidDataType> slots;
+            std::size_t used = 0;
+
+            ReadBuffer() noexcept {
+                destroy = [](Response::Leased* self) noexcept { delete static_cast<ReadBuffer*>(self); };
+            }
+        };
+
+        /// The calling thread's current buffer, and its reference to it.
+        struct ThreadReadBuffer {
+            ReadBuffer* current = new ReadBuffer;
+            bool starved = false;       // the current read was short of memory for a snapshot
+
+            ~ThreadReadBuffer() {
+                if (current->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete current;
+            }
+        };
+
+        ThreadReadBuffer& threadReadBuffer() {
+            thread_local ThreadReadBuffer buffer;
+            return buffer;
+        }
+
+        ReadBuffer& readBuffer() {
+            return *threadReadBuffer().current;
+        }
+
+        /// `loadValue()` for a string: `out` keeps the capacity it has; out of memory, `false` and it's as it was.
+        bool loadString(const std::string_view str, RapidDataType& out) noexcept {
+            try {
+                if (auto* existing = std::get_if<std::string>(&out)) {
+                    existing->assign(str);
+                } else {
+                    std::string copy(str);      // before `out` lets go of what it holds
+                    out.emplace<std::string>(std::move(copy));
+                }
+                return true;
+            } catch (const std::bad_alloc&) {
+                return false;
+            }
+        }
+
+        /// The next free slot of the calling thread's read buffer; `nullptr` (and a starved read) if out of memory.
+        RapidDataType* takeSlot() noexcept {
+            ReadBuffer& buffer = readBuffer();
+            try {
+                if (buffer.used == buffer.slots.size()) buffer.slots.emplace_back();
+            } catch (const std::bad_alloc&) {
+                starveRead();
+                return nullptr;
+            }
+            return &buffer.slots[buffer.used++];
+        }
+
+    } // namespace
+
+
+    bool storeValue(RapidSlab& slab, const RapidDataType& value, RapidCell& cell) noexcept {
+        return std::visit([&slab, &cell](const auto& v) -> bool {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                if (v.size() <= RapidCell::INLINE_CAPACITY) cell = RapidCell::ofInline(v);
+                else if (RapidSlabString copy; slabCopy(slab, v, copy)) cell = RapidCell::ofSlab(copy);
+                else return false;
+            }
+            else if constexpr (std::is_same_v<T, std::int64_t>) cell = RapidCell::ofInt(v);
+            else if constexpr (std::is_same_v<T, double>) cell = RapidCell::ofDouble(v);
+            else cell = RapidCell::ofBool(v);
+            return true;
+        }, value);
+    }
+
+
+    void freeValue(RapidSlab& slab, const RapidCell& value) noexcept {
+        if (value.inSlab()) slabFree(slab, value.asSlabString());
+    }
+
+
+    bool loadValue(const RapidCell& value, RapidDataType& out) noexcept {
+        switch (value.kind()) {
+            case RapidCell::Kind::String: return loadString(value.asString(), out);
+            case RapidCell::Kind::Int:    out = value.asInt(); return true;
+            case RapidCell::Kind::Double: out = value.asDouble(); return true;
+            case RapidCell::Kind::Bool:   out = value.asBool(); return true;
+        }
+        return true;
+    }
+
+
+    bool loadValue(const RapidDataType& value, RapidDataType& out) noexcept {
+        if (const auto* str = std::get_if<std::string>(&value)) return loadString(*str, out);
+        out = value;        // a number, nothing to allocate
+        return true;
+    }
+
+
+    bool sameValue(const RapidCell& value, const RapidDataType& other) noexcept {
+        // kinds follow the alternative order of RapidDataType
+        if (static_cast<std::size_t>(value.kind()) != other.index()) return false;
+        switch (value.kind()) {
+            case RapidCell::Kind::String: return value.asString() == std::get<std::string>(other);
+            case RapidCell::Kind::Int:    return value.asInt() == std::get<std::int64_t>(other);
+            case RapidCell::Kind::Double: return value.asDouble() == std::get<double>(other);
+            case RapidCell::Kind::Bool:   return value.asBool() == std::get<bool>(other);
+        }
+        return false;
+    }
+
+
+    bool spliceValue(RapidSlab& slab, const RapidCell& value, const std::size_t offset, const std::string_view bytes, const std::size_t size, RapidCell& cell) noexcept {
+        RIRI_ASSERT(value.kind() == RapidCell::Kind::String && size >= value.asString().size() && size >= offset + bytes.size());
+        const std::size_t old_size = value.asString().size();
+        char* data;
+        char inline_bytes[RapidCell::INLINE_CAPACITY];
+        if (size <= RapidCell::INLINE_CAPACITY) {
+            data = inline_bytes;
+            std::memcpy(data, value.asString().data(), old_size);
+        } else if (value.inSlab()) {
+            data = slab.grow(const_cast<char*>(value.asSlabString().data), old_size, size);
+        } else {
+            data = slab.allocate(size);         // outgrew its cell
+            if (data != nullptr) std::memcpy(data, value.asString().data(), old_size);
+        }
+        if (data == nullptr) return false;      // only ever before a single byte was written
+
+        if (offset > old_size) std::memset(data + old_size, 0, offset - old_size);
+        std::memcpy(data + offset, bytes.data(), bytes.size());
+
+        cell = size <= RapidCell::INLINE_CAPACITY
+            ? RapidCell::ofInline({data, size})
+            : RapidCell::ofSlab({data, static_cast<std::uint32_t>(size)});
+        cell.setExpires(value.expires());
+        return true;
+    }
+
+
+    void beginRead() noexcept {
+        ThreadReadBuffer& buffer = threadReadBuffer();
+        buffer.starved = false;
+        if (epochPinned()) return;
+        // nobody holds the previous read's values anymore: reuse the slots (and their strings' capacity)
+        if (buffer.current->refs.load(std::memory_order_acquire) == 1) {
+            buffer.current->used = 0;
+            return;
+        }
+        // somebody does: leave it to them, they free it; out of memory for a new one, this read's
+        // values pile up behind theirs instead (more slots never move the ones handed out)
+        ReadBuffer* fresh = new (std::nothrow) ReadBuffer;
+        if (fresh == nullptr) return;
+        buffer.current->refs.fetch_sub(1, std::memory_order_acq_rel);
+        buffer.current = fresh;
+    }
+
+
+    void starveRead() noexcept {
+        threadReadBuffer().starved = true;
+    }
+
+
+    bool readStarved() noexcept {
+        return threadReadBuffer().starved;
+    }
+
+
+    Response::Lease readLease() noexcept {
+        ReadBuffer& buffer = readBuffer();
+        return buffer.used == 0 ? Response::Lease() : Response::Lease(&buffer);
+    }
+
+
+    const RapidDataType* snapshotValue(const RapidCell& value) noexcept {
+        RapidDataType* slot = takeSlot();
+        if (slot == nullptr) return nullptr;
+        if (loadValue(value, *slot)) return slot;
+        starveRead();
+        return nullptr;
+    }
+
+
+    const RapidDataType* snapshotValue(const RapidDataType& value) noexcept {
+        RapidDataType* slot = takeSlot();
+        if (slot == nullptr) return nullptr;
+        if (loadValue(value, *slot)) return slot;
+        starveRead();
+        return nullptr;
+    }
+
+
+    std::string_view snapshotString(const std::string_view str) noexcept {
+        RapidDataType* slot = takeSlot();
+        if (slot == nullptr) return {};
+        if (loadString(str, *slot)) return std::get<std::string>(*slot);
+        starveRead();
+        return {};
+    }
+
+
+    const RapidDataType* snapshotNumber(RapidDataType number, const bool fresh) noexcept {
+        RIRI_ASSERT(!std::holds_alternative<std::string>(number));
+        if (fresh) beginRead();
+        RapidDataType* slot = takeSlot();
+        if (slot != nullptr) *slot = number;
+        return slot;
+    }
+
+
+    bool claimSnapshots(const std::span<RapidDataType*> slots) noexcept {
+        ReadBuffer& buffer = readBuffer();
+        try {
+            if (buffer.slots.size() < buffer.used + slots.size()) buffer.slots.resize(buffer.used + slots.size());
+        } catch (const std::bad_alloc&) {
+            starveRead();
+            return false;
+        }
+        for (RapidDataType*& slot : slots) slot = &buffer.slots[buffer.used++];
+        return true;
+    }
+
+} // namespace RiRi::Internal
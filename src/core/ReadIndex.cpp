@@ -0,0 +1,299 @@
+#include "ReadIndex.h"
+#include "Expiry.h"
+#include "KeyCompare.h"
+#include "LazyFree.h"
+#include "Reclaimer.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <new>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        constexpr std::size_t MIN_READ_TABLE_CAPACITY = 16;
+
+        /// Slots of a cleared table the background freer goes through per step.
+        constexpr std::size_t FREE_STEP_SLOTS = 4096;
+
+        /// Marks an erased slot; probes walk over it, inserts may reuse it.
+        const RapidReadEntry Tombstone{};
+
+        RapidReadTable* makeTable(const std::size_t capacity) {
+            auto table = std::make_unique<RapidReadTable>();
+            table->mask = capacity - 1;
+            table->shift = std::numeric_limits<std::size_t>::digits - std::countr_zero(capacity);
+            table->slots = std::make_unique<std::atomic<const RapidReadEntry*>[]>(capacity);    // all nullptr
+            return table.release();
+        }
+
+        [[nodiscard]] bool isLive(const RapidReadEntry* entry) noexcept {
+            return entry != nullptr && entry != &Tombstone;
+        }
+
+        [[nodiscard]] std::size_t home(const RapidReadTable& table, const std::size_t hash) noexcept {
+            // a shift by the full width is UB, a table of one slot never exists so this never happens
+            return hash >> table.shift;
+        }
+
+        /// The entry of `key` in `table`, TTL or not; `nullptr` if it isn't there. Reader side.
+        [[nodiscard]] const RapidReadEntry* lookUp(const RapidReadTable& table, const std::string_view key, const std::size_t hash) noexcept {
+            std::size_t i = home(table, hash);
+
+            // bounded: the writer keeps at least half of the slots empty
+            for (std::size_t probes = 0; probes <= table.mask; ++probes, i = (i + 1) & table.mask) {
+                const RapidReadEntry* entry = table.slots[i].load(std::memory_order_acquire);
+                if (entry == nullptr) return nullptr;       // end of the chain, key not found
+                if (entry != &Tombstone && entry->hash == hash && sameKey(entry->key, key)) return entry;
+            }
+            return nullptr;
+        }
+
+        /// The slot of `key` in `table`, past the last slot if it isn't there. Writer side.
+        [[nodiscard]] std::size_t slotOf(const RapidReadTable& table, const std::string_view key, const std::size_t hash) noexcept {
+            for (std::size_t i = home(table, hash);; i = (i + 1) & table.mask) {
+                const RapidReadEntry* entry = table.slots[i].load(std::memory_order_relaxed);
+                if (entry == nullptr) return table.mask + 1;
+                if (entry != &Tombstone && entry->hash == hash && sameKey(entry->key, key)) return i;
+            }
+        }
+
+        /// Puts `entry`, whose key isn't in `table`, in the first free slot of its chain. Writer side.
+        void place(RapidReadTable& table, const RapidReadEntry* entry) noexcept {
+            std::size_t i = home(table, entry->hash);
+            for (;; i = (i + 1) & table.mask) {
+                const RapidReadEntry* taken = table.slots[i].load(std::memory_order_relaxed);
+                if (taken == &Tombstone) break;
+                if (taken == nullptr) {
+                    ++table.used;
+                    break;
+                }
+            }
+            table.slots[i].store(entry, std::memory_order_release);
+            ++table.live;
+        }
+
+        // Deleters handed to the reclaimer, plain functions, no captures.
+
+        void deleteEntry(void* entry) {
+            delete static_cast<RapidReadEntry*>(entry);
+        }
+
+        void deleteTable(void* table) {
+            delete static_cast<RapidReadTable*>(table);
+        }
+
+        void deleteTableAndEntries(void* ptr) {
+            auto* table = static_cast<RapidReadTable*>(ptr);
+            for (std::size_t i = 0; i <= table->mask; ++i) {
+                const RapidReadEntry* entry = table->slots[i].load(std::memory_order_relaxed);
+                if (isLive(entry)) delete entry;
+            }
+            delete table;
+        }
+
+        // Once no reader can see them, the big ones go to the background freer instead.
+
+        bool freeTableStep(void* ptr) noexcept {
+            auto* table = static_cast<RapidReadTable*>(ptr);
+            // nobody else has the table by now: `used` counts the slots already gone through
+            const std::size_t end = std::min(table->mask + 1, table->used + FREE_STEP_SLOTS);
+            for (; table->used < end; ++table->used) {
+                const RapidReadEntry* entry = table->slots[table->used].load(std::memory_order_relaxed);
+                if (isLive(entry)) delete entry;
+            }
+            if (table->used <= table->mask) return false;
+            delete table;
+            return true;
+        }
+
+        void freeTableLater(void* ptr) {
+            static_cast<RapidReadTable*>(ptr)->used = 0;
+            lazyFree(ptr, freeTableStep);
+        }
+
+        void freeEntryLater(void* entry) {
+            lazyFree(entry, [](void* ptr) noexcept {
+                delete static_cast<RapidReadEntry*>(ptr);
+                return true;
+            });
+        }
+
+    } // namespace
+
+
+    RapidReadIndex::RapidReadIndex() : _table(makeTable(MIN_READ_TABLE_CAPACITY)) { }
+
+
+    RapidReadIndex::~RapidReadIndex() {
+        // nobody can be reading a store that is being destroyed, free right away
+        RapidReadTable* table = _table.load(std::memory_order_relaxed);
+        if (RapidReadTable* from = table->from.load(std::memory_order_relaxed)) deleteTableAndEntries(from);
+        deleteTableAndEntries(table);
+    }
+
+
+    const RapidDataType* RapidReadIndex::find(const std::string_view key, const std::size_t hash) const noexcept {
+        const RapidReadEntry* entry = findEntry(key, hash);
+        return entry != nullptr ? &entry->value : nullptr;
+    }
+
+
+    const RapidReadEntry* RapidReadIndex::findEntry(const std::string_view key, const std::size_t hash) const noexcept {
+        const RapidReadTable* table = _table.load(std::memory_order_acquire);
+        for (;;) {
+            // an entry moving over is in its new slot before it's gone from its old one: old table first
+            const RapidReadEntry* entry = nullptr;
+            if (const RapidReadTable* from = table->from.load(std::memory_order_acquire)) entry = lookUp(*from, key, hash);
+            if (entry == nullptr) entry = lookUp(*table, key, hash);
+
+            if (entry == nullptr) {
+                // a grow that started since may have moved it out from under us, into a table not looked at
+                const RapidReadTable* now = _table.load(std::memory_order_acquire);
+                if (now == table) return nullptr;
+                table = now;
+                continue;
+            }
+            // expired keys stay published until a writer gets to them, they're just not there anymore
+            const std::int64_t expiresAt = std::atomic_ref(entry->expiresAt).load(std::memory_order_relaxed);
+            if (expiresAt != 0 && expiresAt <= expiryNow()) return nullptr;
+            return entry;
+        }
+    }
+
+
+    void RapidReadIndex::prefetch(const std::size_t hash) const noexcept {
+        const RapidReadTable* table = _table.load(std::memory_order_acquire);
+        RIRI_PREFETCH(&table->slots[home(*table, hash)]);
+    }
+
+
+    void RapidReadIndex::prefetchEntry(const std::size_t hash) const noexcept {
+        const RapidReadTable* table = _table.load(std::memory_order_acquire);
+        const RapidReadEntry* entry = table->slots[home(*table, hash)].load(std::memory_order_acquire);
+        if (entry != nullptr && entry != &Tombstone) RIRI_PREFETCH(entry);
+    }
+
+
+    std::unique_ptr<RapidReadEntry> RapidReadIndex::prepare(const std::string_view key, const std::size_t hash, RapidDataType value) noexcept {
+        try {
+            // a publish that inserts must find the table at most half full after it, grow ahead of it
+            if (const RapidReadTable* table = _table.load(std::memory_order_relaxed); (table->used + 1) * 2 > table->mask + 1) grow();
+            return std::unique_ptr<RapidReadEntry>(new RapidReadEntry{hash, std::string(key), std::move(value)});
+        } catch (const std::bad_alloc&) {
+            return nullptr;     // the writer reports it, nothing changed
+        }
+    }
+
+
+    void RapidReadIndex::publish(std::unique_ptr<RapidReadEntry> entry, const std::int64_t expiresAt, const std::uint64_t version) noexcept {
+        RapidReadTable* table = _table.load(std::memory_order_relaxed);
+        RapidReadTable* from = table->from.load(std::memory_order_relaxed);
+        entry->expiresAt = expiresAt;
+        entry->version = version;
+
+        // a key that hasn't moved over yet is replaced where it is
+        RapidReadTable* in = from;
+        std::size_t i = from != nullptr ? slotOf(*from, entry->key, entry->hash) : SIZE_MAX;
+        if (from == nullptr || i > from->mask) {
+            in = table;
+            i = slotOf(*table, entry->key, entry->hash);
+        }
+
+        if (i <= in->mask) {
+            // replace, readers see either the old or the new entry, never a half-written one
+            const RapidReadEntry* old = in->slots[i].load(std::memory_order_relaxed);
+            entry->stamp = std::atomic_ref(old->stamp).load(std::memory_order_relaxed);
+            in->slots[i].store(entry.release(), std::memory_order_release);
+            epochRetire(const_cast<RapidReadEntry*>(old), deleteEntry);
+        } else {
+            place(*table, entry.release());     // `prepare()` made room for it
+        }
+
+        if (from != nullptr) moveSome(*table, GROW_STEP);
+    }
+
+
+    void RapidReadIndex::expire(const std::string_view key, const std::size_t hash, const std::int64_t expiresAt) noexcept {
+        RapidReadTable* table = _table.load(std::memory_order_relaxed);
+        for (RapidReadTable* in : {table->from.load(std::memory_order_relaxed), table}) {
+            if (in == nullptr) continue;
+            if (const std::size_t i = slotOf(*in, key, hash); i <= in->mask) {
+                std::atomic_ref(in->slots[i].load(std::memory_order_relaxed)->expiresAt).store(expiresAt, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+
+    void RapidReadIndex::erase(const std::string_view key, const std::size_t hash, const bool lazy) noexcept {
+        RapidReadTable* table = _table.load(std::memory_order_relaxed);
+        RapidReadTable* from = table->from.load(std::memory_order_relaxed);
+
+        // wherever it is, it's only ever in one of them
+        for (RapidReadTable* in : {from, table}) {
+            if (in == nullptr) continue;
+            const std::size_t i = slotOf(*in, key, hash);
+            if (i > in->mask) continue;                 // not there
+            const RapidReadEntry* entry = in->slots[i].load(std::memory_order_relaxed);
+            in->slots[i].store(&Tombstone, std::memory_order_release);
+            --in->live;
+            epochRetire(const_cast<RapidReadEntry*>(entry), lazy ? freeEntryLater : deleteEntry);
+            break;
+        }
+
+        if (from != nullptr) moveSome(*table, GROW_STEP);
+    }
+
+
+    void RapidReadIndex::clear() noexcept {
+        RapidReadTable* old = _table.exchange(makeTable(MIN_READ_TABLE_CAPACITY), std::memory_order_acq_rel);
+        // every entry they ever had: not on a writer's time
+        if (RapidReadTable* from = old->from.load(std::memory_order_relaxed)) epochRetire(from, freeTableLater);
+        epochRetire(old, freeTableLater);
+    }
+
+
+    bool RapidReadIndex::growing() const noexcept {
+        return _table.load(std::memory_order_relaxed)->from.load(std::memory_order_relaxed) != nullptr;
+    }
+
+
+    void RapidReadIndex::grow() {
+        RapidReadTable* old = _table.load(std::memory_order_relaxed);
+        const RapidReadTable* from = old->from.load(std::memory_order_relaxed);
+
+        // moving over also sweeps the tombstones out, so this may well be the same size, or smaller; not
+        // so much smaller that `GROW_STEP` slots per write wouldn't empty the old one before it fills up
+        const std::size_t live = old->live + (from != nullptr ? from->live : 0);
+        const std::size_t capacity = old->mask + 1;
+        RapidReadTable* table = makeTable(std::bit_ceil(std::max({MIN_READ_TABLE_CAPACITY, live * 4, capacity / 4})));
+
+        // one grow at a time; the sizes above make sure the last one is done by now, or close to it
+        if (from != nullptr) moveSome(*old, SIZE_MAX);
+        table->from.store(old, std::memory_order_relaxed);
+        _table.store(table, std::memory_order_release);
+    }
+
+
+    void RapidReadIndex::moveSome(RapidReadTable& table, std::size_t slots) noexcept {
+        RapidReadTable* from = table.from.load(std::memory_order_relaxed);
+        for (; slots > 0 && table.moved <= from->mask; --slots, ++table.moved) {
+            const RapidReadEntry* entry = from->slots[table.moved].load(std::memory_order_relaxed);
+            if (!isLive(entry)) continue;
+            // in its new slot first, out of its old one after, readers look in the old table first
+            place(table, entry);
+            from->slots[table.moved].store(&Tombstone, std::memory_order_release);
+            --from->live;
+        }
+        if (table.moved <= from->mask) return;
+
+        // entries are shared by both tables, only the old slot array goes
+        table.from.store(nullptr, std::memory_order_release);
+        epochRetire(from, deleteTable);
+    }
+
+} // namespace RiRi::Internal
@@ -0,0 +1,216 @@
+#include "Reclaimer.h"
+#include "riri/ReadGuard.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        /// An unpinned record carries this epoch; real epochs start at 1.
+        constexpr std::uint64_t QUIESCENT = 0;
+
+        /// Retiring this many objects (on one thread) triggers a collection attempt.
+        constexpr std::size_t COLLECT_THRESHOLD = 64;
+
+        /// Out of memory to queue something, how often a writer tries to get the epoch past it before giving up.
+        constexpr int WAIT_ATTEMPTS = 1000;
+
+        struct Retired {
+            void* ptr;
+            RapidDeleterFn deleter;
+            std::uint64_t epoch;
+        };
+
+        /**
+         * @brief One per thread, padded to full cache lines so that pinning never causes false sharing
+         * between readers. Records are never freed, only recycled by later threads.
+         *
+         * A record also holds what its thread retired, oldest first: the global epoch only goes up, so
+         * the thread's retire epochs do too, and freeing stops at the first one that's still too young.
+         * Its lock is the owner's alone but for `epochCollect()`/`epochPending()`, so writers on
+         * different threads never wait on each other to retire.
+         */
+        struct alignas(RIRI_CACHE_LINE_SIZE) EpochRecord {
+            std::atomic<std::uint64_t> epoch{QUIESCENT};
+            std::atomic<bool> claimed{true};
+            EpochRecord* next = nullptr;
+            std::uint32_t depth = 0;        // only ever touched by the owning thread
+
+            alignas(RIRI_CACHE_LINE_SIZE) std::mutex retiredLock;
+            std::deque<Retired> retired;    // guarded by retiredLock
+            std::size_t sinceCollect = 0;   // only ever touched by the owning thread
+        };
+
+        alignas(RIRI_CACHE_LINE_SIZE) std::atomic<std::uint64_t> GlobalEpoch{1};
+        std::atomic<EpochRecord*> Records{nullptr};
+
+        /// Whatever is still waiting at exit is freed then, no reader can be left by that point.
+        struct FreeAtExit {
+            ~FreeAtExit() {
+                for (EpochRecord* rec = Records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                    for (const auto& item : rec->retired) item.deleter(item.ptr);
+                    rec->retired.clear();
+                }
+            }
+        } FreeRetiredAtExit;
+
+        EpochRecord* acquireRecord() {
+            // recycle a record left behind by a dead thread first
+            for (EpochRecord* rec = Records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                bool expected = false;
+                if (rec->claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    return rec;
+                }
+            }
+            auto* rec = new EpochRecord();
+            rec->next = Records.load(std::memory_order_relaxed);
+            while (!Records.compare_exchange_weak(rec->next, rec, std::memory_order_release, std::memory_order_relaxed)) { }
+            return rec;
+        }
+
+        /// Claims a record on first use, gives it back when the thread exits.
+        struct ThreadRecord {
+            EpochRecord* rec = acquireRecord();
+            ~ThreadRecord() {
+                rec->depth = 0;
+                rec->epoch.store(QUIESCENT, std::memory_order_release);
+                rec->claimed.store(false, std::memory_order_release);
+            }
+        };
+
+        EpochRecord& localRecord() {
+            thread_local ThreadRecord local;
+            return *local.rec;
+        }
+
+        /// Advances the global epoch if every pinned reader has already observed the current one.
+        bool tryAdvance() noexcept {
+            const std::uint64_t current = GlobalEpoch.load(std::memory_order_acquire);
+            for (EpochRecord* rec = Records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                const std::uint64_t seen = rec->epoch.load(std::memory_order_acquire);
+                if (seen != QUIESCENT && seen != current) return false;     // a straggler
+            }
+            std::uint64_t expected = current;
+            GlobalEpoch.compare_exchange_strong(expected, current + 1, std::memory_order_acq_rel);
+            return true;
+        }
+
+        /**
+         * @brief Frees `ptr`, retired at `epoch`, on the spot: there was no memory to queue it.
+         *
+         * Only once the epoch moved twice past it, and only if the readers let it do so soon enough.
+         * Otherwise it leaks: a writer waiting on a reader who may be waiting on that writer's lock
+         * is worse. A pinned caller would wait on itself, it leaks right away.
+         */
+        void freeNow(void* ptr, const RapidDeleterFn deleter, const std::uint64_t epoch) noexcept {
+            if (localRecord().depth != 0) return;
+            for (int attempt = 0; attempt < WAIT_ATTEMPTS; ++attempt) {
+                if (GlobalEpoch.load(std::memory_order_acquire) >= epoch + 2) {
+                    deleter(ptr);
+                    return;
+                }
+                tryAdvance();
+                std::this_thread::yield();
+            }
+        }
+
+        /// Frees what `rec` retired at least two epochs ago; only looks at those, and the first one it keeps.
+        void reclaim(EpochRecord& rec) noexcept {
+            const std::uint64_t current = GlobalEpoch.load(std::memory_order_acquire);
+            while (true) {
+                Retired item;
+                {
+                    std::scoped_lock guard(rec.retiredLock);
+                    // a reader pinned at `epoch` may still see it until the epoch moves twice
+                    if (rec.retired.empty() || rec.retired.front().epoch + 2 > current) return;
+                    item = rec.retired.front();
+                    rec.retired.pop_front();
+                }
+                item.deleter(item.ptr);     // unlocked: a deleter may well retire something itself
+            }
+        }
+
+    } // namespace
+
+
+    void epochEnter() noexcept {
+        EpochRecord& rec = localRecord();
+        if (rec.depth++ != 0) return;   // already pinned by an outer guard
+
+        rec.epoch.store(GlobalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // the pin must be visible to writers before we read any shared pointer
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+
+    void epochExit() noexcept {
+        EpochRecord& rec = localRecord();
+        RIRI_ASSERT(rec.depth > 0);
+        if (--rec.depth != 0) return;
+
+        rec.epoch.store(QUIESCENT, std::memory_order_release);
+    }
+
+
+    bool epochPinned() noexcept {
+        return localRecord().depth != 0;
+    }
+
+
+    void epochRetire(void* ptr, const RapidDeleterFn deleter) noexcept {
+        EpochRecord& rec = localRecord();
+        const std::uint64_t epoch = GlobalEpoch.load(std::memory_order_acquire);
+        bool queued = true;
+        {
+            std::scoped_lock guard(rec.retiredLock);
+            try {
+                rec.retired.push_back({ptr, deleter, epoch});
+            } catch (const std::bad_alloc&) {
+                queued = false;
+            }
+        }
+        if (!queued) {
+            freeNow(ptr, deleter, epoch);
+            return;
+        }
+        if (++rec.sinceCollect == COLLECT_THRESHOLD) {
+            rec.sinceCollect = 0;
+            tryAdvance();
+            reclaim(rec);
+        }
+    }
+
+
+    void epochCollect() noexcept {
+        // two successful advances are enough to free everything retired before this call
+        tryAdvance() && tryAdvance();
+        for (EpochRecord* rec = Records.load(std::memory_order_acquire); rec; rec = rec->next) reclaim(*rec);
+    }
+
+
+    std::size_t epochPending() noexcept {
+        std::size_t pending = 0;
+        for (EpochRecord* rec = Records.load(std::memory_order_acquire); rec; rec = rec->next) {
+            std::scoped_lock guard(rec->retiredLock);
+            pending += rec->retired.size();
+        }
+        return pending;
+    }
+
+} // namespace RiRi::Internal
+
+
+namespace RiRi {
+
+    ReadGuard::ReadGuard() noexcept { Internal::epochEnter(); }
+
+    ReadGuard::~ReadGuard() { Internal::epochExit(); }
+
+} // namespace RiRi
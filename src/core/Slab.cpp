@@ -0,0 +1,220 @@
+#include "Slab.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+
+
+namespace RiRi::Internal {
+
+    RapidSlab::~RapidSlab() {
+        release();
+    }
+
+
+    std::size_t RapidSlab::classOf(const std::size_t bytes) noexcept {
+        if (bytes <= 128) return (bytes - 1) / 16;                      // 16, 32, ..., 128  -> 0..7
+        return 8 + (std::bit_width(bytes - 1) - 8);                     // 256, ..., 4096    -> 8..12
+    }
+
+
+    std::size_t RapidSlab::classSize(const std::size_t size_class) noexcept {
+        if (size_class < 8) return (size_class + 1) * 16;
+        return std::size_t{256} << (size_class - 8);
+    }
+
+
+    char* RapidSlab::allocate(const std::size_t bytes) noexcept {
+        RIRI_ASSERT(bytes > 0);
+
+        if (bytes > MAX_CLASS_SIZE) return allocateLarge(bytes);
+
+        const std::size_t size_class = classOf(bytes);
+        const std::size_t size = classSize(size_class);
+        if (FreeNode* node = _free[size_class]) {
+            _free[size_class] = node->next;     // recycled
+            _carved += size;
+            return reinterpret_cast<char*>(node);
+        }
+
+        if (static_cast<std::size_t>(_end - _cursor) < size) {
+            // the tail of the old slab (< 4 KiB) is simply abandoned until the next release()
+            try {
+                _slabs.push_back(nullptr);
+                _slabs.back() = _pages.allocate(SLAB_SIZE);
+            } catch (const std::bad_alloc&) {
+                if (_slabs.back() == nullptr) _slabs.pop_back();
+                return nullptr;     // the writer reports it, the store stays as it was
+            }
+            _cursor = _slabs.back();
+            _end = _cursor + SLAB_SIZE;
+            _reserved += SLAB_SIZE;
+        }
+        char* ptr = reinterpret_cast<char*>(_cursor);
+        _cursor += size;
+        _carved += size;
+        return ptr;
+    }
+
+
+    void RapidSlab::deallocate(char* ptr, const std::size_t bytes) noexcept {
+        if (bytes > MAX_CLASS_SIZE) {
+            ::operator delete(unlinkLarge(ptr));
+            return;
+        }
+
+        const std::size_t size_class = classOf(bytes);
+        _carved -= classSize(size_class);
+        if (compacting() && retiring(ptr)) return;     // its slab goes away as a whole
+
+        auto* node = reinterpret_cast<FreeNode*>(ptr);
+        node->next = _free[size_class];
+        _free[size_class] = node;
+    }
+
+
+    char* RapidSlab::grow(char* ptr, const std::size_t bytes, const std::size_t new_bytes) noexcept {
+        RIRI_ASSERT(new_bytes >= bytes && bytes > 0);
+        if (bytes > MAX_CLASS_SIZE) {
+            if (reinterpret_cast<LargeBlock*>(ptr)[-1].capacity >= new_bytes) return ptr;
+        } else if (new_bytes <= MAX_CLASS_SIZE && classOf(new_bytes) == classOf(bytes)) {
+            return ptr;
+        }
+
+        char* grown = new_bytes > MAX_CLASS_SIZE ? allocateLarge(new_bytes + new_bytes / 2) : allocate(new_bytes);
+        if (grown == nullptr) return nullptr;
+        std::memcpy(grown, ptr, bytes);
+        deallocate(ptr, bytes);
+        return grown;
+    }
+
+
+    char* RapidSlab::allocateLarge(const std::size_t capacity) noexcept {
+        // too big to share a slab, its own block, linked in so that release() can find it
+        if (capacity > SIZE_MAX - sizeof(LargeBlock)) return nullptr;
+        auto* block = static_cast<LargeBlock*>(::operator new(sizeof(LargeBlock) + capacity, std::nothrow));
+        if (block == nullptr) return nullptr;
+        block->prev = nullptr;
+        block->next = _large;
+        block->capacity = capacity;
+        if (_large) _large->prev = block;
+        _large = block;
+        _reserved += sizeof(LargeBlock) + capacity;
+        return reinterpret_cast<char*>(block + 1);
+    }
+
+
+    RapidSlab::LargeBlock* RapidSlab::unlinkLarge(char* ptr) noexcept {
+        auto* block = reinterpret_cast<LargeBlock*>(ptr) - 1;
+        if (block->prev) block->prev->next = block->next;
+        else _large = block->next;
+        if (block->next) block->next->prev = block->prev;
+        _reserved -= sizeof(LargeBlock) + block->capacity;
+        return block;
+    }
+
+
+    void* RapidSlab::detach(char* ptr, [[maybe_unused]] const std::size_t bytes) noexcept {
+        RIRI_ASSERT(bytes > MAX_CLASS_SIZE);
+        return unlinkLarge(ptr);
+    }
+
+
+    void RapidSlab::release() noexcept {
+        while (_large) {
+            LargeBlock* next = _large->next;
+            ::operator delete(_large);
+            _large = next;
+        }
+        for (std::byte* slab : _slabs) _pages.deallocate(slab, SLAB_SIZE);
+        _slabs.clear();
+        _slabs.shrink_to_fit();
+        (void)releaseRetired();
+        _free.fill(nullptr);
+        _cursor = _end = nullptr;
+        _reserved = 0;
+        _carved = 0;
+    }
+
+
+    bool RapidSlab::releaseStep(std::size_t blocks) noexcept {
+        for (; _large && blocks != 0; --blocks) {
+            ::operator delete(std::exchange(_large, _large->next));
+        }
+        for (std::vector<std::byte*>* slabs : {&_slabs, &_retiring}) {
+            for (; !slabs->empty() && blocks != 0; --blocks) {
+                _pages.deallocate(slabs->back(), SLAB_SIZE);
+                slabs->pop_back();
+            }
+        }
+        if (_large || !_slabs.empty() || !_retiring.empty()) return false;
+        release();      // nothing left to free, just resets the rest
+        return true;
+    }
+
+
+    void RapidSlab::swap(RapidSlab& other) noexcept {
+        std::swap(_free, other._free);
+        std::swap(_pages, other._pages);
+        std::swap(_slabs, other._slabs);
+        std::swap(_retiring, other._retiring);
+        std::swap(_cursor, other._cursor);
+        std::swap(_end, other._end);
+        std::swap(_large, other._large);
+        std::swap(_carved, other._carved);
+        std::swap(_reserved, other._reserved);
+    }
+
+
+    void RapidSlab::retire() noexcept {
+        RIRI_ASSERT(!compacting());
+        _retiring = std::move(_slabs);
+        _slabs.clear();
+        std::sort(_retiring.begin(), _retiring.end());
+        _free.fill(nullptr);        // every free block is in a retiring slab
+        _cursor = _end = nullptr;
+    }
+
+
+    bool RapidSlab::retiring(const char* ptr) const noexcept {
+        const auto* byte = reinterpret_cast<const std::byte*>(ptr);
+        const auto it = std::upper_bound(_retiring.begin(), _retiring.end(), byte, std::less<>{});
+        return it != _retiring.begin() && byte < *std::prev(it) + SLAB_SIZE;
+    }
+
+
+    std::size_t RapidSlab::releaseRetired() noexcept {
+        const std::size_t freed = _retiring.size() * SLAB_SIZE;
+        for (std::byte* slab : _retiring) _pages.deallocate(slab, SLAB_SIZE);
+        _retiring.clear();
+        _retiring.shrink_to_fit();
+        _reserved -= freed;
+        return freed;
+    }
+
+
+    bool slabCopy(RapidSlab& slab, const std::string_view str, RapidSlabString& copy) noexcept {
+        RIRI_ASSERT(str.size() <= UINT32_MAX);      // the writers turn longer ones down before they get here
+        if (str.empty()) {
+            copy = {};
+            return true;
+        }
+
+        char* data = slab.allocate(str.size());
+        if (data == nullptr) return false;
+        std::memcpy(data, str.data(), str.size());
+        copy = {data, static_cast<std::uint32_t>(str.size())};
+        return true;
+    }
+
+
+    void slabFree(RapidSlab& slab, const RapidSlabString str) noexcept {
+        if (str.size == 0) return;
+        slab.deallocate(const_cast<char*>(str.data), str.size);
+    }
+
+} // namespace RiRi::Internal
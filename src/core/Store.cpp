@@ -0,0 +1,52 @@
+#include "riri/Store.hpp"
+#include "MemoryMaps.h"
+
+#include <utility>
+
+
+namespace RiRi {
+
+    Store::Store(const StoreOptions& options)
+    : _owned(std::make_unique<Internal::RapidStore>(options)), _store(_owned.get()) { }
+
+    Store::Store(Internal::RapidStore& store) noexcept : _store(&store) { }
+
+    Store::~Store() = default;
+
+    Store::Store(Store&& other) noexcept
+    : _owned(std::move(other._owned)), _store(std::exchange(other._store, nullptr)) { }
+
+    Store& Store::operator=(Store&& other) noexcept {
+        _owned = std::move(other._owned);
+        _store = std::exchange(other._store, nullptr);
+        return *this;
+    }
+
+
+    Store& Store::defaultStore() noexcept {
+        // wraps MemoryMap, so the Internal::* default overloads and this one are the very same store
+        static Store instance(Internal::MemoryMap);
+        return instance;
+    }
+
+
+    const StoreOptions& Store::options() const noexcept {
+        return _store->options();
+    }
+
+
+    int Store::nodeOf(const std::string_view key) const noexcept {
+        return _store->shardNode(_store->shardIndex(Internal::RapidStore::hash(key)));
+    }
+
+
+    std::size_t numaNodeCount() noexcept {
+        return Internal::numaNodes().size();
+    }
+
+
+    bool runOnNode(const int node) noexcept {
+        return Internal::runOnNode(node);
+    }
+
+} // namespace RiRi
@@ -0,0 +1,127 @@
+#include "ValueIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        /// Keeps an int and a bool (or a double) with the same bits apart.
+        [[nodiscard]] std::size_t tagged(const std::size_t hash, const RapidCell::Kind kind) noexcept {
+            return hash ^ (static_cast<std::size_t>(kind) + 1) * 0x9E3779B97F4A7C15ull;
+        }
+
+        [[nodiscard]] std::size_t hashBits(const std::uint64_t bits) noexcept {
+            return ankerl::unordered_dense::hash<std::uint64_t>{}(bits);
+        }
+
+        [[nodiscard]] std::size_t hashDouble(double value) noexcept {
+            if (value == 0.0) value = 0.0;      // -0.0 == 0.0, so they'd better hash the same
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return hashBits(bits);
+        }
+
+        /**
+         * @brief Makes room in `map` for one more entry.
+         *
+         * A map that grows in place drops its buckets before it allocates the new ones, and is broken
+         * for good if that runs out of memory; the bigger one is built on the side instead, and only
+         * swapped in once it holds everything.
+         */
+        template <typename Map>
+        void roomForOne(Map& map) {
+            if (static_cast<float>(map.size() + 1) <= static_cast<float>(map.bucket_count()) * map.max_load_factor()) return;
+            Map grown;
+            grown.reserve((map.size() + 1) * 2);
+            // all the room is there already, nothing below allocates
+            for (auto& entry : map) grown.emplace(std::move(entry.first), std::move(entry.second));
+            map.swap(grown);
+        }
+
+    } // namespace
+
+
+    std::size_t hashValue(const RapidCell& value) noexcept {
+        switch (value.kind()) {
+            case RapidCell::Kind::String:
+                return tagged(ankerl::unordered_dense::hash<std::string_view>{}(value.asString()), value.kind());
+            case RapidCell::Kind::Int:    return tagged(hashBits(static_cast<std::uint64_t>(value.asInt())), value.kind());
+            case RapidCell::Kind::Double: return tagged(hashDouble(value.asDouble()), value.kind());
+            case RapidCell::Kind::Bool:   return tagged(hashBits(value.asBool()), value.kind());
+        }
+        return 0;
+    }
+
+
+    std::size_t hashValue(const RapidDataType& value) noexcept {
+        // kinds follow the alternative order of RapidDataType
+        const auto kind = static_cast<RapidCell::Kind>(value.index());
+        return std::visit([kind](const auto& v) -> std::size_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) return tagged(ankerl::unordered_dense::hash<std::string_view>{}(v), kind);
+            else if constexpr (std::is_same_v<T, std::int64_t>) return tagged(hashBits(static_cast<std::uint64_t>(v)), kind);
+            else if constexpr (std::is_same_v<T, double>) return tagged(hashDouble(v), kind);
+            else return tagged(hashBits(v), kind);
+        }, value);
+    }
+
+
+    bool RapidValueIndex::add(const RapidCell& value, const RapidValueRef key) noexcept {
+        // whatever can run out of memory goes first: out of memory, the index is just as it was
+        try {
+            const std::size_t hash = hashValue(value);
+            const auto it = _buckets.find(hash);
+            if (it == _buckets.end()) {
+                roomForOne(_buckets);
+                _buckets.emplace(hash, Bucket{key, {}});
+                return true;
+            }
+            std::vector<RapidValueRef>& rest = it->second.rest;
+            if (rest.size() == rest.capacity()) rest.reserve(std::max<std::size_t>(4, rest.size() * 2));
+            roomForOne(_positions);
+            _positions.emplace(key.key.data, rest.size());
+            rest.push_back(key);
+            return true;
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+    }
+
+
+    void RapidValueIndex::remove(const RapidCell& value, const RapidSlabString key) noexcept {
+        const auto it = _buckets.find(hashValue(value));
+        if (it == _buckets.end()) return;
+        Bucket& bucket = it->second;
+
+        // keys are compared by address, a key has exactly one copy in the slab
+        if (bucket.first.key.data == key.data) {
+            if (bucket.rest.empty()) {
+                _buckets.erase(it);
+                return;
+            }
+            bucket.first = bucket.rest.back();
+            bucket.rest.pop_back();
+            _positions.erase(bucket.first.key.data);
+            return;
+        }
+        const auto at = _positions.find(key.data);
+        if (at == _positions.end()) return;
+        const std::size_t i = at->second;
+        _positions.erase(at);
+        // the last key takes its place
+        if (i + 1 != bucket.rest.size()) {
+            bucket.rest[i] = bucket.rest.back();
+            _positions.find(bucket.rest[i].key.data)->second = i;
+        }
+        bucket.rest.pop_back();
+    }
+
+} // namespace RiRi::Internal
@@ -0,0 +1,150 @@
+#include "WorkPool.h"
+#include "Numa.h"
+
+#include <algorithm>
+
+
+namespace RiRi::Internal {
+
+    namespace {
+
+        [[nodiscard]] constexpr std::uint64_t pack(const std::uint32_t begin, const std::uint32_t end) noexcept {
+            return static_cast<std::uint64_t>(begin) << 32 | end;
+        }
+
+        [[nodiscard]] constexpr std::uint32_t beginOf(const std::uint64_t bounds) noexcept {
+            return static_cast<std::uint32_t>(bounds >> 32);
+        }
+
+        [[nodiscard]] constexpr std::uint32_t endOf(const std::uint64_t bounds) noexcept {
+            return static_cast<std::uint32_t>(bounds);
+        }
+
+    } // namespace
+
+
+    RapidWorkPool& RapidWorkPool::instance() {
+        static RapidWorkPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+        return pool;
+    }
+
+
+    RapidWorkPool::RapidWorkPool(const std::size_t workers) {
+        _workers.reserve(workers);
+        const std::vector<int>& nodes = numaNodes();
+        for (std::size_t i = 1; i <= workers; ++i) {
+            // thread i starts a job on the i-th slice of its tasks: on a NUMA box, that's the i-th slice of the nodes
+            const int node = nodes.size() > 1 ? nodes[i * nodes.size() / (workers + 1)] : -1;
+            _workers.emplace_back([this, i, node](const std::stop_token stop) {
+                if (node >= 0) runOnNode(node);
+                work(i, stop);
+            });
+        }
+    }
+
+
+    RapidWorkPool::~RapidWorkPool() {
+        for (auto& worker : _workers) worker.request_stop();
+        _workers.clear();       // joins them
+    }
+
+
+    void RapidWorkPool::run(const std::size_t tasks, const std::size_t threads, const TaskFn fn, void* context) {
+        const std::size_t participants = std::min({threads == 0 ? this->threads() : threads, this->threads(), tasks});
+        if (participants <= 1) {
+            for (std::size_t task = 0; task < tasks; ++task) fn(context, task);
+            return;
+        }
+
+        Job job{fn, context, participants, std::make_unique<Range[]>(participants)};
+        for (std::size_t p = 0; p < participants; ++p) {
+            const auto begin = static_cast<std::uint32_t>(tasks * p / participants);
+            const auto end = static_cast<std::uint32_t>(tasks * (p + 1) / participants);
+            job.ranges[p].bounds.store(pack(begin, end), std::memory_order_relaxed);
+        }
+        job.ranges[0].joined = true;
+        {
+            std::lock_guard lock(_mutex);
+            _open.push_back(&job);
+        }
+        _wake.notify_all();
+
+        // workers busy with other jobs join late or not at all: whatever they'd have run, we steal
+        drain(job, 0);
+        // nobody joins anymore, wait for those who did (they're out of tasks too, just not out of the last ones yet)
+        std::unique_lock lock(_mutex);
+        _open.erase(std::find(_open.begin(), _open.end(), &job));
+        _left.wait(lock, [&job] { return job.active == 0; });
+    }
+
+
+    void RapidWorkPool::work(const std::size_t self, const std::stop_token stop) {
+        while (true) {
+            Job* job;
+            {
+                std::unique_lock lock(_mutex);
+                if (!_wake.wait(lock, stop, [&] { return (job = openJob(self)) != nullptr; })) return;
+                job->ranges[self].joined = true;
+                ++job->active;
+            }
+            drain(*job, self);
+            {
+                std::lock_guard lock(_mutex);       // the job is gone the moment its caller sees it at 0
+                --job->active;
+            }
+            _left.notify_all();
+        }
+    }
+
+
+    RapidWorkPool::Job* RapidWorkPool::openJob(const std::size_t self) const noexcept {
+        for (Job* job : _open) {
+            if (self < job->participants && !job->ranges[self].joined) return job;
+        }
+        return nullptr;
+    }
+
+
+    void RapidWorkPool::drain(Job& job, const std::size_t self) noexcept {
+        Range& own = job.ranges[self];
+        while (true) {
+            for (std::uint32_t task; take(own, task);) job.fn(job.context, task);
+
+            // out of work: try everybody else, starting with the next one over
+            bool stole = false;
+            for (std::size_t i = 1; i < job.participants && !stole; ++i) {
+                stole = steal(job.ranges[(self + i) % job.participants], own);
+            }
+            if (!stole) return;
+        }
+    }
+
+
+    bool RapidWorkPool::take(Range& range, std::uint32_t& task) noexcept {
+        std::uint64_t bounds = range.bounds.load(std::memory_order_acquire);
+        while (beginOf(bounds) < endOf(bounds)) {
+            if (range.bounds.compare_exchange_weak(bounds, pack(beginOf(bounds) + 1, endOf(bounds)), std::memory_order_acq_rel)) {
+                task = beginOf(bounds);
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool RapidWorkPool::steal(Range& victim, Range& self) noexcept {
+        std::uint64_t bounds = victim.bounds.load(std::memory_order_acquire);
+        while (beginOf(bounds) < endOf(bounds)) {
+            const std::uint32_t begin = beginOf(bounds);
+            const std::uint32_t end = endOf(bounds);
+            const std::uint32_t middle = begin + (end - begin) / 2;
+            if (victim.bounds.compare_exchange_weak(bounds, pack(begin, middle), std::memory_order_acq_rel)) {
+                // nobody steals from an empty range, so this doesn't race with anything
+                self.bounds.store(pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace RiRi::Internal
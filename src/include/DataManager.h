@@ -4,9 +4,16 @@
 // We are doing this to avoid exposing our map to the
 // command layers (the public API for RiRi).
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 #include "RiRiMacros.h"
+#include "riri/RapidResponse.hpp"
 #include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
 
 
 /**
@@ -21,37 +28,143 @@
  * code of RiRi is always available on GitHub, here: https://github.com/ad4rsh2701/riri
  */
 namespace RiRi::Internal {
-    
+
+    class RapidStore;   // MemoryMaps.h, we don't want the map in the command layers
+
+    /**
+     * @brief The `RapidStore` behind a public `Store`, for the command layers.
+     */
+    GO_AWAY struct StoreAccess {
+        [[nodiscard]] static RapidStore& of(Store& store) noexcept { return *store._store; }
+    };
+
+    /**
+     * @brief What a write did: a `StatusCode`, that still reads like the `bool` writes used to return.
+     *
+     * `true` if the write went through: `OK`, or `WARN_KEY_STORE_NEARING_CAPACITY` if it did, but its
+     * shard is past the store's warning mark. `false` if it didn't: `ERR_KEY_ALREADY_EXISTS` (set),
+     * `ERR_KEY_NOT_FOUND` (update), `ERR_VERSION_MISMATCH` (compare-and-swap), or `ERR_KEY_STORE_FULL` if it
+     * doesn't fit in the memory budget.
+     */
+    GO_AWAY class RapidWrite {
+    public:
+        constexpr RapidWrite(const StatusCode code = StatusCode::OK) noexcept : _code(code) { }
+
+        [[nodiscard]] constexpr StatusCode code() const noexcept { return _code; }
+
+        constexpr operator bool() const noexcept {
+            return _code == StatusCode::OK || _code == StatusCode::WARN_KEY_STORE_NEARING_CAPACITY;
+        }
+
+    private:
+        StatusCode _code;
+    };
+
+    // Every function below comes in two flavours: one that works on an explicit `RapidStore`, and one
+    // that works on the default store (`MemoryMap`). They are all safe to call from multiple threads;
+    // each call only locks the shard(s) its key(s) hash to.
+    //
+    // Keys and string values are stored in the shard's slab, not as `RapidDataType`s, so lookups hand
+    // out a copy from the calling thread's read buffer instead of a pointer into the shard. Writers
+    // can't touch it, it stays valid until the same thread reads again, unless something holds a
+    // `readLease()` on it (the response the command returns it in) or the thread holds a
+    // `RiRi::ReadGuard`. In concurrent-reads mode, lookups take no lock at all and copy the same way;
+    // only inside a `RiRi::ReadGuard` do they skip the copy and hand out the published value itself,
+    // valid for as long as the guard is held.
+    //
+    // Writes turn down keys and string values over 4 GiB (`ERR_VALUE_OUT_OF_RANGE`), and report
+    // `ERR_OUT_OF_MEMORY` if the shard's slab can't get the memory for them; nothing changes then.
+    //
+    // The single key functions take an optional `hash`: the key's `RiRi::hashKey()`, if the caller
+    // already has it (`RiRi::RapidKey`, `RapidNode::hash`), or `0` to have it computed. Batched ones
+    // use `RapidNode::hash` the same way.
+
+    /**
+     * @brief A lease on the calling thread's read buffer, keeping the values the last lookup copied into
+     * it valid for as long as it lives; empty if that lookup copied none. Commands hand it to their response.
+     */
+    GO_AWAY Response::Lease readLease() noexcept;
+
+    /**
+     * @brief Whether the calling thread's last lookup was short of memory for its copies.
+     *
+     * A value it couldn't copy comes back `nullptr` (a key, an empty view), just like one that isn't
+     * there: commands ask this before they answer `ERR_KEY_NOT_FOUND`, and answer `ERR_OUT_OF_MEMORY` instead.
+     */
+    GO_AWAY [[nodiscard]] bool readStarved() noexcept;
+
+    /// Marks the calling thread's current lookup as short of memory, see `readStarved()`.
+    GO_AWAY void starveRead() noexcept;
+
+    /**
+     * @brief Hands out a number a command came up with (a TTL, a length, a version...) the way lookups
+     * hand out values: from the calling thread's read buffer, for `readLease()` to keep.
+     *
+     * `fresh` starts a new read first; a command with several numbers passes it with the first only.
+     * `nullptr` if out of memory.
+     */
+    GO_AWAY const RapidDataType* snapshotNumber(RapidDataType number, bool fresh = true) noexcept;
+
+
     /**
      * @brief Insert the key-value pair in the internal memory map.
      * 
      * @param key Type: `std::string_view`
      * @param value Type: `const RapidDataType&`
-     * @return `true` or `false`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `RapidWrite`
      * 
-     * @note Returns `true` if the key-value pair was successfully inserted, `false` if the key already exists or the insertion failed (very unlikely).
+     * @note `true` if the key-value pair was inserted, `false` if the key already exists or it doesn't fit in the store's memory budget.
+     * If the store evicts, keys of the same shard may be evicted to make room for it.
      */
-    GO_AWAY bool setValue(std::string&& key, RapidDataType&& value) noexcept;
+    GO_AWAY RapidWrite setValue(std::string_view key, RapidDataType&& value, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite setValue(RapidStore& store, std::string_view key, RapidDataType&& value, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Same as `setValue()` above, and the key expires `ttl` from now.
+     *
+     * @param ttl Type: `std::chrono::milliseconds`; must be positive
+     * @note A key whose TTL ran out is gone for every function here, even if its memory wasn't reclaimed yet.
+     */
+    GO_AWAY RapidWrite setValue(std::string_view key, RapidDataType&& value, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite setValue(RapidStore& store, std::string_view key, RapidDataType&& value, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
 
 
     /**
      * @brief Retrieve the value associated with the key from the internal memory map.
      * 
      * @param key Type: `std::string_view`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
      * @return `RapidDataType*` or `nullptr`
      * 
      * @note Returns the value associated with the key if it exists, `nullptr` otherwise.
      */
-    GO_AWAY const RapidDataType* getValue(std::string_view key) noexcept;
+    GO_AWAY const RapidDataType* getValue(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY const RapidDataType* getValue(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
     
     
     /**
      * @brief Delete the key-value pair associated with the given key from the internal memory map.
      * 
      * @param key Type: `std::string_view`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `true` if the key was found and erased, `false` if the key did not exist.
+     */
+    GO_AWAY bool deleteKey(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY bool deleteKey(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief `deleteKey`, except that a big value (`LAZY_FREE_MIN_BYTES` or more) is freed in the background.
+     *
+     * The key is gone when this returns, its value's memory stops counting against the shard; only
+     * handing the pages back to the system is left to the background freer (see `lazyFree()`).
+     *
      * @return `true` if the key was found and erased, `false` if the key did not exist.
      */
-    GO_AWAY bool deleteKey(std::string_view key) noexcept;
+    GO_AWAY bool unlinkKey(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY bool unlinkKey(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
 
 
     /**
@@ -59,9 +172,245 @@ namespace RiRi::Internal {
      * 
      * @param key Type: `std::string_view`
      * @param newValue Type: `RapidDataType`
-     * @return `true` if the key was found and updated, `false` if the key did not exist.
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `RapidWrite`; `true` if the key was found and updated, `false` if the key did not exist
+     * or the new value doesn't fit in the store's memory budget.
+     */
+    GO_AWAY RapidWrite updateValue(std::string_view key, RapidDataType&& newValue, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite updateValue(RapidStore& store, std::string_view key, RapidDataType&& newValue, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Same as `updateValue()` above, and the key expires `ttl` from now (instead of keeping the TTL it had).
+     *
+     * @param ttl Type: `std::chrono::milliseconds`; must be positive
+     */
+    GO_AWAY RapidWrite updateValue(std::string_view key, RapidDataType&& newValue, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite updateValue(RapidStore& store, std::string_view key, RapidDataType&& newValue, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Insert or update: the key holds `value` afterwards, whether it existed or not.
+     *
+     * One probe, `insert_or_assign` style: the insert that would fail a `setValue()` finds the entry
+     * to update instead, no second lookup, and no other write of the key gets in between. A key that
+     * existed keeps its TTL, like with `updateValue()`.
+     *
+     * @param key Type: `std::string_view`
+     * @param value Type: `RapidDataType&&`; moved into the store if it went through
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `RapidWrite`; `false` only if it doesn't fit in the store's memory budget.
+     */
+    GO_AWAY RapidWrite upsertValue(std::string_view key, RapidDataType&& value, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite upsertValue(RapidStore& store, std::string_view key, RapidDataType&& value, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Same as `upsertValue()` above, and the key expires `ttl` from now, whether it had a TTL or not.
+     *
+     * @param ttl Type: `std::chrono::milliseconds`; must be positive
+     */
+    GO_AWAY RapidWrite upsertValue(std::string_view key, RapidDataType&& value, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite upsertValue(RapidStore& store, std::string_view key, RapidDataType&& value, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Batched `setValue`: moves every node's key and value into the store.
+     *
+     * Nodes are grouped by shard, and each shard's lock is taken once for the whole batch instead
+     * of once per node. Nodes of the same shard are processed in their original order.
+     *
+     * With `threads` other than 1, big batches are spread over the shared `RapidWorkPool`, a shard
+     * per task: shards run in parallel, every shard's nodes still in order under its lock. Results
+     * land in their node's slot of `inserted`, wherever they ran, so there's nothing to merge.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; keys and values are moved out on success
+     * @param inserted Type: `std::span<RapidWrite>`; must be as long as `nodes`, `inserted[i]` is the result for `nodes[i]`
+     * @param threads Type: `std::size_t`; up to how many threads to run on, the caller included (`0` for one per core)
+     */
+    GO_AWAY void setValues(std::span<RapidNode> nodes, std::span<RapidWrite> inserted) noexcept;
+    GO_AWAY void setValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> inserted, std::size_t threads = 1) noexcept;
+
+
+    /**
+     * @brief Batched `getValue`, one shared lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<const RapidNode>`; only the keys are read
+     * @param values Type: `std::span<const RapidDataType*>`; must be as long as `nodes`, `nullptr` for missing keys
+     * @param threads Type: `std::size_t`; see `setValues()`. Lock-free stores split the batch in chunks instead of by shard.
+     */
+    GO_AWAY void getValues(std::span<const RapidNode> nodes, std::span<const RapidDataType*> values) noexcept;
+    GO_AWAY void getValues(RapidStore& store, std::span<const RapidNode> nodes, std::span<const RapidDataType*> values, std::size_t threads = 1) noexcept;
+
+
+    /**
+     * @brief Batched `updateValue`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; values are moved out on success
+     * @param updated Type: `std::span<RapidWrite>`; must be as long as `nodes`
+     * @param threads Type: `std::size_t`; see `setValues()`
+     */
+    GO_AWAY void updateValues(std::span<RapidNode> nodes, std::span<RapidWrite> updated) noexcept;
+    GO_AWAY void updateValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> updated, std::size_t threads = 1) noexcept;
+
+
+    /**
+     * @brief Batched `upsertValue`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; values are moved out on success
+     * @param written Type: `std::span<RapidWrite>`; must be as long as `nodes`
+     * @param threads Type: `std::size_t`; see `setValues()`
+     */
+    GO_AWAY void upsertValues(std::span<RapidNode> nodes, std::span<RapidWrite> written) noexcept;
+    GO_AWAY void upsertValues(RapidStore& store, std::span<RapidNode> nodes, std::span<RapidWrite> written, std::size_t threads = 1) noexcept;
+
+
+    /**
+     * @brief Loads a (big) batch as fast as the store allows: BULK_LOAD.
+     *
+     * Like `upsertValues()`, shard by shard under one lock, except that every shard's table grows
+     * once, to fit all of its nodes, before any goes in; its buckets are prefetched a group at a
+     * time; and a store without a memory budget skips the per-write checks a SET makes. Results are
+     * only written down if asked for.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; keys and values are moved out of those that go in
+     * @param policy Type: `DuplicatePolicy`; what happens to a key that's there already, or earlier in `nodes`
+     * @param loaded Type: `std::span<RapidWrite>`; empty, or as long as `nodes` for every node's result
+     * @param threads Type: `std::size_t`; see `setValues()`
+     * @return How many nodes failed (or were reported, `DuplicatePolicy::Report`)
+     */
+    GO_AWAY std::size_t loadValues(std::span<RapidNode> nodes, DuplicatePolicy policy, std::span<RapidWrite> loaded = {}) noexcept;
+    GO_AWAY std::size_t loadValues(RapidStore& store, std::span<RapidNode> nodes, DuplicatePolicy policy, std::span<RapidWrite> loaded = {}, std::size_t threads = 1) noexcept;
+
+
+    /**
+     * @brief Adds `by` to the number stored at `key`, in place: one probe, no variant in between.
+     *
+     * Atomic per key, like every write: it all happens under the key's shard lock.
+     *
+     * @param by Type: `std::int64_t` or `double`; the stored value must be of the same type
+     * @param initial Type: `std::optional`; what a missing key starts from, or `std::nullopt` to leave it missing
+     * @param result Type: `std::int64_t&` or `double&`; the new value, if it went through
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `OK` (or a capacity warning), `ERR_KEY_NOT_FOUND`, `ERR_WRONG_TYPE`, `ERR_VALUE_OUT_OF_RANGE` if
+     * the result doesn't fit (or isn't finite), or `ERR_KEY_STORE_FULL` for a new key that doesn't fit.
+     */
+    GO_AWAY RapidWrite incrementValue(std::string_view key, std::int64_t by, std::optional<std::int64_t> initial, std::int64_t& result, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite incrementValue(RapidStore& store, std::string_view key, std::int64_t by, std::optional<std::int64_t> initial, std::int64_t& result, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite incrementValue(std::string_view key, double by, std::optional<double> initial, double& result, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite incrementValue(RapidStore& store, std::string_view key, double by, std::optional<double> initial, double& result, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Batched `incrementValue`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; every value is the increment (an `std::int64_t` for `T = std::int64_t`,
+     * a `double` for `T = double`, anything else is `ERR_INVALID_ARGUMENT`), and is replaced by the new value on success
+     * @param initial Type: `std::optional<T>`; see `incrementValue()`
+     * @param incremented Type: `std::span<RapidWrite>`; must be as long as `nodes`
+     */
+    template <typename T>
+    GO_AWAY void incrementValues(std::span<RapidNode> nodes, std::optional<T> initial, std::span<RapidWrite> incremented) noexcept;
+    template <typename T>
+    GO_AWAY void incrementValues(RapidStore& store, std::span<RapidNode> nodes, std::optional<T> initial, std::span<RapidWrite> incremented) noexcept;
+
+
+    /// `offset` of `spliceString()` that means "at the end", i.e. append.
+    GO_AWAY inline constexpr std::size_t SPLICE_APPEND = SIZE_MAX;
+
+
+    /**
+     * @brief Writes `bytes` at `offset` of the string stored at `key`, in place (APPEND, SETRANGE).
+     *
+     * The string grows as needed, zero filled past its old end. Its bytes only move when their slab
+     * block is full, and then to one with room to spare, so appending is amortized O(length appended).
+     * A missing key is created, as if it held an empty string.
+     *
+     * @param offset Type: `std::size_t`; where to write, `SPLICE_APPEND` for the end
+     * @param bytes Type: `std::string_view`; what to write
+     * @param length Type: `std::size_t&`; the string's new length, if it went through
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `OK` (or a capacity warning), `ERR_WRONG_TYPE` if the value isn't a string,
+     * `ERR_VALUE_OUT_OF_RANGE` past 4 GiB, or `ERR_KEY_STORE_FULL`.
+     */
+    GO_AWAY RapidWrite spliceString(std::string_view key, std::size_t offset, std::string_view bytes, std::size_t& length, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite spliceString(RapidStore& store, std::string_view key, std::size_t offset, std::string_view bytes, std::size_t& length, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Up to `length` bytes of the string stored at `key`, from `offset` on (GETRANGE); `substr()` rules.
+     *
+     * Only those bytes are copied, into the calling thread's read buffer (see `snapshotValue()`). In
+     * concurrent-reads mode inside a `RiRi::ReadGuard` nothing is copied at all, the view points into
+     * the readers' copy of the value, kept alive by the guard like a GET's.
+     *
+     * @param range Type: `std::string_view&`; the bytes, empty if `offset` is past the end
+     * @return `OK`, `ERR_KEY_NOT_FOUND`, `ERR_WRONG_TYPE` if the value isn't a string, or `ERR_OUT_OF_MEMORY` for the copy.
+     */
+    GO_AWAY StatusCode getRange(std::string_view key, std::size_t offset, std::size_t length, std::string_view& range, std::size_t hash = 0) noexcept;
+    GO_AWAY StatusCode getRange(RapidStore& store, std::string_view key, std::size_t offset, std::size_t length, std::string_view& range, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief `getValue()`, and the value's version.
+     *
+     * Every write of a value gives it a new version, bigger than any other its shard ever handed out
+     * (TTL changes don't count, they don't touch the value). Versions start at `1`, so `0` never
+     * belongs to a live key.
+     *
+     * @param version Type: `std::uint64_t&`; the value's version, `0` if the key doesn't exist
+     * @return `RapidDataType*` or `nullptr`, same as `getValue()`.
+     */
+    GO_AWAY const RapidDataType* getVersionedValue(std::string_view key, std::uint64_t& version, std::size_t hash = 0) noexcept;
+    GO_AWAY const RapidDataType* getVersionedValue(RapidStore& store, std::string_view key, std::uint64_t& version, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Compare-and-swap: replaces the value of `key` only if it's still at version `expected`.
+     *
+     * One probe, under the key's shard lock: no other write of the key can get in between the
+     * compare and the swap. `expected == 0` means "only if the key doesn't exist", which creates it.
+     *
+     * @param expected Type: `std::uint64_t`; the version the value must be at (see `getVersionedValue()`)
+     * @param value Type: `RapidDataType&&`; moved into the store if it went through
+     * @param version Type: `std::uint64_t&`; the new version if it went through, the one the value is at if not (`0` for no key)
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `OK` (or a capacity warning), `ERR_VERSION_MISMATCH`, `ERR_KEY_NOT_FOUND` (`expected != 0`),
+     * or `ERR_KEY_STORE_FULL`.
+     */
+    GO_AWAY RapidWrite compareAndSwap(std::string_view key, std::uint64_t expected, RapidDataType&& value, std::uint64_t& version, std::size_t hash = 0) noexcept;
+    GO_AWAY RapidWrite compareAndSwap(RapidStore& store, std::string_view key, std::uint64_t expected, RapidDataType&& value, std::uint64_t& version, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Batched `compareAndSwap`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<RapidNode>`; values are moved out on success, and replaced by their new version (an `std::int64_t`)
+     * @param expected Type: `std::span<const std::uint64_t>`; must be as long as `nodes`, `expected[i]` is the version for `nodes[i]`
+     * @param swapped Type: `std::span<RapidWrite>`; must be as long as `nodes`
+     */
+    GO_AWAY void compareAndSwapValues(std::span<RapidNode> nodes, std::span<const std::uint64_t> expected, std::span<RapidWrite> swapped) noexcept;
+    GO_AWAY void compareAndSwapValues(RapidStore& store, std::span<RapidNode> nodes, std::span<const std::uint64_t> expected, std::span<RapidWrite> swapped) noexcept;
+
+
+    /**
+     * @brief Batched `deleteKey`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<const RapidNode>`; only the keys are read
+     * @param deleted Type: `std::span<bool>`; must be as long as `nodes`
+     */
+    GO_AWAY void deleteKeys(std::span<const RapidNode> nodes, std::span<bool> deleted) noexcept;
+    GO_AWAY void deleteKeys(RapidStore& store, std::span<const RapidNode> nodes, std::span<bool> deleted) noexcept;
+
+
+    /**
+     * @brief Batched `unlinkKey`, one lock per shard per batch.
+     *
+     * @param nodes Type: `std::span<const RapidNode>`; only the keys are read
+     * @param unlinked Type: `std::span<bool>`; must be as long as `nodes`
      */
-    GO_AWAY bool updateValue(std::string_view key, RapidDataType&& newValue) noexcept;
+    GO_AWAY void unlinkKeys(std::span<const RapidNode> nodes, std::span<bool> unlinked) noexcept;
+    GO_AWAY void unlinkKeys(RapidStore& store, std::span<const RapidNode> nodes, std::span<bool> unlinked) noexcept;
 
 
     /**
@@ -69,17 +418,162 @@ namespace RiRi::Internal {
      * 
      * @param value Type: `const RapidDataType&`
      * @return `std::string*` containing the key if found, `nullptr` otherwise.
+     * @note The string is a per-thread copy, overwritten by the next call on the same thread.
      *
-     * @warning This is a `slow linear search`. Only used in rare or non-performance-critical cases.
+     * @warning This is a `slow linear search`, unless the store has a value index. Only used in rare or non-performance-critical cases.
      */
     GO_AWAY const std::string* getKeyByValue(const RapidDataType& value) noexcept;
+    GO_AWAY const std::string* getKeyByValue(RapidStore& store, const RapidDataType& value) noexcept;
+
+
+    /**
+     * @brief Retrieve every key associated with the given value.
+     *
+     * Goes through the store's value index if it has one (`StoreOptions::valueIndex`): a lookup per
+     * shard. Otherwise, it's the same linear search as `getKeyByValue()`, just without stopping early.
+     *
+     * @param value Type: `const RapidDataType&`
+     * @param limit Type: `std::size_t`; stop after this many keys
+     * @return The keys, in no particular order, empty if there are none.
+     * @note The keys are snapshots in the calling thread's read buffer (see `snapshotString()`), a
+     * `readLease()` keeps them; the span itself is overwritten by the next call on the same thread.
+     */
+    GO_AWAY std::span<const std::string_view> findKeysByValue(const RapidDataType& value, std::size_t limit = SIZE_MAX) noexcept;
+    GO_AWAY std::span<const std::string_view> findKeysByValue(RapidStore& store, const RapidDataType& value, std::size_t limit = SIZE_MAX) noexcept;
+
+
+    /**
+     * @brief A key and its value, as found by `scanKeys()`, `scanPrefix()` and `scanStore()`; both are
+     * snapshots in the calling thread's read buffer, a `readLease()` keeps them.
+     */
+    GO_AWAY struct RapidScanEntry {
+        std::string_view key;
+        const RapidDataType* value;
+    };
+
+
+    /**
+     * @brief Every key in `[from, to)`, in order, with its value.
+     *
+     * Goes through the store's ordered index if it has one (`StoreOptions::orderedIndex`): a descent
+     * per shard and then only the keys that are returned (at most `limit` per shard). Otherwise, it's a
+     * linear search of the whole store.
+     *
+     * @param from Type: `std::string_view`; the first key, inclusive
+     * @param to Type: `std::string_view`; the last key, exclusive, empty for no end
+     * @param limit Type: `std::size_t`; stop after this many keys
+     * @return The entries, sorted by key, empty if there are none.
+     * @note The span is per-thread, overwritten by the next call on the same thread; not what it points to.
+     */
+    GO_AWAY std::span<const RapidScanEntry> scanKeys(std::string_view from, std::string_view to, std::size_t limit = SIZE_MAX) noexcept;
+    GO_AWAY std::span<const RapidScanEntry> scanKeys(RapidStore& store, std::string_view from, std::string_view to, std::size_t limit = SIZE_MAX) noexcept;
+
+
+    /**
+     * @brief Every key starting with `prefix`, in order, with its value; `scanKeys()` for the range the prefix spans.
+     */
+    GO_AWAY std::span<const RapidScanEntry> scanPrefix(std::string_view prefix, std::size_t limit = SIZE_MAX) noexcept;
+    GO_AWAY std::span<const RapidScanEntry> scanPrefix(RapidStore& store, std::string_view prefix, std::size_t limit = SIZE_MAX) noexcept;
+
+
+    /**
+     * @brief The next chunk of a walk over every key of the store, with its value.
+     *
+     * Stateless: everything the walk needs is in `cursor`. Every shard's entries are walked from the
+     * back of their dense vector, a shared lock per shard per call, so a key that exists for the whole
+     * walk is returned at least once, whatever is erased or inserted meanwhile. Keys can come twice
+     * (erasing moves entries around, a rehash starts the shard over), and keys added during the walk
+     * may or may not come at all.
+     *
+     * @param cursor Type: `std::uint64_t&`; `0` to start, the next cursor on return, `0` once done
+     * @param count Type: `std::size_t`; entries looked at (expired ones included), at most
+     * @return The live entries among them, in no particular order.
+     * @note The entries are per-thread copies, overwritten by the next call on the same thread.
+     */
+    GO_AWAY std::span<const RapidScanEntry> scanStore(std::uint64_t& cursor, std::size_t count) noexcept;
+    GO_AWAY std::span<const RapidScanEntry> scanStore(RapidStore& store, std::uint64_t& cursor, std::size_t count) noexcept;
+
+    /// What `getTtl()` and `persistKey()` return for a key that doesn't exist (or just expired).
+    GO_AWAY inline constexpr std::chrono::milliseconds TTL_KEY_NOT_FOUND{-2};
+
+    /// What `getTtl()` and `persistKey()` return for a key without a TTL.
+    GO_AWAY inline constexpr std::chrono::milliseconds TTL_NEVER{-1};
+
+
+    /**
+     * @brief Give a key a TTL, or a new one.
+     *
+     * @param key Type: `std::string_view`
+     * @param ttl Type: `std::chrono::milliseconds`; `0` or less deletes the key right away
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return `true` if the key was found, `false` if it did not exist.
+     */
+    GO_AWAY bool expireKey(std::string_view key, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+    GO_AWAY bool expireKey(RapidStore& store, std::string_view key, std::chrono::milliseconds ttl, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief How long a key has left.
+     *
+     * @param key Type: `std::string_view`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return The time left (at least 1ms), `TTL_NEVER` or `TTL_KEY_NOT_FOUND`.
+     */
+    GO_AWAY std::chrono::milliseconds getTtl(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY std::chrono::milliseconds getTtl(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Take a key's TTL away, it lives until deleted.
+     *
+     * @param key Type: `std::string_view`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return What `getTtl()` returned right before.
+     */
+    GO_AWAY std::chrono::milliseconds persistKey(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY std::chrono::milliseconds persistKey(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
+
+
+    /**
+     * @brief Reclaims every key whose TTL ran out, one shard (and a bounded number of keys) per lock.
+     *
+     * Writes already do this a few keys at a time for the shard they touch; this is for the shards
+     * nobody writes to, called by the store's sweeper (`StoreOptions::expirySweepInterval`).
+     * Only ever looks at keys that are due, never at the whole store.
+     *
+     * @return The number of keys expired.
+     */
+    GO_AWAY std::size_t expireKeys() noexcept;
+    GO_AWAY std::size_t expireKeys(RapidStore& store) noexcept;
+
 
     /**
      * @brief Clears all entries from the internal memory map.
      * 
      * This operation is guaranteed to succeed and does not throw.
+     *
+     * O(1) per shard, however many keys it held: the shard's table, slab and indexes are swapped for
+     * fresh, empty ones (reserved for the store's initial capacity) under its lock, the old ones are
+     * freed in the background (see `lazyFree()`).
      */
     GO_AWAY void clearMap() noexcept;
+    GO_AWAY void clearMap(RapidStore& store) noexcept;
+
+
+    /**
+     * @brief Gives back what mass deletions left behind: shrinks the hash tables that are under a
+     * quarter full, and moves the keys and values out of slabs that are a quarter idle or more into
+     * fresh ones, freeing the old slabs.
+     *
+     * Incremental, one shard at a time: a shrink is a rehash into a smaller table, the strings move a
+     * bounded number of entries per shard lock, which is let go of in between. Reads and writes of the
+     * shard carry on meanwhile. Strings too big for the slabs stay where they are.
+     * Shards with `StoreOptions::compactBelow` do this on their own, a few entries per write.
+     *
+     * @return The bytes given back to the system (tables and slabs).
+     */
+    GO_AWAY std::size_t compactStore() noexcept;
+    GO_AWAY std::size_t compactStore(RapidStore& store) noexcept;
 
 
     /**
@@ -89,7 +583,50 @@ namespace RiRi::Internal {
      * directly in public headers. It serves purely as an access abstraction.
      * 
      * @return `size_t` representing the number of key-value pairs.
+     * @note Counts keys whose TTL ran out but which weren't reclaimed yet.
      */
     GO_AWAY size_t size() noexcept;
+    GO_AWAY size_t size(RapidStore& store) noexcept;
+
+
+    /**
+     * @brief Where a store's memory goes, see `memoryStats()`.
+     */
+    GO_AWAY struct RapidMemoryStats {
+        std::size_t keys = 0;           // number of keys, like `size()`
+        std::size_t keyBytes = 0;       // the keys' own bytes
+        std::size_t valueBytes = 0;     // string values too long to live in their entry (the rest cost nothing extra)
+        std::size_t bucketBytes = 0;    // the hash tables' bucket arrays
+        std::size_t entryBytes = 0;     // the dense vectors of entries (key + value cells), spare capacity included
+        std::size_t slabBytes = 0;      // what the slabs holding key and value bytes took from the system, free space included
+        std::size_t budgetBytes = 0;    // what's charged against `StoreOptions::maxMemory`
+
+        /// Keys, values and the tables: the live bytes.
+        [[nodiscard]] std::size_t total() const noexcept { return keyBytes + valueBytes + bucketBytes + entryBytes; }
+    };
+
+
+    /**
+     * @brief The byte counts of a store.
+     *
+     * Every shard keeps its counts up to date as it's written to, this only adds them up: a shared
+     * lock per shard, never a look at a single key.
+     *
+     * @return `RapidMemoryStats`
+     * @note Lock-free readers' copies (concurrent-reads mode), the value and ordered indexes and TTLs aren't counted.
+     */
+    GO_AWAY RapidMemoryStats memoryStats() noexcept;
+    GO_AWAY RapidMemoryStats memoryStats(RapidStore& store) noexcept;
+
+
+    /**
+     * @brief What a single key costs its store: its key and value bytes, its entry and its share of the buckets.
+     *
+     * @param key Type: `std::string_view`
+     * @param hash Type: `std::size_t`; `hashKey(key)`, or `0` if not known yet
+     * @return The bytes, `0` if the key doesn't exist.
+     */
+    GO_AWAY std::size_t memoryUsage(std::string_view key, std::size_t hash = 0) noexcept;
+    GO_AWAY std::size_t memoryUsage(RapidStore& store, std::string_view key, std::size_t hash = 0) noexcept;
 
 } // namespace RiRi::Internal
@@ -0,0 +1,37 @@
+#pragma once    // EVICTION.H
+
+#include <cstdint>
+
+#include "RiRiMacros.h"
+#include "riri/Store.hpp"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    // Approximate LRU/LFU, the way Redis does it: every key carries a 32 bit access stamp (in the
+    // padding of its `RapidSlabString`, so it costs nothing), and a shard over its budget samples a
+    // few keys and evicts the one whose stamp looks worst. No lists, no heaps, nothing to keep in
+    // order on every read.
+    //
+    // LRU stamps are a clock with 10ms ticks (wraps around after ~16 months, long enough).
+    // LFU stamps are Redis' LFU counter: 24 bits of "last decayed at" in minutes, then an 8 bit
+    // logarithmic access counter, which loses a point for every minute the key isn't used.
+
+    /// Keys looked at per eviction; Redis' default, close enough to exact LRU for most workloads.
+    inline constexpr int EVICTION_SAMPLES = 5;
+
+    /// Stamp of a key that was just used (or, with `fresh`, just created), given its previous stamp.
+    GO_AWAY [[nodiscard]] std::uint32_t touchedStamp(EvictionPolicy policy, std::uint32_t stamp, bool fresh) noexcept;
+
+    /// How badly a key wants to be evicted, given its stamp: the bigger, the sooner.
+    GO_AWAY [[nodiscard]] std::uint32_t evictionScore(EvictionPolicy policy, std::uint32_t stamp) noexcept;
+
+    /// A cheap per-thread random number, for sampling.
+    GO_AWAY [[nodiscard]] std::uint64_t evictionRandom() noexcept;
+
+} // namespace RiRi::Internal
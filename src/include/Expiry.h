@@ -0,0 +1,154 @@
+#pragma once    // EXPIRY.H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RiRiMacros.h"
+#include "Slab.h"
+#include "ankerl/unordered_dense.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /// What deadlines are measured in: milliseconds on the steady clock. Never `0`, so `0` can mean "no deadline".
+    GO_AWAY inline std::int64_t expiryNow() noexcept {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count() + 1;
+    }
+
+
+    /**
+     * @brief ### Hierarchical timing wheel: "wake me up at `at`", in O(1).
+     *
+     * `LEVELS` wheels of `SLOTS` slots each; a slot of level `L` covers `SLOTS^L` milliseconds. A timer
+     * goes into the coarsest level it needs and, as time comes close, is cascaded down one level at a
+     * time (at most `LEVELS - 1` moves in its whole life) until it lands in level 0 and fires. Nothing
+     * ever scans the timers that are not due yet, let alone the keys without one.
+     *
+     * Timers further out than the wheel reaches (~2 years) are parked at its far end and simply fire
+     * early; whoever gets them handed out checks the real deadline anyway.
+     *
+     * Not thread safe, owned by a shard and only touched under its unique lock.
+     */
+    GO_AWAY class RapidTimingWheel {
+    public:
+        struct Timer {
+            const char* key;        // the key's slab bytes, an id, never read through by the wheel
+            std::int64_t at;
+        };
+
+        explicit RapidTimingWheel(std::int64_t now) noexcept : _tick(now) { }
+
+        /// Files `timer`; one that is already due fires on the next `advance()`.
+        void schedule(Timer timer);
+
+        /// Moves every timer due at or before `now` to the back of `due`.
+        void advance(std::int64_t now, std::vector<Timer>& due);
+
+        [[nodiscard]] std::size_t size() const noexcept { return _count; }
+
+    private:
+        static constexpr int SLOT_BITS = 6;
+        static constexpr int LEVELS = 6;
+        static constexpr std::size_t SLOTS = std::size_t{1} << SLOT_BITS;
+        static constexpr std::int64_t SLOT_MASK = SLOTS - 1;
+        static constexpr std::int64_t REACH = std::int64_t{1} << (SLOT_BITS * LEVELS);
+
+        void cascade(int level);
+
+        /// The next tick that brings any timer down from levels 1 and up.
+        [[nodiscard]] std::int64_t nextCascade() const noexcept;
+
+        std::array<std::array<std::vector<Timer>, SLOTS>, LEVELS> _slots;
+        std::array<std::uint64_t, LEVELS> _occupied{};      // one bit per non-empty slot
+        std::vector<Timer> _scratch;                        // a cascading slot, kept for its capacity
+        std::int64_t _tick;                                 // the next millisecond to fire
+        std::size_t _count = 0;
+    };
+
+
+    /**
+     * @brief ### The TTLs of one shard.
+     *
+     * Only keys that have a TTL are in here (their map entry just carries a flag, see
+     * `RapidCell::expires()`), so keys without one pay nothing for the feature, not even a byte.
+     *
+     * Keys are identified by the address of their slab bytes, which is stable for as long as the
+     * key is in the map. The map's writers keep the two in sync under the shard's unique lock.
+     *
+     * Every key has at most one live timer in the wheel: pushing a deadline back leaves the timer
+     * where it is, and when it fires, it's re-filed at the new deadline instead of expiring anything.
+     * Timers of keys that were deleted, persisted or given a sooner deadline are recognised as stale
+     * (`Deadline::scheduled` doesn't match) and dropped when they fire.
+     */
+    GO_AWAY class RapidExpiry {
+    public:
+        explicit RapidExpiry(const std::int64_t now) noexcept : _wheel(now) { }
+
+        /// `key` (owned by the shard's map) expires at `at` now, replacing any earlier deadline.
+        void set(RapidSlabString key, std::size_t hash, std::int64_t at);
+
+        /// Forgets `key`'s deadline, if it has one.
+        void remove(const RapidSlabString key) noexcept { _deadlines.erase(key.data); }
+
+        /// `key`'s deadline, `0` if it has none.
+        [[nodiscard]] std::int64_t deadline(const RapidSlabString key) const noexcept {
+            const auto it = _deadlines.find(key.data);
+            return it == _deadlines.end() ? 0 : it->second.at;
+        }
+
+        /// Number of keys with a TTL.
+        [[nodiscard]] std::size_t size() const noexcept { return _deadlines.size(); }
+
+        /**
+         * @brief Hands up to `budget` keys whose deadline is at or before `now` to `expire`.
+         *
+         * `expire(RapidSlabString key, std::size_t hash)` must take the key out of the shard, and
+         * `remove()` it from here. Keys that are due but over the budget wait for the next call.
+         *
+         * @return How many keys were handed out.
+         */
+        template <typename Fn>
+        std::size_t expireDue(const std::int64_t now, const std::size_t budget, Fn&& expire) {
+            _wheel.advance(now, _due);
+            std::size_t expired = 0;
+            while (expired < budget && !_due.empty()) {
+                const RapidTimingWheel::Timer timer = _due.back();
+                _due.pop_back();
+
+                const auto it = _deadlines.find(timer.key);
+                if (it == _deadlines.end() || it->second.scheduled != timer.at) continue;    // stale timer
+                if (it->second.at > now) {
+                    // pushed back (or further out than the wheel reaches), wait for the real deadline
+                    it->second.scheduled = it->second.at;
+                    _wheel.schedule({timer.key, it->second.at});
+                    continue;
+                }
+                expire(RapidSlabString{timer.key, it->second.size}, it->second.hash);
+                ++expired;
+            }
+            return expired;
+        }
+
+    private:
+        struct Deadline {
+            std::int64_t at;
+            std::int64_t scheduled;     // when the key's timer in the wheel fires, `<= at`
+            std::size_t hash;
+            std::uint32_t size;         // with the key's address, enough to find it in the map again
+        };
+
+        ankerl::unordered_dense::map<const char*, Deadline> _deadlines;
+        RapidTimingWheel _wheel;
+        std::vector<RapidTimingWheel::Timer> _due;      // fired, not handed out yet (over the budget)
+    };
+
+} // namespace RiRi::Internal
@@ -0,0 +1,59 @@
+#pragma once    // KEYCOMPARE.H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief Key equality, for the probes of the maps and the read index.
+     *
+     * `std::string_view`'s `==` is a `memcmp` call per candidate, and most keys are a few dozen bytes
+     * at most. Up to 32 of them, two overlapping loads per side settle it inline, without a call or
+     * a byte loop: 4, 8 or 16 (SSE2) bytes from the front and as many from the back.
+     *
+     * Longer keys do go to `memcmp`: glibc picks its AVX2 (or AVX-512) version for the CPU at load
+     * time, and a hand-rolled AVX2 loop behind our own dispatch measured slower than that.
+     */
+    GO_AWAY GET_INLINE_PLEASE bool sameKey(const std::string_view lhs, const std::string_view rhs) noexcept {
+        const std::size_t size = lhs.size();
+        if (size != rhs.size()) return false;
+        const char* a = lhs.data();
+        const char* b = rhs.data();
+
+        const auto load64 = [](const char* at) { std::uint64_t word; std::memcpy(&word, at, sizeof(word)); return word; };
+        const auto load32 = [](const char* at) { std::uint32_t word; std::memcpy(&word, at, sizeof(word)); return word; };
+        if (size >= 16) {
+            if (size > 32) return std::memcmp(a, b, size) == 0;
+#if defined(__SSE2__)
+            const auto load128 = [](const char* at) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(at)); };
+            const __m128i head = _mm_cmpeq_epi8(load128(a), load128(b));
+            const __m128i tail = _mm_cmpeq_epi8(load128(a + size - 16), load128(b + size - 16));
+            return _mm_movemask_epi8(_mm_and_si128(head, tail)) == 0xFFFF;
+#else
+            return ((load64(a) ^ load64(b)) | (load64(a + 8) ^ load64(b + 8))
+                  | (load64(a + size - 16) ^ load64(b + size - 16)) | (load64(a + size - 8) ^ load64(b + size - 8))) == 0;
+#endif
+        }
+        if (size >= 8) return ((load64(a) ^ load64(b)) | (load64(a + size - 8) ^ load64(b + size - 8))) == 0;
+        if (size >= 4) return ((load32(a) ^ load32(b)) | (load32(a + size - 4) ^ load32(b + size - 4))) == 0;
+        if (size == 0) return true;
+        // 1 to 3 bytes: the first, the middle and the last one are all of them
+        return ((a[0] ^ b[0]) | (a[size / 2] ^ b[size / 2]) | (a[size - 1] ^ b[size - 1])) == 0;
+    }
+
+} // namespace RiRi::Internal
@@ -0,0 +1,42 @@
+#pragma once    // LAZYFREE.H
+
+// Background freeing, for whatever is too big to free on the caller's time.
+//
+// A CLEAR of a store with millions of keys used to give back every slab, every index node and the
+// whole table inline, holding the shard lock; an UNLINK of a value of hundreds of megabytes, its
+// pages. Now the caller takes the garbage out of the shard (an O(1) swap) and hands it over here:
+// one thread, started on first use, frees it a bounded step at a time, taking turns between
+// everything it was handed, so a small UNLINK never waits behind a huge CLEAR.
+
+#include <cstddef>
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /// Values smaller than this are freed on the spot, even by an UNLINK: handing them over costs more.
+    inline constexpr std::size_t LAZY_FREE_MIN_BYTES = 64 * 1024;
+
+    /// Frees a bounded piece of `garbage`; `true` once it freed the last of it (`garbage` itself included).
+    GO_AWAY using RapidFreeStepFn = bool(*)(void* garbage) noexcept;
+
+    /**
+     * @brief Hands `garbage` over to the background freer, which calls `step(garbage)` until it returns `true`.
+     *
+     * Nothing else may touch `garbage` from now on; `step` runs on the freer's thread, with no lock held.
+     * Out of memory to hand it over (or to start the freer), it runs right here instead, to the last step.
+     */
+    GO_AWAY void lazyFree(void* garbage, RapidFreeStepFn step) noexcept;
+
+    /// Blocks until everything handed over so far is freed.
+    GO_AWAY void lazyFreeWait() noexcept;
+
+    /// Number of things handed over that aren't entirely freed yet.
+    GO_AWAY std::size_t lazyFreePending() noexcept;
+
+} // namespace RiRi::Internal
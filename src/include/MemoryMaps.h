@@ -1,11 +1,28 @@
 #pragma once    // MEMORYMAPS.H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <shared_mutex>
+#include <span>
+#include <thread>
 #include <variant>
 #include <string>
 #include <string_view>
 
 #include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
 #include "RiRiMacros.h"
+#include "Expiry.h"
+#include "RapidValue.h"
+#include "Numa.h"
+#include "OrderedIndex.h"
+#include "PageAllocator.h"
+#include "ReadIndex.h"
+#include "Slab.h"
+#include "ValueIndex.h"
 #include "ankerl/unordered_dense.h"
 
 
@@ -25,6 +42,69 @@
  */
 namespace RiRi::Internal {
 
+    /**
+     * @brief A key that already knows its hash.
+     *
+     * The shard of a key is picked from its `RapidHash` value, so by the time we reach a shard's map
+     * we have already paid for the hash once. Handing this to the map (instead of the raw key) makes
+     * `RapidHash` return the cached value, so every operation hashes a key exactly once.
+     *
+     * @note Non-owning, lives only as long as the `string_view` it wraps.
+     */
+    GO_AWAY struct RapidHashedKey {
+        std::string_view key;
+        std::size_t hash;
+
+        [[nodiscard]] friend bool operator==(const RapidHashedKey& lhs, const RapidSlabString& rhs) noexcept {
+            return sameKey(lhs.key, rhs.view());
+        }
+    };
+
+
+    /**
+     * @brief Inserting counterpart of `RapidHashedKey`.
+     *
+     * ankerl constructs the stored key from whatever we pass to `try_emplace`, so this converts into
+     * a `RapidSlabString` (copying the bytes into the shard's slab) only when the key actually gets
+     * inserted. If the key already exists, the slab is never touched. If the slab is out of memory,
+     * it throws `std::bad_alloc`, before ankerl changed a thing; `RapidTable::insert()` catches it.
+     */
+    GO_AWAY struct RapidSlabKey {
+        std::string_view key;
+        std::size_t hash;
+        RapidSlab& slab;
+
+        // NOLINTNEXTLINE(google-explicit-constructor): must be implicit for piecewise construction
+        operator RapidSlabString() const {
+            RapidSlabString copy;
+            if (!slabCopy(slab, key, copy)) throw std::bad_alloc();
+            return copy;
+        }
+
+        [[nodiscard]] friend bool operator==(const RapidSlabKey& lhs, const RapidSlabString& rhs) noexcept {
+            return sameKey(lhs.key, rhs.view());
+        }
+    };
+
+
+    /**
+     * @brief A stored key moving from one table to another, whose hash we already know.
+     *
+     * Same trick as `RapidSlabKey`, minus the copy: the bytes are already in the slab.
+     */
+    GO_AWAY struct RapidMovedKey {
+        RapidSlabString key;
+        std::size_t hash;
+
+        // NOLINTNEXTLINE(google-explicit-constructor): must be implicit for piecewise construction
+        operator RapidSlabString() const noexcept { return key; }
+
+        [[nodiscard]] friend bool operator==(const RapidMovedKey& lhs, const RapidSlabString& rhs) noexcept {
+            return sameKey(lhs.key.view(), rhs.view());
+        }
+    };
+
+
     /**
      * @brief Sigh, this is a workaround for the fact that ankerl's unordered_dense does not take transparent hash functions by default.
      *
@@ -59,27 +139,376 @@ namespace RiRi::Internal {
         [[nodiscard]] size_t operator()(const std::string_view sv) const noexcept {
             return ankerl::unordered_dense::hash<std::string_view>{}(sv);
         }
+
+        // stored keys, only hashed again when the map grows
+        [[nodiscard]] size_t operator()(const RapidSlabString& s) const noexcept {
+            return ankerl::unordered_dense::hash<std::string_view>{}(s.view());
+        }
+
+        // pre-hashed keys, no re-hashing
+        [[nodiscard]] size_t operator()(const RapidHashedKey& k) const noexcept { return k.hash; }
+        [[nodiscard]] size_t operator()(const RapidSlabKey& k) const noexcept { return k.hash; }
+        [[nodiscard]] size_t operator()(const RapidMovedKey& k) const noexcept { return k.hash; }
     };
 
 
     /**
-     * @brief ### Main Memory Map for Rapid Data Access.
+     * @brief The map type backing every shard.
+     *
+     * This map uses `RapidSlabString` as keys and `RapidCell`s as values, all string bytes live in
+     * the owning shard's `RapidSlab`. It is designed for fast lookups and efficient memory usage.
      *
-     * This map uses `std::string` as keys and `RapidDataType` as values.
-     * It is designed for fast lookups and efficient memory usage.
-     * 
-     * The map is initialized with a reserved size to optimize performance.
-     * 
      * @note This map is used for storing rapid data types that can be strings, integers,
      * floating-point numbers, and booleans.
-     * @see RapidDataType for the types of values stored in this map.
+     * @see RapidCell for how values are stored in this map.
+     * @see RapidPageAllocator for where its entries and buckets live.
      */
-    GO_AWAY extern ankerl::unordered_dense::map<
-        std::string,
-        RapidDataType,
+    GO_AWAY using RapidMap = ankerl::unordered_dense::map<
+        RapidSlabString,
+        RapidCell,
         RapidHash,
-        std::equal_to<>
-    > MemoryMap;
+        std::equal_to<>,
+        RapidPageAllocator<std::pair<RapidSlabString, RapidCell>>
+    >;
+
+
+    /**
+     * @brief ### A shard's hash table, optionally growing without ever stopping the world.
+     *
+     * When an ankerl map outgrows its buckets it rebuilds all of them in one go, hashing every key
+     * again (and copying every entry if its values vector is full too). At millions of keys per shard
+     * that is milliseconds, spent inside whichever write crossed the load factor, shard lock held.
+     *
+     * In incremental mode a full table is moved aside instead (`_draining`) and a fresh one, twice as
+     * big, takes its place. From then on every write moves `REHASH_STEP` entries over, until the old
+     * table is empty and goes away. A key is always in exactly one of the two, lookups check both,
+     * writers pull the key they touch into the new one first so they only ever deal with that one.
+     *
+     * The fresh table still gets its buckets zeroed up front (ankerl has no lazy buckets), but that is
+     * a memset, a small fraction of what a rehash costs.
+     *
+     * Outside of incremental mode this is a plain `RapidMap` with a slightly different interface.
+     * All writers hold the shard's unique lock, all readers at least its shared one.
+     */
+    GO_AWAY class RapidTable {
+    public:
+        using iterator = RapidMap::iterator;
+        using value_type = RapidMap::value_type;
+
+        /// Entries moved from the old table to the new one by every write during a rehash.
+        static constexpr std::size_t REHASH_STEP = 8;
+
+        /// Smaller tables grow in place like they always did, that takes microseconds.
+        static constexpr std::size_t MIN_INCREMENTAL_SIZE = 4096;
+
+        /// Sets the table up for `capacity` keys, call it while it's still empty.
+        /// `pages` decides where the entries and buckets go (huge pages, a NUMA node), for good.
+        void configure(float maxLoadFactor, std::size_t capacity, bool incremental, const RapidMap::allocator_type& pages = {});
+
+        /**
+         * @brief Finds `key` in either table (readers).
+         * @return The entry, or `nullptr` if the key isn't there
+         */
+        [[nodiscard]] const value_type* find(const RapidHashedKey& key) const noexcept;
+
+        /**
+         * @brief Finds `key` (writers). Also moves a step of the rehash along, if one is running.
+         * @return An iterator into the current table, `end()` if the key isn't there
+         */
+        [[nodiscard]] iterator findForWrite(const RapidHashedKey& key) noexcept;
+
+        /**
+         * @brief Starts pulling in the bucket a `find(key)` will look at first, without waiting for it.
+         *
+         * The first step of a batch lookup: prefetch the buckets of a group of keys, then their
+         * entries (`prefetchEntry()`), then find them; the cache misses of the whole group overlap.
+         */
+        void prefetch(const RapidHashedKey& key) const noexcept {
+            _map.prefetch_bucket(key);
+            if (rehashing()) _draining.prefetch_bucket(key);
+        }
+
+        /// Starts pulling in the entry `key`'s bucket points at; call it a while after `prefetch(key)`.
+        void prefetchEntry(const RapidHashedKey& key) const noexcept {
+            _map.prefetch_value(key);
+            if (rehashing()) _draining.prefetch_value(key);
+        }
+
+        /// Inserts `key` (with an empty value) unless it's there already, see `RapidMap::try_emplace`.
+        /// `{end(), false}` if the slab has no memory left for the key's bytes.
+        std::pair<iterator, bool> insert(const RapidSlabKey& key) noexcept;
+
+        /// Grows the table to take `keys` keys without growing again, in one go; finishes a running rehash first.
+        void reserve(std::size_t keys) noexcept;
+
+        /// `it` must come from `findForWrite()` or `insert()`.
+        void erase(const iterator it) noexcept { _map.erase(it); }
+
+        [[nodiscard]] iterator end() noexcept { return _map.end(); }
+
+        void clear() noexcept;
+
+        /**
+         * @brief Trades entries and buckets (both tables') with `other`, in O(1).
+         *
+         * What CLEAR does instead of `clear()`: swap in a fresh, configured table, free the old one in
+         * the background. `rehashes()` stays with each table, so scan cursors still notice.
+         */
+        void swap(RapidTable& other) noexcept {
+            _map.swap(other._map);
+            _draining.swap(other._draining);
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return _map.size() + _draining.size(); }
+
+        /// The `index`-th entry, `index < size()`, in no particular order; for picking keys at random.
+        [[nodiscard]] const value_type& at(const std::size_t index) const noexcept {
+            return index < _map.size() ? _map.values()[index] : _draining.values()[index - _map.size()];
+        }
+
+        /**
+         * @brief The entries of the current table, or of the old one (`draining`), in storage order.
+         *
+         * Erasing an entry moves the last one into its slot, and rehash steps only ever take the old
+         * table's last entry, so walking either one from the back never misses an entry that was
+         * there all along (a scan cursor is a slot count, see `scanStore()`).
+         */
+        [[nodiscard]] std::span<const value_type> entries(const bool draining) const noexcept {
+            return draining ? std::span<const value_type>(_draining.values()) : std::span<const value_type>(_map.values());
+        }
+
+        /// How many rehashes were started; one moves every entry to the old table, invalidating slot counts.
+        [[nodiscard]] std::uint32_t rehashes() const noexcept { return _rehashes; }
+
+        /// How many keys fit in before the table has to grow (again).
+        [[nodiscard]] std::size_t capacity() const noexcept;
+
+        /// Bytes of the bucket arrays, both tables'.
+        [[nodiscard]] std::size_t bucketBytes() const noexcept;
+
+        /// Bytes of the dense vectors the entries live in, spare capacity included, both tables'.
+        [[nodiscard]] std::size_t entryBytes() const noexcept;
+
+        [[nodiscard]] bool rehashing() const noexcept { return !_draining.empty(); }
+
+        /**
+         * @brief Whether the table is worth shrinking: fewer keys than `lowWater` times what it holds
+         * (`capacity()`), and a shrink would end up smaller. Never while a rehash is running.
+         */
+        [[nodiscard]] bool sparse(float lowWater) const noexcept;
+
+        /**
+         * @brief Moves the table into a smaller one, sized for twice its keys (but no smaller than it was set up for).
+         *
+         * Exactly like a rehash that grows it, entries move over a few at a time, with every write
+         * (and with `drain()`), lookups check both tables until the old one is empty and goes away,
+         * its buckets and its entries' spare capacity with it. Call it only if `sparse()`.
+         */
+        void startShrink() noexcept;
+
+        /// Moves up to `entries` entries of a running rehash (or shrink) over. @return `true` once none are left
+        bool drain(const std::size_t entries) noexcept {
+            rehashStep(entries);
+            return !rehashing();
+        }
+
+        /// The `index`-th entry of the current table, `index < size()`, for writers; only while `!rehashing()`.
+        [[nodiscard]] iterator entryAt(const std::size_t index) noexcept {
+            RIRI_ASSERT(!rehashing() && index < _map.size());
+            return _map.begin() + static_cast<std::ptrdiff_t>(index);
+        }
+
+        /**
+         * @brief Calls `fn(key, value)` for every entry, until it returns `false`.
+         * @return `false` if `fn` stopped it
+         */
+        template <typename Fn>
+        bool forEach(Fn&& fn) const {
+            for (const RapidMap* table : {&_map, &_draining}) {
+                for (const auto& [key, value] : *table) {
+                    if (!fn(key, value)) return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        /// Moves `_map` aside and starts over in a table reserved for `keys`, see the rehash above.
+        void startRehash(std::size_t keys) noexcept;
+        void rehashStep(std::size_t entries) noexcept;
+
+        /// What a shrink sizes the table for: twice its keys, but no less than it was set up for.
+        [[nodiscard]] std::size_t shrunkSize() const noexcept { return std::max(_map.size() * 2, _floor); }
+
+        RapidMap _map;
+        RapidMap _draining;         // the outgrown (or oversized) table, empty unless a rehash is running
+        std::size_t _floor = 0;     // the capacity it was set up for, it never shrinks below that
+        std::uint32_t _rehashes = 0;
+        bool _incremental = false;
+    };
+
+
+    /// Number of shards a store gets when nobody asks for anything else (must be a power of two).
+    inline constexpr std::size_t DEFAULT_SHARD_COUNT = StoreOptions{}.shardCount;
+
+    /// ankerl uses the lowest byte of the hash as the bucket fingerprint, and the upper bits as the
+    /// bucket index, so the shard index is taken from the bits right above the fingerprint.
+    inline constexpr std::size_t SHARD_HASH_SHIFT = 8;
+
+
+    /**
+     * @brief One independently locked slice of the store.
+     *
+     * Readers take the lock shared, writers take it exclusive. Each shard sits on its own cache
+     * line(s), so two threads hammering two different shards never fight over the same line.
+     *
+     * `slab` owns the bytes of every key and string value in `map`, whoever takes an entry out of
+     * `map` gives its bytes back to `slab`.
+     *
+     * In concurrent-reads mode, `reads` mirrors `map` and readers go there instead, without the lock.
+     * Outside of it, `reads` is null and costs nothing. Same for `values`, the reverse (value -> keys)
+     * index, and `ordered`, the sorted key index, which only exist if the store was asked for them,
+     * and for `expiry`, which only exists once a key of the shard got a TTL.
+     *
+     * `keyBytes` and `valueBytes` count the slab bytes of the shard's keys and string values, kept
+     * up to date by the writers; what the table itself takes is read off `map`.
+     *
+     * `version` is the last version handed out: every write of a value gives it the next one (kept in
+     * its key, see `RapidSlabString::version`). Never reset, not even by a CLEAR, so a version is
+     * never seen twice in a shard, whatever was deleted and created again in between.
+     *
+     * A compaction (`COMPACT`, or `compactBelow` on its own) moves the entries' strings out of the
+     * slabs `slab` retired, `compactCursor` entries to go, from the back of `map`; `compactRehashes`
+     * is `map.rehashes()` when it counted them, a rehash since means starting the walk over.
+     */
+    GO_AWAY struct alignas(RIRI_CACHE_LINE_SIZE) RapidShard {
+        mutable std::shared_mutex lock;
+        RapidSlab slab;
+        RapidTable map;
+        std::unique_ptr<RapidReadIndex> reads;
+        std::unique_ptr<RapidValueIndex> values;
+        std::unique_ptr<RapidOrderedIndex> ordered;
+        std::unique_ptr<RapidExpiry> expiry;
+        std::size_t keyBytes = 0;
+        std::size_t valueBytes = 0;
+        std::uint64_t version = 0;
+        float compactBelow = 0.0f;
+        std::size_t compactCursor = 0;
+        std::uint32_t compactRehashes = 0;
+
+        /// What an entry costs on top of its key and value bytes, as far as the memory budget goes: the
+        /// entry and its bucket. The real table grows in steps, charging those would make writes fail at random.
+        static constexpr std::size_t ENTRY_BYTES = sizeof(RapidTable::value_type) + sizeof(RapidMap::bucket_type);
+
+        /// What the shard is charged against the store's memory budget.
+        [[nodiscard]] std::size_t used() const noexcept { return keyBytes + valueBytes + map.size() * ENTRY_BYTES; }
+    };
+
+
+    /**
+     * @brief ### Sharded Memory Store for Rapid Data Access.
+     *
+     * A fixed, power-of-two number of `RapidShard`s. A key always lives in the shard picked by its
+     * `RapidHash` value, so unrelated keys can be read and written from different threads without
+     * contending on a single lock, and throughput grows with the number of cores.
+     *
+     * @note The shard count is fixed for the lifetime of the store (keys never move across shards).
+     *
+     * In concurrent-reads mode, lookups skip the shard locks entirely and go through every shard's
+     * lock-free `RapidReadIndex` instead; writers keep both in sync under the shard's unique lock.
+     * This trades some write throughput (and memory) for reads that never wait on, or write to
+     * the same memory as, anybody else. Values returned in this mode are guarded by the epoch
+     * reclaimer, see `RiRi::ReadGuard`.
+     *
+     * Keys with a TTL are expired by the writes to their shard, a few at a time, and, if the store was
+     * asked for one (`StoreOptions::expirySweepInterval`), by a background sweeper owned by the store.
+     *
+     * A memory budget (`StoreOptions::maxMemory`) is enforced per shard, under the shard's lock, with
+     * `maxMemory / shardCount` bytes each: no global counter for every write to fight over.
+     */
+    GO_AWAY class RapidStore {
+    public:
+        /**
+         * @param options See `StoreOptions`. The shard count is rounded up to the next power of two
+         * (minimum 1), the initial capacity is spread evenly over the shards.
+         */
+        explicit RapidStore(const StoreOptions& options);
+
+        RapidStore(const RapidStore&) = delete;
+        RapidStore& operator=(const RapidStore&) = delete;
+
+        /// Hash a key with the same function the shard maps use.
+        [[nodiscard]] static std::size_t hash(const std::string_view key) noexcept {
+            return RapidHash{}(key);
+        }
+
+        /// `known` if the caller already hashed the key (`RiRi::RapidKey`, `RapidNode::hash`), computed otherwise.
+        /// Trusted as is: a wrong one sends the key to the wrong shard and slot, dev-mode builds check it.
+        [[nodiscard]] static std::size_t hash(const std::string_view key, const std::size_t known) noexcept {
+            RIRI_ASSERT(known == 0 || known == hash(key));
+            return known ? known : hash(key);
+        }
+
+        [[nodiscard]] std::size_t shardIndex(const std::size_t hash) const noexcept {
+            return (hash >> SHARD_HASH_SHIFT) & _shard_mask;
+        }
+
+        [[nodiscard]] RapidShard& shardFor(const std::size_t hash) noexcept {
+            return _shards[shardIndex(hash)];
+        }
+
+        [[nodiscard]] RapidShard& shard(const std::size_t index) noexcept { return _shards[index]; }
+
+        [[nodiscard]] std::size_t shardCount() const noexcept { return _shard_mask + 1; }
+
+        [[nodiscard]] bool concurrentReads() const noexcept { return _options.concurrentReads; }
+
+        /// The options actually in effect (rounded and clamped).
+        [[nodiscard]] const StoreOptions& options() const noexcept { return _options; }
+
+        /// Bytes every shard may use, `0` for no limit.
+        [[nodiscard]] std::size_t shardBudget() const noexcept { return _shard_budget; }
+
+        /// Bytes past which a shard's writes warn that it's nearly full, `SIZE_MAX` for never.
+        [[nodiscard]] std::size_t shardWarning() const noexcept { return _shard_warning; }
+
+        /**
+         * @brief The NUMA node shard `index`'s memory comes from, `-1` if the store doesn't care.
+         *
+         * Nodes get contiguous runs of shards (shard `i` of `n` on node `i * nodes / n`), the same
+         * way the work pool spreads its threads, so parallel batches mostly run each shard on its node.
+         */
+        [[nodiscard]] int shardNode(const std::size_t index) const noexcept {
+            return _numa ? numaNodes()[index * numaNodes().size() / shardCount()] : -1;
+        }
+
+        /// Sets a fresh table and slab up the way shard `index`'s were: load factor, initial capacity, pages, node.
+        void setUp(std::size_t index, RapidTable& map, RapidSlab& slab) const;
+
+        /// Whether key uses have to be stamped: there's a budget, and keys get evicted for it.
+        [[nodiscard]] bool tracksUses() const noexcept {
+            return _shard_budget != 0 && _options.eviction != EvictionPolicy::Reject;
+        }
+
+    private:
+        StoreOptions _options;
+        std::unique_ptr<RapidShard[]> _shards;
+        std::size_t _shard_mask;
+        std::size_t _shard_budget = 0;
+        std::size_t _shard_warning = SIZE_MAX;
+        bool _numa = false;         // asked for, and there's more than one node
+        std::jthread _sweeper;      // last, so it's stopped before the shards go away
+    };
+
+
+    /**
+     * @brief ### Main Memory Store for Rapid Data Access.
+     *
+     * The default store every free `Internal::*` function (and so every `Commands::*` function) works on.
+     *
+     * The store is initialized with a reserved size to optimize performance.
+     */
+    GO_AWAY extern RapidStore MemoryMap;
 
     // We are using ankerl::unordered_dense::map<std::string, RapidDataType> with a custom hash.
     // This allows us to store various types of data in the map, including strings, integers, doubles, and booleans.
@@ -0,0 +1,39 @@
+#pragma once    // NUMA.H
+
+#include <cstddef>
+#include <vector>
+
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief The NUMA nodes that have memory, in order; just `{0}` on single-node machines and
+     * wherever we can't tell.
+     *
+     * Read once, through libnuma if the library was built with it (`RIRI_LIBNUMA`), from sysfs
+     * otherwise.
+     */
+    [[nodiscard]] GO_AWAY const std::vector<int>& numaNodes() noexcept;
+
+    /**
+     * @brief Asks for the pages of `[pages, pages + bytes)` to come from `node`, when they're first touched.
+     *
+     * A preference (`MPOL_PREFERRED`), not a hard binding: a node that's out of memory spills over
+     * to the others instead of failing the allocation. Pages already touched stay where they are.
+     * Partial pages at either end are left alone, they may be somebody else's.
+     *
+     * @return `false` if the kernel said no (no NUMA support, or a container that hides it)
+     */
+    GO_AWAY bool bindToNode(void* pages, std::size_t bytes, int node) noexcept;
+
+    /// Restricts the calling thread to the CPUs of `node`, `false` if it couldn't be done.
+    GO_AWAY bool runOnNode(int node) noexcept;
+
+} // namespace RiRi::Internal
@@ -0,0 +1,119 @@
+#pragma once    // ORDEREDINDEX.H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "RiRiMacros.h"
+#include "Slab.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief ### Ordered index of one shard's keys: a B+tree.
+     *
+     * The map can find a key, but not "every key after this one"; this can, in O(log n) to get there
+     * and O(1) per key after that. Leaves hold up to `FANOUT` keys each, in order, and are chained
+     * together, so a range scan is a descent and then a walk along the chain.
+     *
+     * Leaves point at the keys' slab bytes (owned by the shard's map, like the value index does);
+     * inner nodes own copies of their separators, since the key a separator came from may be long
+     * gone by the time the separator is looked at.
+     *
+     * Erasing never merges nodes, it only drops the ones that became empty: a tree that shrank a lot
+     * has some half-empty leaves, which costs a little memory, never correctness.
+     *
+     * Not thread safe: the shard's writers keep it in sync with the map under the shard's unique
+     * lock, readers walk it under (at least) the shared one.
+     */
+    GO_AWAY class RapidOrderedIndex {
+    public:
+        RapidOrderedIndex() noexcept = default;
+        ~RapidOrderedIndex() { clear(); }
+
+        RapidOrderedIndex(const RapidOrderedIndex&) = delete;
+        RapidOrderedIndex& operator=(const RapidOrderedIndex&) = delete;
+
+        /**
+         * @brief Adds `key` (owned by the shard's map), which must not be in here yet.
+         * @return `false` if out of memory; nothing changed then
+         */
+        [[nodiscard]] bool insert(RapidSlabString key) noexcept;
+
+        /// Takes `key` out, if it's in here.
+        void erase(std::string_view key) noexcept;
+
+        /// Points the index at `key`'s new bytes (same string, moved to another spot in the slab), if it's in here.
+        void rekey(RapidSlabString key) noexcept;
+
+        void clear() noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+        /**
+         * @brief Calls `fn(RapidSlabString key)` for every key `>= from`, in order, until it returns `false`.
+         */
+        template <typename Fn>
+        void forEachFrom(const std::string_view from, Fn&& fn) const {
+            const Leaf* leaf = nullptr;
+            std::size_t i = 0;
+            seek(from, leaf, i);
+            for (; leaf != nullptr; leaf = leaf->next, i = 0) {
+                for (; i < leaf->count; ++i) {
+                    if (!fn(leaf->keys[i])) return;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t FANOUT = 64;
+        static constexpr std::size_t MAX_DEPTH = 16;     // 64^16 keys, plenty
+
+        struct Node {
+            bool leaf;
+            std::uint32_t count = 0;       // keys of a leaf, children of an inner node
+        };
+
+        struct Leaf : Node {
+            Leaf() noexcept : Node{true} { }
+            std::array<RapidSlabString, FANOUT> keys;
+            Leaf* prev = nullptr;
+            Leaf* next = nullptr;
+        };
+
+        struct Inner : Node {
+            Inner() noexcept : Node{false} { }
+            std::array<std::string, FANOUT - 1> separators;     // `separators[i] <=` every key under `children[i + 1]`
+            std::array<Node*, FANOUT> children;
+        };
+
+        /// An inner node on the way down, and which child the descent took.
+        struct Step {
+            Inner* node;
+            std::uint32_t child;
+        };
+
+        /// The child of `node` that `key` belongs under.
+        [[nodiscard]] static std::uint32_t route(const Inner& node, std::string_view key) noexcept;
+
+        /// The leaf `key` belongs in, and the descent that got there (`path`, `depth` steps long).
+        [[nodiscard]] Leaf* descend(std::string_view key, std::array<Step, MAX_DEPTH>& path, std::size_t& depth) const noexcept;
+
+        /// The first key `>= from`: `leaf` and `i` (past the end of a leaf means the next one).
+        void seek(std::string_view from, const Leaf*& leaf, std::size_t& i) const noexcept;
+
+        static void destroy(Node* node) noexcept;
+
+        Node* _root = nullptr;
+        std::size_t _size = 0;
+    };
+
+} // namespace RiRi::Internal
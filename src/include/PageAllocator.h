@@ -0,0 +1,122 @@
+#pragma once    // PAGEALLOCATOR.H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /// Size of a normal page, and of a huge page (x86-64 and aarch64 with 4K base pages, which is what we run on).
+    inline constexpr std::size_t BASE_PAGE_SIZE = 4096;
+    inline constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+
+    /// Blocks smaller than this stay on the heap even for a NUMA node: not worth a mapping of their own.
+    inline constexpr std::size_t NODE_MIN_BYTES = 64 * 1024;
+
+    /**
+     * @brief Maps `bytes` (a multiple of `HUGE_PAGE_SIZE`) backed by huge pages, if we can get them.
+     *
+     * Explicit ones (`MAP_HUGETLB`, out of the pool the admin reserved) first; if there are none,
+     * plain pages aligned to `HUGE_PAGE_SIZE` with `madvise(MADV_HUGEPAGE)`, so transparent huge
+     * pages can back them (now or once khugepaged gets to it). If neither is on, that's ordinary
+     * memory, it just doesn't get the TLB savings.
+     *
+     * @param node NUMA node the pages should come from (see `bindToNode()`), `-1` for wherever
+     * @return The mapping, `nullptr` if the system is out of memory
+     */
+    [[nodiscard]] GO_AWAY void* mapHugePages(std::size_t bytes, int node = -1) noexcept;
+
+    /// Maps `bytes` (a multiple of `BASE_PAGE_SIZE`) of normal pages, from `node` if it's not `-1`.
+    [[nodiscard]] GO_AWAY void* mapPages(std::size_t bytes, int node = -1) noexcept;
+
+    /// Unmaps what `mapHugePages(bytes)` or `mapPages(bytes)` returned.
+    GO_AWAY void unmapPages(void* pages, std::size_t bytes) noexcept;
+
+    /// `false` once a `MAP_HUGETLB` mapping failed: there's no pool to take from, we stopped asking.
+    [[nodiscard]] GO_AWAY bool explicitHugePages() noexcept;
+
+
+    /**
+     * @brief ### Allocator for the hash tables' entries and buckets, optionally on huge pages.
+     *
+     * A shard with millions of keys has its dense entry vector and its bucket array spread over
+     * hundreds of thousands of 4K pages; every random lookup pays a TLB miss (a page walk) on top
+     * of its two cache misses. On 2MB pages the same arrays take a few hundred TLB entries, which
+     * mostly fit.
+     *
+     * Stateful: `huge` is picked per store (`StoreOptions::hugePages`), `node` per shard (for NUMA
+     * aware stores, `StoreOptions::numaAware`), and both travel with the table through moves and
+     * swaps. Only blocks of at least one huge page get huge pages, and only blocks of at least
+     * `NODE_MIN_BYTES` get a node; those are mapped, everything smaller comes from `operator new`
+     * like it always did. The size alone tells `deallocate()` which one it was.
+     */
+    template <typename T>
+    class RapidPageAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        RapidPageAllocator() noexcept = default;
+        explicit RapidPageAllocator(const bool huge, const int node = -1) noexcept : _huge(huge), _node(node) { }
+
+        template <typename U>
+        // NOLINTNEXTLINE(google-explicit-constructor): containers rebind it implicitly (the buckets)
+        RapidPageAllocator(const RapidPageAllocator<U>& other) noexcept : _huge(other.huge()), _node(other.node()) { }
+
+        [[nodiscard]] bool huge() const noexcept { return _huge; }
+        [[nodiscard]] int node() const noexcept { return _node; }
+
+        [[nodiscard]] T* allocate(const std::size_t n) {
+            const std::size_t bytes = n * sizeof(T);
+            void* pages;
+            if (hugeMapped(bytes)) {
+                pages = mapHugePages(rounded(bytes, HUGE_PAGE_SIZE), _node);
+            } else if (nodeMapped(bytes)) {
+                pages = mapPages(rounded(bytes, BASE_PAGE_SIZE), _node);
+            } else {
+                return static_cast<T*>(::operator new(bytes));
+            }
+            if (pages == nullptr) throw std::bad_alloc();
+            return static_cast<T*>(pages);
+        }
+
+        void deallocate(T* ptr, const std::size_t n) noexcept {
+            const std::size_t bytes = n * sizeof(T);
+            if (hugeMapped(bytes)) {
+                unmapPages(ptr, rounded(bytes, HUGE_PAGE_SIZE));
+            } else if (nodeMapped(bytes)) {
+                unmapPages(ptr, rounded(bytes, BASE_PAGE_SIZE));
+            } else {
+                ::operator delete(ptr, bytes);
+            }
+        }
+
+        template <typename U>
+        [[nodiscard]] bool operator==(const RapidPageAllocator<U>& other) const noexcept {
+            return _huge == other.huge() && _node == other.node();
+        }
+
+    private:
+        [[nodiscard]] bool hugeMapped(const std::size_t bytes) const noexcept { return _huge && bytes >= HUGE_PAGE_SIZE; }
+        [[nodiscard]] bool nodeMapped(const std::size_t bytes) const noexcept { return _node >= 0 && bytes >= NODE_MIN_BYTES; }
+
+        [[nodiscard]] static std::size_t rounded(const std::size_t bytes, const std::size_t page) noexcept {
+            return (bytes + page - 1) & ~(page - 1);
+        }
+
+        bool _huge = false;
+        int _node = -1;
+    };
+
+} // namespace RiRi::Internal
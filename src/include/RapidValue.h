@@ -0,0 +1,182 @@
+#pragma once    // RAPIDVALUE.H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "riri/RapidTypes.hpp"
+#include "RiRiMacros.h"
+#include "Slab.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief ### How a value is actually stored inside a shard: a 16 byte tagged cell.
+     *
+     * `RapidDataType` is a `std::variant` around a `std::string`, ~40 bytes per value, even though
+     * most values are ints, doubles or bools. A cell is 15 payload bytes and a tag byte:
+     *
+     * - int64 / double / bool: the first 8 (or 1) payload bytes
+     * - strings of up to 15 bytes: inline, right in the payload, no slab, no pointer chasing
+     * - longer strings: a `RapidSlabString` (pointer + length) into the shard's `RapidSlab`
+     *
+     * Trivially copyable and destructible; a default constructed cell is an empty string.
+     *
+     * It never leaves the internal zone: writers convert a `RapidDataType` into it on the way in,
+     * readers convert it back on the way out (see `snapshotValue()`).
+     */
+    GO_AWAY class alignas(8) RapidCell {
+    public:
+        /// Same order as the alternatives of `RapidDataType`, so a kind is also a variant index.
+        enum class Kind : std::uint8_t { String = 0, Int = 1, Double = 2, Bool = 3 };
+
+        /// Longest string that fits into the cell itself.
+        static constexpr std::size_t INLINE_CAPACITY = 15;
+
+        RapidCell() noexcept = default;
+
+        [[nodiscard]] static RapidCell ofInt(const std::int64_t value) noexcept { return of(Kind::Int, value); }
+        [[nodiscard]] static RapidCell ofDouble(const double value) noexcept { return of(Kind::Double, value); }
+        [[nodiscard]] static RapidCell ofBool(const bool value) noexcept { return of(Kind::Bool, value); }
+
+        /// `str` must be at most `INLINE_CAPACITY` bytes long.
+        [[nodiscard]] static RapidCell ofInline(const std::string_view str) noexcept {
+            RIRI_ASSERT(str.size() <= INLINE_CAPACITY);
+            RapidCell cell;
+            std::memcpy(cell._bytes, str.data(), str.size());
+            cell._tag = static_cast<std::uint8_t>(str.size() << LENGTH_SHIFT);
+            return cell;
+        }
+
+        [[nodiscard]] static RapidCell ofSlab(const RapidSlabString str) noexcept {
+            // field by field, a RapidSlabString is padded to 16 bytes
+            RapidCell cell = of(Kind::String, str.data);
+            std::memcpy(cell._bytes + sizeof(str.data), &str.size, sizeof(str.size));
+            cell._tag |= OUT_OF_LINE;
+            return cell;
+        }
+
+        [[nodiscard]] Kind kind() const noexcept { return static_cast<Kind>(_tag & KIND_MASK); }
+
+        /// Whether this is a string whose bytes live in the slab (and have to be given back).
+        [[nodiscard]] bool inSlab() const noexcept { return (_tag & OUT_OF_LINE) != 0; }
+
+        /// Whether the entry holding this cell has a TTL (its deadline lives in the shard's `RapidExpiry`).
+        [[nodiscard]] bool expires() const noexcept { return (_tag & EXPIRES) != 0; }
+
+        void setExpires(const bool expires) noexcept {
+            _tag = static_cast<std::uint8_t>(expires ? _tag | EXPIRES : _tag & ~EXPIRES);
+        }
+
+        [[nodiscard]] std::int64_t asInt() const noexcept { return as<std::int64_t>(); }
+        [[nodiscard]] double asDouble() const noexcept { return as<double>(); }
+        [[nodiscard]] bool asBool() const noexcept { return as<bool>(); }
+        [[nodiscard]] RapidSlabString asSlabString() const noexcept {
+            RapidSlabString str{as<const char*>()};
+            std::memcpy(&str.size, _bytes + sizeof(str.data), sizeof(str.size));
+            return str;
+        }
+
+        [[nodiscard]] std::string_view asString() const noexcept {
+            if (inSlab()) return asSlabString().view();
+            return {_bytes, static_cast<std::size_t>(_tag >> LENGTH_SHIFT)};
+        }
+
+    private:
+        static constexpr std::uint8_t KIND_MASK = 0b0011;
+        static constexpr std::uint8_t OUT_OF_LINE = 0b0100;
+        static constexpr std::uint8_t EXPIRES = 0b1000;     // a flag of the entry, not of the value
+        static constexpr int LENGTH_SHIFT = 4;      // inline string length, 0..15
+
+        template <typename T>
+        [[nodiscard]] static RapidCell of(const Kind kind, const T& value) noexcept {
+            static_assert(sizeof(T) <= sizeof(_bytes));
+            RapidCell cell;
+            std::memcpy(cell._bytes, &value, sizeof(T));
+            cell._tag = static_cast<std::uint8_t>(kind);
+            return cell;
+        }
+
+        template <typename T>
+        [[nodiscard]] T as() const noexcept {
+            T value;
+            std::memcpy(&value, _bytes, sizeof(T));
+            return value;
+        }
+
+        char _bytes[INLINE_CAPACITY] = {};
+        std::uint8_t _tag = 0;      // kind | OUT_OF_LINE | EXPIRES | inline length << LENGTH_SHIFT
+    };
+
+    static_assert(sizeof(RapidCell) == 16);
+    static_assert(std::is_trivially_copyable_v<RapidCell>);
+
+
+    /// Stores `value` in `slab` (string bytes are copied, `value` is left as is); `false` if the slab is out of memory.
+    GO_AWAY [[nodiscard]] bool storeValue(RapidSlab& slab, const RapidDataType& value, RapidCell& cell) noexcept;
+
+    /// Gives the slab bytes of `value` (if any) back to `slab`.
+    GO_AWAY void freeValue(RapidSlab& slab, const RapidCell& value) noexcept;
+
+    /// Writes `value` into `out`, reusing `out`'s string buffer if it already holds a string; `false`
+    /// if out of memory for the string, `out` is as it was then.
+    GO_AWAY [[nodiscard]] bool loadValue(const RapidCell& value, RapidDataType& out) noexcept;
+    GO_AWAY [[nodiscard]] bool loadValue(const RapidDataType& value, RapidDataType& out) noexcept;
+
+    /// Compares a stored value with a public one, without converting either.
+    GO_AWAY bool sameValue(const RapidCell& value, const RapidDataType& other) noexcept;
+
+    /**
+     * @brief Writes `bytes` at `offset` of the string in `value`, which becomes `size` bytes long (any gap zero filled).
+     *
+     * The old bytes stay where they are if their slab block has room (see `RapidSlab::grow()`), a
+     * short string stays in its cell; the TTL flag is kept. `value` must be a string, `size` at least
+     * as long as it and `offset + bytes.size()`.
+     *
+     * @return `false` if the slab is out of memory, nothing changed then. Otherwise `cell` is the new
+     * cell, and `value` is stale.
+     */
+    GO_AWAY [[nodiscard]] bool spliceValue(RapidSlab& slab, const RapidCell& value, std::size_t offset, std::string_view bytes, std::size_t size, RapidCell& cell) noexcept;
+
+
+    /**
+     * @brief Starts a read: values snapshotted after this replace the ones from the previous read.
+     *
+     * Unless some response still holds a `readLease()` on those, then the thread moves on to a fresh
+     * buffer; or the calling thread holds a `RiRi::ReadGuard`, then they pile up until the guard is gone.
+     */
+    GO_AWAY void beginRead() noexcept;
+
+    /**
+     * @brief Copies `value` into the calling thread's read buffer and returns the copy.
+     *
+     * The copy belongs to the thread, not to the store, so writers can't pull it out from under the
+     * caller. It stays valid until the thread's next read, unless a `readLease()` (or the thread's
+     * `RiRi::ReadGuard`) keeps it around. Buffer slots (and their string capacity) are reused when
+     * nothing does, so steady-state reads don't allocate. `nullptr` if out of memory, see `readStarved()`.
+     */
+    GO_AWAY const RapidDataType* snapshotValue(const RapidCell& value) noexcept;
+
+    /// `snapshotValue()` for a value lock-free readers found (see `RapidReadIndex`); the caller must be pinned.
+    GO_AWAY const RapidDataType* snapshotValue(const RapidDataType& value) noexcept;
+
+    /// `snapshotValue()` for a piece of a string: only `str` is copied.
+    GO_AWAY std::string_view snapshotString(std::string_view str) noexcept;
+
+    /**
+     * @brief Claims `slots.size()` slots of the calling thread's read buffer, for other threads to
+     * fill in with `loadValue()` (a parallel batch's workers); valid just as long as a snapshot.
+     * @return `false` if out of memory, a starved read then
+     */
+    GO_AWAY [[nodiscard]] bool claimSnapshots(std::span<RapidDataType*> slots) noexcept;
+
+} // namespace RiRi::Internal
@@ -0,0 +1,127 @@
+#pragma once    // READINDEX.H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "riri/RapidTypes.hpp"
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief An immutable key-value snapshot, as seen by lock-free readers.
+     *
+     * Never modified after it's published, but for `expiresAt` and `stamp`; an update publishes a new
+     * entry and retires the old one.
+     */
+    GO_AWAY struct RapidReadEntry {
+        std::size_t hash;
+        std::string key;
+        RapidDataType value;
+        mutable std::int64_t expiresAt = 0;     // `expiryNow()` deadline, 0 if the key has no TTL; only through `std::atomic_ref`
+        std::uint64_t version = 0;              // the value's version, see `RapidShard::version`
+        mutable std::uint32_t stamp = 0;        // lock-free readers' uses, for eviction; only through `std::atomic_ref`
+    };
+
+
+    /**
+     * @brief Open-addressing slot array of a `RapidReadIndex`.
+     *
+     * Linear probing over atomic pointers. `used` counts live entries and tombstones, and is kept
+     * at or below half the capacity, so a probe always hits an empty slot eventually.
+     */
+    GO_AWAY struct RapidReadTable {
+        std::size_t shift;      // slot = hash >> shift (the upper bits, the shard index lives in the low ones)
+        std::size_t mask;
+        std::size_t used = 0;   // writer only
+        std::size_t live = 0;   // writer only
+        std::size_t moved = 0;  // writer only, slots of `from` gone through so far
+        std::atomic<RapidReadTable*> from{nullptr};     // the outgrown table, while its entries move in
+        std::unique_ptr<std::atomic<const RapidReadEntry*>[]> slots;
+    };
+
+
+    /**
+     * @brief ### Lock-free read view of one shard.
+     *
+     * Mirrors a shard's map for readers that must not take the shard lock. Writers (holding the
+     * shard's unique lock, so there is only ever one of them) publish and erase entries; readers
+     * just probe, with a handful of acquire loads and zero stores to shared memory.
+     *
+     * Anything a reader could still see (replaced entries, erased entries, outgrown slot arrays) is
+     * handed to the epoch reclaimer instead of being freed, so readers must be inside
+     * `epochEnter()`/`epochExit()` (or a `RiRi::ReadGuard`) while they hold a result.
+     *
+     * Growing is incremental, like `RapidTable`'s: a bigger table takes over and every write moves
+     * `GROW_STEP` slots of the outgrown one into it. Readers look in the outgrown table first, then in
+     * the new one: an entry is published in its new slot before its old one is cleared.
+     */
+    GO_AWAY class RapidReadIndex {
+    public:
+        /// Slots of the outgrown table every write goes through; a table never shrinks to less than a quarter, so it's done in time.
+        static constexpr std::size_t GROW_STEP = 16;
+
+        RapidReadIndex();
+        ~RapidReadIndex();
+
+        RapidReadIndex(const RapidReadIndex&) = delete;
+        RapidReadIndex& operator=(const RapidReadIndex&) = delete;
+
+        /**
+         * @brief Lock-free lookup, safe to call concurrently with one writer.
+         * @return The published value, or `nullptr` if the key isn't there (or its TTL ran out)
+         */
+        [[nodiscard]] const RapidDataType* find(std::string_view key, std::size_t hash) const noexcept;
+
+        /// `find()`, the whole entry: for the value's version.
+        [[nodiscard]] const RapidReadEntry* findEntry(std::string_view key, std::size_t hash) const noexcept;
+
+        /// Starts pulling in the slot a `find()` of `hash` starts at, see `RapidTable::prefetch()`.
+        void prefetch(std::size_t hash) const noexcept;
+
+        /// Starts pulling in the entry in that slot; call it a while after `prefetch(hash)`.
+        void prefetchEntry(std::size_t hash) const noexcept;
+
+        /**
+         * @brief A new entry of `key` for `publish()`, and room for it (writer side, shard lock held).
+         *
+         * All a publish allocates, allocated before the write changes anything else: out of memory, it
+         * backs out with the store as it was.
+         * @return `nullptr` if out of memory
+         */
+        [[nodiscard]] std::unique_ptr<RapidReadEntry> prepare(std::string_view key, std::size_t hash, RapidDataType value) noexcept;
+
+        /// Inserts or replaces the entry of its key (writer side, shard lock held). A replacement keeps the readers' `stamp`.
+        void publish(std::unique_ptr<RapidReadEntry> entry, std::int64_t expiresAt = 0, std::uint64_t version = 0) noexcept;
+
+        /// Gives the entry of `key` a new deadline (`0` for none), in place (writer side, shard lock held).
+        void expire(std::string_view key, std::size_t hash, std::int64_t expiresAt) noexcept;
+
+        /// Removes `key`, if present (writer side, shard lock held). `lazy` leaves freeing its entry to the background freer.
+        void erase(std::string_view key, std::size_t hash, bool lazy = false) noexcept;
+
+        /// Drops everything (writer side, shard lock held); the entries are freed in the background, see `lazyFree()`.
+        void clear() noexcept;
+
+        /// Whether an outgrown table is still being moved out of.
+        [[nodiscard]] bool growing() const noexcept;
+
+    private:
+        /// Throws `std::bad_alloc` (only) if out of memory, before it changes anything.
+        void grow();
+        void moveSome(RapidReadTable& table, std::size_t slots) noexcept;
+
+        std::atomic<RapidReadTable*> _table;
+    };
+
+} // namespace RiRi::Internal
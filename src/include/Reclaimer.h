@@ -0,0 +1,63 @@
+#pragma once    // RECLAIMER.H
+
+// Epoch-based memory reclamation for the lock-free read path.
+//
+// Readers announce "I might be looking at shared memory" by pinning the current global epoch in
+// their own (per-thread, cache line sized) record. Writers never free memory that readers may
+// still see; they retire it instead, tagged with the epoch it was retired in. Once every pinned
+// reader has moved past that epoch, nobody can hold a pointer to it anymore, and it is freed.
+// Each thread keeps what it retired to itself, so writers never wait on each other to retire.
+
+#include <cstddef>
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ * Use `RiRi::ReadGuard` instead.
+ */
+namespace RiRi::Internal {
+
+    /// Frees whatever was retired; a plain function pointer, no captures, no type erasure.
+    GO_AWAY using RapidDeleterFn = void(*)(void*);
+
+    /**
+     * @brief Pins the calling thread to the current epoch (re-entrant, nested pins are counted).
+     *
+     * Only ever writes to the calling thread's own record, never to a cache line shared with other readers.
+     */
+    GO_AWAY void epochEnter() noexcept;
+
+    /**
+     * @brief Unpins the calling thread once the outermost `epochEnter()` is matched.
+     */
+    GO_AWAY void epochExit() noexcept;
+
+    /**
+     * @brief Whether the calling thread is currently pinned (holds a `RiRi::ReadGuard`, say).
+     */
+    GO_AWAY bool epochPinned() noexcept;
+
+    /**
+     * @brief Hands `ptr` over to the reclaimer; `deleter(ptr)` runs once no reader can see it anymore.
+     *
+     * Also opportunistically advances the epoch and frees old garbage the calling thread retired, so
+     * writers pay for reclamation in small, bounded steps. Out of memory to queue `ptr`, it's freed on
+     * the spot once the readers let it be, or, if they don't soon enough, never.
+     */
+    GO_AWAY void epochRetire(void* ptr, RapidDeleterFn deleter) noexcept;
+
+    /**
+     * @brief Tries to advance the global epoch and frees everything that became unreachable, whichever
+     * thread (live or gone) retired it.
+     */
+    GO_AWAY void epochCollect() noexcept;
+
+    /**
+     * @brief Number of retired objects that are still waiting to be freed.
+     */
+    GO_AWAY std::size_t epochPending() noexcept;
+
+} // namespace RiRi::Internal
@@ -29,4 +29,17 @@
 // =======================
 // Force Inlining
 // =======================
-#define GET_INLINE_PLEASE inline __attribute__((always_inline))
\ No newline at end of file
+#define GET_INLINE_PLEASE inline __attribute__((always_inline))
+
+// =======================
+// Cache line size
+// =======================
+// std::hardware_destructive_interference_size is not reliably available (and GCC warns about using it
+// in headers), 64 bytes is right for every x86-64 and most ARM64 machines we care about.
+#define RIRI_CACHE_LINE_SIZE 64
+
+// =======================
+// Software prefetch
+// =======================
+// Read access, keep it in every cache level: for lookups that are coming up shortly.
+#define RIRI_PREFETCH(address) __builtin_prefetch((address), 0, 3)
@@ -0,0 +1,189 @@
+#pragma once    // SLAB.H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "KeyCompare.h"
+#include "PageAllocator.h"
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief ### Size-class slab allocator for key and value bytes.
+     *
+     * Every `std::string` key (and every string value longer than the SSO buffer) used to be its own
+     * heap allocation, scattered all over the heap. A shard now carves its strings out of big slabs
+     * instead: small requests are rounded up to a size class and served from that class's free list,
+     * or bumped off the current slab; only very large strings still go to the heap one by one.
+     *
+     * - No per-allocation header for slab sized strings, the caller hands the size back on free.
+     * - `release()` drops every slab in one go, which is what makes `CLEAR` cheap.
+     * - `retire()` starts over in fresh slabs, so `COMPACT` can move the live strings into them.
+     * - Slabs can be put on a NUMA node (`setNode()`); large strings stay on the heap.
+     *
+     * @note NOT thread safe on its own, every shard's slab is guarded by the shard's lock.
+     */
+    GO_AWAY class RapidSlab {
+    public:
+        /// Bytes per slab; every size class is carved out of slabs of this size.
+        static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+        /// Anything bigger than this skips the size classes and gets its own heap block.
+        static constexpr std::size_t MAX_CLASS_SIZE = 4096;
+
+        RapidSlab() noexcept = default;
+        ~RapidSlab();
+
+        RapidSlab(const RapidSlab&) = delete;
+        RapidSlab& operator=(const RapidSlab&) = delete;
+
+        /// Takes the slabs from now on out of `node`'s memory (`-1` for wherever); call it while it's empty.
+        void setNode(const int node) noexcept { _pages = RapidPageAllocator<std::byte>(false, node); }
+
+        [[nodiscard]] int node() const noexcept { return _pages.node(); }
+
+        /// Returns `bytes` bytes (16 byte aligned), `bytes` must be > 0; `nullptr` if there's no memory left to get them from.
+        [[nodiscard]] char* allocate(std::size_t bytes) noexcept;
+
+        /// Gives back memory from `allocate()` (or `grow()`); `bytes` must be the size it was asked for (or grown to).
+        void deallocate(char* ptr, std::size_t bytes) noexcept;
+
+        /**
+         * @brief Makes `ptr`, `bytes` long, `new_bytes` long, keeping its first `bytes` bytes.
+         *
+         * In place if its block has room (size classes round up, so a string growing a little at a
+         * time mostly stays put), otherwise moved to a new block. Large blocks it moves get 50% spare
+         * room, so a string appended to byte by byte is copied O(log n) times, not O(n).
+         *
+         * @return Where the bytes are now; `ptr` may be gone. `nullptr` if there's no memory left to move
+         * them to, `ptr` is untouched then.
+         */
+        [[nodiscard]] char* grow(char* ptr, std::size_t bytes, std::size_t new_bytes) noexcept;
+
+        /// Frees every slab and large block at once. Everything allocated from this slab is gone.
+        void release() noexcept;
+
+        /**
+         * @brief `release()`, a bounded piece at a time: frees up to `blocks` slabs and large blocks.
+         * @return `true` once there's nothing left to free
+         */
+        bool releaseStep(std::size_t blocks) noexcept;
+
+        /// Trades everything (slabs, free lists, node) with `other`. CLEAR swaps a shard's slab for an empty one.
+        void swap(RapidSlab& other) noexcept;
+
+        /**
+         * @brief Takes a large block (`bytes > MAX_CLASS_SIZE`) out of the slab without freeing it.
+         *
+         * The bytes stop counting towards `reservedBytes()` right away; whoever gets the block frees it
+         * with `freeDetached()`, from any thread, whenever it suits them.
+         */
+        [[nodiscard]] void* detach(char* ptr, std::size_t bytes) noexcept;
+
+        static void freeDetached(void* block) noexcept { ::operator delete(block); }
+
+        /**
+         * @brief Starts a defragmentation: from now on, strings come out of fresh slabs only.
+         *
+         * The slabs so far keep whatever lives in them, but are retiring: their free lists are gone,
+         * and bytes given back to them are simply dropped. Once the caller has copied every string
+         * that's still in them out (`retiring()` says which), `releaseRetired()` frees them all.
+         * Large blocks have nothing to defragment, they stay as they are.
+         */
+        void retire() noexcept;
+
+        /// Whether a defragmentation is running (`retire()` was called, `releaseRetired()` wasn't yet).
+        [[nodiscard]] bool compacting() const noexcept { return !_retiring.empty(); }
+
+        /// Whether `ptr` is in a retiring slab.
+        [[nodiscard]] bool retiring(const char* ptr) const noexcept;
+
+        /// Frees the retiring slabs, nothing may live in them anymore. @return The bytes freed
+        std::size_t releaseRetired() noexcept;
+
+        /// Bytes currently held from the system (slabs plus large blocks).
+        [[nodiscard]] std::size_t reservedBytes() const noexcept { return _reserved; }
+
+        /// Bytes of slabs no string lives in: free lists, abandoned slab tails, what `retire()` left behind.
+        [[nodiscard]] std::size_t idleBytes() const noexcept {
+            return (_slabs.size() + _retiring.size()) * SLAB_SIZE - _carved;
+        }
+
+    private:
+        /// Multiples of 16 up to 128, then powers of two up to `MAX_CLASS_SIZE`.
+        static constexpr std::size_t CLASS_COUNT = 13;
+
+        struct FreeNode { FreeNode* next; };
+
+        /// Intrusive header in front of every large block, so `release()` can find them all.
+        struct alignas(16) LargeBlock {
+            LargeBlock* prev;
+            LargeBlock* next;
+            std::size_t capacity;       // usable bytes, more than asked for if `grow()` made it
+        };
+
+        [[nodiscard]] char* allocateLarge(std::size_t capacity) noexcept;
+
+        /// Takes the large block `ptr` belongs to off the list, and off `_reserved`.
+        [[nodiscard]] LargeBlock* unlinkLarge(char* ptr) noexcept;
+
+        [[nodiscard]] static std::size_t classOf(std::size_t bytes) noexcept;
+        [[nodiscard]] static std::size_t classSize(std::size_t size_class) noexcept;
+
+        std::array<FreeNode*, CLASS_COUNT> _free{};
+        RapidPageAllocator<std::byte> _pages;   // where the slabs come from: the heap, unless there's a node
+        std::vector<std::byte*> _slabs;
+        std::vector<std::byte*> _retiring;      // sorted, see `retire()`
+        std::byte* _cursor = nullptr;           // bump pointer into the newest slab
+        std::byte* _end = nullptr;
+        LargeBlock* _large = nullptr;
+        std::size_t _reserved = 0;
+        std::size_t _carved = 0;                // size-class bytes handed out and not given back
+    };
+
+
+    /**
+     * @brief A string whose bytes live in a `RapidSlab`.
+     *
+     * Just a pointer and a length: trivially copyable and trivially destructible, so the map can
+     * shuffle it around for free and clearing a shard never has to visit its strings one by one.
+     * The flip side: it owns nothing, whoever erases it gives the bytes back to the slab.
+     */
+    GO_AWAY struct RapidSlabString {
+        const char* data = nullptr;
+        std::uint32_t size = 0;
+        /// Fills what would be padding anyway. Map keys keep their access stamp here, for eviction (see
+        /// Eviction.h); it's bookkeeping, not part of the string, so it's `mutable` and ignored by `==`.
+        mutable std::uint32_t stamp = 0;
+        /// Same deal: map keys keep the version of their value here (see `RapidShard::version`).
+        mutable std::uint64_t version = 0;
+
+        [[nodiscard]] std::string_view view() const noexcept { return {data, size}; }
+
+        [[nodiscard]] friend bool operator==(const RapidSlabString& lhs, const RapidSlabString& rhs) noexcept {
+            return sameKey(lhs.view(), rhs.view());
+        }
+    };
+
+
+    /**
+     * @brief Copies `str` (at most `UINT32_MAX` bytes) into `slab`; empty strings don't allocate.
+     * @return `false` if the slab is out of memory, `copy` is left alone then
+     */
+    GO_AWAY [[nodiscard]] bool slabCopy(RapidSlab& slab, std::string_view str, RapidSlabString& copy) noexcept;
+
+    /// Gives the bytes of `str` back to `slab`.
+    GO_AWAY void slabFree(RapidSlab& slab, RapidSlabString str) noexcept;
+
+} // namespace RiRi::Internal
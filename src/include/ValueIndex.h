@@ -0,0 +1,93 @@
+#pragma once    // VALUEINDEX.H
+
+#include <cstddef>
+#include <vector>
+
+#include "riri/RapidTypes.hpp"
+#include "RiRiMacros.h"
+#include "RapidValue.h"
+#include "Slab.h"
+#include "ankerl/unordered_dense.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /// Hash of a value, the same for a `RapidCell` and the `RapidDataType` it was made from.
+    GO_AWAY std::size_t hashValue(const RapidCell& value) noexcept;
+    GO_AWAY std::size_t hashValue(const RapidDataType& value) noexcept;
+
+
+    /// A key as the value index remembers it: its slab bytes (owned by the shard's map) and its hash.
+    GO_AWAY struct RapidValueRef {
+        RapidSlabString key;
+        std::size_t hash;
+    };
+
+
+    /**
+     * @brief ### Reverse index of one shard: value -> keys.
+     *
+     * Keyed by `hashValue()`, so every bucket holds the keys of one value (or, once in a blue moon,
+     * of several values sharing a hash: callers check the candidates against the map).
+     *
+     * Most values belong to a single key, so a bucket keeps its first key inline and only allocates
+     * once a second key with the same value shows up. Some values (`0`, `true`, `""`) may well belong
+     * to millions, so every key past the first has its place in its bucket remembered: taking one
+     * out is O(1) however many keys share its value.
+     *
+     * Doesn't own anything it points to; the shard's writers keep it in sync with the map under the
+     * shard's unique lock, readers look things up under (at least) the shared one.
+     */
+    GO_AWAY class RapidValueIndex {
+    public:
+        /**
+         * @brief Records that `key` now holds `value`.
+         * @return `false` if out of memory; nothing changed then
+         */
+        [[nodiscard]] bool add(const RapidCell& value, RapidValueRef key) noexcept;
+
+        /// Forgets that `key` held `value` (both exactly as they were passed to `add()`). Nothing shrinks,
+        /// so adding it right back never runs out of memory.
+        void remove(const RapidCell& value, RapidSlabString key) noexcept;
+
+        void clear() noexcept {
+            _buckets.clear();
+            _positions.clear();
+        }
+
+        /// Number of distinct value hashes, i.e. (almost always) of distinct values.
+        [[nodiscard]] std::size_t size() const noexcept { return _buckets.size(); }
+
+        /// Calls `fn(const RapidValueRef&)` for every key that may hold `value`.
+        template <typename Fn>
+        void forEachCandidate(const RapidDataType& value, Fn&& fn) const {
+            const auto it = _buckets.find(hashValue(value));
+            if (it == _buckets.end()) return;
+            fn(it->second.first);
+            for (const RapidValueRef& ref : it->second.rest) fn(ref);
+        }
+
+    private:
+        struct Bucket {
+            RapidValueRef first;
+            std::vector<RapidValueRef> rest;
+        };
+
+        // the value hashes are good already, no need to mix them again
+        struct IdentityHash {
+            using is_avalanching = void;
+            [[nodiscard]] std::size_t operator()(const std::size_t hash) const noexcept { return hash; }
+        };
+
+        ankerl::unordered_dense::map<std::size_t, Bucket, IdentityHash> _buckets;
+
+        /// Where in its bucket's `rest` every key there is, by the address of its bytes (one copy per key).
+        ankerl::unordered_dense::map<const char*, std::size_t> _positions;
+    };
+
+} // namespace RiRi::Internal
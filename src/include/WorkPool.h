@@ -0,0 +1,110 @@
+#pragma once    // WORKPOOL.H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "RiRiMacros.h"
+
+
+/**
+ * @brief ### WARNING: INTERNAL ZONE.
+ *
+ * Please DO NOT use internal functions, files, classes, or structs; they're NOT part of the public API.
+ */
+namespace RiRi::Internal {
+
+    /**
+     * @brief ### Work-stealing thread pool for parallel batches.
+     *
+     * A job is `tasks` numbered tasks (one per shard, for a batch), run on the calling thread and up
+     * to `threads - 1` workers. Every thread starts out with an even, contiguous range of the task
+     * numbers and takes from its front; a thread that runs out steals the back half of somebody
+     * else's range. So a thread stuck with a busy shard doesn't hold the whole job up while the
+     * others sit idle.
+     *
+     * On machines with more than one NUMA node, the workers are spread over the nodes in the same
+     * order the tasks are: with every thread on a job, a NUMA aware store's shards (see
+     * `RapidStore::shardNode()`) start out on threads of their own node, and only cross over to be
+     * stolen.
+     *
+     * A range is one atomic word (`begin << 32 | end`), owners and thieves both move it with a CAS:
+     * no locks while a job runs. Several jobs (parallel batches from different threads) can run at
+     * once and share the workers: each worker joins every open job it has a place in, one after the
+     * other. A job never waits for a worker to be free, its caller steals whatever nobody joined for.
+     */
+    GO_AWAY class RapidWorkPool {
+    public:
+        /// The process-wide pool, started on first use: a worker per core but the caller's, at least one.
+        static RapidWorkPool& instance();
+
+        explicit RapidWorkPool(std::size_t workers);
+        ~RapidWorkPool();
+
+        RapidWorkPool(const RapidWorkPool&) = delete;
+        RapidWorkPool& operator=(const RapidWorkPool&) = delete;
+
+        /// Threads a job can run on: the workers, and the caller.
+        [[nodiscard]] std::size_t threads() const noexcept { return _workers.size() + 1; }
+
+        /**
+         * @brief Runs `fn(task)` for every `task < tasks`, on up to `threads` threads (`0` for all of
+         * them), the calling thread included. Returns once every task is done.
+         */
+        template <typename Fn>
+        void run(const std::size_t tasks, const std::size_t threads, Fn&& fn) {
+            run(tasks, threads, [](void* context, const std::size_t task) noexcept {
+                (*static_cast<std::remove_reference_t<Fn>*>(context))(task);
+            }, &fn);
+        }
+
+    private:
+        using TaskFn = void (*)(void*, std::size_t) noexcept;
+
+        /// A thread's share of the job's tasks, `begin << 32 | end`.
+        struct alignas(RIRI_CACHE_LINE_SIZE) Range {
+            std::atomic<std::uint64_t> bounds{0};
+            bool joined = false;        // whether its worker took it up yet; guarded by `_mutex`
+        };
+
+        /// One `run()`, on its caller's stack for as long as it runs.
+        struct Job {
+            TaskFn fn;
+            void* context;
+            std::size_t participants;           // threads it can use, the caller included
+            std::unique_ptr<Range[]> ranges;    // one per participant, the caller's first
+            std::size_t active = 0;             // workers on it right now; guarded by `_mutex`
+        };
+
+        void run(std::size_t tasks, std::size_t threads, TaskFn fn, void* context);
+
+        void work(std::size_t self, std::stop_token stop);
+
+        /// An open job worker `self` has a place in and hasn't joined yet, `nullptr` if none. `_mutex` held.
+        [[nodiscard]] Job* openJob(std::size_t self) const noexcept;
+
+        /// Runs the tasks of `self`'s range of `job`, then stolen ones, until there are none left anywhere.
+        static void drain(Job& job, std::size_t self) noexcept;
+
+        /// Takes the first task of `range`, `false` if it's empty.
+        static bool take(Range& range, std::uint32_t& task) noexcept;
+
+        /// Moves the back half of `victim`'s range into `self`'s (which is empty), `false` if there was nothing to take.
+        static bool steal(Range& victim, Range& self) noexcept;
+
+        std::mutex _mutex;                  // guards the open jobs, for the workers to pick up
+        std::condition_variable_any _wake;
+        std::condition_variable _left;      // a worker is done with its job
+        std::vector<Job*> _open;            // jobs still taking workers, oldest first
+
+        std::vector<std::jthread> _workers;     // last, so they're stopped before the rest goes away
+    };
+
+} // namespace RiRi::Internal
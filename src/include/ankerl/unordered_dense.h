@@ -4,6 +4,10 @@
 // Version 4.5.0
 // https://github.com/martinus/unordered_dense
 //
+// Vendored with one local patch, marked "RiRi addition": prefetch_bucket() and prefetch_value() on the
+// table, next to contains(), and the RiRiMacros.h include they prefetch with. Carry it over when updating,
+// or drop it if upstream grows its own.
+//
 // Licensed under the MIT License <http://opensource.org/licenses/MIT>.
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2022-2024 Martin Leitner-Ankerl <martin.ankerl@gmail.com>
@@ -29,6 +33,8 @@
 #ifndef ANKERL_UNORDERED_DENSE_H
 #define ANKERL_UNORDERED_DENSE_H
 
+#include "../RiRiMacros.h" // RiRi addition: RIRI_PREFETCH
+
 // see https://semver.org/spec/v2.0.0.html
 #define ANKERL_UNORDERED_DENSE_VERSION_MAJOR 4 // NOLINT(cppcoreguidelines-macro-usage) incompatible API changes
 #define ANKERL_UNORDERED_DENSE_VERSION_MINOR 5 // NOLINT(cppcoreguidelines-macro-usage) backwards compatible functionality
@@ -1832,6 +1838,30 @@ public:
         return find(key) != end();
     }
 
+    // RiRi addition (local patch, not upstream): software prefetch ahead of a find(key), so a batch of
+    // lookups can overlap its cache misses. prefetch_bucket() pulls in the key's home bucket; prefetch_value()
+    // reads that bucket (prefetch it a while before) and pulls in the entry it points at, if the fingerprint
+    // matches. Buckets are private, so this can't live in RapidTable.
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    void prefetch_bucket(K const& key) const noexcept {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(empty())) {
+            return;
+        }
+        RIRI_PREFETCH(&at(m_buckets, bucket_idx_from_hash(mixed_hash(key))));
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    void prefetch_value(K const& key) const noexcept {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(empty())) {
+            return;
+        }
+        auto mh = mixed_hash(key);
+        auto const& bucket = at(m_buckets, bucket_idx_from_hash(mh));
+        if (bucket.m_dist_and_fingerprint == dist_and_fingerprint_from_hash(mh)) {
+            RIRI_PREFETCH(&m_values[bucket.m_value_idx]);
+        }
+    }
+
     auto equal_range(Key const& key) -> std::pair<iterator, iterator> {
         auto it = do_find(key);
         return {it, it == end() ? end() : it + 1};
@@ -0,0 +1,136 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  APPEND; grows the string, from its cell to the slab     | default                                             |
+// | 2.  SETRANGE; overwrites, grows, fills gaps with zeros      | default                                             |
+// | 3.  GETRANGE; substr() rules                                | default :: concurrent reads                         |
+// | 4.  APPEND, SETRANGE, GETRANGE; missing keys, wrong types   | default                                             |
+// | 5.  APPEND; TTLs stay, GET and FIND_BY_VALUE follow         | concurrent reads + value index                      |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::int64_t lengthOf(const RiRi::Response::StatusWith<const RiRi::RapidDataType*>& response) {
+        REQUIRE(response.ok());
+        return std::get<std::int64_t>(*response.field());
+    }
+
+    std::string valueOf(RiRi::Store& store, const std::string_view key) {
+        const auto response = GET(store, key);
+        REQUIRE(response.ok());
+        return std::get<std::string>(*response.field());
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("APPEND, SETRANGE, GETRANGE") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store& store = RiRi::Store::defaultStore();
+        REQUIRE(SET("log", "RiRi").ok());
+        REQUIRE(SET("number", std::int64_t{7}).ok());
+
+        // 1
+        SUBCASE("APPEND; grows the string, from its cell to the slab") {
+            CHECK(lengthOf(APPEND("log", " is")) == 7);
+            CHECK(valueOf(store, "log") == "RiRi is");
+
+            std::string expected = "RiRi is";
+            for (int i = 0; i < 2000; i++) {
+                const std::string line = " line " + std::to_string(i) + "\n";
+                expected += line;
+                CHECK(lengthOf(APPEND("log", line)) == static_cast<std::int64_t>(expected.size()));
+            }
+            CHECK(valueOf(store, "log") == expected);      // well past the size classes, into a large block
+            CHECK(std::get<std::int64_t>(*MEMORY_USAGE("log").field()) >= static_cast<std::int64_t>(expected.size()));
+        }
+
+        // 2
+        SUBCASE("SETRANGE; overwrites, grows, fills gaps with zeros") {
+            CHECK(lengthOf(SETRANGE("log", 1, "aRi")) == 4);
+            CHECK(valueOf(store, "log") == "RaRi");
+            CHECK(lengthOf(SETRANGE("log", 2, "Ri rocks")) == 10);
+            CHECK(valueOf(store, "log") == "RaRi rocks");
+            CHECK(lengthOf(SETRANGE("log", 12, "!")) == 13);
+            CHECK(valueOf(store, "log") == std::string("RaRi rocks\0\0!", 13));
+
+            const std::string long_value(100, 'x');
+            CHECK(lengthOf(SETRANGE("log", 0, long_value)) == 100);
+            CHECK(lengthOf(SETRANGE("log", 50, "y")) == 100);
+            CHECK(valueOf(store, "log") == std::string(50, 'x') + "y" + std::string(49, 'x'));
+            CHECK(SETRANGE("log", SIZE_MAX, "y").code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+
+            // each length lives as long as its response, not until the next APPEND
+            const auto shorter = SETRANGE("log", 0, "z");
+            const auto longer = APPEND("log", "!");
+            CHECK(lengthOf(shorter) == 100);
+            CHECK(lengthOf(longer) == 101);
+        }
+
+        // 3
+        SUBCASE("GETRANGE; substr() rules") {
+            RiRi::Store concurrent({.concurrentReads = true});
+            for (RiRi::Store* target : {&store, &concurrent}) {
+                REQUIRE(SET(*target, "text", "a value long enough for the slab").ok());
+                RiRi::ReadGuard guard;
+                CHECK(GETRANGE(*target, "text", 2, 5).field() == "value");
+                CHECK(GETRANGE(*target, "text", 28).field() == "slab");
+                CHECK(GETRANGE(*target, "text", 0).field() == "a value long enough for the slab");
+                CHECK(GETRANGE(*target, "text", 100).ok());
+                CHECK(GETRANGE(*target, "text", 100).field().empty());
+            }
+        }
+
+        // 4
+        SUBCASE("APPEND, SETRANGE, GETRANGE; missing keys, wrong types") {
+            CHECK(lengthOf(APPEND("new", "abc")) == 3);
+            CHECK(lengthOf(SETRANGE("gap", 3, "abc")) == 6);
+            CHECK(valueOf(store, "gap") == std::string("\0\0\0abc", 6));
+            CHECK(GETRANGE("missing", 0).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+            CHECK(APPEND("number", "1").code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(APPEND("number", "1").field() == nullptr);
+            CHECK(SETRANGE("number", 0, "1").code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(GETRANGE("number", 0).code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(std::get<std::int64_t>(*GET("number").field()) == 7);
+        }
+
+        // 5
+        SUBCASE("APPEND; TTLs stay, GET and FIND_BY_VALUE follow") {
+            RiRi::Store indexed({.concurrentReads = true, .valueIndex = true});
+            REQUIRE(SET(indexed, "log", "RiRi", 50ms).ok());
+            CHECK(lengthOf(APPEND(indexed, "log", " and a lot more than fifteen bytes")) == 38);
+            CHECK(valueOf(indexed, "log") == "RiRi and a lot more than fifteen bytes");
+            CHECK(FIND_BY_VALUE(indexed, "RiRi and a lot more than fifteen bytes").totalEntryCount() == 1);
+            CHECK(FIND_BY_VALUE(indexed, "RiRi").code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(TTL(indexed, "log").ok());
+
+            std::this_thread::sleep_for(60ms);
+            CHECK(lengthOf(APPEND(indexed, "log", "fresh")) == 5);     // expired, so it starts over
+            CHECK(valueOf(indexed, "log") == "fresh");
+        }
+    }
+
+}
@@ -0,0 +1,142 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "MemoryMaps.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include "riri/utils/Accessors.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace RiRi::Commands;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  Cold start: every key in, every table grown once        | (store, span) :: 8 shards, serial and parallel      |
+// | 2.  LastWins: later values replace earlier ones             | (span, LastWins)                                    |
+// | 3.  FirstWins: earlier values stay, quietly                 | (span, FirstWins)                                   |
+// | 4.  Report: duplicates fail, and say so                     | (span, Report), (span, enableErrorBatched, Report)  |
+// | 5.  Memory budgets, TTLs and indexes still apply            | (store, span, enableErrorBatched) :: options        |
+// | 6.  No nodes                                                | (span), (span, enableErrorBatched)                  |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::vector<RiRi::RapidNode> numbered(const int count, const std::string& prefix = "key") {
+        std::vector<RiRi::RapidNode> nodes;
+        nodes.reserve(count);
+        for (int i = 0; i < count; i++) nodes.push_back({prefix + std::to_string(i), std::int64_t{i}});
+        return nodes;
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("BULK_LOAD") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+
+        // 1
+        SUBCASE("Cold start: every key in, every table grown once") {
+            for (const std::size_t threads : {std::size_t{1}, std::size_t{0}}) {
+                RiRi::Store store({.initialCapacity = 0, .shardCount = 8, .incrementalRehash = true});
+                auto& rapid = RiRi::Internal::StoreAccess::of(store);
+                auto nodes = numbered(40'000);
+                CHECK(BULK_LOAD(store, nodes, RiRi::DuplicatePolicy::LastWins, RiRi::enableParallel{threads}).code() == RiRi::StatusCode::OK);
+                CHECK(RiRi::Internal::size(rapid) == 40'000);
+                for (std::size_t s = 0; s < rapid.shardCount(); ++s) {
+                    // grown to size up front: never had to start an incremental rehash
+                    CHECK(rapid.shard(s).map.rehashes() == 0);
+                    CHECK_FALSE(rapid.shard(s).map.rehashing());
+                }
+                for (int i = 0; i < 40'000; i += 97) {
+                    const auto response = GET(store, "key" + std::to_string(i));
+                    REQUIRE(response.ok());
+                    CHECK(*response.field() == RiRi::RapidDataType(std::int64_t{i}));
+                }
+            }
+        }
+
+        // 2
+        SUBCASE("LastWins: later values replace earlier ones") {
+            REQUIRE(SET("key1", "stored").ok());
+            RiRi::RapidNode nodes[] {{"key1", "loaded"}, {"key2", "first"}, {"key2", "second"}, {"key3", std::int64_t{3}}};
+            CHECK(BULK_LOAD(nodes).code() == RiRi::StatusCode::OK);
+            CHECK(RiRi::Internal::size() == 3);
+            CHECK(*GET("key1").field() == RiRi::RapidDataType("loaded"));
+            CHECK(*GET("key2").field() == RiRi::RapidDataType("second"));
+            CHECK(*GET("key3").field() == RiRi::RapidDataType(std::int64_t{3}));
+        }
+
+        // 3
+        SUBCASE("FirstWins: earlier values stay, quietly") {
+            REQUIRE(SET("key1", "stored").ok());
+            RiRi::RapidNode nodes[] {{"key1", "loaded"}, {"key2", "first"}, {"key2", "second"}};
+            const auto response = BULK_LOAD(nodes, RiRi::enableErrorBatched{}, RiRi::DuplicatePolicy::FirstWins);
+            CHECK(response.code() == RiRi::StatusCode::OK);
+            CHECK(response.totalErrorCount() == 0);
+            CHECK(*GET("key1").field() == RiRi::RapidDataType("stored"));
+            CHECK(*GET("key2").field() == RiRi::RapidDataType("first"));
+        }
+
+        // 4
+        SUBCASE("Report: duplicates fail, and say so") {
+            REQUIRE(SET("key1", "stored").ok());
+            RiRi::RapidNode nodes[] {{"key1", "loaded"}, {"key2", "first"}, {"key2", "second"}};
+            CHECK(BULK_LOAD(nodes, RiRi::DuplicatePolicy::Report).code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            CHECK(*GET("key2").field() == RiRi::RapidDataType("first"));
+
+            RiRi::RapidNode again[] {{"key3", "new"}, {"key1", "loaded"}};
+            const auto response = BULK_LOAD(again, RiRi::enableErrorBatched{}, RiRi::DuplicatePolicy::Report);
+            CHECK(response.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            REQUIRE(response.totalErrorCount() == 1);
+            for (auto& [key, code] : response) {
+                CHECK(key == "key1");
+                CHECK(code == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+            }
+            CHECK(*GET("key1").field() == RiRi::RapidDataType("stored"));
+            CHECK(*GET("key3").field() == RiRi::RapidDataType("new"));
+        }
+
+        // 5
+        SUBCASE("Memory budgets, TTLs and indexes still apply") {
+            RiRi::Store full({.initialCapacity = 0, .shardCount = 1, .maxMemory = 4096});
+            auto nodes = numbered(1000);
+            const auto response = BULK_LOAD(full, nodes, RiRi::enableErrorBatched{});
+            CHECK_FALSE(response.ok());
+            CHECK(response.totalErrorCount() > 0);
+            for (auto& [key, code] : response) CHECK(code == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(full)) == 1000 - response.totalErrorCount());
+
+            RiRi::Store indexed({.shardCount = 4, .concurrentReads = true, .valueIndex = true, .orderedIndex = true});
+            REQUIRE(SET(indexed, "key5", "old", std::chrono::hours(1)).ok());
+            auto more = numbered(100);
+            CHECK(BULK_LOAD(indexed, more).ok());
+            const auto ttl = TTL(indexed, "key5");       // replaced, TTL kept, like an UPSERT
+            REQUIRE(ttl.ok());
+            CHECK(std::get<std::int64_t>(*ttl.field()) > 59 * 60 * 1000);
+            CHECK(*GET(indexed, "key5").field() == RiRi::RapidDataType(std::int64_t{5}));
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType(std::int64_t{42})).totalEntryCount() == 1);
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType("old")).totalEntryCount() == 0);
+            CHECK(RANGE(indexed, "key10", "key12").totalEntryCount() == 2);      // key10, key11
+            RiRi::ReadGuard guard;
+            CHECK(*GET(indexed, "key99").field() == RiRi::RapidDataType(std::int64_t{99}));
+        }
+
+        // 6
+        SUBCASE("No nodes") {
+            CHECK(BULK_LOAD(std::span<RiRi::RapidNode>{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+            CHECK(BULK_LOAD(std::span<RiRi::RapidNode>{}, RiRi::enableErrorBatched{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  GET; every write gives the value a new version          | (key, version)                                      |
+// | 2.  CAS; matching and stale versions, missing keys          | (key, version, value)                               |
+// | 3.  CAS; batched                                            | (span, versions)                                    |
+// | 4.  CAS; TTLs stay, versions outlive deletes and CLEARs     | concurrent reads                                    |
+// | 5.  CAS; concurrent read-modify-writes never lose one       | concurrent reads                                    |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::uint64_t versionOf(RiRi::Store& store, const std::string_view key) {
+        std::uint64_t version = 0;
+        GET(store, key, version);
+        return version;
+    }
+
+    std::uint64_t swappedTo(const RiRi::Response::StatusWith<const RiRi::RapidDataType*>& response) {
+        REQUIRE(response.field() != nullptr);
+        return static_cast<std::uint64_t>(std::get<std::int64_t>(*response.field()));
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("CAS, versioned GET") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store& store = RiRi::Store::defaultStore();
+        REQUIRE(SET("key", "value").ok());
+
+        // 1
+        SUBCASE("GET; every write gives the value a new version") {
+            std::uint64_t version = 0;
+            auto response = GET("key", version);
+            CHECK(response.ok());
+            CHECK(std::get<std::string>(*response.field()) == "value");
+            CHECK(version != 0);
+
+            std::uint64_t last = version;
+            const auto changed = [&] {
+                const std::uint64_t now = versionOf(store, "key");
+                const bool newer = now > last;
+                last = now;
+                return newer;
+            };
+            CHECK(UPDATE("key", "other").ok());
+            CHECK(changed());
+            CHECK(APPEND("key", "!").ok());
+            CHECK(changed());
+            CHECK(UPDATE("key", std::int64_t{1}).ok());
+            CHECK(changed());
+            CHECK(INCRBY("key", 1).ok());
+            CHECK(changed());
+
+            // the value didn't change, neither does its version
+            CHECK(EXPIRE("key", 10s).ok());
+            CHECK(GET("key").ok());
+            CHECK(!changed());
+
+            CHECK(GET("missing", version).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(version == 0);
+        }
+
+        // 2
+        SUBCASE("CAS; matching and stale versions, missing keys") {
+            const std::uint64_t version = versionOf(store, "key");
+            auto swapped = CAS("key", version, "new");
+            CHECK(swapped.ok());
+            const std::uint64_t next = swappedTo(swapped);
+            CHECK(next > version);
+            CHECK(next == versionOf(store, "key"));
+            CHECK(std::get<std::string>(*GET("key").field()) == "new");
+
+            // somebody else got there first: nothing changes, and the caller learns the current version
+            auto stale = CAS("key", version, "lost");
+            CHECK(stale.code() == RiRi::StatusCode::ERR_VERSION_MISMATCH);
+            CHECK(swappedTo(stale) == next);
+            CHECK(swappedTo(swapped) == next);      // each version lives as long as its response
+            CHECK(std::get<std::string>(*GET("key").field()) == "new");
+
+            CHECK(CAS("missing", 1, "value").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(CAS("missing", 1, "value").field() == nullptr);
+            CHECK(CAS("key", 0, "value").code() == RiRi::StatusCode::ERR_VERSION_MISMATCH);
+
+            // version 0: create, only if missing
+            auto created = CAS("missing", 0, std::int64_t{7});
+            CHECK(created.ok());
+            CHECK(swappedTo(created) == versionOf(store, "missing"));
+            CHECK(CAS("missing", 0, std::int64_t{8}).code() == RiRi::StatusCode::ERR_VERSION_MISMATCH);
+            CHECK(std::get<std::int64_t>(*GET("missing").field()) == 7);
+        }
+
+        // 3
+        SUBCASE("CAS; batched") {
+            REQUIRE(SET("other", "value").ok());
+            RiRi::RapidNode nodes[] {
+                {"key", "one"},
+                {"other", "two"},
+                {"missing", "three"},
+                {"created", "four"},
+            };
+            const std::uint64_t versions[] {versionOf(store, "key"), versionOf(store, "other") + 1000, 1, 0};
+            auto response = CAS(nodes, versions);
+            CHECK(response.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            std::vector<std::pair<std::string, RiRi::StatusCode>> failed;
+            for (const auto& [key, result] : response) {
+                if (const auto* code = std::get_if<RiRi::StatusCode>(&result)) failed.emplace_back(key, *code);
+            }
+            CHECK(failed == std::vector<std::pair<std::string, RiRi::StatusCode>>{
+                {"other", RiRi::StatusCode::ERR_VERSION_MISMATCH},
+                {"missing", RiRi::StatusCode::ERR_KEY_NOT_FOUND},
+            });
+            CHECK(static_cast<std::uint64_t>(std::get<std::int64_t>(nodes[0].value)) == versionOf(store, "key"));
+            CHECK(static_cast<std::uint64_t>(std::get<std::int64_t>(nodes[3].value)) == versionOf(store, "created"));
+            CHECK(std::get<std::string>(nodes[1].value) == "two");      // not swapped, still the caller's
+            CHECK(std::get<std::string>(*GET("key").field()) == "one");
+            CHECK(std::get<std::string>(*GET("other").field()) == "value");
+
+            CHECK(CAS(nodes, std::span(versions).first(2)).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+            CHECK(CAS(std::span<RiRi::RapidNode>{}, {}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+        }
+
+        // 4
+        SUBCASE("CAS; TTLs stay, versions outlive deletes and CLEARs") {
+            RiRi::Store concurrent({.concurrentReads = true});
+            REQUIRE(SET(concurrent, "key", "value", 10s).ok());
+            const std::uint64_t version = versionOf(concurrent, "key");
+            CHECK(CAS(concurrent, "key", version, "new").ok());
+            CHECK(TTL(concurrent, "key").ok());
+            CHECK(versionOf(concurrent, "key") > version);
+
+            // a key that's created again never gets a version it had before
+            const std::uint64_t before = versionOf(concurrent, "key");
+            REQUIRE(DELETE(concurrent, "key").ok());
+            REQUIRE(SET(concurrent, "key", "value").ok());
+            CHECK(CAS(concurrent, "key", before, "stale").code() == RiRi::StatusCode::ERR_VERSION_MISMATCH);
+            const std::uint64_t after = versionOf(concurrent, "key");
+            CLEAR(concurrent);
+            REQUIRE(SET(concurrent, "key", "value").ok());
+            CHECK(versionOf(concurrent, "key") > after);
+        }
+
+        // 5
+        SUBCASE("CAS; concurrent read-modify-writes never lose one") {
+            RiRi::Store concurrent({.shardCount = 4, .concurrentReads = true});
+            REQUIRE(SET(concurrent, "counter", std::int64_t{0}).ok());
+            constexpr int THREADS = 4;
+            constexpr int INCREMENTS = 2'000;
+            {
+                std::vector<std::jthread> threads;
+                for (int t = 0; t < THREADS; t++) {
+                    threads.emplace_back([&concurrent] {
+                        for (int i = 0; i < INCREMENTS; i++) {
+                            for (;;) {
+                                RiRi::ReadGuard guard;      // lock-free GETs, the value has to outlive the CAS
+                                std::uint64_t version = 0;
+                                const auto value = std::get<std::int64_t>(*GET(concurrent, "counter", version).field());
+                                if (CAS(concurrent, "counter", version, value + 1).ok()) break;
+                            }
+                        }
+                    });
+                }
+            }
+            CHECK(std::get<std::int64_t>(*GET(concurrent, "counter").field()) == THREADS * INCREMENTS);
+        }
+    }
+
+}
@@ -0,0 +1,177 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include "riri/utils/Accessors.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  COMPACT after deleting 80%; smaller, nothing lost       | every index, TTLs :: concurrent reads               |
+// | 2.  COMPACT; empty store, store compact already             | default :: 2 shards                                 |
+// | 3.  COMPACT while others read and write                     | every index, 2 shards                               |
+// | 4.  compactBelow; writes compact the store on their own     | compactBelow = 0.2                                  |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    constexpr int KEYS = 20'000;
+
+    std::string keyOf(const int i) {
+        return "user:" + std::to_string(i);
+    }
+
+    std::string valueOf(const int i) {
+        return "a value long enough for the slab, number " + std::to_string(i);
+    }
+
+    std::int64_t reclaimedBy(const RiRi::Response::StatusWith<const RiRi::RapidDataType*>& response) {
+        REQUIRE(response.ok());
+        return std::get<std::int64_t>(*response.field());
+    }
+
+    void fill(RiRi::Store& store) {
+        for (int i = 0; i < KEYS; i++) REQUIRE(SET(store, keyOf(i), valueOf(i)).ok());
+    }
+
+    /// Deletes all but every fifth key `fill()` set.
+    void thin(RiRi::Store& store) {
+        for (int i = 0; i < KEYS; i++) {
+            if (i % 5 != 0) REQUIRE(DELETE(store, keyOf(i)).ok());
+        }
+    }
+
+    void fillAndThin(RiRi::Store& store) {
+        fill(store);
+        thin(store);
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("COMPACT") {
+
+        // 1
+        SUBCASE("COMPACT after deleting 80%; smaller, nothing lost") {
+            for (const bool concurrent : {false, true}) {
+                RiRi::Store store({.shardCount = 2, .concurrentReads = concurrent, .valueIndex = true, .orderedIndex = true});
+                auto& internal = RiRi::Internal::StoreAccess::of(store);
+                fillAndThin(store);
+                for (int i = 0; i < KEYS; i += 50) REQUIRE(EXPIRE(store, keyOf(i), 1h).ok());
+                std::vector<std::uint64_t> versions(KEYS);
+                for (int i = 0; i < KEYS; i += 5) REQUIRE(GET(store, keyOf(i), versions[i]).ok());
+
+                const auto before = RiRi::Internal::memoryStats(internal);
+                const std::int64_t reclaimed = reclaimedBy(COMPACT(store));
+                const auto after = RiRi::Internal::memoryStats(internal);
+
+                CHECK(reclaimed > 0);
+                CHECK(static_cast<std::size_t>(reclaimed)
+                    == before.bucketBytes + before.entryBytes + before.slabBytes - after.bucketBytes - after.entryBytes - after.slabBytes);
+                CHECK(after.bucketBytes < before.bucketBytes);
+                CHECK(after.entryBytes < before.entryBytes);
+                CHECK(after.slabBytes * 2 < before.slabBytes);
+                CHECK(after.keys == KEYS / 5);
+                CHECK(after.keyBytes == before.keyBytes);
+                CHECK(after.valueBytes == before.valueBytes);
+
+                for (int i = 0; i < KEYS; i += 5) {
+                    std::uint64_t version = 0;
+                    const auto value = GET(store, keyOf(i), version);
+                    REQUIRE(value.ok());
+                    CHECK(*value.field() == RiRi::RapidDataType(valueOf(i)));
+                    CHECK(version == versions[i]);
+                    CHECK(TTL(store, keyOf(i)).code() == (i % 50 == 0 ? RiRi::StatusCode::OK : RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY));
+                }
+                CHECK(FIND_BY_VALUE(store, valueOf(1000)).totalEntryCount() == 1);
+                CHECK(SCAN_PREFIX(store, "user:1000").totalEntryCount() == 3);     // 1000, 10000 .. 10009
+                CHECK(RANGE(store, "user:", "user:;").totalEntryCount() == KEYS / 5);
+
+                // and it's an ordinary store still: the moved keys go away, TTLs run out
+                CHECK(DELETE(store, keyOf(0)).ok());
+                CHECK(FIND_BY_VALUE(store, valueOf(0)).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+                CHECK(EXPIRE(store, keyOf(50), 0ms).ok());
+                CHECK_FALSE(GET(store, keyOf(50)).ok());
+                CHECK(RANGE(store, "user:", "user:;").totalEntryCount() == KEYS / 5 - 2);
+                CHECK(SET(store, keyOf(1), valueOf(1)).ok());
+                CHECK(*GET(store, keyOf(1)).field() == RiRi::RapidDataType(valueOf(1)));
+            }
+        }
+
+        // 2
+        SUBCASE("COMPACT; empty store, store compact already") {
+            RiRi::Internal::clearMap();
+            CHECK(reclaimedBy(COMPACT()) == 0);
+
+            RiRi::Store store({.shardCount = 2});
+            CHECK(reclaimedBy(COMPACT(store)) == 0);
+            fill(store);
+            CHECK(reclaimedBy(COMPACT(store)) == 0);        // nothing deleted, nothing to give back
+
+            thin(store);
+            const auto first = COMPACT(store);
+            const auto second = COMPACT(store);
+            CHECK(reclaimedBy(first) > 0);
+            CHECK(reclaimedBy(second) == 0);                // done the first time
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(store)) == KEYS / 5);
+        }
+
+        // 3
+        SUBCASE("COMPACT while others read and write") {
+            RiRi::Store store({.shardCount = 2, .valueIndex = true, .orderedIndex = true});
+            fillAndThin(store);
+
+            std::atomic<bool> done{false};
+            std::thread writer([&] {
+                for (int round = 0; !done.load(); round++) {
+                    const int i = (round * 5) % KEYS;
+                    CHECK(*GET(store, keyOf(i)).field() == RiRi::RapidDataType(valueOf(i)));
+                    CHECK(UPSERT(store, "new:" + std::to_string(round % 1000), valueOf(round)).ok());
+                    CHECK(UPDATE(store, keyOf(i), valueOf(i)).ok());
+                }
+            });
+            CHECK(reclaimedBy(COMPACT(store)) > 0);
+            done = true;
+            writer.join();
+
+            for (int i = 0; i < KEYS; i += 5) CHECK(*GET(store, keyOf(i)).field() == RiRi::RapidDataType(valueOf(i)));
+            CHECK(RANGE(store, "user:", "user:;").totalEntryCount() == KEYS / 5);
+        }
+
+        // 4
+        SUBCASE("compactBelow; writes compact the store on their own") {
+            RiRi::Store store({.shardCount = 1, .compactBelow = 0.2f, .orderedIndex = true});
+            auto& internal = RiRi::Internal::StoreAccess::of(store);
+            CHECK(store.options().compactBelow == 0.2f);
+            CHECK(RiRi::Store({.compactBelow = 0.9f}).options().compactBelow == 0.25f);
+
+            fill(store);
+            const auto filled = RiRi::Internal::memoryStats(internal);
+            thin(store);        // DELETEs are writes too, they move it along, a few keys each
+            const auto thinned = RiRi::Internal::memoryStats(internal);
+
+            CHECK(thinned.bucketBytes < filled.bucketBytes);
+            CHECK(thinned.entryBytes < filled.entryBytes);
+            CHECK(thinned.slabBytes * 2 < filled.slabBytes);
+            CHECK(reclaimedBy(COMPACT(store)) == 0);        // nothing left to do
+            for (int i = 0; i < KEYS; i += 5) CHECK(*GET(store, keyOf(i)).field() == RiRi::RapidDataType(valueOf(i)));
+            CHECK(RANGE(store, "user:", "user:;").totalEntryCount() == KEYS / 5);
+        }
+    }
+
+}
@@ -0,0 +1,161 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  SET with a TTL; the key is gone once it's up            | default                                             |
+// | 2.  EXPIRE, TTL and PERSIST; status codes                   | default                                             |
+// | 3.  Expired keys are missing for every write                | default                                             |
+// | 4.  Expired keys are reclaimed, without a full scan         | sweeper :: concurrent reads                         |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::int64_t ttlOf(const std::string_view key) {
+        const auto response = TTL(key);
+        REQUIRE(response.ok());
+        return std::get<std::int64_t>(*response.field());
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("EXPIRE, TTL, PERSIST") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+
+        // 1
+        SUBCASE("SET with a TTL; the key is gone once it's up") {
+            CHECK(SET("short", "a value long enough for the slab", 100ms).ok());
+            CHECK(SET("long", std::int64_t{7}, 1h).ok());
+            CHECK(SET("short", "again", 1h).code() == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+            CHECK(SET("zero", "value", 0ms).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+            CHECK(GET("zero").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+            CHECK(GET("short").ok() == true);
+            CHECK(ttlOf("short") <= 100);
+            CHECK(ttlOf("long") > 3'500'000);
+
+            // each TTL's number lives as long as its response, not until the next TTL
+            const auto short_ttl = TTL("short");
+            const auto long_ttl = TTL("long");
+            REQUIRE(short_ttl.ok());
+            REQUIRE(long_ttl.ok());
+            CHECK(std::get<std::int64_t>(*short_ttl.field()) <= 100);
+            CHECK(std::get<std::int64_t>(*long_ttl.field()) > 3'500'000);
+
+            std::this_thread::sleep_for(150ms);
+            CHECK(GET("short").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(TTL("short").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(FIND_BY_VALUE(RiRi::RapidDataType("a value long enough for the slab")).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(GET("long").ok() == true);
+
+            const RiRi::RapidKey key("prehashed");
+            CHECK(SET(key, "value", 1h).ok());
+            CHECK(ttlOf("prehashed") > 3'500'000);
+        }
+
+        // 2
+        SUBCASE("EXPIRE, TTL and PERSIST; status codes") {
+            SET("key", "value");
+            CHECK(TTL("key").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+            CHECK(TTL("key").field() == nullptr);
+            CHECK(PERSIST("key").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+
+            CHECK(EXPIRE("key", 1h).ok());
+            CHECK(ttlOf("key") > 3'500'000);
+            CHECK(EXPIRE("key", 10s).ok());         // sooner
+            CHECK(ttlOf("key") <= 10'000);
+            CHECK(EXPIRE("key", 2h).ok());          // and later again
+            CHECK(ttlOf("key") > 7'100'000);
+
+            CHECK(PERSIST("key").ok());
+            CHECK(TTL("key").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+
+            CHECK(EXPIRE("key", 0ms).ok());         // gone right away
+            CHECK(GET("key").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(RiRi::Internal::size() == 0);
+
+            CHECK(EXPIRE("missing", 1s).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(TTL("missing").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(PERSIST("missing").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+        }
+
+        // 3
+        SUBCASE("Expired keys are missing for every write") {
+            SET("updated", "value", 1h);
+            CHECK(UPDATE("updated", "a value long enough for the slab").ok());
+            CHECK(ttlOf("updated") > 3'500'000);   // UPDATE keeps the TTL
+
+            SET("set", "old", 20ms);
+            SET("updating", "old", 20ms);
+            SET("deleted", "old", 20ms);
+            SET("persisted", "old", 20ms);
+            std::this_thread::sleep_for(40ms);
+
+            CHECK(SET("set", "new").ok());          // expired, so not there anymore
+            CHECK(std::get<std::string>(*GET("set").field()) == "new");
+            CHECK(TTL("set").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);     // the old TTL is gone too
+
+            CHECK(UPDATE("updating", "new").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(DELETE("deleted").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(PERSIST("persisted").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(EXPIRE("persisted", 1h).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+            CHECK(DELETE("updated").ok());
+            CHECK(TTL("updated").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(RiRi::Internal::size() == 1);
+        }
+
+        // 4
+        SUBCASE("Expired keys are reclaimed, without a full scan") {
+            RiRi::Store swept({.shardCount = 4, .expirySweepInterval = 5ms});
+            RiRi::Store lockFree({.concurrentReads = true});
+
+            for (int i = 0; i < 10'000; i++) {
+                const std::string key = "key" + std::to_string(i);
+                // one in ten expires, the rest never do
+                if (i % 10 == 0) {
+                    REQUIRE(SET(swept, key, std::int64_t{i}, 20ms).ok());
+                    REQUIRE(SET(lockFree, key, std::int64_t{i}, 20ms).ok());
+                } else {
+                    REQUIRE(SET(swept, key, std::int64_t{i}).ok());
+                    REQUIRE(SET(lockFree, key, std::int64_t{i}).ok());
+                }
+            }
+            REQUIRE(SET(lockFree, "later", "value", 1h).ok());
+            CHECK(GET(lockFree, "later").ok() == true);
+
+            std::this_thread::sleep_for(100ms);
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(swept)) == 9'000);   // nobody wrote, the sweeper did it
+
+            CHECK(GET(lockFree, "key0").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);     // lock-free readers know too
+            CHECK(GET(lockFree, "key1").ok() == true);
+            CHECK(GET(lockFree, "later").ok() == true);
+
+            // the writes above expired some already (how many depends on how fast they were), this gets the rest
+            const std::size_t before = RiRi::Internal::size(RiRi::Internal::StoreAccess::of(lockFree));
+            CHECK(before - RiRi::Internal::expireKeys(RiRi::Internal::StoreAccess::of(lockFree)) == 9'001);
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(lockFree)) == 9'001);
+            CHECK(RiRi::Internal::expireKeys(RiRi::Internal::StoreAccess::of(lockFree)) == 0);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace RiRi::Commands;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  FIND_BY_VALUE; several keys match                       | default (scan) :: indexed                           |
+// | 2.  FIND_BY_VALUE; nothing matches                          | default (scan) :: indexed                           |
+// | 3.  FIND_BY_VALUE; types have to match too                  | default (scan) :: indexed                           |
+// | 4.  FIND_BY_VALUE; follows UPDATE, DELETE and CLEAR         | default (scan) :: indexed                           |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::vector<std::string> keysOf(const RiRi::Response::StatusBatchWith<std::string_view, std::monostate>& response) {
+        std::vector<std::string> keys;
+        for (const auto& [key, code] : response) keys.emplace_back(key);
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("FIND_BY_VALUE") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store indexed({.valueIndex = true});
+
+        // even keys hold a long string, odd ones their number
+        for (int i = 0; i < 100; i++) {
+            RiRi::RapidDataType value = i % 2
+                ? RiRi::RapidDataType(std::int64_t{i})
+                : RiRi::RapidDataType("a value long enough for the slab");
+            RiRi::Internal::setValue("key" + std::to_string(i), RiRi::RapidDataType(value));
+            REQUIRE(SET(indexed, "key" + std::to_string(i), std::move(value)).ok());
+        }
+        REQUIRE(RiRi::Internal::size() == 100);
+
+        // 1
+        SUBCASE("FIND_BY_VALUE; several keys match") {
+            auto response_d = FIND_BY_VALUE(RiRi::RapidDataType("a value long enough for the slab"));
+            CHECK(response_d.ok() == true);
+            CHECK(response_d.totalEntryCount() == 50);
+
+            auto response_i = FIND_BY_VALUE(indexed, RiRi::RapidDataType("a value long enough for the slab"));
+            CHECK(response_i.ok() == true);
+            CHECK(response_i.totalEntryCount() == 50);
+            CHECK(keysOf(response_d) == keysOf(response_i));
+
+            auto single = FIND_BY_VALUE(indexed, RiRi::RapidDataType(std::int64_t{37}));
+            REQUIRE(single.totalEntryCount() == 1);
+            CHECK(single.begin()->target == "key37");
+            CHECK(keysOf(response_i).front() == "key0");     // the keys live as long as their response
+        }
+
+        // 2
+        SUBCASE("FIND_BY_VALUE; nothing matches") {
+            auto response_d = FIND_BY_VALUE(RiRi::RapidDataType("RiRi"));
+            CHECK(response_d.code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(response_d.totalEntryCount() == 0);
+
+            auto response_i = FIND_BY_VALUE(indexed, RiRi::RapidDataType(std::int64_t{38}));
+            CHECK(response_i.code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(response_i.begin() == response_i.end());
+        }
+
+        // 3
+        SUBCASE("FIND_BY_VALUE; types have to match too") {
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType(std::int64_t{1})).totalEntryCount() == 1);
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType(true)).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType(1.0)).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(FIND_BY_VALUE(indexed, RiRi::RapidDataType("1")).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(FIND_BY_VALUE(RiRi::RapidDataType(true)).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+        }
+
+        // 4
+        SUBCASE("FIND_BY_VALUE; follows UPDATE, DELETE and CLEAR") {
+            for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+                CHECK(UPDATE(*store, "key1", RiRi::RapidDataType(std::int64_t{3})).ok());
+                CHECK(DELETE(*store, "key0").ok());
+                CHECK(keysOf(FIND_BY_VALUE(*store, RiRi::RapidDataType(std::int64_t{3}))) == std::vector<std::string>{"key1", "key3"});
+                CHECK(FIND_BY_VALUE(*store, RiRi::RapidDataType(std::int64_t{1})).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+                CHECK(FIND_BY_VALUE(*store, RiRi::RapidDataType("a value long enough for the slab")).totalEntryCount() == 49);
+
+                CHECK(CLEAR(*store).ok());
+                CHECK(FIND_BY_VALUE(*store, RiRi::RapidDataType(std::int64_t{3})).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            }
+        }
+    }
+
+}
@@ -1,9 +1,17 @@
 #include "DataManager.h"
+#include "MemoryMaps.h"
+#include "Reclaimer.h"
 #include "doctest.h"
 #include "riri/Commands.hpp"
 #include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
 #include "riri/utils/Accessors.hpp"
 #include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace RiRi::Commands;
 
@@ -18,6 +26,10 @@ using namespace RiRi::Commands;
 // | 5.  GET multiple keys; no keys exist                        | GET(span, enableBatched)                            |
 // | 6.  GET multiple keys; some exist                           | GET(span, enableBatched)                            |
 // | 7.  GET multiple keys; empty span                           | GET(span, enableBatched)                            |
+// | 8.  GET pre-hashed keys                                     | (RapidKey) :: (span, enableBatched) after prehash() |
+// | 9.  GET multiple keys; big batches, mid-rehash and lock-free | GET(span, enableBatched) :: own stores              |
+// | 10. GET results kept; each valid as long as its response    | (key) :: (span, enableBatched) :: GETRANGE          |
+// | 11. GET results kept, lock-free; writers free the originals | (key) :: (span, enableBatched) :: (key, version)    |
 // +-------------------------------------------------------------+-----------------------------------------------------+
 
 
@@ -181,5 +193,129 @@ TEST_SUITE("Commands") {
             CHECK(response.totalEntryCount() == 0);
             REQUIRE(response.begin() == response.end());
         }
+
+        // 8
+        SUBCASE("GET pre-hashed keys") {
+            const RiRi::RapidKey key("key7");
+            CHECK(key.hash() == RiRi::hashKey("key7"));
+            auto response_k = GET(key);
+            REQUIRE(response_k.ok() == true);
+            CHECK(*response_k.field() == RiRi::RapidDataType("RiRi"));
+            CHECK(GET(RiRi::RapidKey("key100")).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+            RiRi::prehash(mixed_nodes);
+            CHECK(mixed_nodes[0].hash == RiRi::hashKey(mixed_nodes[0].key));
+            auto response_b = GET(mixed_nodes, RiRi::enableBatched{});
+            CHECK(response_b.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            CHECK(response_b.totalEntryCount() == 200);
+            CHECK(response_b.begin()->target == mixed_nodes[0].key);
+        }
+
+        // 9
+        SUBCASE("GET multiple keys; big batches, mid-rehash and lock-free") {
+            // batches are looked up a group at a time, odd sizes leave a partial group at the end
+            RiRi::Store rehashing({.initialCapacity = 0, .shardCount = 2, .incrementalRehash = true});
+            RiRi::Store lock_free({.shardCount = 4, .concurrentReads = true});
+            RiRi::Internal::RapidStore& rapid = RiRi::Internal::StoreAccess::of(rehashing);
+
+            int count = 0;
+            const auto mid_rehash = [&] { return rapid.shard(0).map.rehashing() || rapid.shard(1).map.rehashing(); };
+            while (count < 5000 || !mid_rehash()) {
+                REQUIRE(count < 1'000'000);
+                SET(rehashing, "key" + std::to_string(count), std::int64_t{count});
+                SET(lock_free, "key" + std::to_string(count), std::int64_t{count});
+                count++;
+            }
+
+            std::vector<RiRi::RapidNode> nodes;
+            for (int i = 0; i < count + 37; i += 2) nodes.push_back({"key" + std::to_string(i), {}});
+            for (RiRi::Store* store : {&rehashing, &lock_free}) {
+                RiRi::ReadGuard guard;
+                const auto response = GET(*store, nodes, RiRi::enableBatched{});
+                CHECK(response.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+                REQUIRE(response.totalEntryCount() == nodes.size());
+                std::size_t i = 0;
+                for (auto [key, result] : response) {
+                    CHECK(key == nodes[i].key);
+                    const bool there = 2 * static_cast<int>(i) < count;
+                    if (there) {
+                        REQUIRE(RiRi::Utils::unpack_field(&result) != nullptr);
+                        CHECK(*RiRi::Utils::unpack_field(&result) == RiRi::RapidDataType(std::int64_t{2 * static_cast<int>(i)}));
+                    } else {
+                        CHECK(RiRi::Utils::unpack_field_code(&result) != nullptr);
+                    }
+                    i++;
+                }
+            }
+        }
+
+        // 10
+        SUBCASE("GET results kept; each valid as long as its response") {
+            RiRi::Store store({.shardCount = 2});
+            for (int i = 0; i < 4; i++) REQUIRE(SET(store, "kept" + std::to_string(i), "value number " + std::to_string(i)).ok());
+
+            const auto first = GET(store, "kept0");
+            const auto second = GET(store, "kept1");
+            RiRi::RapidNode nodes[] {{"kept2", {}}, {"kept3", {}}};
+            const auto batch = GET(store, nodes, RiRi::enableBatched{});
+            const auto range = GETRANGE(store, "kept3", 6, 6);
+            for (int i = 0; i < 100; i++) CHECK(GET(store, "kept" + std::to_string(i % 4)).ok());     // and more reads after
+
+            REQUIRE(first.ok());
+            REQUIRE(second.ok());
+            CHECK(*first.field() == RiRi::RapidDataType("value number 0"));
+            CHECK(*second.field() == RiRi::RapidDataType("value number 1"));
+            REQUIRE(batch.code() == RiRi::StatusCode::OK);
+            int i = 2;
+            for (auto [key, result] : batch) {
+                CHECK(*RiRi::Utils::unpack_field(&result) == RiRi::RapidDataType("value number " + std::to_string(i++)));
+            }
+            CHECK(range.field() == "number");
+
+            // outliving the thread that read it, too
+            RiRi::Response::StatusWith<const RiRi::RapidDataType*> moved;
+            std::thread([&] { moved = GET(store, "kept1"); }).join();
+            REQUIRE(moved.ok());
+            CHECK(*moved.field() == RiRi::RapidDataType("value number 1"));
+
+            // nothing kept: the same slot again, no allocating on every read
+            const RiRi::RapidDataType* dropped = GET(store, "kept0").field();
+            CHECK(GET(store, "kept1").field() == dropped);
+        }
+
+        // 11
+        SUBCASE("GET results kept, lock-free; writers free the originals") {
+            RiRi::Store store({.shardCount = 2, .concurrentReads = true});
+            for (int i = 0; i < 4; i++) REQUIRE(SET(store, "kept" + std::to_string(i), "value number " + std::to_string(i)).ok());
+
+            const auto single = GET(store, "kept0");
+            RiRi::RapidNode nodes[] {{"kept1", {}}, {"kept2", {}}};
+            const auto batch = GET(store, nodes, RiRi::enableBatched{});
+            const auto range = GETRANGE(store, "kept3", 6, 6);
+            std::uint64_t version = 0;
+            const auto versioned = GET(store, "kept3", version);
+
+            // no guard held: every published value these came from is retired, and freed
+            for (int i = 0; i < 4; i++) REQUIRE(UPDATE(store, "kept" + std::to_string(i), "another value").ok());
+            RiRi::Internal::epochCollect();
+            RiRi::Internal::epochCollect();
+
+            REQUIRE(single.ok());
+            CHECK(*single.field() == RiRi::RapidDataType("value number 0"));
+            REQUIRE(batch.code() == RiRi::StatusCode::OK);
+            int i = 1;
+            for (auto [key, result] : batch) {
+                CHECK(*RiRi::Utils::unpack_field(&result) == RiRi::RapidDataType("value number " + std::to_string(i++)));
+            }
+            CHECK(range.field() == "number");
+            REQUIRE(versioned.ok());
+            CHECK(version != 0);
+            CHECK(*versioned.field() == RiRi::RapidDataType("value number 3"));
+
+            // inside a guard, the published value itself: no copy
+            RiRi::ReadGuard guard;
+            CHECK(GET(store, "kept0").field() == GET(store, "kept0").field());
+            CHECK(*GET(store, "kept0").field() == RiRi::RapidDataType("another value"));
+        }
     }
 }
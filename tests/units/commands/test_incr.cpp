@@ -0,0 +1,209 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  INCRBY, INCRBYFLOAT; existing keys                      | (key, by)                                           |
+// | 2.  INCRBY, INCRBYFLOAT; missing keys, with and without     | (key, by) :: (key, by, initial)                     |
+// |     an initial value                                        |                                                     |
+// | 3.  INCRBY, INCRBYFLOAT; wrong types, overflow              | (key, by)                                           |
+// | 4.  INCRBY, INCRBYFLOAT; batched                            | (span) :: (span, initial)                           |
+// | 5.  INCRBY; TTLs stay, GET and FIND_BY_VALUE follow         | concurrent reads + value index                      |
+// | 6.  INCRBY; concurrent increments never lose one            | concurrent reads                                    |
+// | 7.  INCRBY; past 2^53, up to the int64 limits               | (key, by) :: (span)                                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::int64_t intOf(const RiRi::Response::StatusWith<const RiRi::RapidDataType*>& response) {
+        REQUIRE(response.field() != nullptr);
+        return std::get<std::int64_t>(*response.field());
+    }
+
+    double doubleOf(const RiRi::Response::StatusWith<const RiRi::RapidDataType*>& response) {
+        REQUIRE(response.field() != nullptr);
+        return std::get<double>(*response.field());
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("INCRBY, INCRBYFLOAT") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        REQUIRE(SET("counter", std::int64_t{10}).ok());
+        REQUIRE(SET("ratio", 0.5).ok());
+        REQUIRE(SET("name", "RiRi").ok());
+
+        // 1
+        SUBCASE("INCRBY, INCRBYFLOAT; existing keys") {
+            CHECK(intOf(INCRBY("counter", 5)) == 15);
+            CHECK(intOf(INCRBY("counter", -20)) == -5);
+            CHECK(std::get<std::int64_t>(*GET("counter").field()) == -5);
+
+            CHECK(doubleOf(INCRBYFLOAT("ratio", 0.25)) == 0.75);
+            CHECK(doubleOf(INCRBYFLOAT("ratio", -1.0)) == -0.25);
+            CHECK(std::get<double>(*GET("ratio").field()) == -0.25);
+            CHECK(RiRi::Internal::size() == 3);
+
+            // each number lives as long as its response, not until the next INCRBY
+            const auto first = INCRBY("counter", 1);
+            const auto second = INCRBYFLOAT("ratio", 1.0);
+            CHECK(intOf(first) == -4);
+            CHECK(doubleOf(second) == 0.75);
+        }
+
+        // 2
+        SUBCASE("INCRBY, INCRBYFLOAT; missing keys, with and without an initial value") {
+            auto missing = INCRBY("hits", 1);
+            CHECK(missing.code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(missing.field() == nullptr);
+            CHECK(INCRBYFLOAT("score", 1.5).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(RiRi::Internal::size() == 3);
+
+            CHECK(intOf(INCRBY("hits", 1, 0)) == 1);
+            CHECK(intOf(INCRBY("hits", 1, 100)) == 2);          // only a missing key starts from it
+            CHECK(doubleOf(INCRBYFLOAT("score", 1.5, 10.0)) == 11.5);
+            CHECK(RiRi::Internal::size() == 5);
+        }
+
+        // 3
+        SUBCASE("INCRBY, INCRBYFLOAT; wrong types, overflow") {
+            CHECK(INCRBY("name", 1).code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(INCRBY("ratio", 1).code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(INCRBYFLOAT("counter", 1.0).code() == RiRi::StatusCode::ERR_WRONG_TYPE);
+            CHECK(INCRBY("name", 1, 0).code() == RiRi::StatusCode::ERR_WRONG_TYPE);     // it's there, just no number
+
+            constexpr auto MAX = std::numeric_limits<std::int64_t>::max();
+            CHECK(INCRBY("counter", MAX).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+            CHECK(INCRBY("new", 1, MAX).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+            CHECK(INCRBYFLOAT("ratio", std::numeric_limits<double>::infinity()).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+            CHECK(INCRBYFLOAT("ratio", std::numeric_limits<double>::max()).ok());
+            CHECK(INCRBYFLOAT("ratio", std::numeric_limits<double>::max()).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+
+            // nothing changed by the failures
+            CHECK(std::get<std::int64_t>(*GET("counter").field()) == 10);
+            CHECK(std::get<std::string>(*GET("name").field()) == "RiRi");
+            CHECK(GET("new").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+        }
+
+        // 4
+        SUBCASE("INCRBY, INCRBYFLOAT; batched") {
+            RiRi::RapidNode nodes[] {
+                {"counter", std::int64_t{1}},
+                {"missing", std::int64_t{1}},
+                {"name", std::int64_t{1}},
+                {"counter", std::int64_t{2}},       // twice in a batch, both count
+                {"ratio", 1.0},                     // not an integer increment
+            };
+            auto response = INCRBY(nodes);
+            CHECK(response.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            std::vector<std::pair<std::string, RiRi::StatusCode>> failed;
+            for (const auto& [key, result] : response) {
+                if (const auto* code = std::get_if<RiRi::StatusCode>(&result)) failed.emplace_back(key, *code);
+            }
+            CHECK(failed == std::vector<std::pair<std::string, RiRi::StatusCode>>{
+                {"missing", RiRi::StatusCode::ERR_KEY_NOT_FOUND},
+                {"name", RiRi::StatusCode::ERR_WRONG_TYPE},
+                {"ratio", RiRi::StatusCode::ERR_INVALID_ARGUMENT},
+            });
+            CHECK(std::get<std::int64_t>(nodes[0].value) == 11);
+            CHECK(std::get<std::int64_t>(nodes[3].value) == 13);
+            CHECK(std::get<std::int64_t>(*GET("counter").field()) == 13);
+
+            RiRi::RapidNode floats[] {{"ratio", 0.5}, {"fresh", 2.0}};
+            auto created = INCRBYFLOAT(floats, 1.0);
+            CHECK(created.ok());
+            CHECK(created.totalEntryCount() == 2);
+            CHECK(std::get<double>(floats[0].value) == 1.0);
+            CHECK(std::get<double>(floats[1].value) == 3.0);
+
+            CHECK(INCRBY(std::span<RiRi::RapidNode>{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+        }
+
+        // 5
+        SUBCASE("INCRBY; TTLs stay, GET and FIND_BY_VALUE follow") {
+            RiRi::Store store({.concurrentReads = true, .valueIndex = true});
+            REQUIRE(SET(store, "counter", std::int64_t{1}, 50ms).ok());
+            CHECK(intOf(INCRBY(store, "counter", 41)) == 42);
+            CHECK(std::get<std::int64_t>(*GET(store, "counter").field()) == 42);
+            CHECK(FIND_BY_VALUE(store, std::int64_t{42}).totalEntryCount() == 1);
+            CHECK(FIND_BY_VALUE(store, std::int64_t{1}).code() == RiRi::StatusCode::ERR_VALUE_NOT_FOUND);
+            CHECK(TTL(store, "counter").ok());
+
+            std::this_thread::sleep_for(60ms);
+            CHECK(GET(store, "counter").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(intOf(INCRBY(store, "counter", 1, 0)) == 1);      // expired, so it starts over
+            CHECK(TTL(store, "counter").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+        }
+
+        // 6
+        SUBCASE("INCRBY; concurrent increments never lose one") {
+            RiRi::Store store({.shardCount = 4, .concurrentReads = true});
+            constexpr int THREADS = 4;
+            constexpr int INCREMENTS = 10'000;
+            {
+                std::vector<std::jthread> threads;
+                for (int t = 0; t < THREADS; t++) {
+                    threads.emplace_back([&store] {
+                        for (int i = 0; i < INCREMENTS; i++) {
+                            INCRBY(store, "shared", 1, 0);
+                            INCRBYFLOAT(store, "shared-float", 0.5, 0.0);
+                        }
+                    });
+                }
+            }
+            CHECK(std::get<std::int64_t>(*GET(store, "shared").field()) == THREADS * INCREMENTS);
+            CHECK(std::get<double>(*GET(store, "shared-float").field()) == THREADS * INCREMENTS * 0.5);
+        }
+
+        // 7
+        SUBCASE("INCRBY; past 2^53, up to the int64 limits") {
+            constexpr auto MAX = std::numeric_limits<std::int64_t>::max();
+            constexpr auto MIN = std::numeric_limits<std::int64_t>::min();
+
+            // exact, not rounded to the nearest double
+            REQUIRE(SET("big", std::int64_t{9'007'199'254'740'993}).ok());     // 2^53 + 1
+            CHECK(intOf(INCRBY("big", 0)) == 9'007'199'254'740'993);
+            REQUIRE(SET("bigger", std::int64_t{123'456'789'012'345'679}).ok());
+            CHECK(intOf(INCRBY("bigger", 1)) == 123'456'789'012'345'680);
+
+            // right up to the limits, and not one past them
+            REQUIRE(SET("max", MAX - 1).ok());
+            CHECK(intOf(INCRBY("max", 1)) == MAX);
+            CHECK(INCRBY("max", 1).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+            CHECK(std::get<std::int64_t>(*GET("max").field()) == MAX);
+
+            REQUIRE(SET("min", MIN + 1).ok());
+            CHECK(intOf(INCRBY("min", -1)) == MIN);
+            CHECK(INCRBY("min", -1).code() == RiRi::StatusCode::ERR_VALUE_OUT_OF_RANGE);
+            CHECK(intOf(INCRBY("min", MAX)) == -1);
+
+            RiRi::RapidNode nodes[] {{"big", std::int64_t{1}}, {"max", std::int64_t{1}}};
+            CHECK(INCRBY(nodes).code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            CHECK(std::get<std::int64_t>(*GET("big").field()) == 9'007'199'254'740'994);
+            CHECK(std::get<std::int64_t>(*GET("max").field()) == MAX);
+        }
+    }
+
+}
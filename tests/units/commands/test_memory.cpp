@@ -0,0 +1,159 @@
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  MEMORY_STATS follows SET, UPDATE, DELETE and CLEAR      | default                                             |
+// | 2.  MEMORY_USAGE of a single key                            | default                                             |
+// | 3.  The counts match a recount, whatever took keys out      | TTLs :: eviction :: incremental rehash              |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::map<std::string, std::int64_t> statsOf(RiRi::Store& store) {
+        const auto response = MEMORY_STATS(store);
+        REQUIRE(response.ok());
+        std::map<std::string, std::int64_t> stats;
+        for (const auto& [field, result] : response) {
+            stats.emplace(field, std::get<std::int64_t>(*std::get<const RiRi::RapidDataType*>(result)));
+        }
+        return stats;
+    }
+
+    std::int64_t usageOf(const std::string_view key) {
+        const auto response = MEMORY_USAGE(key);
+        REQUIRE(response.ok());
+        return std::get<std::int64_t>(*response.field());
+    }
+
+    /// Key and value bytes of every entry, counted the slow way.
+    std::pair<std::size_t, std::size_t> recount(RiRi::Internal::RapidStore& store) {
+        std::size_t keys = 0, values = 0;
+        for (std::size_t s = 0; s < store.shardCount(); s++) {
+            store.shard(s).map.forEach([&](const RiRi::Internal::RapidSlabString& key, const RiRi::Internal::RapidCell& value) {
+                keys += key.size;
+                values += value.inSlab() ? value.asSlabString().size : 0;
+                return true;
+            });
+        }
+        return {keys, values};
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("MEMORY_STATS, MEMORY_USAGE") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store& store = RiRi::Store::defaultStore();
+
+        // 1
+        SUBCASE("MEMORY_STATS follows SET, UPDATE, DELETE and CLEAR") {
+            auto stats = statsOf(store);
+            CHECK(stats.size() == 9);
+            CHECK(stats["keys"] == 0);
+            CHECK(stats["key_bytes"] == 0);
+            CHECK(stats["value_bytes"] == 0);
+            CHECK(stats["bucket_bytes"] > 0);       // reserved up front
+            CHECK(stats["max_memory"] == 0);
+
+            const std::string long_value(100, 'v');
+            SET("key", long_value);                 // 3 + 100
+            SET("number", std::int64_t{1});         // 6 + 0, numbers live in their entry
+            SET("short", "inline");                 // 5 + 0, and so do short strings
+            stats = statsOf(store);
+            CHECK(stats["keys"] == 3);
+            CHECK(stats["key_bytes"] == 14);
+            CHECK(stats["value_bytes"] == 100);
+            CHECK(stats["used_bytes"] == stats["key_bytes"] + stats["value_bytes"] + stats["bucket_bytes"] + stats["entry_bytes"]);
+            CHECK(stats["slab_bytes"] >= 114);
+
+            UPDATE("number", std::string(40, 'n'));
+            UPDATE("key", std::int64_t{2});
+            stats = statsOf(store);
+            CHECK(stats["key_bytes"] == 14);
+            CHECK(stats["value_bytes"] == 40);
+
+            DELETE("number");
+            stats = statsOf(store);
+            CHECK(stats["keys"] == 2);
+            CHECK(stats["key_bytes"] == 8);
+            CHECK(stats["value_bytes"] == 0);
+
+            CLEAR();
+            stats = statsOf(store);
+            CHECK(stats["key_bytes"] == 0);
+            CHECK(stats["budget_bytes"] == 0);
+        }
+
+        // 2
+        SUBCASE("MEMORY_USAGE of a single key") {
+            SET("short", "inline");
+            SET("long", std::string(100, 'v'));
+            CHECK(usageOf("short") >= 5 + 32);      // at least the key and its entry
+            CHECK(usageOf("long") >= 4 + 100 + 32);
+
+            // every response keeps its own numbers
+            const auto short_usage = MEMORY_USAGE("short");
+            const auto stats = MEMORY_STATS();
+            const auto long_usage = MEMORY_USAGE("long");
+            REQUIRE(short_usage.ok());
+            REQUIRE(long_usage.ok());
+            CHECK(*short_usage.field() == RiRi::RapidDataType(usageOf("short")));
+            CHECK(std::get<std::int64_t>(*long_usage.field()) > std::get<std::int64_t>(*short_usage.field()));
+            REQUIRE(stats.ok());
+            CHECK(std::get<std::int64_t>(*std::get<const RiRi::RapidDataType*>(stats.begin()->result)) == 2);   // keys
+
+            CHECK(MEMORY_USAGE("missing").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(MEMORY_USAGE("missing").field() == nullptr);
+        }
+
+        // 3
+        SUBCASE("The counts match a recount, whatever took keys out") {
+            RiRi::Store busy({
+                .initialCapacity = 0, .shardCount = 2, .incrementalRehash = true,
+                .maxMemory = 200'000, .eviction = RiRi::EvictionPolicy::LRU
+            });
+            RiRi::Internal::RapidStore& rapid = RiRi::Internal::StoreAccess::of(busy);
+
+            for (int i = 0; i < 20'000; i++) {
+                const std::string key = "key" + std::to_string(i);
+                const RiRi::RapidDataType value = i % 3 ? RiRi::RapidDataType(std::string(i % 50, 'v')) : RiRi::RapidDataType(3.14);
+                if (i % 7 == 0) SET(busy, key, value, 1ms);
+                else SET(busy, key, value);
+                if (i % 5 == 0) UPDATE(busy, "key" + std::to_string(i / 2), std::string(i % 70, 'u'));
+                if (i % 11 == 0) DELETE(busy, "key" + std::to_string(i / 3));
+            }
+            std::this_thread::sleep_for(5ms);
+            RiRi::Internal::expireKeys(rapid);
+
+            auto stats = statsOf(busy);
+            const auto [keys, values] = recount(rapid);
+            CHECK(stats["keys"] == static_cast<std::int64_t>(RiRi::Internal::size(rapid)));
+            CHECK(stats["key_bytes"] == static_cast<std::int64_t>(keys));
+            CHECK(stats["value_bytes"] == static_cast<std::int64_t>(values));
+            CHECK(stats["budget_bytes"] <= 200'000);
+            CHECK(stats["max_memory"] == 200'000);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include "riri/utils/Accessors.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace RiRi::Commands;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  SET and GET big batches on every core                   | (span, enableBatched, enableParallel) :: 16 shards  |
+// | 2.  SET; per key errors, modes, and nodes of one shard      | (span, enableErrorBatched, enableParallel, mode)    |
+// | 3.  GET; lock-free store                                    | (span, enableBatched, enableParallel) :: concurrent |
+// | 4.  Small batches and a single thread                       | (span, enableBatched, enableParallel) :: default    |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::vector<RiRi::RapidNode> numbered(const int count, const int offset = 0) {
+        std::vector<RiRi::RapidNode> nodes;
+        nodes.reserve(count);
+        for (int i = 0; i < count; i++) nodes.push_back({"key" + std::to_string(i + offset), std::int64_t{i + offset}});
+        return nodes;
+    }
+
+    /// Every node came back with its own number, or (past `found`) as missing.
+    void checkValues(const RiRi::Response::StatusBatchWith<std::string_view, const RiRi::RapidDataType*>& response,
+                     const std::vector<RiRi::RapidNode>& nodes, const std::size_t found) {
+        REQUIRE(response.totalEntryCount() == nodes.size());
+        std::size_t i = 0;
+        for (auto [key, result] : response) {
+            REQUIRE(key == nodes[i].key);
+            if (i < found) {
+                REQUIRE(RiRi::Utils::unpack_field(&result) != nullptr);
+                CHECK(*RiRi::Utils::unpack_field(&result) == RiRi::RapidDataType(std::int64_t{std::stoi(std::string(key.substr(3)))}));
+            } else {
+                CHECK(*RiRi::Utils::unpack_field_code(&result) == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            }
+            i++;
+        }
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("SET, GET (enableParallel)") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        constexpr int KEYS = 50'000;
+
+        // 1
+        SUBCASE("SET and GET big batches on every core") {
+            RiRi::Store store({.initialCapacity = 0, .shardCount = 16, .incrementalRehash = true});
+            auto nodes = numbered(KEYS);
+            const auto written = SET(store, nodes, RiRi::enableBatched{}, RiRi::enableParallel{});
+            CHECK(written.ok());
+            CHECK(written.totalEntryCount() == 0);
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(store)) == KEYS);
+
+            auto wanted = numbered(KEYS + 1000);      // the last thousand aren't there
+            checkValues(GET(store, wanted, RiRi::enableBatched{}, RiRi::enableParallel{}), wanted, KEYS);
+            checkValues(GET(store, wanted, RiRi::enableBatched{}, RiRi::enableParallel{3}), wanted, KEYS);
+        }
+
+        // 2
+        SUBCASE("SET; per key errors, modes, and nodes of one shard") {
+            RiRi::Store store({.shardCount = 8});
+            auto first = numbered(KEYS / 2);
+            REQUIRE(SET(store, first, RiRi::enableErrorBatched{}, RiRi::enableParallel{}).ok());
+
+            // half of these exist already: NX turns exactly those down
+            auto second = numbered(KEYS, KEYS / 4);
+            const auto response = SET(store, second, RiRi::enableErrorBatched{}, RiRi::enableParallel{});
+            CHECK(response.code() == RiRi::StatusCode::ERR_MULTIPLE_OPERATIONS_FAILED);
+            CHECK(response.totalErrorCount() == KEYS / 4);
+
+            // repeated keys of a shard still land in order: the last one wins
+            std::vector<RiRi::RapidNode> repeated;
+            for (int i = 0; i < KEYS; i++) repeated.push_back({"key" + std::to_string(i % 100), std::string("round") + std::to_string(i / 100)});
+            CHECK(SET(store, repeated, RiRi::enableErrorBatched{}, RiRi::enableParallel{}, RiRi::SetMode::Always).ok());
+            CHECK(*GET(store, "key7").field() == RiRi::RapidDataType(std::string("round") + std::to_string(KEYS / 100 - 1)));
+        }
+
+        // 3
+        SUBCASE("GET; lock-free store") {
+            RiRi::Store store({.shardCount = 4, .concurrentReads = true});
+            auto nodes = numbered(KEYS);
+            REQUIRE(SET(store, nodes, RiRi::enableBatched{}, RiRi::enableParallel{}).ok());
+
+            RiRi::ReadGuard guard;
+            auto wanted = numbered(KEYS + 100);
+            checkValues(GET(store, wanted, RiRi::enableBatched{}, RiRi::enableParallel{}), wanted, KEYS);
+        }
+
+        // 4
+        SUBCASE("Small batches and a single thread") {
+            auto nodes = numbered(10);
+            CHECK(SET(nodes, RiRi::enableBatched{}, RiRi::enableParallel{}).ok());
+            auto wanted = numbered(12);
+            checkValues(GET(wanted, RiRi::enableBatched{}, RiRi::enableParallel{}), wanted, 10);
+
+            auto more = numbered(KEYS, 10);
+            CHECK(SET(more, RiRi::enableBatched{}, RiRi::enableParallel{1}).ok());
+            CHECK(RiRi::Internal::size() == KEYS + 10);
+            CHECK(GET(std::span<RiRi::RapidNode>{}, RiRi::enableBatched{}, RiRi::enableParallel{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  SCAN_PREFIX; keys and values, in order                  | default (scan) :: indexed                           |
+// | 2.  RANGE; bounds and limit                                 | default (scan) :: indexed                           |
+// | 3.  RANGE, SCAN_PREFIX; nothing there, invalid arguments    | default (scan) :: indexed                           |
+// | 4.  RANGE; follows DELETE, TTLs and CLEAR                   | default (scan) :: indexed                           |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    using ScanResponse = RiRi::Response::StatusBatchWith<std::string_view, const RiRi::RapidDataType*>;
+
+    std::vector<std::string> keysOf(const ScanResponse& response) {
+        std::vector<std::string> keys;
+        for (const auto& [key, result] : response) keys.emplace_back(key);
+        return keys;    // already in order, or the test fails
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("RANGE, SCAN_PREFIX") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store indexed({.shardCount = 4, .orderedIndex = true});
+
+        // user:000 .. user:199 hold their number, a few others are around them
+        for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+            for (int i = 199; i >= 0; i--) {
+                const std::string id = std::to_string(1000 + i).substr(1);
+                REQUIRE(SET(*store, "user:" + id, std::int64_t{i}).ok());
+            }
+            REQUIRE(SET(*store, "user", "not a user").ok());
+            REQUIRE(SET(*store, "user;", "not a user either").ok());
+            REQUIRE(SET(*store, "session:1", "a value long enough for the slab").ok());
+            REQUIRE(SET(*store, "\xff\xff", "last").ok());
+        }
+
+        // 1
+        SUBCASE("SCAN_PREFIX; keys and values, in order") {
+            for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+                auto response = SCAN_PREFIX(*store, "user:01");
+                CHECK(response.ok());
+                REQUIRE(response.totalEntryCount() == 10);
+                std::int64_t expected = 10;
+                for (const auto& [key, result] : response) {
+                    CHECK(key == "user:0" + std::to_string(expected));
+                    CHECK(std::get<std::int64_t>(*std::get<const RiRi::RapidDataType*>(result)) == expected);
+                    ++expected;
+                }
+
+                CHECK(SCAN_PREFIX(*store, "user:").totalEntryCount() == 200);
+                CHECK(SCAN_PREFIX(*store, "user").totalEntryCount() == 202);
+                CHECK(keysOf(SCAN_PREFIX(*store, "session")) == std::vector<std::string>{"session:1"});
+                CHECK(keysOf(SCAN_PREFIX(*store, "\xff")) == std::vector<std::string>{"\xff\xff"});
+                CHECK(SCAN_PREFIX(*store, "").totalEntryCount() == 204);
+
+                // the first response's keys and values outlived every scan since
+                CHECK(response.begin()->target == "user:010");
+                CHECK(std::get<std::int64_t>(*std::get<const RiRi::RapidDataType*>(response.begin()->result)) == 10);
+            }
+        }
+
+        // 2
+        SUBCASE("RANGE; bounds and limit") {
+            for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+                CHECK(keysOf(RANGE(*store, "user:050", "user:053")) == std::vector<std::string>{"user:050", "user:051", "user:052"});
+                CHECK(keysOf(RANGE(*store, "user:0505", "user:052")) == std::vector<std::string>{"user:051"});
+                CHECK(keysOf(RANGE(*store, "user:198", "")) == std::vector<std::string>{"user:198", "user:199", "user;", "\xff\xff"});
+                CHECK(keysOf(RANGE(*store, "", "user:")) == std::vector<std::string>{"session:1", "user"});
+
+                // the first keys of the range, across every shard
+                CHECK(keysOf(RANGE(*store, "user:1", "", 3)) == std::vector<std::string>{"user:100", "user:101", "user:102"});
+                CHECK(SCAN_PREFIX(*store, "user:", 50).totalEntryCount() == 50);
+                CHECK(keysOf(SCAN_PREFIX(*store, "user:", 1)) == std::vector<std::string>{"user:000"});
+            }
+        }
+
+        // 3
+        SUBCASE("RANGE, SCAN_PREFIX; nothing there, invalid arguments") {
+            for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+                auto empty = RANGE(*store, "user:0505", "user:051");
+                CHECK(empty.code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+                CHECK(empty.begin() == empty.end());
+                CHECK(RANGE(*store, "user:050", "user:050").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+                CHECK(SCAN_PREFIX(*store, "nobody").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+                CHECK(RANGE(*store, "user:051", "user:050").code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+                CHECK(RANGE(*store, "user:", "", 0).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+                CHECK(SCAN_PREFIX(*store, "user:", 0).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+            }
+        }
+
+        // 4
+        SUBCASE("RANGE; follows DELETE, TTLs and CLEAR") {
+            for (RiRi::Store* store : {&RiRi::Store::defaultStore(), &indexed}) {
+                CHECK(DELETE(*store, "user:051").ok());
+                CHECK(EXPIRE(*store, "user:052", 1ms).ok());
+                std::this_thread::sleep_for(5ms);
+                CHECK(keysOf(RANGE(*store, "user:050", "user:054")) == std::vector<std::string>{"user:050", "user:053"});
+                // an expired key doesn't count against the limit either
+                CHECK(keysOf(RANGE(*store, "user:051", "", 1)) == std::vector<std::string>{"user:053"});
+
+                CHECK(SET(*store, "user:051", std::int64_t{-1}).ok());
+                CHECK(SET(*store, "user:052", std::int64_t{-2}).ok());     // its entry was expired, not gone
+                CHECK(keysOf(RANGE(*store, "user:050", "user:054")) == std::vector<std::string>{"user:050", "user:051", "user:052", "user:053"});
+
+                CHECK(CLEAR(*store).ok());
+                CHECK(SCAN_PREFIX(*store, "").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+                CHECK(SET(*store, "user:000", std::int64_t{0}).ok());
+                CHECK(keysOf(SCAN_PREFIX(*store, "user:")) == std::vector<std::string>{"user:000"});
+            }
+        }
+    }
+
+}
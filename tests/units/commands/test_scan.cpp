@@ -0,0 +1,152 @@
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Store                            |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  SCAN; a walk returns every key once, with its value     | default                                             |
+// | 2.  SCAN; no call looks at more than `count` entries        | default                                             |
+// | 3.  SCAN; keys that stay are all found, whatever is deleted | default                                             |
+// | 4.  SCAN; ... and whatever a rehash moves around            | incremental rehash                                  |
+// | 5.  SCAN; empty store, invalid count                        | default                                             |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::string key(const int i) { return "key" + std::to_string(i); }
+
+    /// One SCAN call, its keys counted in `seen`.
+    std::size_t scanInto(RiRi::Store& store, std::uint64_t& cursor, const std::size_t count, std::map<std::string, int>& seen) {
+        const auto response = SCAN(store, cursor, count);
+        REQUIRE(response.ok());
+        for (const auto& [k, result] : response) ++seen[std::string(k)];
+        return response.totalEntryCount();
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("SCAN") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store& store = RiRi::Store::defaultStore();
+
+        // 1
+        SUBCASE("SCAN; a walk returns every key once, with its value") {
+            for (int i = 0; i < 1000; i++) REQUIRE(SET(key(i), std::int64_t{i}).ok());
+
+            // every response is kept until the walk is done, its keys and values live as long as it does
+            std::vector<RiRi::Response::StatusBatchWith<std::string_view, const RiRi::RapidDataType*>> responses;
+            std::uint64_t cursor = 0;
+            do {
+                responses.push_back(SCAN(cursor, 64));
+                REQUIRE(responses.back().ok());
+            } while (cursor != 0);
+
+            std::map<std::string, int> seen;
+            for (const auto& response : responses) {
+                for (const auto& [k, result] : response) {
+                    ++seen[std::string(k)];
+                    CHECK(k == key(static_cast<int>(std::get<std::int64_t>(*std::get<const RiRi::RapidDataType*>(result)))));
+                }
+            }
+            CHECK(seen.size() == 1000);
+            CHECK(std::all_of(seen.begin(), seen.end(), [](const auto& entry) { return entry.second == 1; }));
+            CHECK(responses.size() >= 1000 / 64);
+        }
+
+        // 2
+        SUBCASE("SCAN; no call looks at more than `count` entries") {
+            for (int i = 0; i < 300; i++) {
+                if (i % 2) REQUIRE(SET(key(i), "soon gone", 1ms).ok());
+                else REQUIRE(SET(key(i), std::int64_t{i}).ok());
+            }
+            std::this_thread::sleep_for(5ms);
+
+            std::map<std::string, int> seen;
+            std::uint64_t cursor = 0;
+            do {
+                CHECK(scanInto(store, cursor, 7, seen) <= 7);
+            } while (cursor != 0);
+            CHECK(seen.size() == 150);      // expired keys take up their slots, never come back
+        }
+
+        // 3
+        SUBCASE("SCAN; keys that stay are all found, whatever is deleted") {
+            for (int i = 0; i < 2000; i++) REQUIRE(SET(key(i), std::int64_t{i}).ok());
+
+            // every call, some keys go (their slots filled from the back) and some come
+            std::map<std::string, int> seen;
+            std::uint64_t cursor = 0;
+            int step = 0;
+            do {
+                scanInto(store, cursor, 50, seen);
+                for (int j = 0; j < 20; j++) DELETE(key((step * 97 + j * 31) % 2000));
+                for (int j = 0; j < 10; j++) SET(key(10'000 + step * 10 + j), std::int64_t{0});
+                ++step;
+            } while (cursor != 0);
+
+            for (int i = 0; i < 2000; i++) {
+                if (RiRi::Internal::getValue(key(i)) != nullptr) CHECK(seen.contains(key(i)));
+            }
+        }
+
+        // 4
+        SUBCASE("SCAN; ... and whatever a rehash moves around") {
+            RiRi::Store rehashing({.initialCapacity = 0, .shardCount = 2, .incrementalRehash = true});
+            for (int i = 0; i < 24000; i++) REQUIRE(SET(rehashing, key(i), std::int64_t{i}).ok());
+            RiRi::Internal::RapidTable& table = RiRi::Internal::StoreAccess::of(rehashing).shard(0).map;
+            const std::uint32_t rehashes = table.rehashes();
+
+            std::map<std::string, int> seen;
+            std::uint64_t cursor = 0;
+            int step = 0;
+            do {
+                scanInto(rehashing, cursor, 100, seen);
+                // enough new keys to start rehashes in the middle of the walk, and deletes to move the rest
+                for (int j = 0; j < 40; j++) SET(rehashing, key(100'000 + step * 40 + j), std::int64_t{0});
+                for (int j = 0; j < 10; j++) DELETE(rehashing, key((step * 613 + j * 7) % 24000));
+                ++step;
+            } while (cursor != 0);
+            CHECK(table.rehashes() > rehashes);     // or this tested nothing
+
+            for (int i = 0; i < 24000; i++) {
+                if (GET(rehashing, key(i)).ok()) CHECK(seen.contains(key(i)));
+            }
+        }
+
+        // 5
+        SUBCASE("SCAN; empty store, invalid count") {
+            std::uint64_t cursor = 0;
+            const auto empty = SCAN(cursor, 10);
+            CHECK(empty.ok());
+            CHECK(empty.begin() == empty.end());
+            CHECK(cursor == 0);
+
+            SET("key", "value");
+            CHECK(SCAN(cursor, 0).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+        }
+    }
+
+}
@@ -0,0 +1,107 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "LazyFree.h"
+#include "MemoryMaps.h"
+#include "Reclaimer.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include "riri/utils/Accessors.hpp"
+#include <ostream>
+#include <string>
+
+using namespace RiRi::Commands;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  UNLINK single key; key exists, key does not exist       | (key) :: (RapidKey)                                 |
+// | 2.  UNLINK big values: gone now, freed in the background    | (store, key) :: 1 shard, concurrent reads           |
+// | 3.  UNLINK multiple keys; some exist                        | (span) :: (span, enableErrorBatched)                |
+// | 4.  UNLINK multiple keys; empty span                        | (span) :: (span, enableErrorBatched)                |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("UNLINK") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+
+        for (int i = 0; i < 100; i++) {
+            RiRi::Internal::setValue("key" + std::to_string(i), RiRi::RapidDataType("RiRi"));
+        }
+        REQUIRE(RiRi::Internal::size() == 100);
+
+        // 1
+        SUBCASE("UNLINK single key; key exists, key does not exist") {
+            CHECK(UNLINK("key0").code() == RiRi::StatusCode::OK);
+            CHECK(UNLINK(RiRi::RapidKey("key1")).code() == RiRi::StatusCode::OK);
+            CHECK(RiRi::Internal::size() == 98);
+            CHECK_FALSE(GET("key0").ok());
+
+            const auto missing = UNLINK("key0");
+            CHECK(missing.code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(missing.errorCount() == 1);
+            CHECK(UNLINK(RiRi::RapidKey("nope")).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+        }
+
+        // 2
+        SUBCASE("UNLINK big values: gone now, freed in the background") {
+            for (const bool concurrent : {false, true}) {
+                RiRi::Store store({.shardCount = 1, .concurrentReads = concurrent});
+                auto& shard = RiRi::Internal::StoreAccess::of(store).shard(0);
+                const std::string big(1 << 20, 'b');
+                REQUIRE(SET(store, "big", big).ok());
+                REQUIRE(SET(store, "small", std::string(100, 's')).ok());
+                REQUIRE(shard.slab.reservedBytes() > big.size());
+
+                RiRi::ReadGuard guard;      // lock-free readers keep what they got, UNLINK or not
+                const auto before = GET(store, "big");
+                REQUIRE(before.ok());
+
+                CHECK(UNLINK(store, "big").code() == RiRi::StatusCode::OK);
+                CHECK(UNLINK(store, "small").code() == RiRi::StatusCode::OK);
+                CHECK_FALSE(GET(store, "big").ok());
+                CHECK(shard.valueBytes == 0);
+                CHECK(shard.slab.reservedBytes() < big.size());   // no longer the store's, whenever it's freed
+                if (concurrent) CHECK(*before.field() == RiRi::RapidDataType(big));
+
+                REQUIRE(SET(store, "big", "again").ok());
+                CHECK(*GET(store, "big").field() == RiRi::RapidDataType("again"));
+            }
+            RiRi::Internal::epochCollect();
+            RiRi::Internal::lazyFreeWait();
+            CHECK(RiRi::Internal::lazyFreePending() == 0);
+        }
+
+        // 3
+        SUBCASE("UNLINK multiple keys; some exist") {
+            RiRi::RapidNode nodes[] {{"key1", {}}, {"nope1", {}}, {"key2", {}}, {"nope2", {}}};
+            CHECK(UNLINK(nodes).code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            CHECK(RiRi::Internal::size() == 98);
+
+            RiRi::RapidNode again[] {{"key1", {}}, {"key3", {}}, {"key4", {}}};
+            const auto response = UNLINK(again, RiRi::enableErrorBatched{});
+            CHECK(response.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+            CHECK(response.totalErrorCount() == 1);
+            for (const auto& [key, code] : response) {
+                CHECK(key == "key1");
+                CHECK(code == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            }
+            CHECK(RiRi::Internal::size() == 96);
+        }
+
+        // 4
+        SUBCASE("UNLINK multiple keys; empty span") {
+            CHECK(UNLINK(std::span<RiRi::RapidNode>{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+            CHECK(UNLINK(std::span<RiRi::RapidNode>{}, RiRi::enableErrorBatched{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+            CHECK(RiRi::Internal::size() == 100);
+        }
+    }
+
+}
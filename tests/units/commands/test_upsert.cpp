@@ -0,0 +1,163 @@
+#include "DataManager.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+// =============================================== LISTS OF SUBCASES ===================================================
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// |                             SUBCASE                         |                    Overload / Store                 |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+// | 1.  UPSERT; creates missing keys, replaces existing ones    | (key, value) :: (RapidKey, value) :: (key, ttl)     |
+// | 2.  UPSERT multiple keys; new, existing and repeated ones   | (span) :: (span, enableErrorBatched)                |
+// |                                                             | :: (span, enableBatched)                            |
+// | 3.  SET; NX, XX and Always modes                            | (key, value, mode) :: (key, value, ttl, mode)       |
+// |                                                             | :: (span, mode)                                     |
+// | 4.  UPSERT; a full store still takes a replacement          | memory budget                                       |
+// | 5.  UPSERT; concurrent writers of the same keys             | concurrent reads                                    |
+// +-------------------------------------------------------------+-----------------------------------------------------+
+
+
+namespace {
+
+    std::string valueOf(RiRi::Store& store, const std::string_view key) {
+        const auto response = GET(store, key);
+        REQUIRE(response.field() != nullptr);
+        return std::get<std::string>(*response.field());
+    }
+
+} // namespace
+
+
+TEST_SUITE("COMMANDS") {
+
+    TEST_CASE("UPSERT, SET modes") {
+
+        // Data
+        RiRi::Internal::clearMap();
+        REQUIRE(RiRi::Internal::size() == 0);
+        RiRi::Store& store = RiRi::Store::defaultStore();
+
+        // 1
+        SUBCASE("UPSERT; creates missing keys, replaces existing ones") {
+            CHECK(UPSERT("key", "first").ok());
+            CHECK(valueOf(store, "key") == "first");
+            CHECK(UPSERT("key", std::string(100, 'v')).ok());       // inline to slab
+            CHECK(valueOf(store, "key") == std::string(100, 'v'));
+            CHECK(UPSERT(RiRi::RapidKey("key"), std::int64_t{7}).ok());
+            CHECK(*GET("key").field() == RiRi::RapidDataType(std::int64_t{7}));
+            CHECK(RiRi::Internal::size() == 1);
+
+            // a replacement keeps the key's TTL, unless it brings its own
+            CHECK(EXPIRE("key", 10s).ok());
+            CHECK(UPSERT("key", "second").ok());
+            CHECK(TTL("key").ok());
+            CHECK(UPSERT("key", "third", 50ms).ok());
+            CHECK(std::get<std::int64_t>(*TTL("key").field()) <= 50);
+            CHECK(UPSERT("fresh", "value", 10s).ok());
+            CHECK(TTL("fresh").ok());
+
+            CHECK(UPSERT("key", "value", 0ms).code() == RiRi::StatusCode::ERR_INVALID_ARGUMENT);
+            CHECK(valueOf(store, "key") == "third");
+        }
+
+        // 2
+        SUBCASE("UPSERT multiple keys; new, existing and repeated ones") {
+            REQUIRE(SET("key0", "old").ok());
+            REQUIRE(SET("key1", "old").ok());
+
+            RiRi::RapidNode nodes[] {{"key0", "new"}, {"key2", "new"}, {"key2", "newer"}, {"key3", std::int64_t{3}}};
+            CHECK(UPSERT(nodes).ok());
+            CHECK(valueOf(store, "key0") == "new");
+            CHECK(valueOf(store, "key1") == "old");
+            CHECK(valueOf(store, "key2") == "newer");       // the last one wins
+            CHECK(RiRi::Internal::size() == 4);
+
+            RiRi::RapidNode errors[] {{"key1", "new"}, {"key4", "new"}};
+            const auto error_batch = UPSERT(errors, RiRi::enableErrorBatched{});
+            CHECK(error_batch.ok());
+            CHECK(error_batch.totalErrorCount() == 0);
+            CHECK(valueOf(store, "key1") == "new");
+
+            RiRi::RapidNode batched[] {{"key4", "newer"}, {"key5", "new"}};
+            const auto batch = UPSERT(batched, RiRi::enableBatched{});
+            CHECK(batch.ok());
+            CHECK(batch.totalEntryCount() == 0);     // only failures are reported
+            CHECK(valueOf(store, "key4") == "newer");
+
+            CHECK(UPSERT(std::span<RiRi::RapidNode>{}).code() == RiRi::StatusCode::WARN_ZERO_NODES_PROVIDED);
+        }
+
+        // 3
+        SUBCASE("SET; NX, XX and Always modes") {
+            CHECK(SET("key", "first").ok());
+            CHECK(SET("key", "second", RiRi::SetMode::NX).code() == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+            CHECK(SET("key", "second", RiRi::SetMode::XX).ok());
+            CHECK(valueOf(store, "key") == "second");
+            CHECK(SET("missing", "value", RiRi::SetMode::XX).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(GET("missing").field() == nullptr);
+            CHECK(SET("key", "third", RiRi::SetMode::Always).ok());
+            CHECK(SET("other", "value", RiRi::SetMode::Always).ok());
+            CHECK(valueOf(store, "key") == "third");
+
+            // with a TTL, XX and Always give an existing key the new one
+            CHECK(SET("key", "fourth", 10s, RiRi::SetMode::XX).ok());
+            CHECK(TTL("key").ok());
+            CHECK(SET("other", "value", 10s, RiRi::SetMode::NX).code() == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+            CHECK(TTL("other").code() == RiRi::StatusCode::INFO_KEY_HAS_NO_EXPIRY);
+            CHECK(SET("other", "value", 10s, RiRi::SetMode::Always).ok());
+            CHECK(TTL("other").ok());
+            CHECK(SET("missing", "value", 10s, RiRi::SetMode::XX).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+
+            RiRi::RapidNode nodes[] {{"key", "fifth"}, {"missing", "value"}};
+            const auto batch = SET(nodes, RiRi::enableErrorBatched{}, RiRi::SetMode::XX);
+            CHECK(batch.totalErrorCount() == 1);
+            CHECK(valueOf(store, "key") == "fifth");
+            CHECK(GET("missing").field() == nullptr);
+        }
+
+        // 4
+        SUBCASE("UPSERT; a full store still takes a replacement") {
+            RiRi::Store full({.shardCount = 1, .maxMemory = 4096, .memoryWarningRatio = 1.0f});
+            int i = 0;
+            while (SET(full, "key" + std::to_string(i), std::int64_t{i}).ok()) i++;
+            REQUIRE(i > 0);
+
+            CHECK(UPSERT(full, "new", std::int64_t{0}).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+            CHECK(UPSERT(full, "key0", std::int64_t{-1}).ok());
+            CHECK(*GET(full, "key0").field() == RiRi::RapidDataType(std::int64_t{-1}));
+            CHECK(UPSERT(full, "key0", std::string(8192, 'v')).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+            CHECK(*GET(full, "key0").field() == RiRi::RapidDataType(std::int64_t{-1}));     // left as it was
+        }
+
+        // 5
+        SUBCASE("UPSERT; concurrent writers of the same keys") {
+            RiRi::Store concurrent({.shardCount = 4, .concurrentReads = true});
+            constexpr int THREADS = 4, KEYS = 64, ROUNDS = 200;
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; t++) {
+                threads.emplace_back([&concurrent, t] {
+                    for (int r = 0; r < ROUNDS; r++) {
+                        const std::string key = "key" + std::to_string((r * 7 + t) % KEYS);
+                        CHECK(UPSERT(concurrent, key, std::string(r % 40, 'a' + t)).ok());
+                        RiRi::ReadGuard guard;
+                        CHECK(GET(concurrent, key).field() != nullptr);
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(concurrent)) == KEYS);
+        }
+    }
+}
@@ -62,7 +62,7 @@ using namespace RiRi::Utils;
 
 // ============== FORCE OOM (DO NOT USE) =================
 
-GO_AWAY static bool force_oom = false;
+GO_AWAY bool force_oom = false;     // test_core.cpp runs out of memory on purpose too
 
 void* operator new(std::size_t size) {
     if (force_oom) throw std::bad_alloc();
@@ -1,13 +1,57 @@
 #include "doctest.h"
 #include "DataManager.h"
+#include "Expiry.h"
+#include "KeyCompare.h"
+#include "LazyFree.h"
+#include "MemoryMaps.h"
+#include "Numa.h"
+#include "OrderedIndex.h"
+#include "PageAllocator.h"
+#include "RapidValue.h"
+#include "ReadIndex.h"
+#include "Reclaimer.h"
+#include "Slab.h"
+#include "ValueIndex.h"
+#include "WorkPool.h"
+#include "riri/ReadGuard.hpp"
+#include "riri/Store.hpp"
 #include "riri/utils/Accessors.hpp"
 #include "riri/RapidTypes.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <set>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace RiRi::Internal;
 using namespace RiRi::Utils;
 
+extern bool force_oom;      // every `new` throws while it's set, see test_status_batch_with.cpp
+
+namespace {
+
+    /// `slabCopy()`, for slabs that have the memory.
+    RapidSlabString copied(RapidSlab& slab, const std::string_view str) {
+        RapidSlabString copy;
+        REQUIRE(slabCopy(slab, str, copy));
+        return copy;
+    }
+
+    /// `storeValue()`, likewise.
+    RapidCell stored(RapidSlab& slab, const RiRi::RapidDataType& value) {
+        RapidCell cell;
+        REQUIRE(storeValue(slab, value, cell));
+        return cell;
+    }
+
+} // namespace
+
 
 TEST_CASE("(INTERNAL) Data Manager") {
 
@@ -109,4 +153,1231 @@ TEST_CASE("(INTERNAL) Data Manager") {
         CHECK(size() == 1);
     }
 
-}
\ No newline at end of file
+}
+
+
+TEST_CASE("(INTERNAL) Sharded Store") {
+
+    RapidStore store({.initialCapacity = 64, .shardCount = 6});    // not a power of two on purpose
+
+    SUBCASE("shard count is rounded up to a power of two") {
+        CHECK(store.shardCount() == 8);
+        CHECK(RapidStore({.initialCapacity = 0, .shardCount = 0}).shardCount() == 1);
+    }
+
+    SUBCASE("a key always maps to the same shard") {
+        const auto hash = RapidStore::hash("_key");
+        CHECK(store.shardIndex(hash) == store.shardIndex(RapidStore::hash(std::string("_key"))));
+        CHECK(store.shardIndex(hash) < store.shardCount());
+    }
+
+    SUBCASE("failed insert leaves the key untouched") {
+        std::string key = "_key";
+        CHECK(setValue(store, std::move(key), RiRi::RapidDataType{"RiRi"}) == true);
+
+        std::string dup = "_key";
+        CHECK(setValue(store, std::move(dup), RiRi::RapidDataType{"again"}) == false);
+        CHECK(dup == "_key");   // try_emplace never consumed it
+        CHECK(size(store) == 1);
+        CHECK(getValue("_key") == nullptr);     // and the default store never saw any of it
+    }
+
+    SUBCASE("out of memory for the indexes, a write backs out") {
+        RapidStore indexed({.initialCapacity = 64, .shardCount = 1, .valueIndex = true, .orderedIndex = true});
+        REQUIRE(setValue(indexed, "_a", RiRi::RapidDataType{"same"}));
+        REQUIRE(setValue(indexed, "_b", RiRi::RapidDataType{"other"}));
+        RiRi::RapidDataType replacement{"same"};
+        RiRi::RapidDataType created{"same"};
+
+        // a second key with the same value is the first one its bucket has to make room for
+        force_oom = true;
+        const RapidWrite update = updateValue(indexed, "_b", std::move(replacement));
+        const RapidWrite set = setValue(indexed, "_c", std::move(created));
+        force_oom = false;
+
+        CHECK(update.code() == RiRi::StatusCode::ERR_OUT_OF_MEMORY);
+        CHECK(set.code() == RiRi::StatusCode::ERR_OUT_OF_MEMORY);
+        CHECK(*unpack_as<std::string>(getValue(indexed, "_b")) == "other");
+        CHECK(getValue(indexed, "_c") == nullptr);
+        CHECK(size(indexed) == 2);
+        CHECK(findKeysByValue(indexed, RiRi::RapidDataType{"other"}).size() == 1);
+        CHECK(findKeysByValue(indexed, RiRi::RapidDataType{"same"}).size() == 1);
+        CHECK(scanKeys(indexed, "", "~").size() == 2);
+    }
+
+    SUBCASE("out of memory for a copy, a read says so instead of missing") {
+        RapidStore concurrent({.initialCapacity = 64, .shardCount = 2, .concurrentReads = true});
+        const std::string big(1 << 20, 'x');      // more than any read buffer slot held so far
+        for (const char* key : {"_a", "_b", "_c"}) {
+            REQUIRE(setValue(store, key, RiRi::RapidDataType{big}));
+            REQUIRE(setValue(concurrent, key, RiRi::RapidDataType{big}));
+        }
+
+        force_oom = true;
+        const auto* locked = getValue(store, "_a");
+        const bool lockedStarved = readStarved();
+        const auto* lockFree = getValue(concurrent, "_a");
+        const bool lockFreeStarved = readStarved();
+        std::uint64_t cursor = 0;
+        const std::size_t scanned = scanStore(store, cursor, 10).size();
+        const bool scanStarved = readStarved();
+        force_oom = false;
+
+        CHECK(locked == nullptr);
+        CHECK(lockedStarved);
+        CHECK(lockFree == nullptr);
+        CHECK(lockFreeStarved);
+        CHECK(scanned == 0);
+        CHECK(scanStarved);
+
+        // nothing was lost: the next reads get it all, the scan right from where it stopped
+        CHECK(*unpack_as<std::string>(getValue(store, "_a")) == big);
+        CHECK_FALSE(readStarved());
+        std::size_t walked = 0;
+        do walked += scanStore(store, cursor, 10).size(); while (cursor != 0);
+        CHECK(walked == 3);
+    }
+
+    SUBCASE("pre-hashed keys skip the hashing, not the lookup") {
+        const std::string key = "some-long-composite-key:tenant:42:user:1337:session:current";
+        const std::size_t hash = RiRi::hashKey(key);
+        CHECK(hash == RapidStore::hash(key));
+
+        CHECK(setValue(store, key, RiRi::RapidDataType{std::int64_t{1}}, hash));
+        CHECK(*getValue(store, key) == RiRi::RapidDataType{std::int64_t{1}});     // same shard, same slot
+        CHECK(updateValue(store, key, RiRi::RapidDataType{std::int64_t{2}}, hash));
+        CHECK(*getValue(store, key, hash) == RiRi::RapidDataType{std::int64_t{2}});
+
+        RiRi::RapidNode nodes[] {{key, {}}, {"not-there", {}}};
+        RiRi::prehash(nodes);
+        CHECK(nodes[1].hash == RapidStore::hash("not-there"));
+        bool deleted[2];
+        deleteKeys(store, nodes, deleted);
+        CHECK(deleted[0]);
+        CHECK_FALSE(deleted[1]);
+        CHECK_FALSE(deleteKey(store, key, hash));
+    }
+
+    SUBCASE("values handed out are snapshots") {
+        setValue(store, "_key", RiRi::RapidDataType{std::string(64, 'a')});
+        const auto* before = getValue(store, "_key");
+        REQUIRE(before != nullptr);
+
+        updateValue(store, "_key", RiRi::RapidDataType{std::string(64, 'b')});
+        CHECK(*unpack_as<std::string>(before) == std::string(64, 'a'));     // a writer can't reach it
+
+        {
+            RiRi::ReadGuard guard;      // reads pile up instead of reusing the buffer
+            const auto* first = getValue(store, "_key");
+            deleteKey(store, "_key");
+            setValue(store, "_key", RiRi::RapidDataType{std::int64_t{7}});
+            const auto* second = getValue(store, "_key");
+            CHECK(*unpack_as<std::string>(first) == std::string(64, 'b'));
+            CHECK(*unpack_as<std::int64_t>(second) == 7);
+        }
+        CHECK(*getKeyByValue(store, RiRi::RapidDataType{std::int64_t{7}}) == "_key");
+    }
+
+    SUBCASE("batched functions report per node, in input order") {
+        std::array<RiRi::RapidNode, 64> nodes;
+        for (int i = 0; i < 64; i++) {
+            nodes[i] = {"key" + std::to_string(i % 48), std::int64_t{i}};   // 16 duplicates at the end
+        }
+        auto nodes_ref = nodes;     // setValues moves keys out
+        RapidWrite inserted[64];
+        setValues(store, nodes, inserted);
+        for (int i = 0; i < 64; i++) {
+            CHECK(inserted[i] == (i < 48));
+        }
+        CHECK(size(store) == 48);
+
+        const RiRi::RapidDataType* values[64];
+        getValues(store, nodes_ref, values);
+        for (int i = 0; i < 64; i++) {
+            REQUIRE(values[i] != nullptr);
+            CHECK(*unpack_as<std::int64_t>(values[i]) == i % 48);   // first insert wins
+        }
+
+        std::array<RiRi::RapidNode, 2> updates {{{"key1", std::int64_t{-1}}, {"missing", std::int64_t{-1}}}};
+        RapidWrite updated[2];
+        updateValues(store, updates, updated);
+        CHECK(updated[0] == true);
+        CHECK(updated[1] == false);
+        CHECK(*unpack_as<std::int64_t>(getValue(store, "key1")) == -1);
+
+        bool deleted[64];
+        deleteKeys(store, nodes_ref, deleted);
+        for (int i = 0; i < 64; i++) {
+            CHECK(deleted[i] == (i < 48));  // duplicates are already gone by the time we reach them
+        }
+        CHECK(size(store) == 0);
+    }
+
+    SUBCASE("concurrent writers and readers") {
+        constexpr int THREADS = 8;
+        constexpr int PER_THREAD = 2000;
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < THREADS; t++) {
+            workers.emplace_back([&store, t] {
+                for (int i = 0; i < PER_THREAD; i++) {
+                    std::string key = std::to_string(t) + ":" + std::to_string(i);
+                    setValue(store, std::string(key), std::int64_t{i});
+                    const auto* val = getValue(store, key);
+                    // only this thread writes this key, so it must be there
+                    CHECK(val != nullptr);
+                    if (i % 2) deleteKey(store, key);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        CHECK(size(store) == THREADS * PER_THREAD / 2);
+        clearMap(store);
+        CHECK(size(store) == 0);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Concurrent Reads") {
+
+    RapidStore store({.initialCapacity = 64, .shardCount = 4, .concurrentReads = true});
+    REQUIRE(store.concurrentReads());
+
+    SUBCASE("read index follows every write") {
+        CHECK(setValue(store, "_key", RiRi::RapidDataType{"RiRi"}) == true);
+        CHECK(*unpack_as<std::string>(getValue(store, "_key")) == "RiRi");
+
+        CHECK(updateValue(store, "_key", RiRi::RapidDataType{std::int64_t{42}}) == true);
+        CHECK(*unpack_as<std::int64_t>(getValue(store, "_key")) == 42);
+
+        CHECK(deleteKey(store, "_key") == true);
+        CHECK(getValue(store, "_key") == nullptr);
+
+        // enough keys to make the read indexes grow a few times
+        for (int i = 0; i < 1000; i++) setValue(store, "key" + std::to_string(i), std::int64_t{i});
+        for (int i = 0; i < 1000; i += 2) deleteKey(store, "key" + std::to_string(i));
+        for (int i = 0; i < 1000; i++) {
+            const auto* val = getValue(store, "key" + std::to_string(i));
+            if (i % 2) {
+                REQUIRE(val != nullptr);
+                CHECK(*unpack_as<std::int64_t>(val) == i);
+            } else {
+                CHECK(val == nullptr);
+            }
+        }
+
+        std::array<RiRi::RapidNode, 3> nodes {{{"key1", {}}, {"key2", {}}, {"key3", {}}}};
+        const RiRi::RapidDataType* values[3];
+        getValues(store, nodes, values);
+        CHECK(values[0] != nullptr);
+        CHECK(values[1] == nullptr);
+        CHECK(values[2] != nullptr);
+
+        clearMap(store);
+        CHECK(getValue(store, "key1") == nullptr);
+    }
+
+    SUBCASE("the read index grows a few slots per write, readers find every key all along") {
+        RapidReadIndex index;
+        const auto key = [](const int i) { return "grow-key-" + std::to_string(i); };
+        const auto found = [&index, &key](const int i) {
+            const std::string k = key(i);
+            const auto* value = index.find(k, RapidHash{}(k));
+            return value != nullptr && *value == RiRi::RapidDataType{std::int64_t{i}};
+        };
+        const auto publish = [&index, &key](const int i) {
+            const std::string k = key(i);
+            index.publish(index.prepare(k, RapidHash{}(k), std::int64_t{i}));
+        };
+
+        // a few grows in, and then one caught halfway
+        int count = 0;
+        while (count < 1000 || !index.growing()) publish(count++);
+        const int grown_at = count;
+        for (int i = 0; i < count; i++) CHECK(found(i));
+
+        // keys that haven't moved yet are replaced and erased where they are
+        const std::string first = key(0);
+        index.publish(index.prepare(first, RapidHash{}(first), "replaced"));
+        CHECK(*index.find(first, RapidHash{}(first)) == RiRi::RapidDataType{"replaced"});
+        index.erase(first, RapidHash{}(first));
+        CHECK(index.find(first, RapidHash{}(first)) == nullptr);
+        publish(0);
+
+        // the outgrown table had fewer than `2 * grown_at` slots, `GROW_STEP` of them go per write
+        while (index.growing()) publish(count++);
+        CHECK(count - grown_at <= 2 * grown_at / static_cast<int>(RapidReadIndex::GROW_STEP) + 1);
+        for (int i = 0; i < count; i++) CHECK(found(i));
+
+        // and with a reader going all the while, grow after grow
+        std::atomic<bool> done{false};
+        std::atomic<int> missed{0};
+        std::thread reader([&done, &missed, &found] {
+            while (!done.load(std::memory_order_relaxed)) {
+                RiRi::ReadGuard guard;
+                for (int i = 0; i < 100; i++) {
+                    if (!found(i)) ++missed;
+                }
+            }
+        });
+        for (int i = count; i < count + 20'000; i++) publish(i);
+        done = true;
+        reader.join();
+        CHECK(missed == 0);
+    }
+
+    SUBCASE("out of memory for the readers' copy, a write backs out") {
+        REQUIRE(setValue(store, "_key", RiRi::RapidDataType{"old"}));
+        RiRi::RapidDataType replacement{"new"};
+        RiRi::RapidDataType created{"created"};
+
+        force_oom = true;
+        const RapidWrite update = updateValue(store, "_key", std::move(replacement));
+        const RapidWrite set = setValue(store, "_other", std::move(created));
+        force_oom = false;
+
+        CHECK(update.code() == RiRi::StatusCode::ERR_OUT_OF_MEMORY);
+        CHECK(set.code() == RiRi::StatusCode::ERR_OUT_OF_MEMORY);
+        CHECK(*unpack_as<std::string>(getValue(store, "_key")) == "old");
+        CHECK(getValue(store, "_other") == nullptr);
+        CHECK(size(store) == 1);
+    }
+
+    SUBCASE("a guarded value outlives its replacement") {
+        setValue(store, "_key", RiRi::RapidDataType{"old"});
+        {
+            RiRi::ReadGuard guard;
+            const auto* old = getValue(store, "_key");
+            REQUIRE(old != nullptr);
+
+            updateValue(store, "_key", RiRi::RapidDataType{"new"});
+            epochCollect();     // must not free what the guard protects
+            CHECK(*unpack_as<std::string>(old) == "old");
+            CHECK(*unpack_as<std::string>(getValue(store, "_key")) == "new");
+            CHECK(epochPending() > 0);
+        }
+        epochCollect();
+        CHECK(epochPending() == 0);
+    }
+
+    SUBCASE("lock-free readers alongside writers") {
+        constexpr int KEYS = 64;
+        constexpr int WRITES = 5000;
+        for (int k = 0; k < KEYS; k++) setValue(store, "key" + std::to_string(k), RiRi::RapidDataType{"0"});
+
+        std::atomic<bool> done{false};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 6; t++) {
+            readers.emplace_back([&store, &done, &bad, t] {
+                int k = t;
+                while (!done.load(std::memory_order_relaxed)) {
+                    RiRi::ReadGuard guard;
+                    const auto* val = getValue(store, "key" + std::to_string(k++ % KEYS));
+                    // every key is always present, and every value a complete number
+                    const auto* str = val ? unpack_as<std::string>(val) : nullptr;
+                    if (!str || str->empty() || str->find_first_not_of("0123456789") != std::string::npos) ++bad;
+                }
+            });
+        }
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 2; t++) {
+            writers.emplace_back([&store, t] {
+                for (int i = 0; i < WRITES; i++) {
+                    // long enough to never fit the small string buffer
+                    updateValue(store, "key" + std::to_string((i + t) % KEYS), RiRi::RapidDataType{std::string(40, '0' + i % 10)});
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        done = true;
+        for (auto& r : readers) r.join();
+
+        CHECK(bad == 0);
+        CHECK(size(store) == KEYS);
+    }
+
+    SUBCASE("out of memory to queue them, retired objects are freed all the same, once") {
+        epochCollect();
+        REQUIRE(epochPending() == 0);
+        int freed = 0;
+        const RapidDeleterFn count = [](void* counter) { ++*static_cast<int*>(counter); };
+
+        force_oom = true;
+        for (int i = 0; i < 500; i++) epochRetire(&freed, count);
+        const std::size_t queued = epochPending();
+        const int early = freed;
+        force_oom = false;
+
+        CHECK(early > 0);       // the ones that didn't fit in the queue, right away
+        CHECK(queued + static_cast<std::size_t>(early) == 500);
+        epochCollect();
+        CHECK(freed == 500);
+        CHECK(epochPending() == 0);
+    }
+
+    SUBCASE("writers retire on their own threads, whatever they leave behind is still freed") {
+        constexpr int WRITERS = 4;
+        constexpr int WRITES = 2000;
+        for (int t = 0; t < WRITERS; t++) {
+            for (int k = 0; k < 16; k++) setValue(store, "w" + std::to_string(t) + ":" + std::to_string(k), RiRi::RapidDataType{"-"});
+        }
+        setValue(store, "_pinned", RiRi::RapidDataType{std::string(40, 'p')});
+        epochCollect();
+        REQUIRE(epochPending() == 0);
+
+        const auto write = [&store](const int t) {
+            for (int i = 0; i < WRITES; i++) {
+                updateValue(store, "w" + std::to_string(t) + ":" + std::to_string(i % 16), RiRi::RapidDataType{std::string(40, 'a' + i % 26)});
+            }
+        };
+        {
+            RiRi::ReadGuard guard;      // pinned: nothing retired from here on may be freed
+            const auto* pinned = getValue(store, "_pinned");
+            REQUIRE(pinned != nullptr);
+
+            std::vector<std::thread> writers;
+            for (int t = 0; t < WRITERS; t++) writers.emplace_back(write, t);
+            for (auto& w : writers) w.join();
+            deleteKey(store, "_pinned");
+            epochCollect();
+
+            CHECK(epochPending() >= WRITERS * WRITES);
+            CHECK(*unpack_as<std::string>(pinned) == std::string(40, 'p'));
+        }
+
+        // unpinned, they free their own as they go
+        std::vector<std::thread> writers;
+        for (int t = 0; t < WRITERS; t++) writers.emplace_back(write, t);
+        for (auto& w : writers) w.join();
+        for (int t = 0; t < WRITERS; t++) {
+            CHECK(*unpack_as<std::string>(getValue(store, "w" + std::to_string(t) + ":15")) == std::string(40, 'a' + (WRITES - 1) % 26));
+        }
+
+        // and the threads are gone, yet what they left is reached all the same
+        epochCollect();
+        CHECK(epochPending() == 0);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Slab") {
+
+    RapidSlab slab;
+
+    SUBCASE("freed memory is recycled within its size class") {
+        char* a = slab.allocate(20);    // 32 byte class
+        slab.deallocate(a, 20);
+        CHECK(slab.allocate(31) == a);
+        CHECK(slab.allocate(20) != a);
+        CHECK(slab.reservedBytes() == RapidSlab::SLAB_SIZE);
+    }
+
+    SUBCASE("strings round trip") {
+        const std::string big(RapidSlab::MAX_CLASS_SIZE + 1, 'x');
+        const RapidSlabString small = copied(slab, "RiRi");
+        const RapidSlabString large = copied(slab, big);
+        const RapidSlabString empty = copied(slab, "");
+
+        CHECK(small.view() == "RiRi");
+        CHECK(large.view() == big);
+        CHECK(empty.view().empty());
+        CHECK(slab.reservedBytes() > RapidSlab::SLAB_SIZE + big.size());
+
+        slabFree(slab, large);
+        CHECK(slab.reservedBytes() == RapidSlab::SLAB_SIZE);
+        slabFree(slab, empty);
+    }
+
+    SUBCASE("grow stays in place while the block has room, keeps the bytes when it moves") {
+        char* str = slab.allocate(20);          // 32 byte class
+        std::memcpy(str, "RiRi", 4);
+        CHECK(slab.grow(str, 20, 32) == str);
+        char* moved = slab.grow(str, 32, 33);
+        CHECK(moved != str);
+        CHECK(std::string_view(moved, 4) == "RiRi");
+        CHECK(slab.allocate(32) == str);        // the old block was given back
+
+        // large blocks get room to spare: a byte at a time, they move only now and then
+        char* large = slab.grow(moved, 33, RapidSlab::MAX_CLASS_SIZE + 1);
+        std::size_t moves = 0;
+        for (std::size_t size = RapidSlab::MAX_CLASS_SIZE + 1; size < 64 * 1024; ++size) {
+            char* grown = slab.grow(large, size, size + 1);
+            moves += grown != large;
+            large = grown;
+        }
+        CHECK(std::string_view(large, 4) == "RiRi");
+        CHECK(moves < 10);
+        slab.deallocate(large, 64 * 1024);
+        CHECK(slab.reservedBytes() == RapidSlab::SLAB_SIZE);
+    }
+
+    SUBCASE("release drops everything at once") {
+        for (int i = 0; i < 10000; i++) (void)slab.allocate(1 + i % 300);
+        (void)slab.allocate(RapidSlab::MAX_CLASS_SIZE * 2);
+        CHECK(slab.reservedBytes() > RapidSlab::SLAB_SIZE);
+        slab.release();
+        CHECK(slab.reservedBytes() == 0);
+        CHECK(slab.allocate(16) != nullptr);    // and is still usable afterwards
+    }
+
+    SUBCASE("retired slabs keep their strings until they're released, all at once") {
+        std::vector<RapidSlabString> strings;
+        for (int i = 0; i < 5000; i++) strings.push_back(copied(slab, "retiring string " + std::to_string(i)));
+        const std::size_t reserved = slab.reservedBytes();
+        for (int i = 1; i < 5000; i += 2) slabFree(slab, strings[i]);
+        CHECK(slab.idleBytes() >= reserved / 2);
+
+        slab.retire();
+        CHECK(slab.compacting());
+        CHECK(slab.retiring(strings[0].data));
+        const RapidSlabString fresh = copied(slab, "fresh");
+        CHECK_FALSE(slab.retiring(fresh.data));
+        CHECK(strings[4998].view() == "retiring string 4998");
+
+        for (int i = 0; i < 5000; i += 2) {
+            const RapidSlabString moved = copied(slab, strings[i].view());
+            slabFree(slab, strings[i]);         // dropped, not recycled
+            CHECK_FALSE(slab.retiring(moved.data));
+        }
+        CHECK(slab.releaseRetired() == reserved);
+        CHECK_FALSE(slab.compacting());
+        CHECK(slab.reservedBytes() < reserved);
+        CHECK(slab.idleBytes() < RapidSlab::SLAB_SIZE);
+    }
+
+    SUBCASE("no memory to be had: nullptr, and nothing else changes") {
+        constexpr std::size_t LARGE = RapidSlab::MAX_CLASS_SIZE + 1;
+        char* kept = slab.allocate(LARGE);
+        std::memset(kept, 'k', LARGE);
+        const std::size_t reserved = slab.reservedBytes();
+
+        CHECK(slab.allocate(SIZE_MAX / 2) == nullptr);      // more than any heap has
+        CHECK(slab.grow(kept, LARGE, SIZE_MAX / 4) == nullptr);
+        CHECK(slab.reservedBytes() == reserved);
+        CHECK(std::string_view(kept, LARGE) == std::string(LARGE, 'k'));
+
+        // and it carries on as if nothing happened
+        char* grown = slab.grow(kept, LARGE, 2 * LARGE);
+        REQUIRE(grown != nullptr);
+        CHECK(std::string_view(grown, LARGE) == std::string(LARGE, 'k'));
+        slab.deallocate(grown, 2 * LARGE);
+        CHECK(slab.reservedBytes() == 0);
+    }
+
+    SUBCASE("CLEAR hands the slabs back") {
+        RapidStore store({.initialCapacity = 0, .shardCount = 1});
+        for (int i = 0; i < 1000; i++) {
+            setValue(store, "some-rather-long-key-" + std::to_string(i), RiRi::RapidDataType{std::string(100, 'v')});
+        }
+        CHECK(store.shard(0).slab.reservedBytes() >= 1000 * 100);
+        clearMap(store);
+        CHECK(store.shard(0).slab.reservedBytes() == 0);
+        CHECK(getValue(store, "some-rather-long-key-1") == nullptr);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Key Comparison") {
+
+    SUBCASE("every length, equal or different at any byte") {
+        // separate buffers, so nothing gets away with comparing pointers
+        std::string lhs, rhs;
+        for (std::size_t size = 0; size <= 200; ++size) {
+            lhs.assign(size, 'k');
+            rhs.assign(size, 'k');
+            for (std::size_t i = 0; i < size; ++i) lhs[i] = rhs[i] = static_cast<char>('a' + i % 26);
+            REQUIRE(sameKey(lhs, rhs));
+            for (std::size_t i = 0; i < size; ++i) {
+                rhs[i] ^= 0x20;
+                REQUIRE_FALSE(sameKey(lhs, rhs));
+                rhs[i] ^= 0x20;
+            }
+            rhs.push_back('k');
+            REQUIRE_FALSE(sameKey(lhs, rhs));
+        }
+    }
+
+    SUBCASE("keys in the middle of bigger buffers") {
+        const std::string buffer = std::string(100, 'x') + "tenant:42:session:1234567890:abcdefghij" + std::string(100, 'x');
+        const std::string key = "tenant:42:session:1234567890:abcdefghij";
+        CHECK(sameKey(std::string_view(buffer).substr(100, key.size()), key));
+        CHECK_FALSE(sameKey(std::string_view(buffer).substr(99, key.size()), key));
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Work Pool") {
+
+    RapidWorkPool pool(3);
+    REQUIRE(pool.threads() == 4);
+
+    SUBCASE("every task runs exactly once, however uneven they are") {
+        std::vector<std::atomic<int>> runs(1000);
+        std::atomic<std::uint64_t> spent{0};
+        pool.run(runs.size(), 0, [&](const std::size_t task) {
+            // the first tasks are the slow ones, so their owner falls behind and gets robbed
+            std::uint64_t work = 0;
+            for (std::size_t i = 0; i < (task < 50 ? 20'000 : 10); ++i) work += i ^ task;
+            spent += work;
+            ++runs[task];
+        });
+        CHECK(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& count) { return count == 1; }));
+        CHECK(spent > 0);
+    }
+
+    SUBCASE("job after job, some with fewer threads or tasks than the pool has") {
+        std::atomic<std::size_t> total{0};
+        std::size_t expected = 0;
+        for (std::size_t job = 0; job < 200; ++job) {
+            const std::size_t tasks = job % 7;
+            pool.run(tasks, job % 5, [&](const std::size_t task) { total += task + 1; });
+            expected += tasks * (tasks + 1) / 2;
+        }
+        CHECK(total == expected);
+    }
+
+    SUBCASE("one thread is the caller alone") {
+        const auto caller = std::this_thread::get_id();
+        bool elsewhere = false;
+        pool.run(100, 1, [&](std::size_t) { elsewhere |= std::this_thread::get_id() != caller; });
+        CHECK_FALSE(elsewhere);
+    }
+
+    SUBCASE("jobs from several threads run at the same time, and all complete") {
+        // each job's tasks wait for the other job to get going: one job at a time would never see it
+        std::atomic<int> started[2] {0, 0};
+        std::atomic<bool> overlapped[2] {false, false};
+        const auto batch = [&](const int self) {
+            pool.run(64, 0, [&, self](std::size_t) {
+                ++started[self];
+                const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (started[1 - self] == 0 && std::chrono::steady_clock::now() < give_up) std::this_thread::yield();
+                if (started[1 - self] != 0) overlapped[self] = true;
+            });
+        };
+        std::thread other(batch, 1);
+        batch(0);
+        other.join();
+        CHECK(started[0] == 64);
+        CHECK(started[1] == 64);
+        CHECK(overlapped[0]);
+        CHECK(overlapped[1]);
+
+        // and many at once, some bigger than the pool, some smaller
+        std::atomic<std::size_t> total{0};
+        std::vector<std::thread> submitters;
+        for (std::size_t t = 0; t < 4; ++t) {
+            submitters.emplace_back([&pool, &total, t] {
+                for (std::size_t job = 0; job < 100; ++job) {
+                    pool.run(job % 9, (job + t) % 5, [&total](const std::size_t task) { total += task + 1; });
+                }
+            });
+        }
+        for (auto& submitter : submitters) submitter.join();
+        std::size_t expected = 0;
+        for (std::size_t job = 0; job < 100; ++job) expected += (job % 9) * (job % 9 + 1) / 2;
+        CHECK(total == 4 * expected);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Value Cell") {
+
+    RapidSlab slab;
+    const auto roundTrip = [&slab](const RiRi::RapidDataType& value) {
+        const RapidCell cell = stored(slab, value);
+        RiRi::RapidDataType out;
+        CHECK(loadValue(cell, out));
+        CHECK(sameValue(cell, value));
+        freeValue(slab, cell);
+        return out;
+    };
+
+    SUBCASE("every type survives the trip") {
+        CHECK(sizeof(RapidCell) == 16);
+        CHECK(roundTrip(std::int64_t{-42}) == RiRi::RapidDataType{std::int64_t{-42}});
+        CHECK(roundTrip(3.14159265359) == RiRi::RapidDataType{3.14159265359});
+        CHECK(roundTrip(true) == RiRi::RapidDataType{true});
+        CHECK(roundTrip(std::string()) == RiRi::RapidDataType{std::string()});
+        CHECK(roundTrip(std::string(15, 's')) == RiRi::RapidDataType{std::string(15, 's')});
+        CHECK(roundTrip(std::string(16, 'l')) == RiRi::RapidDataType{std::string(16, 'l')});
+    }
+
+    SUBCASE("short strings stay inline, long ones go to the slab") {
+        const RapidCell small = stored(slab, std::string(RapidCell::INLINE_CAPACITY, 's'));
+        CHECK(small.kind() == RapidCell::Kind::String);
+        CHECK_FALSE(small.inSlab());
+        CHECK(slab.reservedBytes() == 0);
+
+        const RapidCell large = stored(slab, std::string(RapidCell::INLINE_CAPACITY + 1, 'l'));
+        CHECK(large.inSlab());
+        CHECK(large.asString() == std::string(RapidCell::INLINE_CAPACITY + 1, 'l'));
+        CHECK(slab.reservedBytes() > 0);
+    }
+
+    SUBCASE("value hashes agree between cells and variants") {
+        for (const RiRi::RapidDataType& value : {RiRi::RapidDataType{std::int64_t{1}}, RiRi::RapidDataType{true},
+                                                 RiRi::RapidDataType{1.0}, RiRi::RapidDataType{std::string("1")},
+                                                 RiRi::RapidDataType{std::string(40, 'l')}}) {
+            const RapidCell cell = stored(slab, value);
+            CHECK(hashValue(cell) == hashValue(value));
+            freeValue(slab, cell);
+        }
+        CHECK(hashValue(RiRi::RapidDataType{std::int64_t{1}}) != hashValue(RiRi::RapidDataType{true}));
+        CHECK(hashValue(RiRi::RapidDataType{-0.0}) == hashValue(RiRi::RapidDataType{0.0}));    // they're equal after all
+    }
+
+    SUBCASE("kinds don't compare equal across types") {
+        const RapidCell one = stored(slab, std::int64_t{1});
+        CHECK_FALSE(sameValue(one, true));
+        CHECK_FALSE(sameValue(one, 1.0));
+        CHECK_FALSE(sameValue(one, std::string("1")));
+        CHECK(RapidCell().kind() == RapidCell::Kind::String);   // empty string by default
+        CHECK(RapidCell().asString().empty());
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Value Index") {
+
+    SUBCASE("keys sharing a value come and go in any order") {
+        RapidSlab slab;
+        RapidValueIndex index;
+        const RapidCell zero = RapidCell::ofInt(0);
+        const RapidCell one = RapidCell::ofInt(1);
+        std::vector<RapidSlabString> keys;
+        for (int i = 0; i < 1000; i++) {
+            keys.push_back(copied(slab, "key" + std::to_string(i)));
+            REQUIRE(index.add(i % 10 == 0 ? one : zero, {keys.back(), RapidHash{}(keys.back())}));
+        }
+        const auto candidates = [&index](const std::int64_t value) {
+            std::set<std::string> found;
+            index.forEachCandidate(RiRi::RapidDataType{value}, [&found](const RapidValueRef& ref) {
+                CHECK(found.insert(std::string(ref.key.view())).second);    // every key once
+            });
+            return found;
+        };
+        CHECK(index.size() == 2);
+        CHECK(candidates(0).size() == 900);
+
+        // the first key, the last one and everything in between, from either end
+        for (int i = 999; i >= 0; i -= 3) index.remove(i % 10 == 0 ? one : zero, keys[i]);
+        for (int i = 1; i < 1000; i += 3) index.remove(i % 10 == 0 ? one : zero, keys[i]);
+        index.remove(zero, keys[0]);    // not one of its keys, nothing happens
+
+        std::set<std::string> left;
+        for (int i = 0; i < 1000; i++) {
+            if ((999 - i) % 3 != 0 && (i - 1) % 3 != 0 && i % 10 != 0) left.insert("key" + std::to_string(i));
+        }
+        CHECK(candidates(0) == left);
+        CHECK(candidates(1).size() == 100 - 34 - 33);
+
+        for (int i = 0; i < 1000; i++) {
+            if ((999 - i) % 3 != 0 && (i - 1) % 3 != 0) index.remove(i % 10 == 0 ? one : zero, keys[i]);
+        }
+        CHECK(index.size() == 0);
+        for (const RapidSlabString key : keys) slabFree(slab, key);
+    }
+
+    SUBCASE("out of memory, nothing changes; a key taken out always fits back in") {
+        RapidSlab slab;
+        RapidValueIndex index;
+        const RapidCell zero = RapidCell::ofInt(0);
+        std::vector<RapidSlabString> keys;
+        std::vector<RapidCell> values;
+        for (int i = 0; i < 400; i++) {
+            keys.push_back(copied(slab, "key" + std::to_string(i)));
+            values.push_back(i % 2 == 0 ? zero : RapidCell::ofInt(i));     // a crowded bucket, and lots of fresh ones
+        }
+        for (std::size_t i = 0; i < 100; i++) REQUIRE(index.add(values[i], {keys[i], RapidHash{}(keys[i])}));
+
+        std::vector<char> added(keys.size(), 1);
+        force_oom = true;
+        for (std::size_t i = 100; i < keys.size(); i++) added[i] = index.add(values[i], {keys[i], RapidHash{}(keys[i])});
+        // the first key of a bucket and one of the rest, out and straight back in
+        index.remove(zero, keys[0]);
+        const bool first = index.add(zero, {keys[0], RapidHash{}(keys[0])});
+        index.remove(zero, keys[50]);
+        const bool rest = index.add(zero, {keys[50], RapidHash{}(keys[50])});
+        force_oom = false;
+
+        CHECK(first);
+        CHECK(rest);
+        CHECK(std::count(added.begin(), added.end(), 0) > 0);
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            std::size_t found = 0;
+            index.forEachCandidate(RiRi::RapidDataType{std::int64_t{i % 2 == 0 ? 0 : static_cast<std::int64_t>(i)}}, [&](const RapidValueRef& ref) {
+                found += ref.key.data == keys[i].data;
+            });
+            CHECK(found == static_cast<std::size_t>(added[i]));
+        }
+
+        // and whatever made it in comes out just the same
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (added[i]) index.remove(values[i], keys[i]);
+        }
+        CHECK(index.size() == 0);
+        for (const RapidSlabString key : keys) slabFree(slab, key);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Incremental Rehash") {
+
+    // one shard, so every key goes through the same table
+    RapidStore store({.initialCapacity = 0, .shardCount = 1, .incrementalRehash = true});
+    RapidTable& table = store.shard(0).map;
+    const auto key = [](const std::size_t n) { return "rehash-key-" + std::to_string(n); };
+
+    // fill it up until it has to grow, and then some, but not so much that the rehash is over
+    std::size_t count = 0;
+    while (!table.rehashing()) {
+        REQUIRE(setValue(store, key(count), RiRi::RapidDataType{static_cast<std::int64_t>(count)}));
+        ++count;
+    }
+    const std::size_t grown_at = count;
+    for (std::size_t i = 0; i < 10; ++i, ++count) {
+        REQUIRE(setValue(store, key(count), RiRi::RapidDataType{static_cast<std::int64_t>(count)}));
+    }
+    REQUIRE(table.rehashing());
+    CHECK(grown_at >= RapidTable::MIN_INCREMENTAL_SIZE);
+
+    SUBCASE("every key is found in either table") {
+        CHECK(size(store) == count);
+        for (std::size_t n = 0; n < count; ++n) {
+            const auto* value = getValue(store, key(n));
+            REQUIRE(value != nullptr);
+            CHECK(*value == RiRi::RapidDataType{static_cast<std::int64_t>(n)});
+        }
+        std::string dup = key(0);       // still in the old table, still a duplicate
+        CHECK_FALSE(setValue(store, std::move(dup), RiRi::RapidDataType{true}));
+    }
+
+    SUBCASE("writers work on keys that haven't moved yet") {
+        CHECK(updateValue(store, key(1), RiRi::RapidDataType{"updated"}));
+        CHECK(*getValue(store, key(1)) == RiRi::RapidDataType{"updated"});
+        CHECK(deleteKey(store, key(2)));
+        CHECK(getValue(store, key(2)) == nullptr);
+        CHECK(size(store) == count - 1);
+    }
+
+    SUBCASE("the old table goes away after enough writes") {
+        while (table.rehashing()) {
+            REQUIRE(setValue(store, key(count), RiRi::RapidDataType{static_cast<std::int64_t>(count)}));
+            ++count;
+        }
+        CHECK(count - grown_at <= grown_at / RapidTable::REHASH_STEP + 1);
+        CHECK(table.capacity() >= 2 * grown_at);
+        CHECK(size(store) == count);
+        CHECK(*getValue(store, key(0)) == RiRi::RapidDataType{std::int64_t{0}});
+    }
+
+    SUBCASE("a table emptied out shrinks the same way it grows") {
+        while (table.rehashing()) (void)table.drain(RapidTable::REHASH_STEP);
+        const std::size_t buckets = table.bucketBytes();
+        CHECK_FALSE(table.sparse(0.25f));
+        for (std::size_t n = 100; n < count; ++n) REQUIRE(deleteKey(store, key(n)));
+        REQUIRE(table.sparse(0.25f));
+
+        table.startShrink();
+        CHECK(table.rehashing());
+        CHECK_FALSE(table.sparse(0.25f));       // not while it's at it
+        CHECK(*getValue(store, key(99)) == RiRi::RapidDataType{std::int64_t{99}});
+        CHECK(table.drain(100));
+        CHECK(table.bucketBytes() < buckets);
+        CHECK(size(store) == 100);
+        CHECK(*getValue(store, key(0)) == RiRi::RapidDataType{std::int64_t{0}});
+        CHECK_FALSE(table.sparse(0.25f));       // as small as it gets: never below what it was set up for
+    }
+
+    SUBCASE("CLEAR drops both tables") {
+        clearMap(store);
+        CHECK_FALSE(table.rehashing());
+        CHECK(size(store) == 0);
+        CHECK(getValue(store, key(0)) == nullptr);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Huge Pages") {
+
+    const auto aligned = [](const void* ptr) { return reinterpret_cast<std::uintptr_t>(ptr) % HUGE_PAGE_SIZE == 0; };
+
+    SUBCASE("big blocks are mapped on huge page boundaries, small ones aren't") {
+        RapidPageAllocator<std::uint64_t> pages(true);
+        const std::size_t count = HUGE_PAGE_SIZE / sizeof(std::uint64_t) + 1;     // a page and a bit
+        std::uint64_t* block = pages.allocate(count);
+        CHECK(aligned(block));
+        for (std::size_t i = 0; i < count; ++i) block[i] = i;
+        CHECK(block[count - 1] == count - 1);
+        pages.deallocate(block, count);
+
+        std::uint64_t* small = pages.allocate(16);
+        small[15] = 1;
+        pages.deallocate(small, 16);
+
+        // the buckets get the entries' allocator, rebound
+        CHECK(RapidPageAllocator<char>(pages) == pages);
+        CHECK_FALSE(RapidPageAllocator<std::uint64_t>() == pages);
+    }
+
+    SUBCASE("a store on huge pages, through a rehash and a clear") {
+        RapidStore store({.initialCapacity = 0, .shardCount = 1, .incrementalRehash = true, .hugePages = true});
+        RapidTable& table = store.shard(0).map;
+        const auto key = [](const std::size_t n) { return "huge-key-" + std::to_string(n); };
+
+        constexpr std::size_t KEYS = 200'000;
+        bool rehashed = false;
+        for (std::size_t n = 0; n < KEYS; ++n) {
+            REQUIRE(setValue(store, key(n), RiRi::RapidDataType{static_cast<std::int64_t>(n)}));
+            rehashed |= table.rehashing();
+        }
+        CHECK(rehashed);
+        CHECK(table.entryBytes() >= HUGE_PAGE_SIZE);
+        CHECK(aligned(table.entries(false).data()));
+        for (std::size_t n = 0; n < KEYS; n += 7) {
+            const auto* value = getValue(store, key(n));
+            REQUIRE(value != nullptr);
+            CHECK(*value == RiRi::RapidDataType{static_cast<std::int64_t>(n)});
+        }
+
+        clearMap(store);
+        CHECK(size(store) == 0);
+        for (std::size_t n = 0; n < KEYS; ++n) REQUIRE(setValue(store, key(n), RiRi::RapidDataType{true}));
+        CHECK(aligned(table.entries(false).data()));
+    }
+}
+
+
+TEST_CASE("(INTERNAL) NUMA") {
+
+    const std::vector<int>& nodes = numaNodes();
+    REQUIRE_FALSE(nodes.empty());
+    CHECK(std::is_sorted(nodes.begin(), nodes.end()));
+    CHECK(RiRi::numaNodeCount() == nodes.size());
+    const int node = nodes.front();
+
+    SUBCASE("blocks for a node are mapped, small ones and partial pages aren't") {
+        RapidPageAllocator<char> pages(false, node);
+        char* block = pages.allocate(NODE_MIN_BYTES + 1);
+        CHECK(reinterpret_cast<std::uintptr_t>(block) % BASE_PAGE_SIZE == 0);
+        std::memset(block, 7, NODE_MIN_BYTES + 1);
+        pages.deallocate(block, NODE_MIN_BYTES + 1);
+
+        char* small = pages.allocate(100);
+        CHECK_FALSE(bindToNode(small, 100, node));      // not a single whole page in there
+        pages.deallocate(small, 100);
+
+        CHECK_FALSE(RapidPageAllocator<char>(false) == pages);
+        CHECK_FALSE(RapidPageAllocator<char>(true, node) == pages);
+    }
+
+    SUBCASE("a shard's table and slab on a node") {
+        RapidStore store({.initialCapacity = 0, .shardCount = 1});
+        RapidShard& shard = store.shard(0);
+        shard.slab.setNode(node);
+        shard.map.configure(0.8f, 0, false, RapidMap::allocator_type(false, node));
+
+        for (std::size_t n = 0; n < 20'000; ++n) {
+            REQUIRE(setValue(store, "numa-key-" + std::to_string(n), RiRi::RapidDataType{std::string(40, 'v')}));
+        }
+        CHECK(shard.slab.reservedBytes() >= RapidSlab::SLAB_SIZE);
+        CHECK(reinterpret_cast<std::uintptr_t>(shard.map.entries(false).data()) % BASE_PAGE_SIZE == 0);
+        CHECK(*getValue(store, "numa-key-12345") == RiRi::RapidDataType{std::string(40, 'v')});
+        clearMap(store);
+        CHECK(shard.slab.reservedBytes() == 0);
+    }
+
+    SUBCASE("NUMA aware stores, on as many nodes as there are") {
+        RiRi::Store store({.shardCount = 8, .numaAware = true});
+        RapidStore& rapid = StoreAccess::of(store);
+        for (std::size_t s = 0; s < rapid.shardCount(); ++s) {
+            if (nodes.size() == 1) {
+                CHECK(rapid.shardNode(s) == -1);        // one node: nothing to place, nothing changes
+            } else {
+                CHECK(std::find(nodes.begin(), nodes.end(), rapid.shardNode(s)) != nodes.end());
+                CHECK(rapid.shardNode(s) >= rapid.shardNode(s == 0 ? 0 : s - 1));
+            }
+        }
+        CHECK(store.nodeOf("some key") == rapid.shardNode(rapid.shardIndex(RapidStore::hash("some key"))));
+        CHECK(RiRi::Store().nodeOf("some key") == -1);
+    }
+
+    SUBCASE("threads can be kept on a node") {
+        bool pinned = false;
+        std::thread([&] { pinned = RiRi::runOnNode(node); }).join();
+        CHECK(pinned);
+        CHECK_FALSE(RiRi::runOnNode(4096));
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Lazy Free") {
+
+    struct Countdown {
+        std::atomic<int>* steps;
+        int left;
+    };
+    std::atomic<int> steps{0};
+    const RapidFreeStepFn step = [](void* garbage) noexcept {
+        auto* countdown = static_cast<Countdown*>(garbage);
+        countdown->steps->fetch_add(1);
+        if (--countdown->left != 0) return false;
+        delete countdown;
+        return true;
+    };
+
+    SUBCASE("garbage is freed a step at a time, in turns") {
+        for (int i = 0; i < 10; i++) lazyFree(new Countdown{&steps, 1 + i}, step);
+        lazyFreeWait();
+        CHECK(steps.load() == 55);
+        CHECK(lazyFreePending() == 0);
+    }
+
+    SUBCASE("out of memory to hand it over, the caller frees it") {
+        lazyFreeWait();     // the freer is up before the memory runs out
+        std::vector<Countdown*> garbage;
+        for (int i = 0; i < 200; i++) garbage.push_back(new Countdown{&steps, 3});
+
+        force_oom = true;
+        for (Countdown* countdown : garbage) lazyFree(countdown, step);
+        force_oom = false;
+
+        lazyFreeWait();
+        CHECK(steps.load() == 600);     // every step of every one, whoever took them
+        CHECK(lazyFreePending() == 0);
+    }
+
+    SUBCASE("slabs are released in steps too, and swap whole") {
+        RapidSlab slab;
+        for (int i = 0; i < 5000; i++) (void)slab.allocate(1000);
+        (void)slab.allocate(RapidSlab::MAX_CLASS_SIZE * 2);
+        const std::size_t reserved = slab.reservedBytes();
+
+        RapidSlab other;
+        other.swap(slab);
+        CHECK(slab.reservedBytes() == 0);
+        CHECK(other.reservedBytes() == reserved);
+        CHECK(slab.allocate(16) != nullptr);
+
+        std::size_t steps = 1;
+        while (!other.releaseStep(16)) ++steps;
+        CHECK(steps > 1);
+        CHECK(other.reservedBytes() == 0);
+
+        char* large = slab.allocate(RapidSlab::MAX_CLASS_SIZE * 2);
+        void* block = slab.detach(large, RapidSlab::MAX_CLASS_SIZE * 2);
+        CHECK(slab.reservedBytes() == RapidSlab::SLAB_SIZE);
+        RapidSlab::freeDetached(block);
+    }
+
+    SUBCASE("CLEAR swaps every shard for an empty one, whatever it held") {
+        RiRi::Store store({
+            .initialCapacity = 64, .shardCount = 2, .concurrentReads = true,
+            .incrementalRehash = true, .valueIndex = true, .orderedIndex = true
+        });
+        RapidStore& rapid = StoreAccess::of(store);
+        for (std::size_t n = 0; n < 50'000; ++n) {
+            REQUIRE(setValue(rapid, "lazy-key-" + std::to_string(n), RiRi::RapidDataType{std::string(40, 'v')}));
+        }
+        REQUIRE(setValue(rapid, "ttl", RiRi::RapidDataType{std::int64_t{1}}, std::chrono::hours(1)));
+        const std::size_t buckets = rapid.shard(0).map.bucketBytes();
+
+        clearMap(rapid);
+        CHECK(size(rapid) == 0);
+        for (std::size_t s = 0; s < rapid.shardCount(); ++s) {
+            CHECK(rapid.shard(s).slab.reservedBytes() == 0);
+            CHECK(rapid.shard(s).keyBytes == 0);
+            CHECK(rapid.shard(s).expiry == nullptr);
+            CHECK(rapid.shard(s).values->size() == 0);
+            CHECK(rapid.shard(s).ordered->size() == 0);
+        }
+        CHECK(rapid.shard(0).map.bucketBytes() < buckets);      // back to the initial capacity
+        CHECK(getValue(rapid, "lazy-key-1") == nullptr);
+
+        // and the fresh shards work like the old ones did
+        REQUIRE(setValue(rapid, "lazy-key-1", RiRi::RapidDataType{std::string(40, 'w')}, std::chrono::hours(1)));
+        CHECK(*getValue(rapid, "lazy-key-1") == RiRi::RapidDataType{std::string(40, 'w')});
+        CHECK(size(rapid) == 1);
+
+        epochCollect();
+        lazyFreeWait();
+        CHECK(lazyFreePending() == 0);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Timing Wheel") {
+
+    // a fake clock, starting somewhere that isn't a multiple of anything
+    std::int64_t now = 1'000'003;
+    RapidTimingWheel wheel(now);
+    std::vector<RapidTimingWheel::Timer> due;
+
+    // the timers' keys are just ids to the wheel, never read through
+    const auto id = [](const std::size_t n) { return reinterpret_cast<const char*>(n + 1); };
+
+    SUBCASE("every timer fires once, on time") {
+        // from the next millisecond to hours out, so every level gets some
+        std::vector<std::int64_t> deadlines;
+        for (std::size_t n = 0; n < 5'000; ++n) {
+            deadlines.push_back(now + static_cast<std::int64_t>((n * n * 7919) % 10'000'000) + 1);
+            wheel.schedule({id(n), deadlines.back()});
+        }
+        CHECK(wheel.size() == deadlines.size());
+
+        std::vector<int> fired(deadlines.size(), 0);
+        // uneven steps, some tiny, some crossing several levels at once
+        for (std::int64_t step = 1; now < 1'000'003 + 10'000'001; step = step * 3 % 100'003 + 1) {
+            now += step;
+            due.clear();
+            wheel.advance(now, due);
+            for (const auto& timer : due) {
+                const std::size_t n = reinterpret_cast<std::size_t>(timer.key) - 1;
+                CHECK(timer.at <= now);             // never early
+                CHECK(timer.at > now - step);       // and not late either
+                ++fired[n];
+            }
+        }
+        CHECK(wheel.size() == 0);
+        CHECK(std::all_of(fired.begin(), fired.end(), [](const int count) { return count == 1; }));
+    }
+
+    SUBCASE("overdue timers fire on the next advance") {
+        wheel.schedule({id(0), now - 50});
+        wheel.advance(now, due);
+        REQUIRE(due.size() == 1);
+        CHECK(due[0].key == id(0));
+    }
+
+    SUBCASE("timers of the next lap wait for it") {
+        wheel.schedule({id(0), now + 62});      // a lower slot than the current one
+        wheel.advance(now + 61, due);
+        CHECK(due.empty());
+        wheel.advance(now + 100, due);
+        REQUIRE(due.size() == 1);
+        CHECK(due[0].at == now + 62);
+    }
+
+    SUBCASE("timers past the wheel's reach fire early, not never") {
+        const std::int64_t far = now + (std::int64_t{1} << 40);
+        wheel.schedule({id(0), far});
+        wheel.advance(far, due);
+        REQUIRE(due.size() == 1);
+        CHECK(due[0].at == far);    // the owner sees the real deadline, and files it again if need be
+    }
+
+    SUBCASE("expiry hands out due keys only, within the budget") {
+        RapidExpiry expiry(now);
+        const char bytes[4] = {'a', 'b', 'c', 'd'};
+        for (std::size_t n = 0; n < 4; ++n) expiry.set(RapidSlabString{bytes + n, 1}, n, now + 10);
+        expiry.set(RapidSlabString{bytes + 1, 1}, 1, now + 100);   // pushed back
+        expiry.remove(RapidSlabString{bytes + 2, 1});               // persisted
+        CHECK(expiry.size() == 3);
+
+        std::vector<std::size_t> expired;
+        const auto expire = [&](const RapidSlabString key, const std::size_t hash) {
+            expired.push_back(hash);
+            expiry.remove(key);
+        };
+        CHECK(expiry.expireDue(now + 10, 1, expire) == 1);
+        CHECK(expiry.expireDue(now + 10, 10, expire) == 1);
+        CHECK(expiry.expireDue(now + 99, 10, expire) == 0);
+        CHECK(expiry.deadline(RapidSlabString{bytes + 1, 1}) == now + 100);
+        CHECK(expiry.expireDue(now + 100, 10, expire) == 1);
+        std::sort(expired.begin(), expired.end());
+        CHECK(expired == std::vector<std::size_t>{0, 1, 3});
+        CHECK(expiry.size() == 0);
+    }
+}
+
+
+TEST_CASE("(INTERNAL) Ordered Index") {
+
+    RapidOrderedIndex index;
+    std::set<std::string> keys;     // owns the bytes, like a shard's slab would, and is what the index must match
+
+    const auto key = [](const std::size_t n) { return "key" + std::to_string(n * 7919 % 100'003); };
+    const auto add = [&](const std::string& k) {
+        const auto [it, inserted] = keys.insert(k);
+        if (inserted) REQUIRE(index.insert(RapidSlabString{it->data(), static_cast<std::uint32_t>(it->size())}));
+    };
+    const auto remove = [&](const std::string& k) {
+        index.erase(k);
+        keys.erase(k);
+    };
+    const auto from = [&](const std::string_view start) {
+        std::vector<std::string> seen;
+        index.forEachFrom(start, [&](const RapidSlabString k) {
+            seen.emplace_back(k.view());
+            return true;
+        });
+        return seen;
+    };
+
+    SUBCASE("keys come out in order, from anywhere") {
+        for (std::size_t n = 0; n < 20'000; ++n) add(key(n));     // a few levels deep
+        CHECK(index.size() == keys.size());
+        CHECK(from("") == std::vector<std::string>(keys.begin(), keys.end()));
+        CHECK(from("key5") == std::vector<std::string>(keys.lower_bound("key5"), keys.end()));
+        CHECK(from("key50000x") == std::vector<std::string>(keys.lower_bound("key50000x"), keys.end()));
+        CHECK(from("z").empty());
+
+        std::size_t calls = 0;
+        index.forEachFrom("key1", [&](RapidSlabString) { return ++calls < 10; });
+        CHECK(calls == 10);
+    }
+
+    SUBCASE("erasing keeps it in sync, down to nothing and back") {
+        for (std::size_t n = 0; n < 20'000; ++n) add(key(n));
+        for (std::size_t n = 0; n < 20'000; n += 3) remove(key(n));
+        index.erase("missing");
+        CHECK(index.size() == keys.size());
+        CHECK(from("") == std::vector<std::string>(keys.begin(), keys.end()));
+
+        // whole leaves and inner nodes emptied out, in the middle of the tree
+        for (std::size_t n = 0; n < 20'000; ++n) {
+            if (key(n) >= "key3" && key(n) < "key7") remove(key(n));
+        }
+        CHECK(from("key2") == std::vector<std::string>(keys.lower_bound("key2"), keys.end()));
+
+        for (std::size_t n = 0; n < 20'000; ++n) remove(key(n));
+        CHECK(index.size() == 0);
+        CHECK(from("").empty());
+
+        for (std::size_t n = 0; n < 1'000; ++n) add(key(n));
+        CHECK(from("") == std::vector<std::string>(keys.begin(), keys.end()));
+        index.clear();
+        CHECK(from("").empty());
+    }
+
+    SUBCASE("out of memory, nothing changes") {
+        for (std::size_t n = 0; n < 5'000; ++n) add(key(n));
+        std::vector<std::string> more;      // the bytes the index points at, they stay put
+        for (std::size_t n = 5'000; n < 10'000; ++n) more.push_back(key(n));
+
+        std::vector<char> inserted(more.size());
+        force_oom = true;
+        for (std::size_t i = 0; i < more.size(); ++i) {
+            inserted[i] = index.insert(RapidSlabString{more[i].data(), static_cast<std::uint32_t>(more[i].size())});
+        }
+        force_oom = false;
+
+        CHECK(std::count(inserted.begin(), inserted.end(), 0) > 0);     // every split needs memory
+        for (std::size_t i = 0; i < more.size(); ++i) {
+            if (inserted[i]) keys.insert(more[i]);
+        }
+        CHECK(index.size() == keys.size());
+        CHECK(from("") == std::vector<std::string>(keys.begin(), keys.end()));
+
+        // and the ones that didn't make it still can
+        for (std::size_t i = 0; i < more.size(); ++i) {
+            if (!inserted[i]) add(more[i]);
+        }
+        CHECK(index.size() == 10'000);
+        CHECK(from("") == std::vector<std::string>(keys.begin(), keys.end()));
+    }
+}
@@ -0,0 +1,189 @@
+#include "DataManager.h"
+#include "MemoryMaps.h"
+#include "doctest.h"
+#include "riri/Commands.hpp"
+#include "riri/RapidTypes.hpp"
+#include "riri/Store.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace RiRi::Commands;
+using namespace std::chrono_literals;
+
+
+namespace {
+
+    /// What one key of `key`'s length with a number for a value costs a shard.
+    std::size_t entryCost(const std::string& key) {
+        RiRi::Store probe({.shardCount = 1});
+        SET(probe, key, std::int64_t{0});
+        return RiRi::Internal::StoreAccess::of(probe).shard(0).used();
+    }
+
+    std::string key(const char prefix, const int i) {
+        std::string key = std::to_string(1000 + i);
+        key[0] = prefix;
+        return key;
+    }
+
+} // namespace
+
+
+TEST_SUITE("Store") {
+
+    TEST_CASE("Store options") {
+        RiRi::Store store({.initialCapacity = 1000, .maxLoadFactor = 5.0f, .shardCount = 3});
+
+        CHECK(store.options().initialCapacity == 1000);
+        CHECK(store.options().maxLoadFactor == doctest::Approx(0.99f));     // clamped
+        CHECK(store.options().shardCount == 4);                             // rounded up
+
+        // the default store is the one the Internal::* default overloads work on
+        CHECK(&RiRi::Internal::StoreAccess::of(RiRi::Store::defaultStore()) == &RiRi::Internal::MemoryMap);
+        CHECK(RiRi::Store::defaultStore().options().shardCount == RiRi::Internal::DEFAULT_SHARD_COUNT);
+
+        // pre-sized: no shard has to grow before its share of the capacity is used up
+        RiRi::Internal::RapidStore& rapid = RiRi::Internal::StoreAccess::of(store);
+        for (std::size_t s = 0; s < rapid.shardCount(); s++) {
+            CHECK(rapid.shard(s).map.capacity() >= 250);
+        }
+    }
+
+    TEST_CASE("Stores are isolated") {
+        RiRi::Internal::clearMap();
+        RiRi::Store tenant_a;
+        RiRi::Store tenant_b({.shardCount = 1});
+
+        CHECK(SET(tenant_a, "key", "a").ok());
+        CHECK(SET(tenant_b, "key", "b").ok());
+        CHECK(SET(tenant_a, "key", "again").code() == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+
+        CHECK(*GET(tenant_a, "key").field() == RiRi::RapidDataType("a"));
+        CHECK(*GET(tenant_b, "key").field() == RiRi::RapidDataType("b"));
+        CHECK(GET("key").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);     // default store never saw it
+
+        CHECK(UPDATE(tenant_b, "key", "bb").ok());
+        CHECK(*GET(tenant_b, "key").field() == RiRi::RapidDataType("bb"));
+        CHECK(*GET(tenant_a, "key").field() == RiRi::RapidDataType("a"));
+
+        CHECK(CLEAR(tenant_a).ok());
+        CHECK(GET(tenant_a, "key").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+        CHECK(GET(tenant_b, "key").ok());
+
+        CHECK(DELETE(tenant_b, "key").ok());
+        CHECK(DELETE(tenant_b, "key").code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+    }
+
+    TEST_CASE("Batched overloads on a store") {
+        RiRi::Store store({.initialCapacity = 64});
+        RiRi::RapidNode nodes[] {{"k1", std::int64_t{1}}, {"k2", std::int64_t{2}}, {"k1", std::int64_t{3}}};
+
+        auto set = SET(store, nodes, RiRi::enableErrorBatched{});
+        CHECK(set.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);     // the duplicate k1
+
+        RiRi::RapidNode keys[] {{"k1", {}}, {"k2", {}}, {"missing", {}}};
+        auto get = GET(store, keys, RiRi::enableBatched{});
+        CHECK(get.totalEntryCount() == 3);
+        CHECK(get.code() == RiRi::StatusCode::ERR_SOME_OPERATIONS_FAILED);
+
+        RiRi::RapidNode updates[] {{"k1", std::int64_t{10}}, {"k2", std::int64_t{20}}};
+        CHECK(UPDATE(store, updates).ok());
+        CHECK(*GET(store, "k2").field() == RiRi::RapidDataType(std::int64_t{20}));
+
+        CHECK(DELETE(store, updates, RiRi::enableBatched{}).ok());
+        CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(store)) == 0);
+    }
+
+    TEST_CASE("Stores can be moved") {
+        RiRi::Store store;
+        SET(store, "key", true);
+        RiRi::Store moved(std::move(store));
+        CHECK(*GET(moved, "key").field() == RiRi::RapidDataType(true));
+    }
+
+    TEST_CASE("Memory budget") {
+        const std::size_t cost = entryCost(key('a', 0));
+        REQUIRE(cost > 0);
+
+        SUBCASE("a full store turns writes down, and warns before that") {
+            RiRi::Store store({.shardCount = 1, .maxMemory = 100 * cost, .memoryWarningRatio = 0.5f});
+            const RiRi::Internal::RapidShard& shard = RiRi::Internal::StoreAccess::of(store).shard(0);
+
+            int i = 0;
+            for (; i < 50; i++) REQUIRE(SET(store, key('a', i), std::int64_t{i}).ok());
+            CHECK(SET(store, key('a', i++), std::int64_t{0}).code() == RiRi::StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
+            for (; i < 100; i++) REQUIRE(SET(store, key('a', i), std::int64_t{i}).code() == RiRi::StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
+            CHECK(shard.used() == 100 * cost);
+
+            CHECK(SET(store, key('b', 0), std::int64_t{0}).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+            CHECK(SET(store, key('a', 0), std::int64_t{0}).code() == RiRi::StatusCode::ERR_KEY_ALREADY_EXISTS);
+            CHECK(UPDATE(store, key('a', 0), std::int64_t{-1}).code() == RiRi::StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
+            CHECK(UPDATE(store, key('a', 0), std::string(100, 'v')).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+            CHECK(*GET(store, key('a', 0)).field() == RiRi::RapidDataType(std::int64_t{-1}));     // left as it was
+
+            RiRi::RapidNode nodes[] {{key('b', 0), std::int64_t{0}}, {key('a', 1), std::int64_t{0}}};
+            const auto batch = SET(store, nodes, RiRi::enableErrorBatched{});
+            CHECK(batch.totalErrorCount() == 2);
+            CHECK(batch.begin()[0].code != batch.begin()[1].code);  // full, and already there
+
+            CHECK(DELETE(store, key('a', 0)).ok());
+            CHECK(SET(store, key('b', 0), std::int64_t{0}).code() == RiRi::StatusCode::WARN_KEY_STORE_NEARING_CAPACITY);
+            CHECK(RiRi::Internal::size(RiRi::Internal::StoreAccess::of(store)) == 100);
+
+            CHECK(CLEAR(store).ok());
+            CHECK(shard.used() == 0);
+            CHECK(SET(store, "big", std::string(200 * cost, 'v')).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+        }
+
+        SUBCASE("LRU evicts the keys nobody read in a while") {
+            for (const bool concurrent : {false, true}) {   // lock-free reads count as uses too
+                CAPTURE(concurrent);
+                RiRi::Store store({.shardCount = 1, .concurrentReads = concurrent, .maxMemory = 100 * cost, .eviction = RiRi::EvictionPolicy::LRU, .memoryWarningRatio = 1.0f});
+                const RiRi::Internal::RapidShard& shard = RiRi::Internal::StoreAccess::of(store).shard(0);
+
+                for (int i = 0; i < 100; i++) REQUIRE(SET(store, key('a', i), std::int64_t{i}).ok());
+                std::this_thread::sleep_for(50ms);
+                for (int i = 0; i < 50; i++) REQUIRE(GET(store, key('a', i)).ok());
+                for (int i = 0; i < 50; i++) REQUIRE(SET(store, key('b', i), std::int64_t{i}).ok());     // never full, it evicts
+                CHECK(shard.used() <= 100 * cost);
+
+                int read = 0, unread = 0;
+                for (int i = 0; i < 50; i++) read += GET(store, key('a', i)).ok();
+                for (int i = 50; i < 100; i++) unread += GET(store, key('a', i)).ok();
+                CHECK(read > unread);
+            }
+        }
+
+        SUBCASE("LFU evicts the keys read the least") {
+            for (const bool concurrent : {false, true}) {
+                CAPTURE(concurrent);
+                RiRi::Store store({.shardCount = 1, .concurrentReads = concurrent, .maxMemory = 100 * cost, .eviction = RiRi::EvictionPolicy::LFU, .memoryWarningRatio = 1.0f});
+                const RiRi::Internal::RapidShard& shard = RiRi::Internal::StoreAccess::of(store).shard(0);
+
+                for (int i = 0; i < 100; i++) REQUIRE(SET(store, key('a', i), std::int64_t{i}).ok());
+                for (int round = 0; round < 100; round++) {
+                    for (int i = 0; i < 50; i++) REQUIRE(GET(store, key('a', i)).ok());
+                }
+                for (int i = 0; i < 50; i++) REQUIRE(SET(store, key('b', i), std::int64_t{i}).ok());
+                CHECK(shard.used() <= 100 * cost);
+
+                int hot = 0, cold = 0;
+                for (int i = 0; i < 50; i++) hot += GET(store, key('a', i)).ok();
+                for (int i = 50; i < 100; i++) cold += GET(store, key('a', i)).ok();
+                CHECK(hot > cold);
+            }
+        }
+
+        SUBCASE("an update never evicts the key it updates") {
+            RiRi::Store store({.shardCount = 1, .maxMemory = 2 * cost + 32, .eviction = RiRi::EvictionPolicy::LRU, .memoryWarningRatio = 1.0f});
+            REQUIRE(SET(store, key('a', 0), std::int64_t{0}).ok());
+            REQUIRE(SET(store, key('a', 1), std::int64_t{1}).ok());
+            CHECK(UPDATE(store, key('a', 0), std::string(64, 'v')).ok());
+            CHECK(GET(store, key('a', 0)).ok());
+            CHECK(GET(store, key('a', 1)).code() == RiRi::StatusCode::ERR_KEY_NOT_FOUND);
+            CHECK(UPDATE(store, key('a', 0), std::string(128, 'v')).code() == RiRi::StatusCode::ERR_KEY_STORE_FULL);
+        }
+    }
+}